@@ -212,6 +212,9 @@ void CaptureContext::LoadLogfileThreaded(const QString &logFile, const QString &
 
     AddFakeProfileMarkers();
 
+    m_DrawcallTable.clear();
+    CacheDrawcalls(m_Drawcalls);
+
     m_PostloadProgress = 0.4f;
 
     m_WinSystems = r->GetSupportedWindowSystems();
@@ -510,6 +513,22 @@ void CaptureContext::AddFakeProfileMarkers()
     m_Drawcalls[i] = ret[i];
 }
 
+void CaptureContext::CacheDrawcalls(const rdctype::array<DrawcallDescription> &draws)
+{
+  for(const DrawcallDescription &d : draws)
+  {
+    CacheDrawcalls(d.children);
+
+    if((int)d.eventID >= m_DrawcallTable.size())
+      m_DrawcallTable.resize(d.eventID + 1);
+
+    // children come first, so if a parent shares its EID with a child the child is returned, the
+    // same as a search of the tree would.
+    if(m_DrawcallTable[d.eventID] == NULL)
+      m_DrawcallTable[d.eventID] = &d;
+  }
+}
+
 void CaptureContext::CloseLogfile()
 {
   if(!m_LogLoaded)
@@ -535,6 +554,8 @@ void CaptureContext::CloseLogfile()
   m_DebugMessages.clear();
   m_UnreadMessageCount = 0;
 
+  m_DrawcallTable.clear();
+
   m_LogLoaded = false;
 
   QVector<ILogViewer *> logviewers(m_LogViewers);
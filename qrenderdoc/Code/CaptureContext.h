@@ -109,7 +109,7 @@ public:
   const rdctype::array<BufferDescription> &GetBuffers() override { return m_BufferList; }
   const DrawcallDescription *GetDrawcall(uint32_t eventID) override
   {
-    return GetDrawcall(m_Drawcalls, eventID);
+    return (int)eventID < m_DrawcallTable.size() ? m_DrawcallTable[eventID] : NULL;
   }
 
   WindowingSystem CurWindowingSystem() override { return m_CurWinSystem; }
@@ -217,28 +217,13 @@ private:
   uint32_t m_SelectedEventID;
   uint32_t m_EventID;
 
-  const DrawcallDescription *GetDrawcall(const rdctype::array<DrawcallDescription> &draws,
-                                         uint32_t eventID)
-  {
-    for(const DrawcallDescription &d : draws)
-    {
-      if(!d.children.empty())
-      {
-        const DrawcallDescription *draw = GetDrawcall(d.children, eventID);
-        if(draw != NULL)
-          return draw;
-      }
-
-      if(d.eventID == eventID)
-        return &d;
-    }
-
-    return NULL;
-  }
+  // fills m_DrawcallTable so that drawcalls can be looked up by EID without searching the tree
+  void CacheDrawcalls(const rdctype::array<DrawcallDescription> &draws);
 
   void setupDockWindow(QWidget *shad);
 
   rdctype::array<DrawcallDescription> m_Drawcalls;
+  QVector<const DrawcallDescription *> m_DrawcallTable;
 
   APIProperties m_APIProps;
   FrameDescription m_FrameInfo;
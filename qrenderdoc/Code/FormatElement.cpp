@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include <QRegularExpression>
+#include <QVarLengthArray>
 #include <QtMath>
 #include "QRDUtils.h"
 
@@ -923,3 +924,363 @@ QString RowTypeString(const ShaderVariable &v)
 
   return QString("%1%2").arg(typeStr).arg(v.columns);
 }
+
+static uint32_t DisplayComponentCount(const FormatElement &el)
+{
+  switch(el.format.specialFormat)
+  {
+    case SpecialFormat::BC6:
+    case SpecialFormat::ETC2:
+    case SpecialFormat::R11G11B10:
+    case SpecialFormat::R5G6B5:
+    case SpecialFormat::R9G9B9E5: return 3;
+    case SpecialFormat::BC1:
+    case SpecialFormat::BC7:
+    case SpecialFormat::BC3:
+    case SpecialFormat::BC2:
+    case SpecialFormat::R10G10B10A2:
+    case SpecialFormat::R5G5B5A1:
+    case SpecialFormat::R4G4B4A4:
+    case SpecialFormat::ASTC: return 4;
+    case SpecialFormat::BC5:
+    case SpecialFormat::R4G4:
+    case SpecialFormat::D16S8:
+    case SpecialFormat::D24S8:
+    case SpecialFormat::D32S8: return 2;
+    case SpecialFormat::BC4:
+    case SpecialFormat::S8: return 1;
+    case SpecialFormat::YUV:
+    case SpecialFormat::EAC:
+    default: break;
+  }
+
+  return el.format.compCount;
+}
+
+static FormatDecoder::ReadOp CompileReadOp(const ResourceFormat &f, uint32_t &compSize)
+{
+  typedef FormatDecoder::ReadOp ReadOp;
+
+  compSize = f.compByteWidth;
+
+  // packed formats are rare enough that they go through GetVariants
+  if(f.special)
+    return ReadOp::Generic;
+
+  if(f.compType == CompType::Double)
+  {
+    compSize = 8;
+    return ReadOp::Float64;
+  }
+
+  switch(f.compType)
+  {
+    case CompType::Float:
+      if(f.compByteWidth == 8)
+        return ReadOp::Float64;
+      if(f.compByteWidth == 4)
+        return ReadOp::Float32;
+      if(f.compByteWidth == 2)
+        return ReadOp::Float16;
+      break;
+    case CompType::SInt:
+    case CompType::SScaled:
+      if(f.compByteWidth == 4)
+        return ReadOp::SInt32;
+      if(f.compByteWidth == 2)
+        return ReadOp::SInt16;
+      if(f.compByteWidth == 1)
+        return ReadOp::SInt8;
+      break;
+    case CompType::UInt:
+    case CompType::UScaled:
+      if(f.compByteWidth == 4)
+        return ReadOp::UInt32;
+      if(f.compByteWidth == 2)
+        return ReadOp::UInt16;
+      if(f.compByteWidth == 1)
+        return ReadOp::UInt8;
+      break;
+    case CompType::Depth:
+      if(f.compByteWidth == 4)
+        return ReadOp::Float32;
+      if(f.compByteWidth == 2)
+        return ReadOp::Depth16;
+      if(f.compByteWidth == 3)
+      {
+        // 24-bit depth is read as a full 32-bit value and masked
+        compSize = 4;
+        return ReadOp::Depth24;
+      }
+      break;
+    case CompType::UNorm:
+      if(f.compByteWidth == 4)
+        return ReadOp::UNorm32;
+      if(f.compByteWidth == 2)
+        return ReadOp::UNorm16;
+      if(f.compByteWidth == 1)
+        return ReadOp::UNorm8;
+      break;
+    case CompType::SNorm:
+      if(f.compByteWidth == 2)
+        return ReadOp::SNorm16;
+      if(f.compByteWidth == 1)
+        return ReadOp::SNorm8;
+      break;
+    default: break;
+  }
+
+  return ReadOp::Generic;
+}
+
+FormatDecoder::FormatDecoder(const QList<FormatElement> &elements)
+{
+  m_Elements.reserve(elements.count());
+  m_Columns.reserve(elements.count() * 4);
+
+  for(int i = 0; i < elements.count(); i++)
+  {
+    const FormatElement &el = elements[i];
+
+    Element e;
+    e.el = el;
+
+    uint32_t compSize = 0;
+    e.op = CompileReadOp(el.format, compSize);
+    e.readSize = compSize * el.format.compCount * qMax(el.matrixdim, 1U);
+    e.firstColumn = (uint32_t)m_Columns.count();
+    e.numColumns = DisplayComponentCount(el);
+
+    // only plain vectors have a fixed size we know here, packed formats are bounds checked by
+    // GetVariants itself
+    if(e.op == ReadOp::Generic)
+      e.readSize = 0;
+
+    VarType type = VarType::Float;
+    if(el.format.compType == CompType::UInt)
+      type = VarType::UInt;
+    else if(el.format.compType == CompType::SInt)
+      type = VarType::Int;
+    else if(e.op == ReadOp::Float64)
+      type = VarType::Double;
+
+    for(uint32_t c = 0; c < e.numColumns; c++)
+      m_Columns.push_back({i, (int)c, type});
+
+    m_Elements.push_back(e);
+  }
+}
+
+template <typename T, typename Convert>
+static void DecodeStrided(const byte *const *rowData, uint32_t numRows, uint32_t numComps,
+                          bool bgra, double *out, Convert convert)
+{
+  // the destination column for each component, swapping R and B in the output rather than when
+  // reading
+  QVarLengthArray<double *, 16> dst((int)numComps);
+  for(uint32_t c = 0; c < numComps; c++)
+  {
+    uint32_t dstComp = c;
+    if(bgra && (c == 0 || c == 2))
+      dstComp = 2 - c;
+
+    dst[c] = out + dstComp * numRows;
+  }
+
+  // the element's components are contiguous, so read them all in one go. The data may not be
+  // aligned so it still has to be copied out rather than read in place.
+  QVarLengthArray<T, 16> vals((int)numComps);
+  const size_t size = numComps * sizeof(T);
+
+  for(uint32_t r = 0; r < numRows; r++)
+  {
+    if(!rowData[r])
+      continue;
+
+    memcpy(vals.data(), rowData[r], size);
+
+    for(uint32_t c = 0; c < numComps; c++)
+      dst[c][r] = convert(vals[c]);
+  }
+}
+
+void FormatDecoder::Decode(const QVector<Source> &sources, uint32_t firstRow,
+                           const uint32_t *indices, uint32_t numRows, Rows &out) const
+{
+  out.numRows = numRows;
+  out.values.fill(0.0, m_Columns.count() * (int)numRows);
+  out.valid.fill(0, m_Elements.count() * (int)numRows);
+
+  if(numRows == 0)
+    return;
+
+  // pointer to each row's data for the current element, or NULL if it's out of bounds
+  QVector<const byte *> rowData(numRows);
+
+  for(int e = 0; e < m_Elements.count(); e++)
+  {
+    const Element &el = m_Elements[e];
+    const Source src = e < sources.count() ? sources[e] : Source();
+
+    uint8_t *valid = out.valid.data() + e * numRows;
+
+    for(uint32_t r = 0; r < numRows; r++)
+    {
+      rowData[r] = NULL;
+
+      uint32_t idx = indices ? indices[r] : firstRow + r;
+
+      if(src.data == NULL || idx == ~0U)
+        continue;
+
+      const byte *data = src.data + src.stride * idx;
+
+      if(data < src.end && data + el.readSize <= src.end)
+      {
+        rowData[r] = data;
+        valid[r] = 1;
+      }
+    }
+
+    double *dst = out.values.data() + el.firstColumn * numRows;
+
+    if(el.op == ReadOp::Generic)
+    {
+      for(uint32_t r = 0; r < numRows; r++)
+      {
+        if(!rowData[r])
+          continue;
+
+        const byte *data = rowData[r];
+        QVariantList list = el.el.GetVariants(data, src.end);
+
+        // we read off the end, or the format couldn't be interpreted
+        if(list.count() < (int)el.numColumns || !list[0].isValid())
+        {
+          valid[r] = 0;
+          continue;
+        }
+
+        for(uint32_t c = 0; c < el.numColumns; c++)
+          dst[c * numRows + r] = list[c].toDouble();
+      }
+
+      continue;
+    }
+
+    uint32_t comps = el.numColumns;
+    bool bgra = el.el.format.bgraOrder && comps >= 3;
+
+    const byte *const *rows = rowData.data();
+
+    switch(el.op)
+    {
+      case ReadOp::Float16:
+        DecodeStrided<uint16_t>(rows, numRows, comps, bgra, dst,
+                                [](uint16_t v) { return (double)Maths_HalfToFloat(v); });
+        break;
+      case ReadOp::Float32:
+        DecodeStrided<float>(rows, numRows, comps, bgra, dst,
+                             [](float v) { return (double)v; });
+        break;
+      case ReadOp::Float64:
+        DecodeStrided<double>(rows, numRows, comps, bgra, dst, [](double v) { return v; });
+        break;
+      case ReadOp::SInt8:
+        DecodeStrided<int8_t>(rows, numRows, comps, bgra, dst,
+                              [](int8_t v) { return (double)v; });
+        break;
+      case ReadOp::SInt16:
+        DecodeStrided<int16_t>(rows, numRows, comps, bgra, dst,
+                               [](int16_t v) { return (double)v; });
+        break;
+      case ReadOp::SInt32:
+        DecodeStrided<int32_t>(rows, numRows, comps, bgra, dst,
+                               [](int32_t v) { return (double)v; });
+        break;
+      case ReadOp::UInt8:
+        DecodeStrided<uint8_t>(rows, numRows, comps, bgra, dst,
+                               [](uint8_t v) { return (double)v; });
+        break;
+      case ReadOp::UInt16:
+        DecodeStrided<uint16_t>(rows, numRows, comps, bgra, dst,
+                                [](uint16_t v) { return (double)v; });
+        break;
+      case ReadOp::UInt32:
+        DecodeStrided<uint32_t>(rows, numRows, comps, bgra, dst,
+                                [](uint32_t v) { return (double)v; });
+        break;
+      case ReadOp::UNorm8:
+        DecodeStrided<uint8_t>(rows, numRows, comps, bgra, dst,
+                               [](uint8_t v) { return (double)((float)v / 255.0f); });
+        break;
+      case ReadOp::UNorm16:
+        DecodeStrided<uint16_t>(rows, numRows, comps, bgra, dst,
+                                [](uint16_t v) { return (double)((float)v / (float)0xffff); });
+        break;
+      case ReadOp::UNorm32:
+        // should never hit this - no 32bit unorm type
+        DecodeStrided<uint32_t>(rows, numRows, comps, bgra, dst, [](uint32_t v) {
+          return (double)((float)v / (float)0xffffffff);
+        });
+        break;
+      case ReadOp::SNorm8:
+        DecodeStrided<int8_t>(rows, numRows, comps, bgra, dst, [](int8_t v) {
+          return v == -128 ? -1.0 : (double)((float)v / 127.0f);
+        });
+        break;
+      case ReadOp::SNorm16:
+        DecodeStrided<int16_t>(rows, numRows, comps, bgra, dst, [](int16_t v) {
+          return v == -32768 ? -1.0 : (double)((float)v / 32767.0f);
+        });
+        break;
+      case ReadOp::Depth16:
+        DecodeStrided<uint16_t>(rows, numRows, comps, bgra, dst,
+                                [](uint16_t v) { return (double)((float)v / (float)0x0000ffff); });
+        break;
+      case ReadOp::Depth24:
+        DecodeStrided<uint32_t>(rows, numRows, comps, bgra, dst, [](uint32_t v) {
+          return (double)((float)(v & 0x00ffffff) / (float)0x00ffffff);
+        });
+        break;
+      case ReadOp::Generic: break;
+    }
+  }
+}
+
+QString FormatDecoder::FormatValue(int col, double value) const
+{
+  const Column &c = m_Columns[col];
+
+  if(c.type == VarType::UInt)
+    return Formatter::Format((uint32_t)value, m_Elements[c.element].el.hex);
+
+  if(c.type == VarType::Int)
+  {
+    int32_t i = (int32_t)value;
+    if(i > 0)
+      return " " + Formatter::Format(i);
+    return Formatter::Format(i);
+  }
+
+  if(qIsNaN(value))
+    return " NaN";
+
+  // force negative and positive 0 together
+  if(value == 0.0)
+    return " " + Formatter::Format(0.0);
+
+  // values decoded from floats are only widened to double for storage, so display them at float
+  // precision
+  QString str;
+  if(c.type == VarType::Float)
+    str = Formatter::Format((float)value);
+  else
+    str = Formatter::Format(value);
+
+  // pad with space on left if sign is missing, to better align
+  if(value < 0.0)
+    return str;
+
+  return " " + str;
+}
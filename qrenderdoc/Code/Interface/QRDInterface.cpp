@@ -81,6 +81,10 @@ CaptureSettings::operator QVariant() const
   opts["SaveAllInitials"] = Options.SaveAllInitials;
   opts["CaptureAllCmdLists"] = Options.CaptureAllCmdLists;
   opts["DebugOutputMute"] = Options.DebugOutputMute;
+  opts["AsyncCaptureWrite"] = Options.AsyncCaptureWrite;
+  opts["RetroactiveFrames"] = Options.RetroactiveFrames;
+  opts["CaptureStatistics"] = Options.CaptureStatistics;
+  opts["SpillResourceChunks"] = Options.SpillResourceChunks;
   ret["Options"] = opts;
 
   return ret;
@@ -117,6 +121,10 @@ CaptureSettings::CaptureSettings(const QVariant &v)
   Options.SaveAllInitials = opts["SaveAllInitials"].toBool();
   Options.CaptureAllCmdLists = opts["CaptureAllCmdLists"].toBool();
   Options.DebugOutputMute = opts["DebugOutputMute"].toBool();
+  Options.AsyncCaptureWrite = opts["AsyncCaptureWrite"].toBool();
+  Options.RetroactiveFrames = opts["RetroactiveFrames"].toUInt();
+  Options.CaptureStatistics = opts["CaptureStatistics"].toBool();
+  Options.SpillResourceChunks = opts["SpillResourceChunks"].toBool();
 }
 
 QString ConfigFilePath(const QString &filename)
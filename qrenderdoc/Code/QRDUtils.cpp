@@ -37,6 +37,7 @@
 #include <QStandardPaths>
 #include <QTreeWidget>
 #include <QtMath>
+#include <float.h>
 
 QString ToQStr(const ResourceUsage usage, const GraphicsAPI apitype)
 {
@@ -586,11 +587,42 @@ void Formatter::setParams(int minFigures, int maxFigures, int expNegCutoff, int
 }
 
 QString Formatter::Format(double f, bool)
+{
+  return FormatReal(f, m_maxFigures);
+}
+
+QString Formatter::Format(float f, bool)
+{
+  // the float's exact value widened to double has trailing digits that aren't meaningful, e.g.
+  // 0.1f is 0.100000001490116. Limit the figures to FLT_DIG + 1 significant digits.
+  const int floatDigits = FLT_DIG + 1;
+
+  int maxFigures = m_maxFigures;
+
+  if(f != 0.0f && qIsFinite(f))
+  {
+    double d = qAbs((double)f);
+
+    if(d < m_expNegValue || d > m_expPosValue)
+    {
+      maxFigures = qMin(maxFigures, floatDigits - 1);
+    }
+    else
+    {
+      int intDigits = (int)qFloor(std::log10(d)) + 1;
+      maxFigures = qMin(maxFigures, qMax(0, floatDigits - intDigits));
+    }
+  }
+
+  return FormatReal((double)f, maxFigures);
+}
+
+QString Formatter::FormatReal(double f, int maxFigures)
 {
   if(f != 0.0 && (qAbs(f) < m_expNegValue || qAbs(f) > m_expPosValue))
-    return QString("%1").arg(f, -m_minFigures, 'E', m_maxFigures);
+    return QString("%1").arg(f, -m_minFigures, 'E', maxFigures);
 
-  QString ret = QString("%1").arg(f, 0, 'f', m_maxFigures);
+  QString ret = QString("%1").arg(f, 0, 'f', maxFigures);
 
   // trim excess trailing 0s
   int decimal = ret.lastIndexOf(QChar('.'));
@@ -608,6 +608,96 @@ struct FormatElement
   ShaderBuiltin systemValue;
 };
 
+// A list of FormatElements compiled down to flat per-component reads. This decodes a whole range of
+// rows at once into typed columns, without building a QVariantList for every element in every row.
+//
+// Each element expands to one column per displayed component, in the same order as the buffer
+// viewer's columns.
+class FormatDecoder
+{
+public:
+  // where to read an element from. data points at the element in row 0, and each row is stride
+  // bytes further on. A stride of 0 reads the same data for every row (e.g. per-instance data).
+  struct Source
+  {
+    const byte *data = NULL;
+    const byte *end = NULL;
+    size_t stride = 0;
+  };
+
+  // decoded values for a range of rows. Values are stored column-major so each column is
+  // contiguous, and an element that couldn't be read for a row is marked as invalid.
+  struct Rows
+  {
+    uint32_t numRows = 0;
+    QVector<double> values;
+    QVector<uint8_t> valid;
+
+    const double *column(int col) const { return values.data() + col * numRows; }
+    double value(int col, uint32_t row) const { return values[col * numRows + row]; }
+    bool isValid(int element, uint32_t row) const { return valid[element * numRows + row] != 0; }
+  };
+
+  FormatDecoder() {}
+  explicit FormatDecoder(const QList<FormatElement> &elements);
+
+  int elementCount() const { return m_Elements.count(); }
+  int columnCount() const { return m_Columns.count(); }
+  int elementForColumn(int col) const { return m_Columns[col].element; }
+  int componentForColumn(int col) const { return m_Columns[col].component; }
+  VarType columnType(int col) const { return m_Columns[col].type; }
+
+  // decodes numRows rows into out. sources has one entry per element. If indices is non-NULL it
+  // gives the row to read for each output row, with ~0U for rows that have no data.
+  void Decode(const QVector<Source> &sources, uint32_t firstRow, const uint32_t *indices,
+              uint32_t numRows, Rows &out) const;
+
+  // formats a decoded value for display, the same way the buffer viewer always has
+  QString FormatValue(int col, double value) const;
+
+  enum class ReadOp
+  {
+    Generic,
+    Float16,
+    Float32,
+    Float64,
+    SInt8,
+    SInt16,
+    SInt32,
+    UInt8,
+    UInt16,
+    UInt32,
+    UNorm8,
+    UNorm16,
+    UNorm32,
+    SNorm8,
+    SNorm16,
+    Depth16,
+    Depth24,
+  };
+
+private:
+  struct Element
+  {
+    FormatElement el;
+    ReadOp op;
+    // total bytes read for the element. If any of these are past the end, the row is invalid
+    uint32_t readSize;
+    uint32_t firstColumn;
+    uint32_t numColumns;
+  };
+
+  struct Column
+  {
+    int element;
+    int component;
+    VarType type;
+  };
+
+  QVector<Element> m_Elements;
+  QVector<Column> m_Columns;
+};
+
 QString TypeString(const ShaderVariable &v);
 QString RowString(const ShaderVariable &v, uint32_t row, VarType type = VarType::Unknown);
 QString VarString(const ShaderVariable &v);
@@ -622,6 +712,8 @@ struct Formatter
   static void setParams(int minFigures, int maxFigures, int expNegCutoff, int expPosCutoff);
 
   static QString Format(double f, bool hex = false);
+  // as above, but doesn't display more significant figures than a float holds
+  static QString Format(float f, bool hex = false);
   static QString Format(uint64_t u, bool hex = false)
   {
     return QString("%1").arg(u, hex ? 16 : 0, hex ? 16 : 10, QChar('0'));
@@ -636,6 +728,8 @@ struct Formatter
   }
   static QString Format(int32_t i, bool hex = false) { return QString::number(i); }
 private:
+  static QString FormatReal(double f, int maxFigures);
+
   static int m_minFigures, m_maxFigures, m_expNegCutoff, m_expPosCutoff;
   static double m_expNegValue, m_expPosValue;
 };
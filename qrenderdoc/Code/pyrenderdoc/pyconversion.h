@@ -347,6 +347,26 @@ struct TypeConversion<rdctype::array<byte>, false>
   }
 };
 
+// specialisation for bytebuf
+template <>
+struct TypeConversion<rdctype::bytebuf, false>
+{
+  static int ConvertFromPy(PyObject *in, rdctype::bytebuf &out)
+  {
+    if(!PyBytes_Check(in))
+      return SWIG_TypeError;
+
+    out.assign((const uint8_t *)PyBytes_AsString(in), (uint64_t)PyBytes_Size(in));
+
+    return SWIG_OK;
+  }
+
+  static PyObject *ConvertToPy(PyObject *self, const rdctype::bytebuf &in)
+  {
+    return PyBytes_FromStringAndSize((const char *)in.elems, (Py_ssize_t)in.count);
+  }
+};
+
 // specialisation for array
 template <typename U>
 struct TypeConversion<rdctype::array<U>, false>
@@ -42,6 +42,7 @@
 %include "pyconversion.i"
 
 SIMPLE_TYPEMAPS(rdctype::str)
+SIMPLE_TYPEMAPS(rdctype::bytebuf)
 
 CONTAINER_TYPEMAPS(rdctype::array)
 
@@ -55,11 +56,35 @@ CONTAINER_TYPEMAPS(rdctype::array)
   if(failed) SWIG_fail;
 }
 
+// destination memory is passed as any writable object supporting the buffer protocol, and written
+// to in-place without an intermediate copy. The view is cleared before any argument is converted,
+// as freearg also runs when an earlier argument fails
+%typemap(arginit) (byte *dest, uint64_t destSize) (Py_buffer view) {
+  memset(&view, 0, sizeof(view));
+}
+
+%typemap(in) (byte *dest, uint64_t destSize) {
+  if(PyObject_GetBuffer($input, &view$argnum, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS) != 0)
+  {
+    SWIG_exception_fail(SWIG_TypeError, "in method '$symname' argument $argnum expected a writable contiguous buffer");
+  }
+
+  $1 = (byte *)view$argnum.buf;
+  $2 = (uint64_t)view$argnum.len;
+}
+
+%typemap(freearg) (byte *dest, uint64_t destSize) {
+  if(view$argnum.obj)
+    PyBuffer_Release(&view$argnum);
+}
+
 // ignore some operators SWIG doesn't have to worry about
 %ignore rdctype::array::operator=;
 %ignore rdctype::array::operator[];
 %ignore rdctype::str::operator=;
 %ignore rdctype::str::operator const char *;
+%ignore rdctype::bytebuf::operator=;
+%ignore rdctype::bytebuf::operator[];
 
 // add __str__ functions
 %feature("python:tp_str") ResourceId "resid_str";
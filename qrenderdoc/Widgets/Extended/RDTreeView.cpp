@@ -23,6 +23,7 @@
  ******************************************************************************/
 
 #include "RDTreeView.h"
+#include <QKeyEvent>
 #include <QPainter>
 
 RDTreeView::RDTreeView(QWidget *parent) : QTreeView(NULL)
@@ -62,3 +63,9 @@ void RDTreeView::drawBranches(QPainter *painter, const QRect &rect, const QModel
     style()->drawPrimitive(QStyle::PE_IndicatorBranch, &opt, painter, this);
   }
 }
+
+void RDTreeView::keyPressEvent(QKeyEvent *e)
+{
+  emit(keyPress(e));
+  QTreeView::keyPressEvent(e);
+}
@@ -33,7 +33,11 @@ public:
   explicit RDTreeView(QWidget *parent = 0);
 
   void setDrawBranches(bool draw) { m_DrawBranches = draw; }
+signals:
+  void keyPress(QKeyEvent *e);
+
 private:
+  void keyPressEvent(QKeyEvent *e) override;
   void drawBranches(QPainter *painter, const QRect &rect, const QModelIndex &index) const override;
 
   bool m_DrawBranches = true;
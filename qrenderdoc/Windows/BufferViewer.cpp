@@ -28,7 +28,10 @@
 #include <QFontDatabase>
 #include <QMenu>
 #include <QMouseEvent>
+#include <QPointer>
 #include <QScrollBar>
+#include <QSet>
+#include <QSharedPointer>
 #include <QTimer>
 #include <QtMath>
 #include "Code/Resources.h"
@@ -331,6 +334,138 @@ struct BufferData
   size_t stride;
 };
 
+// Fetches a large buffer from the replay one page of rows at a time, only once the rows are
+// actually needed, and keeps the most recently used pages in memory.
+class BufferPager : public QEnableSharedFromThis<BufferPager>
+{
+public:
+  BufferPager(IReplayManager &replay, ResourceId id, uint64_t offset, uint64_t size, size_t stride,
+              uint32_t rowAlignment)
+      : m_Replay(replay), m_ID(id), m_Offset(offset), m_Size(size)
+  {
+    // keep pages a multiple of the rows decoded at once, so no block of rows straddles two pages
+    uint64_t alignBytes = qMax((uint64_t)1, (uint64_t)stride * rowAlignment);
+    m_RowsPerPage = rowAlignment * (uint32_t)qMax((uint64_t)1, PageTargetBytes / alignBytes);
+    m_PageBytes = (uint64_t)m_RowsPerPage * qMax((size_t)1, stride);
+  }
+
+  // called on the UI thread whenever a requested page has been fetched
+  std::function<void(uint32_t)> arrived;
+
+  uint32_t rowsPerPage() const { return m_RowsPerPage; }
+  uint32_t pageForRow(uint32_t row) const { return row / m_RowsPerPage; }
+  uint32_t numPages() const { return uint32_t((m_Size + m_PageBytes - 1) / m_PageBytes); }
+  // returns a page if it's already resident, otherwise it's fetched in the background along with
+  // its neighbours and an empty array is returned.
+  QByteArray requestPage(uint32_t page)
+  {
+    QMutexLocker autolock(&m_Lock);
+
+    QByteArray ret = m_Pages.value(page);
+
+    if(!ret.isNull())
+    {
+      m_LRU.removeOne(page);
+      m_LRU.push_back(page);
+    }
+
+    // prefetch either side so that scrolling doesn't stall at every page boundary
+    fetchAsync(page);
+    fetchAsync(page + 1);
+    if(page > 0)
+      fetchAsync(page - 1);
+
+    return ret;
+  }
+
+  // returns a page, blocking until it's been fetched. Must not be called on the replay thread.
+  QByteArray waitForPage(uint32_t page)
+  {
+    {
+      QMutexLocker autolock(&m_Lock);
+
+      QByteArray ret = m_Pages.value(page);
+      if(!ret.isNull())
+        return ret;
+    }
+
+    QByteArray ret;
+    m_Replay.BlockInvoke([this, page, &ret](IReplayController *r) { ret = fetch(r, page); });
+
+    QMutexLocker autolock(&m_Lock);
+    insertPage(page, ret);
+
+    return ret;
+  }
+
+private:
+  // aim for around this many bytes per request, which is few enough round trips for remote replay
+  // without stalling for long on any single page
+  static const uint64_t PageTargetBytes = 1024 * 1024;
+  static const int MaxResidentPages = 32;
+
+  IReplayManager &m_Replay;
+  ResourceId m_ID;
+  uint64_t m_Offset;
+  uint64_t m_Size;
+
+  uint32_t m_RowsPerPage;
+  uint64_t m_PageBytes;
+
+  QMutex m_Lock;
+  QMap<uint32_t, QByteArray> m_Pages;
+  QList<uint32_t> m_LRU;
+  QSet<uint32_t> m_Pending;
+
+  QByteArray fetch(IReplayController *r, uint32_t page)
+  {
+    uint64_t start = (uint64_t)page * m_PageBytes;
+
+    if(start >= m_Size)
+      return QByteArray();
+
+    rdctype::bytebuf data =
+        r->GetBufferData(m_ID, m_Offset + start, qMin(m_PageBytes, m_Size - start));
+
+    return QByteArray((const char *)data.elems, (int)data.count);
+  }
+
+  void insertPage(uint32_t page, const QByteArray &data)
+  {
+    m_Pages[page] = data;
+    m_LRU.removeOne(page);
+    m_LRU.push_back(page);
+
+    while(m_LRU.count() > MaxResidentPages)
+      m_Pages.remove(m_LRU.takeFirst());
+  }
+
+  void fetchAsync(uint32_t page)
+  {
+    if(page >= numPages() || m_Pages.contains(page) || m_Pending.contains(page))
+      return;
+
+    m_Pending.insert(page);
+
+    QSharedPointer<BufferPager> self = sharedFromThis();
+
+    m_Replay.AsyncInvoke([self, page](IReplayController *r) {
+      QByteArray data = self->fetch(r, page);
+
+      {
+        QMutexLocker autolock(&self->m_Lock);
+        self->m_Pending.remove(page);
+        self->insertPage(page, data);
+      }
+
+      GUIInvoke::call([self, page]() {
+        if(self->arrived)
+          self->arrived(page);
+      });
+    });
+  }
+};
+
 uint32_t CalcIndex(BufferData *data, uint32_t vertID, int32_t baseVertex)
 {
   byte *idxData = data->data + vertID * sizeof(uint32_t);
@@ -357,6 +492,68 @@ uint32_t CalcIndex(BufferData *data, uint32_t vertID, int32_t baseVertex)
   return idx;
 }
 
+// rows decoded at once when iterating over a whole buffer, to bound the temporary memory used
+static const uint32_t DecodeBlockSize = 4096;
+
+// raw buffers larger than this are fetched on demand by a BufferPager instead of all at once
+static const uint64_t PagedBufferThreshold = 16 * 1024 * 1024;
+
+void CalcRowIndices(BufferData *indices, int32_t baseVertex, uint32_t firstRow, uint32_t numRows,
+                    QVector<uint32_t> &idx)
+{
+  idx.resize(numRows);
+
+  if(indices && indices->data)
+  {
+    for(uint32_t r = 0; r < numRows; r++)
+      idx[r] = CalcIndex(indices, firstRow + r, baseVertex);
+  }
+  else
+  {
+    for(uint32_t r = 0; r < numRows; r++)
+      idx[r] = firstRow + r;
+  }
+}
+
+QVector<FormatDecoder::Source> DecoderSources(const QList<FormatElement> &columns,
+                                              const QList<BufferData *> &buffers, uint32_t inst)
+{
+  QVector<FormatDecoder::Source> sources;
+  sources.reserve(columns.count());
+
+  for(const FormatElement &el : columns)
+  {
+    FormatDecoder::Source src;
+
+    if(el.buffer < buffers.size() && buffers[el.buffer])
+    {
+      BufferData *buf = buffers[el.buffer];
+
+      src.data = buf->data + el.offset;
+      src.end = buf->end;
+      src.stride = buf->stride;
+
+      // per-instance data reads the same element for every row
+      if(el.perinstance)
+      {
+        uint32_t instIdx = 0;
+        if(el.instancerate > 0)
+          instIdx = inst / el.instancerate;
+
+        src.data += buf->stride * instIdx;
+        src.stride = 0;
+      }
+
+      if(buf->data == NULL)
+        src.data = NULL;
+    }
+
+    sources.push_back(src);
+  }
+
+  return sources;
+}
+
 class BufferItemModel : public QAbstractItemModel
 {
 public:
@@ -365,7 +562,11 @@ public:
     view = v;
     view->setModel(this);
   }
-  void beginReset() { emit beginResetModel(); }
+  void beginReset()
+  {
+    emit beginResetModel();
+    invalidatePages();
+  }
   void endReset()
   {
     cacheColumns();
@@ -486,105 +687,88 @@ public:
       {
         if(col >= 0 && col < m_ColumnCount && row < numRows)
         {
-          if(col == 0 && meshView)
-            return row;
+          QMutexLocker autolock(&m_PageLock);
 
-          uint32_t idx = row;
+          const RowPage &page = pageForRow(row);
+          uint32_t r = row - page.firstRow;
 
-          if(indices && indices->data)
-          {
-            idx = CalcIndex(indices, row, baseVertex);
+          return cellData(row, page.idx[r], col, page.rows, r);
+        }
+      }
+    }
 
-            if(idx == ~0U)
-              return QVariant();
-          }
+    return QVariant();
+  }
 
-          if(col == 1 && meshView)
-            return idx;
+  // decodes a block of rows in one go, and returns the index used for each row. If the data is
+  // paged and not yet available the rows are returned as invalid, unless waitForData is set.
+  void decodeRows(uint32_t firstRow, uint32_t count, FormatDecoder::Rows &rows,
+                  QVector<uint32_t> &idx, bool waitForData = false) const
+  {
+    CalcRowIndices(indices, baseVertex, firstRow, count, idx);
 
-          const FormatElement &el = elementForColumn(col);
+    if(pager)
+    {
+      // paged data is only used for raw buffers, which are tightly packed in one buffer. Blocks of
+      // rows never straddle pages, so decode relative to the start of the page.
+      uint32_t page = pager->pageForRow(firstRow);
+      QByteArray bytes = waitForData ? pager->waitForPage(page) : pager->requestPage(page);
 
-          uint32_t instIdx = 0;
-          if(el.instancerate > 0)
-            instIdx = curInstance / el.instancerate;
+      BufferData pageData;
+      pageData.data = (byte *)bytes.data();
+      pageData.end = pageData.data + bytes.size();
+      pageData.stride = buffers.isEmpty() ? 1 : buffers[0]->stride;
 
-          if(el.buffer < buffers.size())
-          {
-            const byte *data = buffers[el.buffer]->data;
-            const byte *end = buffers[el.buffer]->end;
+      if(bytes.isEmpty())
+        pageData.data = pageData.end = NULL;
 
-            if(!el.perinstance)
-              data += buffers[el.buffer]->stride * idx;
-            else
-              data += buffers[el.buffer]->stride * instIdx;
+      QList<BufferData *> pageBuffers = {&pageData};
 
-            data += el.offset;
+      uint32_t pageStart = page * pager->rowsPerPage();
+      QVector<uint32_t> pageIdx = idx;
+      for(uint32_t &i : pageIdx)
+        if(i != ~0U)
+          i -= pageStart;
 
-            // only slightly wasteful, we need to fetch all variants together
-            // since some formats are packed and can't be read individually
-            QVariantList list = el.GetVariants(data, end);
+      decoder.Decode(DecoderSources(columns, pageBuffers, curInstance), firstRow - pageStart,
+                     pageIdx.data(), count, rows);
+      return;
+    }
 
-            int comp = componentForIndex(col);
+    decoder.Decode(DecoderSources(columns, buffers, curInstance), firstRow, idx.data(), count, rows);
+  }
 
-            if(comp < list.count())
-            {
-              QVariant &v = list[comp];
-
-              QString ret;
-
-              QMetaType::Type vt = (QMetaType::Type)v.type();
-
-              if(vt == QMetaType::Double)
-              {
-                double d = v.toDouble();
-                // pad with space on left if sign is missing, to better align
-                if(d < 0.0)
-                  ret = Formatter::Format(d);
-                else if(d > 0.0)
-                  ret = " " + Formatter::Format(d);
-                else if(qIsNaN(d))
-                  ret = " NaN";
-                else
-                  // force negative and positive 0 together
-                  ret = " " + Formatter::Format(0.0);
-              }
-              else if(vt == QMetaType::Float)
-              {
-                float f = v.toFloat();
-                // pad with space on left if sign is missing, to better align
-                if(f < 0.0)
-                  ret = Formatter::Format(f);
-                else if(f > 0.0)
-                  ret = " " + Formatter::Format(f);
-                else if(qIsNaN(f))
-                  ret = " NaN";
-                else
-                  // force negative and positive 0 together
-                  ret = " " + Formatter::Format(0.0);
-              }
-              else if(vt == QMetaType::UInt || vt == QMetaType::UShort || vt == QMetaType::UChar)
-              {
-                ret = Formatter::Format(v.toUInt(), el.hex);
-              }
-              else if(vt == QMetaType::Int || vt == QMetaType::Short || vt == QMetaType::SChar)
-              {
-                int i = v.toInt();
-                if(i > 0)
-                  ret = " " + Formatter::Format(i);
-                else
-                  ret = Formatter::Format(i);
-              }
-              else
-                ret = v.toString();
-
-              return ret;
-            }
-          }
-        }
-      }
-    }
+  void pageArrived(uint32_t page)
+  {
+    if(!pager || numRows == 0 || m_ColumnCount == 0)
+      return;
 
-    return QVariant();
+    invalidatePages();
+
+    uint32_t first = qMin(page * pager->rowsPerPage(), numRows - 1);
+    uint32_t last = qMin(first + pager->rowsPerPage(), numRows) - 1;
+
+    emit dataChanged(index(first, 0), index(last, m_ColumnCount - 1), {Qt::DisplayRole});
+  }
+
+  QVariant cellData(uint32_t row, uint32_t idx, int col, const FormatDecoder::Rows &rows,
+                    uint32_t rowInBlock) const
+  {
+    if(col == 0 && meshView)
+      return row;
+
+    if(idx == ~0U)
+      return QVariant();
+
+    if(col == 1 && meshView)
+      return idx;
+
+    int dataCol = col - reservedColumnCount();
+
+    if(!rows.isValid(decoder.elementForColumn(dataCol), rowInBlock))
+      return QVariant();
+
+    return decoder.FormatValue(dataCol, rows.value(dataCol, rowInBlock));
   }
 
   RDTableView *view = NULL;
@@ -597,6 +781,7 @@ public:
   BufferData *indices = NULL;
   QList<FormatElement> columns;
   QList<BufferData *> buffers;
+  QSharedPointer<BufferPager> pager;
 
   void setPosColumn(int pos)
   {
@@ -709,50 +894,62 @@ private:
 
   void cacheColumns()
   {
+    decoder = FormatDecoder(columns);
+
     columnLookup.clear();
-    columnLookup.reserve(columns.count() * 4);
+    columnLookup.reserve(decoder.columnCount());
     componentLookup.clear();
-    componentLookup.reserve(columns.count() * 4);
+    componentLookup.reserve(decoder.columnCount());
 
-    for(int i = 0; i < columns.count(); i++)
+    for(int i = 0; i < decoder.columnCount(); i++)
     {
-      FormatElement &fmt = columns[i];
+      columnLookup.push_back(decoder.elementForColumn(i));
+      componentLookup.push_back(decoder.componentForColumn(i));
+    }
 
-      uint32_t compCount;
+    invalidatePages();
+  }
 
-      switch(fmt.format.specialFormat)
-      {
-        case SpecialFormat::BC6:
-        case SpecialFormat::ETC2:
-        case SpecialFormat::R11G11B10:
-        case SpecialFormat::R5G6B5:
-        case SpecialFormat::R9G9B9E5: compCount = 3; break;
-        case SpecialFormat::BC1:
-        case SpecialFormat::BC7:
-        case SpecialFormat::BC3:
-        case SpecialFormat::BC2:
-        case SpecialFormat::R10G10B10A2:
-        case SpecialFormat::R5G5B5A1:
-        case SpecialFormat::R4G4B4A4:
-        case SpecialFormat::ASTC: compCount = 4; break;
-        case SpecialFormat::BC5:
-        case SpecialFormat::R4G4:
-        case SpecialFormat::D16S8:
-        case SpecialFormat::D24S8:
-        case SpecialFormat::D32S8: compCount = 2; break;
-        case SpecialFormat::BC4:
-        case SpecialFormat::S8: compCount = 1; break;
-        case SpecialFormat::YUV:
-        case SpecialFormat::EAC:
-        default: compCount = fmt.format.compCount;
-      }
+  // rows are decoded and displayed a page at a time, and we keep the last few pages around since
+  // the view queries each cell individually
+  static const uint32_t PageSize = 256;
 
-      for(uint32_t c = 0; c < compCount; c++)
-      {
-        columnLookup.push_back(i);
-        componentLookup.push_back((int)c);
-      }
-    }
+  struct RowPage
+  {
+    uint32_t firstRow = ~0U;
+    QVector<uint32_t> idx;
+    FormatDecoder::Rows rows;
+  };
+
+  FormatDecoder decoder;
+
+  mutable QMutex m_PageLock;
+  mutable RowPage m_Pages[4];
+  mutable int m_NextPage = 0;
+
+  void invalidatePages()
+  {
+    QMutexLocker autolock(&m_PageLock);
+
+    for(RowPage &p : m_Pages)
+      p.firstRow = ~0U;
+  }
+
+  const RowPage &pageForRow(uint32_t row) const
+  {
+    uint32_t firstRow = row - (row % PageSize);
+
+    for(const RowPage &p : m_Pages)
+      if(p.firstRow == firstRow)
+        return p;
+
+    RowPage &page = m_Pages[m_NextPage];
+    m_NextPage = (m_NextPage + 1) % (int)ARRAY_COUNT(m_Pages);
+
+    page.firstRow = firstRow;
+    decodeRows(firstRow, qMin(numRows - firstRow, (uint32_t)PageSize), page.rows, page.idx);
+
+    return page;
   }
 };
 
@@ -1232,23 +1429,6 @@ void BufferViewer::OnEventChanged(uint32_t eventID)
     else
     {
       BufferData *buf = new BufferData;
-      rdctype::array<byte> data;
-      if(m_IsBuffer)
-      {
-        uint64_t len = m_ByteSize;
-        if(len == UINT64_MAX)
-          len = 0;
-
-        data = r->GetBufferData(m_BufferID, m_ByteOffset, len);
-      }
-      else
-      {
-        data = r->GetTextureData(m_BufferID, m_TexArrayIdx, m_TexMip);
-      }
-
-      buf->data = new byte[data.count];
-      memcpy(buf->data, data.elems, data.count);
-      buf->end = buf->data + data.count;
 
       // calculate tight stride
       buf->stride = 0;
@@ -1257,7 +1437,51 @@ void BufferViewer::OnEventChanged(uint32_t eventID)
 
       buf->stride = qMax((size_t)1, buf->stride);
 
-      m_ModelVSIn->numRows = uint32_t((data.count + buf->stride - 1) / buf->stride);
+      BufferDescription *bufdesc = m_IsBuffer ? m_Ctx.GetBuffer(m_BufferID) : NULL;
+
+      uint64_t pagedSize = 0;
+      if(bufdesc && m_ByteOffset < bufdesc->length)
+        pagedSize = qMin(m_ByteSize, bufdesc->length - m_ByteOffset);
+
+      if(pagedSize > PagedBufferThreshold)
+      {
+        // large buffers are only fetched a page at a time as the rows are displayed
+        QSharedPointer<BufferPager> pager(new BufferPager(m_Ctx.Replay(), m_BufferID, m_ByteOffset,
+                                                          pagedSize, buf->stride, DecodeBlockSize));
+
+        // the viewer (and the model with it) may be closed while a page is still being fetched
+        QPointer<BufferItemModel> model = m_ModelVSIn;
+        BufferPager *current = pager.data();
+        pager->arrived = [model, current](uint32_t page) {
+          if(model && model->pager.data() == current)
+            model->pageArrived(page);
+        };
+
+        m_ModelVSIn->pager = pager;
+        m_ModelVSIn->numRows = uint32_t((pagedSize + buf->stride - 1) / buf->stride);
+      }
+      else
+      {
+        rdctype::bytebuf data;
+        if(m_IsBuffer)
+        {
+          uint64_t len = m_ByteSize;
+          if(len == UINT64_MAX)
+            len = 0;
+
+          data = r->GetBufferData(m_BufferID, m_ByteOffset, len);
+        }
+        else
+        {
+          data = r->GetTextureData(m_BufferID, m_TexArrayIdx, m_TexMip);
+        }
+
+        buf->data = new byte[(size_t)data.count];
+        memcpy(buf->data, data.elems, (size_t)data.count);
+        buf->end = buf->data + data.count;
+
+        m_ModelVSIn->numRows = uint32_t((data.count + buf->stride - 1) / buf->stride);
+      }
 
       // ownership passes to model
       m_ModelVSIn->buffers.push_back(buf);
@@ -1299,7 +1523,7 @@ void BufferViewer::RT_FetchMeshData(IReplayController *r)
 
   QVector<BoundVBuffer> vbs = m_Ctx.CurPipelineState().GetVBuffers();
 
-  rdctype::array<byte> idata;
+  rdctype::bytebuf idata;
   if(ib.first != ResourceId() && draw && (draw->flags & DrawFlags::UseIBuffer))
     idata = r->GetBufferData(ib.first, ib.second + draw->indexOffset * draw->indexByteWidth,
                              draw->numIndices * draw->indexByteWidth);
@@ -1397,11 +1621,11 @@ void BufferViewer::RT_FetchMeshData(IReplayController *r)
     BufferData *buf = new BufferData;
     if(used)
     {
-      rdctype::array<byte> bufdata = r->GetBufferData(
+      rdctype::bytebuf bufdata = r->GetBufferData(
           vb.Buffer, vb.ByteOffset + offset * vb.ByteStride, (maxIdx + 1) * vb.ByteStride);
 
-      buf->data = new byte[bufdata.count];
-      memcpy(buf->data, bufdata.elems, bufdata.count);
+      buf->data = new byte[(size_t)bufdata.count];
+      memcpy(buf->data, bufdata.elems, (size_t)bufdata.count);
       buf->end = buf->data + bufdata.count;
       buf->stride = vb.ByteStride;
     }
@@ -1451,10 +1675,10 @@ void BufferViewer::RT_FetchMeshData(IReplayController *r)
   if(m_PostVS.buf != ResourceId())
   {
     BufferData *postvs = new BufferData;
-    rdctype::array<byte> bufdata = r->GetBufferData(m_PostVS.buf, m_PostVS.offset, 0);
+    rdctype::bytebuf bufdata = r->GetBufferData(m_PostVS.buf, m_PostVS.offset, 0);
 
-    postvs->data = new byte[bufdata.count];
-    memcpy(postvs->data, bufdata.elems, bufdata.count);
+    postvs->data = new byte[(size_t)bufdata.count];
+    memcpy(postvs->data, bufdata.elems, (size_t)bufdata.count);
     postvs->end = postvs->data + bufdata.count;
     postvs->stride = m_PostVS.stride;
 
@@ -1472,10 +1696,10 @@ void BufferViewer::RT_FetchMeshData(IReplayController *r)
   if(m_PostGS.buf != ResourceId())
   {
     BufferData *postgs = new BufferData;
-    rdctype::array<byte> bufdata = r->GetBufferData(m_PostGS.buf, m_PostGS.offset, 0);
+    rdctype::bytebuf bufdata = r->GetBufferData(m_PostGS.buf, m_PostGS.offset, 0);
 
-    postgs->data = new byte[bufdata.count];
-    memcpy(postgs->data, bufdata.elems, bufdata.count);
+    postgs->data = new byte[(size_t)bufdata.count];
+    memcpy(postgs->data, bufdata.elems, (size_t)bufdata.count);
     postgs->end = postgs->data + bufdata.count;
     postgs->stride = m_PostGS.stride;
 
@@ -1544,6 +1768,50 @@ void BufferViewer::RT_FetchMeshData(IReplayController *r)
   thread->wait(10);
 }
 
+static void CalcColumnBounds(const FormatDecoder &decoder,
+                             const QVector<FormatDecoder::Source> &sources, BufferData *indices,
+                             int32_t baseVertex, uint32_t begin, uint32_t end,
+                             QVector<float> &minOut, QVector<float> &maxOut)
+{
+  minOut.fill(FLT_MAX, decoder.columnCount());
+  maxOut.fill(-FLT_MAX, decoder.columnCount());
+
+  FormatDecoder::Rows rows;
+  QVector<uint32_t> idx;
+
+  for(uint32_t first = begin; first < end; first += DecodeBlockSize)
+  {
+    uint32_t count = qMin(end - first, DecodeBlockSize);
+
+    CalcRowIndices(indices, baseVertex, first, count, idx);
+
+    decoder.Decode(sources, first, idx.data(), count, rows);
+
+    for(int col = 0; col < decoder.columnCount(); col++)
+    {
+      const double *vals = rows.column(col);
+      const uint8_t *valid = rows.valid.data() + decoder.elementForColumn(col) * count;
+
+      float minVal = minOut[col];
+      float maxVal = maxOut[col];
+
+      for(uint32_t r = 0; r < count; r++)
+      {
+        float fval = (float)vals[r];
+
+        if(valid[r] && qIsFinite(fval))
+        {
+          minVal = qMin(minVal, fval);
+          maxVal = qMax(maxVal, fval);
+        }
+      }
+
+      minOut[col] = minVal;
+      maxOut[col] = maxVal;
+    }
+  }
+}
+
 void BufferViewer::calcBoundingData(CalcBoundingBoxData &bbox)
 {
   for(size_t stage = 0; stage < ARRAY_COUNT(bbox.input); stage++)
@@ -1562,68 +1830,50 @@ void BufferViewer::calcBoundingData(CalcBoundingBoxData &bbox)
       maxOutputList.push_back(FloatVector(-FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX));
     }
 
-    QVector<CachedElData> cache;
+    FormatDecoder decoder(s.elements);
+    QVector<FormatDecoder::Source> sources = DecoderSources(s.elements, s.buffers, bbox.inst);
 
-    CacheDataForIteration(cache, s.elements, s.buffers, bbox.inst);
+    // split the rows across threads, with enough rows for each one to be worthwhile
+    int numThreads = qBound(1, QThread::idealThreadCount(), int(s.count / DecodeBlockSize) + 1);
 
-    // possible optimisation here if this shows up as a hot spot - sort and unique the indices and
-    // iterate in ascending order, to be more cache friendly
+    QVector<QVector<float>> mins(numThreads), maxs(numThreads);
 
-    for(uint32_t row = 0; row < s.count; row++)
-    {
-      uint32_t idx = row;
+    QSemaphore finished;
 
-      if(s.indices && s.indices->data)
-      {
-        idx = CalcIndex(s.indices, row, bbox.baseVertex);
+    for(int t = 0; t < numThreads; t++)
+    {
+      uint32_t begin = uint32_t((uint64_t(s.count) * t) / numThreads);
+      uint32_t end = uint32_t((uint64_t(s.count) * (t + 1)) / numThreads);
+
+      QVector<float> &minOut = mins[t];
+      QVector<float> &maxOut = maxs[t];
+
+      LambdaThread *thread =
+          new LambdaThread([&decoder, &sources, &s, &bbox, &minOut, &maxOut, &finished, begin, end] {
+            CalcColumnBounds(decoder, sources, s.indices, bbox.baseVertex, begin, end, minOut,
+                             maxOut);
+            finished.release();
+          });
+      thread->selfDelete(true);
+      thread->start();
+    }
 
-        if(idx == ~0U)
-          continue;
-      }
+    finished.acquire(numThreads);
 
-      for(int col = 0; col < s.elements.count(); col++)
+    for(int t = 0; t < numThreads; t++)
+    {
+      for(int col = 0; col < decoder.columnCount(); col++)
       {
-        const CachedElData &d = cache[col];
-        const FormatElement *el = d.el;
-
-        float *minOut = (float *)&minOutputList[col];
-        float *maxOut = (float *)&maxOutputList[col];
-
-        if(d.data)
-        {
-          const byte *bytes = d.data;
+        int comp = decoder.componentForColumn(col);
 
-          if(!el->perinstance)
-            bytes += d.stride * idx;
-
-          QVariantList list = el->GetVariants(bytes, d.end);
-
-          for(int comp = 0; comp < list.count(); comp++)
-          {
-            const QVariant &v = list[comp];
-
-            QMetaType::Type vt = (QMetaType::Type)v.type();
-
-            float fval = 0.0f;
+        if(comp >= 4)
+          continue;
 
-            if(vt == QMetaType::Double)
-              fval = (float)v.toDouble();
-            else if(vt == QMetaType::Float)
-              fval = v.toFloat();
-            else if(vt == QMetaType::UInt || vt == QMetaType::UShort || vt == QMetaType::UChar)
-              fval = (float)v.toUInt();
-            else if(vt == QMetaType::Int || vt == QMetaType::Short || vt == QMetaType::SChar)
-              fval = (float)v.toInt();
-            else
-              continue;
+        float *minOut = (float *)&minOutputList[decoder.elementForColumn(col)];
+        float *maxOut = (float *)&maxOutputList[decoder.elementForColumn(col)];
 
-            if(qIsFinite(fval))
-            {
-              minOut[comp] = qMin(minOut[comp], fval);
-              maxOut[comp] = qMax(maxOut[comp], fval);
-            }
-          }
-        }
+        minOut[comp] = qMin(minOut[comp], mins[t][col]);
+        maxOut[comp] = qMax(maxOut[comp], maxs[t][col]);
       }
     }
   }
@@ -2411,6 +2661,7 @@ void BufferViewer::ClearModels()
 
     m->buffers.clear();
     m->columns.clear();
+    m->pager.clear();
     m->numRows = 0;
 
     m->endReset();
@@ -2626,8 +2877,16 @@ void BufferViewer::exportData(const BufferExport &params)
       {
         // this is the simplest possible case, we just dump the contents of the first buffer, as
         // it's tightly packed
-        f->write((const char *)model->buffers[0]->data,
-                 int(model->buffers[0]->end - model->buffers[0]->data));
+        if(model->pager)
+        {
+          for(uint32_t page = 0; page < model->pager->numPages(); page++)
+            f->write(model->pager->waitForPage(page));
+        }
+        else
+        {
+          f->write((const char *)model->buffers[0]->data,
+                   int(model->buffers[0]->end - model->buffers[0]->data));
+        }
       }
       else
       {
@@ -2666,8 +2925,8 @@ void BufferViewer::exportData(const BufferExport &params)
     }
     else if(params.format == BufferExport::CSV)
     {
-      // this works identically no matter whether we're mesh view or what, we just iterate the
-      // elements and call the model's data()
+      // this works identically no matter whether we're mesh view or what, we just decode blocks
+      // of rows and format each cell the same way the model's data() does
 
       QTextStream s(f);
 
@@ -2681,17 +2940,27 @@ void BufferViewer::exportData(const BufferExport &params)
 
       s << "\n";
 
-      for(int row = 0; row < model->rowCount(); row++)
+      FormatDecoder::Rows rows;
+      QVector<uint32_t> idx;
+
+      for(uint32_t first = 0; first < model->numRows; first += DecodeBlockSize)
       {
-        for(int col = 0; col < model->columnCount(); col++)
+        uint32_t count = qMin(model->numRows - first, DecodeBlockSize);
+
+        model->decodeRows(first, count, rows, idx, true);
+
+        for(uint32_t r = 0; r < count; r++)
         {
-          s << model->data(model->index(row, col), Qt::DisplayRole).toString();
+          for(int col = 0; col < model->columnCount(); col++)
+          {
+            s << model->cellData(first + r, idx[r], col, rows, r).toString();
 
-          if(col + 1 < model->columnCount())
-            s << ", ";
-        }
+            if(col + 1 < model->columnCount())
+              s << ", ";
+          }
 
-        s << "\n";
+          s << "\n";
+        }
       }
     }
 
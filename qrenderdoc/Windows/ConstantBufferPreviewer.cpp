@@ -112,7 +112,7 @@ void ConstantBufferPreviewer::OnEventChanged(uint32_t eventID)
   if(!m_formatOverride.empty())
   {
     m_Ctx.Replay().AsyncInvoke([this, offs, size](IReplayController *r) {
-      rdctype::array<byte> data = r->GetBufferData(m_cbuffer, offs, size);
+      rdctype::bytebuf data = r->GetBufferData(m_cbuffer, offs, size);
       rdctype::array<ShaderVariable> vars = applyFormatOverride(data);
       GUIInvoke::call([this, vars] { setVariables(vars); });
     });
@@ -241,7 +241,7 @@ void ConstantBufferPreviewer::updateLabels()
 }
 
 rdctype::array<ShaderVariable> ConstantBufferPreviewer::applyFormatOverride(
-    const rdctype::array<byte> &bytes)
+    const rdctype::bytebuf &bytes)
 {
   QVector<ShaderVariable> variables;
 
@@ -71,7 +71,7 @@ private:
   uint32_t m_slot = 0;
   uint32_t m_arrayIdx = 0;
 
-  rdctype::array<ShaderVariable> applyFormatOverride(const rdctype::array<byte> &data);
+  rdctype::array<ShaderVariable> applyFormatOverride(const rdctype::bytebuf &data);
 
   void addVariables(QTreeWidgetItem *root, const rdctype::array<ShaderVariable> &vars);
   void setVariables(const rdctype::array<ShaderVariable> &vars);
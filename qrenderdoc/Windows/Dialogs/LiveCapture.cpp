@@ -834,7 +834,7 @@ void LiveCapture::captureCopied(uint32_t ID, const QString &localPath)
 
 void LiveCapture::captureAdded(uint32_t ID, const QString &executable, const QString &api,
                                const rdctype::array<byte> &thumbnail, QDateTime timestamp,
-                               const QString &path, bool local)
+                               const QString &path, bool local, const QString &statistics)
 {
   CaptureLog *log = new CaptureLog();
   log->remoteID = ID;
@@ -849,6 +849,8 @@ void LiveCapture::captureAdded(uint32_t ID, const QString &executable, const QSt
   QListWidgetItem *item = new QListWidgetItem();
   item->setText(MakeText(log));
   item->setIcon(QIcon(QPixmap::fromImage(MakeThumb(log->thumb))));
+  if(!statistics.isEmpty())
+    item->setToolTip(statistics.trimmed());
   if(!local)
   {
     QFont f = item->font();
@@ -1024,12 +1026,13 @@ void LiveCapture::connectionThreadEntry()
       rdctype::array<byte> thumb = msg.NewCapture.thumbnail;
       QString path = ToQStr(msg.NewCapture.path);
       bool local = msg.NewCapture.local;
+      QString statistics = ToQStr(msg.NewCapture.statistics);
 
-      GUIInvoke::call([this, capID, timestamp, thumb, path, local]() {
+      GUIInvoke::call([this, capID, timestamp, thumb, path, local, statistics]() {
         QString target = QString::fromUtf8(m_Connection->GetTarget());
         QString api = QString::fromUtf8(m_Connection->GetAPI());
 
-        captureAdded(capID, target, api, thumb, timestamp, path, local);
+        captureAdded(capID, target, api, thumb, timestamp, path, local, statistics);
       });
     }
 
@@ -118,7 +118,7 @@ private:
   void captureCopied(uint32_t ID, const QString &localPath);
   void captureAdded(uint32_t ID, const QString &executable, const QString &api,
                     const rdctype::array<byte> &thumbnail, QDateTime timestamp, const QString &path,
-                    bool local);
+                    bool local, const QString &statistics);
   void connectionClosed();
   void killThread();
 
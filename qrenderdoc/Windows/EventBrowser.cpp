@@ -23,7 +23,9 @@
  ******************************************************************************/
 
 #include "EventBrowser.h"
+#include <algorithm>
 #include <QKeyEvent>
+#include <QSet>
 #include <QShortcut>
 #include <QTimer>
 #include "3rdparty/flowlayout/FlowLayout.h"
@@ -37,10 +39,392 @@ enum
   COL_EID = 1,
   COL_DURATION = 2,
 
-  COL_CURRENT,
-  COL_FIND,
-  COL_BOOKMARK,
-  COL_LAST_EID,
+  COL_COUNT,
+};
+
+// returns the last EID covered by draws[idx]. Drawcalls with children span up to the last event of
+// their last child, and set markers are considered part of the drawcall that follows them.
+static uint32_t GetLastEID(const rdctype::array<DrawcallDescription> *draws, int32_t idx)
+{
+  while(!(*draws)[idx].children.empty())
+  {
+    draws = &(*draws)[idx].children;
+    idx = draws->count - 1;
+  }
+
+  const DrawcallDescription &draw = (*draws)[idx];
+
+  if((draw.flags & DrawFlags::SetMarker) && idx + 1 < draws->count)
+    return (*draws)[idx + 1].eventID;
+
+  return draw.eventID;
+}
+
+// nodes in the event tree. These are only created as the view asks for them, so a frame with a
+// huge number of events only pays for the rows that have actually been expanded.
+struct EventNode
+{
+  EventNode *parent = NULL;
+  int row = 0;
+  // the drawcall for this row, or NULL for the frame and frame start rows
+  const DrawcallDescription *draw = NULL;
+  // filled in on demand, see EventItemModel::child()
+  QVector<EventNode *> children;
+};
+
+class EventItemModel : public QAbstractItemModel
+{
+public:
+  EventItemModel(ICaptureContext &ctx, QObject *parent) : QAbstractItemModel(parent), m_Ctx(ctx) {}
+  ~EventItemModel() { deleteNode(m_Frame); }
+  void reset()
+  {
+    beginResetModel();
+
+    deleteNode(m_Frame);
+    m_Frame = NULL;
+    m_Current = NULL;
+    m_Timed = false;
+    m_Durations.clear();
+    m_FindResults.clear();
+
+    if(m_Ctx.LogLoaded())
+    {
+      m_Frame = new EventNode;
+      m_Frame->children.resize(numChildren(m_Frame));
+    }
+
+    endResetModel();
+  }
+
+  QModelIndex frameIndex() const { return m_Frame ? createIndex(0, 0, m_Frame) : QModelIndex(); }
+  uint32_t eventID(const QModelIndex &idx) const
+  {
+    EventNode *node = getNode(idx);
+    return node && node->draw ? node->draw->eventID : 0;
+  }
+
+  uint32_t lastEID(const QModelIndex &idx) const { return lastEID(getNode(idx)); }
+  // finds the row for an event the same way the tree always has: the last row whose last EID is
+  // at or after eventID, preferring an exact match on a leaf.
+  QModelIndex indexForEvent(uint32_t eventID)
+  {
+    if(m_Frame == NULL)
+      return QModelIndex();
+
+    QVector<int> path, found;
+    uint32_t foundEID = 0;
+
+    // drawcall rows come after the frame start row
+    bool exact = findEventPath(m_Ctx.CurDrawcalls(), 1, eventID, path, found, foundEID);
+
+    if(!exact && eventID == 0)
+      found = {0};
+
+    QModelIndex ret = frameIndex();
+
+    for(int row : found)
+      ret = index(row, 0, ret);
+
+    return ret;
+  }
+
+  void setCurrent(const QModelIndex &idx) { m_Current = getNode(idx); }
+  void setBookmarks(const QList<int> &bookmarks) { m_Bookmarks = bookmarks; }
+  void clearFindResults() { m_FindResults.clear(); }
+  void addFindResults(const QVector<uint32_t> &eventIDs)
+  {
+    for(uint32_t eid : eventIDs)
+      m_FindResults.insert(eid);
+  }
+  void setDurations(const rdctype::array<CounterResult> &results)
+  {
+    QHash<uint32_t, double> eventDurations;
+
+    for(const CounterResult &r : results)
+      eventDurations[r.eventID] = r.value.d;
+
+    m_Durations.clear();
+
+    // the frame start row is a leaf with EID 0, and the frame sums everything
+    m_FrameStartDuration = eventDurations.value(0, -1.0);
+    m_FrameDuration = calcDurations(m_Ctx.CurDrawcalls(), eventDurations);
+
+    if(m_FrameStartDuration > 0.0)
+      m_FrameDuration += m_FrameStartDuration;
+
+    m_Timed = true;
+  }
+
+  QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override
+  {
+    if(row < 0 || row >= rowCount(parent) || column < 0 || column >= columnCount())
+      return QModelIndex();
+
+    if(!parent.isValid())
+      return createIndex(row, column, m_Frame);
+
+    return createIndex(row, column, child(getNode(parent), row));
+  }
+
+  QModelIndex parent(const QModelIndex &index) const override
+  {
+    EventNode *node = getNode(index);
+
+    if(node == NULL || node->parent == NULL)
+      return QModelIndex();
+
+    return createIndex(node->parent->row, 0, node->parent);
+  }
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override
+  {
+    if(!parent.isValid())
+      return m_Frame ? 1 : 0;
+
+    if(parent.column() != 0)
+      return 0;
+
+    return numChildren(getNode(parent));
+  }
+
+  int columnCount(const QModelIndex &parent = QModelIndex()) const override { return COL_COUNT; }
+  QVariant headerData(int section, Qt::Orientation orientation, int role) const override
+  {
+    if(orientation == Qt::Horizontal && role == Qt::DisplayRole)
+    {
+      if(section == COL_NAME)
+        return QString("Name");
+      if(section == COL_EID)
+        return QString("EID");
+      if(section == COL_DURATION)
+        return QString("Duration (%1s)").arg(QChar(0x00B5));
+    }
+
+    return QVariant();
+  }
+
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override
+  {
+    EventNode *node = getNode(index);
+
+    if(node == NULL)
+      return QVariant();
+
+    if(role == Qt::DisplayRole)
+    {
+      if(index.column() == COL_NAME)
+        return name(node);
+
+      if(index.column() == COL_EID)
+      {
+        if(node == m_Frame)
+          return QString();
+
+        uint32_t eid = node->draw ? node->draw->eventID : 0;
+
+        // only parents show a range, set markers still show their own EID
+        if(node->draw && !node->draw->children.empty())
+        {
+          uint32_t last = lastEID(node);
+
+          if(last > eid)
+            return QString("%1-%2").arg(eid).arg(last);
+        }
+
+        return QString::number(eid);
+      }
+
+      if(index.column() == COL_DURATION)
+      {
+        if(!m_Timed)
+          return node->draw ? QString("0.0") : QString();
+
+        double duration = m_FrameDuration;
+        if(node->draw)
+          duration = m_Durations.value(node->draw, -1.0);
+        else if(node != m_Frame)
+          duration = m_FrameStartDuration;
+
+        return duration < 0.0 ? QString() : QString::number(duration * 1000000.0);
+      }
+    }
+
+    if(role == Qt::DecorationRole && index.column() == COL_NAME)
+    {
+      if(node == m_Current)
+        return m_CurrentIcon;
+
+      // bookmarks are shown on the leaf that the bookmarked EID selects
+      uint32_t last = lastEID(node);
+      if(numChildren(node) == 0 && (node->draw ? node->draw->eventID : 0) == last &&
+         m_Bookmarks.contains((int)last))
+        return m_BookmarkIcon;
+
+      if(node->draw && m_FindResults.contains(node->draw->eventID))
+        return m_FindIcon;
+    }
+
+    return QVariant();
+  }
+
+  QIcon m_CurrentIcon;
+  QIcon m_FindIcon;
+  QIcon m_BookmarkIcon;
+
+private:
+  ICaptureContext &m_Ctx;
+
+  EventNode *m_Frame = NULL;
+  EventNode *m_Current = NULL;
+
+  QList<int> m_Bookmarks;
+  // EIDs of the drawcalls that contain events matching the current find
+  QSet<uint32_t> m_FindResults;
+
+  bool m_Timed = false;
+  double m_FrameDuration = -1.0;
+  double m_FrameStartDuration = -1.0;
+  QHash<const DrawcallDescription *, double> m_Durations;
+
+  EventNode *getNode(const QModelIndex &idx) const
+  {
+    if(!idx.isValid())
+      return NULL;
+
+    return (EventNode *)idx.internalPointer();
+  }
+
+  void deleteNode(EventNode *node)
+  {
+    if(node == NULL)
+      return;
+
+    for(EventNode *c : node->children)
+      deleteNode(c);
+
+    delete node;
+  }
+
+  const rdctype::array<DrawcallDescription> *childDraws(const EventNode *node) const
+  {
+    if(node == m_Frame)
+      return &m_Ctx.CurDrawcalls();
+
+    if(node->draw)
+      return &node->draw->children;
+
+    return NULL;
+  }
+
+  // the frame row has the frame start row before its drawcalls
+  int childOffset(const EventNode *node) const { return node == m_Frame ? 1 : 0; }
+  int numChildren(const EventNode *node) const
+  {
+    const rdctype::array<DrawcallDescription> *draws = childDraws(node);
+
+    return draws ? draws->count + childOffset(node) : 0;
+  }
+
+  EventNode *child(EventNode *node, int row) const
+  {
+    if(node->children.isEmpty())
+      node->children.resize(numChildren(node));
+
+    EventNode *&ret = node->children[row];
+
+    if(ret == NULL)
+    {
+      ret = new EventNode;
+      ret->parent = node;
+      ret->row = row;
+
+      int idx = row - childOffset(node);
+      if(idx >= 0)
+        ret->draw = &(*childDraws(node))[idx];
+    }
+
+    return ret;
+  }
+
+  uint32_t lastEID(const EventNode *node) const
+  {
+    if(node == NULL)
+      return 0;
+
+    if(node == m_Frame)
+    {
+      const rdctype::array<DrawcallDescription> &draws = m_Ctx.CurDrawcalls();
+      return draws.empty() ? 0 : GetLastEID(&draws, draws.count - 1);
+    }
+
+    if(node->draw == NULL)
+      return 0;
+
+    return GetLastEID(childDraws(node->parent), node->row - childOffset(node->parent));
+  }
+
+  QString name(const EventNode *node) const
+  {
+    if(node == m_Frame)
+      return QString("Frame #%1").arg(m_Ctx.FrameInfo().frameNumber);
+
+    if(node->draw == NULL)
+      return QString("Frame Start");
+
+    return QString(node->draw->name);
+  }
+
+  bool findEventPath(const rdctype::array<DrawcallDescription> &draws, int rowOffset,
+                     uint32_t eventID, QVector<int> &path, QVector<int> &found,
+                     uint32_t &foundEID)
+  {
+    // do a reverse search to find the last match (in case of 'set' markers that
+    // inherit the event of the next real draw).
+    for(int32_t i = draws.count - 1; i >= 0; i--)
+    {
+      uint32_t nEID = GetLastEID(&draws, i);
+
+      path.push_back(i + rowOffset);
+
+      if(nEID >= eventID && (found.isEmpty() || nEID <= foundEID))
+      {
+        found = path;
+        foundEID = nEID;
+      }
+
+      if(nEID == eventID && draws[i].children.empty())
+        return true;
+
+      if(!draws[i].children.empty() &&
+         findEventPath(draws[i].children, 0, eventID, path, found, foundEID))
+        return true;
+
+      path.pop_back();
+    }
+
+    return false;
+  }
+
+  // parent nodes take the value of the sum of their children
+  double calcDurations(const rdctype::array<DrawcallDescription> &draws,
+                       const QHash<uint32_t, double> &eventDurations)
+  {
+    double ret = 0.0;
+
+    for(const DrawcallDescription &d : draws)
+    {
+      double duration = d.children.empty() ? eventDurations.value(d.eventID, -1.0)
+                                           : calcDurations(d.children, eventDurations);
+
+      m_Durations[&d] = duration;
+
+      if(duration > 0.0)
+        ret += duration;
+    }
+
+    return ret;
+  }
 };
 
 EventBrowser::EventBrowser(ICaptureContext &ctx, QWidget *parent)
@@ -50,9 +434,11 @@ EventBrowser::EventBrowser(ICaptureContext &ctx, QWidget *parent)
 
   m_Ctx.AddLogViewer(this);
 
+  m_Model = new EventItemModel(m_Ctx, this);
+
   clearBookmarks();
 
-  ui->events->setClearSelectionOnFocusLoss(false);
+  ui->events->setModel(m_Model);
 
   ui->events->header()->resizeSection(COL_EID, 80);
 
@@ -78,7 +464,9 @@ EventBrowser::EventBrowser(ICaptureContext &ctx, QWidget *parent)
 
   QObject::connect(ui->closeFind, &QToolButton::clicked, this, &EventBrowser::on_HideFindJump);
   QObject::connect(ui->closeJump, &QToolButton::clicked, this, &EventBrowser::on_HideFindJump);
-  QObject::connect(ui->events, &RDTreeWidget::keyPress, this, &EventBrowser::events_keyPress);
+  QObject::connect(ui->events, &RDTreeView::keyPress, this, &EventBrowser::events_keyPress);
+  QObject::connect(ui->events->selectionModel(), &QItemSelectionModel::currentChanged, this,
+                   &EventBrowser::events_currentChanged);
   ui->jumpStrip->hide();
   ui->findStrip->hide();
   ui->bookmarkStrip->hide();
@@ -90,9 +478,11 @@ EventBrowser::EventBrowser(ICaptureContext &ctx, QWidget *parent)
   m_BookmarkStripLayout->addWidget(ui->bookmarkStripHeader);
   m_BookmarkStripLayout->addItem(m_BookmarkSpacer);
 
-  m_CurrentIcon.addFile(QStringLiteral(":/flag_green.png"), QSize(), QIcon::Normal, QIcon::Off);
-  m_FindIcon.addFile(QStringLiteral(":/find.png"), QSize(), QIcon::Normal, QIcon::Off);
-  m_BookmarkIcon.addFile(QStringLiteral(":/asterisk_orange.png"), QSize(), QIcon::Normal, QIcon::Off);
+  m_Model->m_CurrentIcon.addFile(QStringLiteral(":/flag_green.png"), QSize(), QIcon::Normal,
+                                 QIcon::Off);
+  m_Model->m_FindIcon.addFile(QStringLiteral(":/find.png"), QSize(), QIcon::Normal, QIcon::Off);
+  m_Model->m_BookmarkIcon.addFile(QStringLiteral(":/asterisk_orange.png"), QSize(), QIcon::Normal,
+                                  QIcon::Off);
 
   Qt::Key keys[] = {
       Qt::Key_1, Qt::Key_2, Qt::Key_3, Qt::Key_4, Qt::Key_5,
@@ -125,26 +515,13 @@ EventBrowser::~EventBrowser()
 
 void EventBrowser::OnLogfileLoaded()
 {
-  QTreeWidgetItem *frame = new QTreeWidgetItem(
-      (QTreeWidget *)NULL,
-      QStringList{QString("Frame #%1").arg(m_Ctx.FrameInfo().frameNumber), "", ""});
-
   clearBookmarks();
 
-  QTreeWidgetItem *framestart = new QTreeWidgetItem(frame, QStringList{"Frame Start", "0", ""});
-  framestart->setData(COL_EID, Qt::UserRole, QVariant(0));
-  framestart->setData(COL_CURRENT, Qt::UserRole, QVariant(false));
-  framestart->setData(COL_FIND, Qt::UserRole, QVariant(false));
-  framestart->setData(COL_BOOKMARK, Qt::UserRole, QVariant(false));
-  framestart->setData(COL_LAST_EID, Qt::UserRole, QVariant(0));
+  m_Model->reset();
 
-  uint lastEID = AddDrawcalls(frame, m_Ctx.CurDrawcalls());
-  frame->setData(COL_EID, Qt::UserRole, QVariant(0));
-  frame->setData(COL_LAST_EID, Qt::UserRole, QVariant(lastEID));
+  ui->events->expand(m_Model->frameIndex());
 
-  ui->events->insertTopLevelItem(0, frame);
-
-  ui->events->expandItem(frame);
+  uint32_t lastEID = m_Model->lastEID(m_Model->frameIndex());
 
   m_Ctx.SetEventID({this}, lastEID, lastEID);
 }
@@ -152,8 +529,9 @@ void EventBrowser::OnLogfileLoaded()
 void EventBrowser::OnLogfileClosed()
 {
   clearBookmarks();
+  ClearFindIcons();
 
-  ui->events->clear();
+  m_Model->reset();
 }
 
 void EventBrowser::OnEventChanged(uint32_t eventID)
@@ -162,81 +540,6 @@ void EventBrowser::OnEventChanged(uint32_t eventID)
   highlightBookmarks();
 }
 
-uint EventBrowser::AddDrawcalls(QTreeWidgetItem *parent,
-                                const rdctype::array<DrawcallDescription> &draws)
-{
-  uint lastEID = 0;
-
-  for(int32_t i = 0; i < draws.count; i++)
-  {
-    QTreeWidgetItem *child = new QTreeWidgetItem(
-        parent, QStringList{QString(draws[i].name), QString("%1").arg(draws[i].eventID), "0.0"});
-
-    lastEID = AddDrawcalls(child, draws[i].children);
-
-    if(lastEID > draws[i].eventID)
-      child->setText(COL_EID, QString("%1-%2").arg(draws[i].eventID).arg(lastEID));
-
-    if(lastEID == 0)
-    {
-      lastEID = draws[i].eventID;
-
-      if((draws[i].flags & DrawFlags::SetMarker) && i + 1 < draws.count)
-        lastEID = draws[i + 1].eventID;
-    }
-
-    child->setData(COL_EID, Qt::UserRole, QVariant(draws[i].eventID));
-    child->setData(COL_CURRENT, Qt::UserRole, QVariant(false));
-    child->setData(COL_FIND, Qt::UserRole, QVariant(false));
-    child->setData(COL_BOOKMARK, Qt::UserRole, QVariant(false));
-    child->setData(COL_LAST_EID, Qt::UserRole, QVariant(lastEID));
-  }
-
-  return lastEID;
-}
-
-void EventBrowser::SetDrawcallTimes(QTreeWidgetItem *node,
-                                    const rdctype::array<CounterResult> &results)
-{
-  if(node == NULL)
-    return;
-
-  // parent nodes take the value of the sum of their children
-  double duration = 0.0;
-
-  // look up leaf nodes in the dictionary
-  if(node->childCount() == 0)
-  {
-    uint eid = node->data(COL_EID, Qt::UserRole).toUInt();
-
-    duration = -1.0;
-
-    for(const CounterResult &r : results)
-    {
-      if(r.eventID == eid)
-        duration = r.value.d;
-    }
-
-    node->setText(COL_DURATION, duration < 0.0f ? "" : QString::number(duration * 1000000.0));
-    node->setData(COL_DURATION, Qt::UserRole, QVariant(duration));
-
-    return;
-  }
-
-  for(int i = 0; i < node->childCount(); i++)
-  {
-    SetDrawcallTimes(node->child(i), results);
-
-    double nd = node->child(i)->data(COL_DURATION, Qt::UserRole).toDouble();
-
-    if(nd > 0.0)
-      duration += nd;
-  }
-
-  node->setText(COL_DURATION, duration < 0.0f ? "" : QString::number(duration * 1000000.0));
-  node->setData(COL_DURATION, Qt::UserRole, QVariant(duration));
-}
-
 void EventBrowser::on_find_clicked()
 {
   ui->jumpStrip->hide();
@@ -253,10 +556,10 @@ void EventBrowser::on_gotoEID_clicked()
 
 void EventBrowser::on_bookmark_clicked()
 {
-  QTreeWidgetItem *n = ui->events->currentItem();
+  QModelIndex idx = ui->events->currentIndex();
 
-  if(n)
-    toggleBookmark(n->data(COL_LAST_EID, Qt::UserRole).toUInt());
+  if(idx.isValid())
+    toggleBookmark(m_Model->lastEID(idx));
 }
 
 void EventBrowser::on_timeDraws_clicked()
@@ -265,26 +568,23 @@ void EventBrowser::on_timeDraws_clicked()
 
     rdctype::array<CounterResult> results = r->FetchCounters({GPUCounter::EventGPUDuration});
 
-    GUIInvoke::call([this, results]() { SetDrawcallTimes(ui->events->topLevelItem(0), results); });
+    GUIInvoke::call([this, results]() {
+      m_Model->setDurations(results);
+      ui->events->viewport()->update();
+    });
   });
 }
 
-void EventBrowser::on_events_currentItemChanged(QTreeWidgetItem *current, QTreeWidgetItem *previous)
+void EventBrowser::events_currentChanged(const QModelIndex &current, const QModelIndex &previous)
 {
-  if(previous)
-  {
-    previous->setData(COL_CURRENT, Qt::UserRole, QVariant(false));
-    RefreshIcon(previous);
-  }
+  m_Model->setCurrent(current);
+  ui->events->viewport()->update();
 
-  if(!current)
+  if(!current.isValid())
     return;
 
-  current->setData(COL_CURRENT, Qt::UserRole, QVariant(true));
-  RefreshIcon(current);
-
-  uint EID = current->data(COL_EID, Qt::UserRole).toUInt();
-  uint lastEID = current->data(COL_LAST_EID, Qt::UserRole).toUInt();
+  uint32_t EID = m_Model->eventID(current);
+  uint32_t lastEID = m_Model->lastEID(current);
 
   m_Ctx.SetEventID({this}, EID, lastEID);
 
@@ -316,12 +616,10 @@ void EventBrowser::findHighlight_timeout()
 {
   ClearFindIcons();
 
-  int results = SetFindIcons(ui->findEvent->text());
-
-  if(results > 0)
-    ui->findEvent->setStyleSheet("");
-  else
+  if(ui->findEvent->text().isEmpty())
     ui->findEvent->setStyleSheet("QLineEdit{background-color:#ff0000;}");
+  else
+    UpdateFindResults(NULL);
 }
 
 void EventBrowser::on_findEvent_textEdited(const QString &arg1)
@@ -347,8 +645,8 @@ void EventBrowser::on_findEvent_returnPressed()
 
   if(!ui->findEvent->text().isEmpty())
     Find(true);
-
-  findHighlight_timeout();
+  else
+    findHighlight_timeout();
 }
 
 void EventBrowser::on_findEvent_keyPress(QKeyEvent *event)
@@ -361,8 +659,8 @@ void EventBrowser::on_findEvent_keyPress(QKeyEvent *event)
 
     if(!ui->findEvent->text().isEmpty())
       Find(event->modifiers() & Qt::ShiftModifier ? false : true);
-
-    findHighlight_timeout();
+    else
+      findHighlight_timeout();
 
     event->accept();
   }
@@ -446,6 +744,8 @@ void EventBrowser::clearBookmarks()
   m_Bookmarks.clear();
   m_BookmarkButtons.clear();
 
+  m_Model->setBookmarks(m_Bookmarks);
+
   ui->bookmarkStrip->setVisible(false);
 }
 
@@ -453,19 +753,10 @@ void EventBrowser::toggleBookmark(uint32_t EID)
 {
   int index = m_Bookmarks.indexOf(EID);
 
-  QTreeWidgetItem *found = NULL;
-  FindEventNode(found, ui->events->topLevelItem(0), EID);
-
   if(index >= 0)
   {
     delete m_BookmarkButtons.takeAt(index);
     m_Bookmarks.removeAt(index);
-
-    if(found)
-    {
-      found->setData(COL_BOOKMARK, Qt::UserRole, QVariant(false));
-      RefreshIcon(found);
-    }
   }
   else
   {
@@ -486,17 +777,14 @@ void EventBrowser::toggleBookmark(uint32_t EID)
 
     highlightBookmarks();
 
-    if(found)
-    {
-      found->setData(COL_BOOKMARK, Qt::UserRole, QVariant(true));
-      RefreshIcon(found);
-    }
-
     m_BookmarkStripLayout->removeItem(m_BookmarkSpacer);
     m_BookmarkStripLayout->addWidget(but);
     m_BookmarkStripLayout->addItem(m_BookmarkSpacer);
   }
 
+  m_Model->setBookmarks(m_Bookmarks);
+  ui->events->viewport()->update();
+
   ui->bookmarkStrip->setVisible(!m_BookmarkButtons.isEmpty());
 }
 
@@ -520,234 +808,166 @@ void EventBrowser::highlightBookmarks()
   }
 }
 
-bool EventBrowser::hasBookmark(QTreeWidgetItem *node)
-{
-  if(node)
-    return hasBookmark(node->data(COL_EID, Qt::UserRole).toUInt());
-
-  return false;
-}
-
 bool EventBrowser::hasBookmark(uint32_t EID)
 {
   return m_Bookmarks.contains(EID);
 }
 
-void EventBrowser::RefreshIcon(QTreeWidgetItem *item)
+bool EventBrowser::SelectEvent(uint32_t eventID)
 {
-  if(item->data(COL_CURRENT, Qt::UserRole).toBool())
-    item->setIcon(COL_NAME, m_CurrentIcon);
-  else if(item->data(COL_BOOKMARK, Qt::UserRole).toBool())
-    item->setIcon(COL_NAME, m_BookmarkIcon);
-  else if(item->data(COL_FIND, Qt::UserRole).toBool())
-    item->setIcon(COL_NAME, m_FindIcon);
-  else
-    item->setIcon(COL_NAME, QIcon());
-}
+  if(!m_Ctx.LogLoaded())
+    return false;
 
-bool EventBrowser::FindEventNode(QTreeWidgetItem *&found, QTreeWidgetItem *parent, uint32_t eventID)
-{
-  // do a reverse search to find the last match (in case of 'set' markers that
-  // inherit the event of the next real draw).
-  for(int i = parent->childCount() - 1; i >= 0; i--)
+  QModelIndex found = m_Model->indexForEvent(eventID);
+  if(found.isValid())
   {
-    QTreeWidgetItem *n = parent->child(i);
-
-    uint nEID = n->data(COL_LAST_EID, Qt::UserRole).toUInt();
-    uint fEID = found ? found->data(COL_LAST_EID, Qt::UserRole).toUInt() : 0;
-
-    if(nEID >= eventID && (found == NULL || nEID <= fEID))
-      found = n;
+    ui->events->selectionModel()->setCurrentIndex(
+        found, QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
 
-    if(nEID == eventID && n->childCount() == 0)
-      return true;
+    for(QModelIndex idx = found.parent(); idx.isValid(); idx = idx.parent())
+      ui->events->expand(idx);
 
-    if(n->childCount() > 0)
-    {
-      bool exact = FindEventNode(found, n, eventID);
-      if(exact)
-        return true;
-    }
+    ui->events->scrollTo(found);
+    return true;
   }
 
   return false;
 }
 
-void EventBrowser::ExpandNode(QTreeWidgetItem *node)
+void EventBrowser::ClearFindIcons()
 {
-  QTreeWidgetItem *n = node;
-  while(node != NULL)
-  {
-    node->setExpanded(true);
-    node = node->parent();
-  }
+  // any search still in flight is now stale
+  m_FindGeneration++;
+  m_FindPending = false;
+  m_FindString.clear();
+  m_FindResults.clear();
 
-  if(n)
-    ui->events->scrollToItem(n);
+  m_Model->clearFindResults();
+  ui->events->viewport()->update();
 }
 
-bool EventBrowser::SelectEvent(uint32_t eventID)
+void EventBrowser::UpdateFindResults(std::function<void()> finished)
 {
-  if(!m_Ctx.LogLoaded())
-    return false;
+  ClearFindIcons();
 
-  QTreeWidgetItem *found = NULL;
-  FindEventNode(found, ui->events->topLevelItem(0), eventID);
-  if(found != NULL)
-  {
-    ui->events->clearSelection();
-    ui->events->setItemSelected(found, true);
-    ui->events->setCurrentItem(found);
+  if(!m_Ctx.LogLoaded())
+    return;
 
-    ExpandNode(found);
-    return true;
-  }
+  m_FindString = ui->findEvent->text();
+  m_FindPending = true;
 
-  return false;
+  FetchFindResults(m_FindGeneration, m_FindString.toUtf8(), 0, finished);
 }
 
-void EventBrowser::ClearFindIcons(QTreeWidgetItem *parent)
+void EventBrowser::FetchFindResults(int generation, QByteArray text, uint32_t afterEID,
+                                    std::function<void()> finished)
 {
-  for(int i = 0; i < parent->childCount(); i++)
-  {
-    QTreeWidgetItem *n = parent->child(i);
+  // results are fetched in batches so that the icons fill in as the search progresses. Each batch
+  // uses the same tag so a new search drops any batches of an old one that are still queued.
+  m_Ctx.Replay().AsyncInvoke(
+      "FindEvents", [this, generation, text, afterEID, finished](IReplayController *r) {
+        const uint32_t batchSize = 1000;
 
-    n->setData(COL_FIND, Qt::UserRole, QVariant(false));
-    RefreshIcon(n);
+        rdctype::array<uint32_t> eventIDs = r->FindEvents(text.data(), afterEID, batchSize);
 
-    if(n->childCount() > 0)
-      ClearFindIcons(n);
-  }
-}
+        bool last = eventIDs.count < (int32_t)batchSize;
 
-void EventBrowser::ClearFindIcons()
-{
-  if(m_Ctx.LogLoaded())
-    ClearFindIcons(ui->events->topLevelItem(0));
-}
+        GUIInvoke::call([this, generation, text, eventIDs, last, finished]() {
+          if(generation != m_FindGeneration)
+            return;
 
-int EventBrowser::SetFindIcons(QTreeWidgetItem *parent, QString filter)
-{
-  int results = 0;
+          AddFindResults(eventIDs);
 
-  for(int i = 0; i < parent->childCount(); i++)
-  {
-    QTreeWidgetItem *n = parent->child(i);
+          if(!last)
+          {
+            FetchFindResults(generation, text, eventIDs[eventIDs.count - 1], finished);
+            return;
+          }
 
-    if(n->text(COL_NAME).contains(filter, Qt::CaseInsensitive))
-    {
-      n->setData(COL_FIND, Qt::UserRole, QVariant(true));
-      RefreshIcon(n);
-      results++;
-    }
+          m_FindPending = false;
 
-    if(n->childCount() > 0)
-    {
-      results += SetFindIcons(n, filter);
-    }
-  }
+          if(m_FindResults.isEmpty())
+            ui->findEvent->setStyleSheet("QLineEdit{background-color:#ff0000;}");
+          else
+            ui->findEvent->setStyleSheet("");
 
-  return results;
+          if(finished)
+            finished();
+        });
+      });
 }
 
-int EventBrowser::SetFindIcons(QString filter)
+void EventBrowser::AddFindResults(const rdctype::array<uint32_t> &eventIDs)
 {
-  if(filter.isEmpty())
-    return 0;
+  uint32_t lastEID = m_Model->lastEID(m_Model->frameIndex());
 
-  return SetFindIcons(ui->events->topLevelItem(0), filter);
-}
+  QVector<uint32_t> draws;
 
-QTreeWidgetItem *EventBrowser::FindNode(QTreeWidgetItem *parent, QString filter, uint32_t after)
-{
-  for(int i = 0; i < parent->childCount(); i++)
+  for(uint32_t eid : eventIDs)
   {
-    QTreeWidgetItem *n = parent->child(i);
+    // matching events that aren't drawcalls themselves belong to the next drawcall
+    while(eid < lastEID && m_Ctx.GetDrawcall(eid) == NULL)
+      eid++;
 
-    uint eid = n->data(COL_LAST_EID, Qt::UserRole).toUInt();
+    if(m_Ctx.GetDrawcall(eid) == NULL)
+      continue;
 
-    if(eid > after && n->text(COL_NAME).contains(filter, Qt::CaseInsensitive))
-      return n;
+    // results arrive in order, so only the last one can be a duplicate
+    if(!m_FindResults.isEmpty() && m_FindResults.back() == eid)
+      continue;
 
-    if(n->childCount() > 0)
-    {
-      QTreeWidgetItem *found = FindNode(n, filter, after);
-
-      if(found != NULL)
-        return found;
-    }
+    m_FindResults.push_back(eid);
+    draws.push_back(eid);
   }
 
-  return NULL;
+  m_Model->addFindResults(draws);
+  ui->events->viewport()->update();
 }
 
-int EventBrowser::FindEvent(QTreeWidgetItem *parent, QString filter, uint32_t after, bool forward)
+void EventBrowser::Find(bool forward)
 {
-  if(parent == NULL)
-    return -1;
+  if(ui->findEvent->text().isEmpty())
+    return;
 
-  for(int i = forward ? 0 : parent->childCount() - 1; i >= 0 && i < parent->childCount();
-      i += forward ? 1 : -1)
+  // if the results are out of date, search again then step once they're all in
+  if(m_FindPending || m_FindString != ui->findEvent->text())
   {
-    auto n = parent->child(i);
-
-    uint eid = n->data(COL_LAST_EID, Qt::UserRole).toUInt();
-
-    bool matchesAfter = (forward && eid > after) || (!forward && eid < after);
-
-    if(matchesAfter)
-    {
-      QString name = n->text(COL_NAME);
-      if(name.contains(filter, Qt::CaseInsensitive))
-        return (int)eid;
-    }
-
-    if(n->childCount() > 0)
-    {
-      int found = FindEvent(n, filter, after, forward);
-
-      if(found > 0)
-        return found;
-    }
+    UpdateFindResults([this, forward]() { StepFindResult(forward); });
+    return;
   }
 
-  return -1;
+  StepFindResult(forward);
 }
 
-int EventBrowser::FindEvent(QString filter, uint32_t after, bool forward)
+void EventBrowser::StepFindResult(bool forward)
 {
-  if(!m_Ctx.LogLoaded())
-    return 0;
-
-  return FindEvent(ui->events->topLevelItem(0), filter, after, forward);
-}
-
-void EventBrowser::Find(bool forward)
-{
-  if(ui->findEvent->text().isEmpty())
+  if(m_FindResults.isEmpty())
+  {
+    ui->findEvent->setStyleSheet("QLineEdit{background-color:#ff0000;}");
     return;
+  }
 
   uint32_t curEID = m_Ctx.CurEvent();
-  if(!ui->events->selectedItems().isEmpty())
-    curEID = ui->events->selectedItems()[0]->data(COL_LAST_EID, Qt::UserRole).toUInt();
+  if(ui->events->currentIndex().isValid())
+    curEID = m_Model->lastEID(ui->events->currentIndex());
+
+  uint32_t eid = 0;
 
-  int eid = FindEvent(ui->findEvent->text(), curEID, forward);
-  if(eid >= 0)
+  if(forward)
   {
-    SelectEvent((uint32_t)eid);
-    ui->findEvent->setStyleSheet("");
+    auto it = std::upper_bound(m_FindResults.begin(), m_FindResults.end(), curEID);
+
+    // wrap around to the start
+    eid = it == m_FindResults.end() ? m_FindResults.front() : *it;
   }
-  else    // if(WrapSearch)
+  else
   {
-    eid = FindEvent(ui->findEvent->text(), forward ? 0 : ~0U, forward);
-    if(eid >= 0)
-    {
-      SelectEvent((uint32_t)eid);
-      ui->findEvent->setStyleSheet("");
-    }
-    else
-    {
-      ui->findEvent->setStyleSheet("QLineEdit{background-color:#ff0000;}");
-    }
+    auto it = std::lower_bound(m_FindResults.begin(), m_FindResults.end(), curEID);
+
+    // wrap around to the end
+    eid = it == m_FindResults.begin() ? m_FindResults.back() : *(it - 1);
   }
+
+  SelectEvent(eid);
+  ui->findEvent->setStyleSheet("");
 }
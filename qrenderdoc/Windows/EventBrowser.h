@@ -26,6 +26,7 @@
 
 #include <QFrame>
 #include <QIcon>
+#include <functional>
 #include "Code/CaptureContext.h"
 
 namespace Ui
@@ -35,10 +36,10 @@ class EventBrowser;
 
 class QSpacerItem;
 class QToolButton;
-class QTreeWidgetItem;
 class QTimer;
 class FlowLayout;
 class SizeDelegate;
+class EventItemModel;
 
 class EventBrowser : public QFrame, public IEventBrowser, public ILogViewer
 {
@@ -68,7 +69,6 @@ private slots:
   void on_findEvent_returnPressed();
   void on_findEvent_keyPress(QKeyEvent *event);
   void on_findEvent_textEdited(const QString &arg1);
-  void on_events_currentItemChanged(QTreeWidgetItem *current, QTreeWidgetItem *previous);
   void on_findNext_clicked();
   void on_findPrev_clicked();
   void on_stepNext_clicked();
@@ -77,6 +77,7 @@ private slots:
   // manual slots
   void findHighlight_timeout();
   void events_keyPress(QKeyEvent *event);
+  void events_currentChanged(const QModelIndex &current, const QModelIndex &previous);
 
 public slots:
   void clearBookmarks();
@@ -85,42 +86,35 @@ public slots:
   void jumpToBookmark(int idx);
 
 private:
-  uint AddDrawcalls(QTreeWidgetItem *parent, const rdctype::array<DrawcallDescription> &draws);
-  void SetDrawcallTimes(QTreeWidgetItem *node, const rdctype::array<CounterResult> &results);
-
-  void ExpandNode(QTreeWidgetItem *node);
-
-  bool FindEventNode(QTreeWidgetItem *&found, QTreeWidgetItem *parent, uint32_t eventID);
   bool SelectEvent(uint32_t eventID);
 
-  void ClearFindIcons(QTreeWidgetItem *parent);
   void ClearFindIcons();
 
-  int SetFindIcons(QTreeWidgetItem *parent, QString filter);
-  int SetFindIcons(QString filter);
+  void UpdateFindResults(std::function<void()> finished);
+  void FetchFindResults(int generation, QByteArray text, uint32_t afterEID,
+                        std::function<void()> finished);
+  void AddFindResults(const rdctype::array<uint32_t> &eventIDs);
 
   void highlightBookmarks();
-  bool hasBookmark(QTreeWidgetItem *node);
 
-  QTreeWidgetItem *FindNode(QTreeWidgetItem *parent, QString filter, uint32_t after);
-  int FindEvent(QTreeWidgetItem *parent, QString filter, uint32_t after, bool forward);
-  int FindEvent(QString filter, uint32_t after, bool forward);
   void Find(bool forward);
+  void StepFindResult(bool forward);
 
-  QIcon m_CurrentIcon;
-  QIcon m_FindIcon;
-  QIcon m_BookmarkIcon;
-
+  EventItemModel *m_Model;
   SizeDelegate *m_SizeDelegate;
   QTimer *m_FindHighlight;
 
+  // sorted EIDs of the drawcalls matching m_FindString, filled in as the search progresses
+  QString m_FindString;
+  QVector<uint32_t> m_FindResults;
+  bool m_FindPending = false;
+  int m_FindGeneration = 0;
+
   FlowLayout *m_BookmarkStripLayout;
   QSpacerItem *m_BookmarkSpacer;
   QList<int> m_Bookmarks;
   QList<QToolButton *> m_BookmarkButtons;
 
-  void RefreshIcon(QTreeWidgetItem *item);
-
   Ui::EventBrowser *ui;
   ICaptureContext &m_Ctx;
 };
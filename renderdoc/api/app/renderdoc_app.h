@@ -191,6 +191,52 @@ typedef enum {
   // 0 - API debugging is displayed as normal
   eRENDERDOC_Option_DebugOutputMute = 11,
 
+  // Write captures to disk on a background thread, so that the application can continue as soon
+  // as the capture's data has been gathered rather than waiting for it to be compressed and
+  // written. A small number of captures can be pending at once, after which capturing waits for
+  // earlier writes to finish.
+  //
+  // Default - disabled
+  //
+  // 1 - Captures are written to disk in the background
+  // 0 - Captures are written to disk before the captured frame's present returns
+  eRENDERDOC_Option_AsyncCaptureWrite = 12,
+
+  // Continuously capture every frame into memory, keeping the most recent N frames so that
+  // triggering a capture writes out frames that have already happened, rather than the next frame.
+  // This has a large overhead, and memory use is also capped so fewer than N frames may be kept
+  // for heavy frames. A frame too large to fit on its own isn't kept at all.
+  //
+  // 0 indicates that captures are only made of the frames after a trigger.
+  //
+  // Default - 0 frames
+  eRENDERDOC_Option_RetroactiveFrames = 13,
+
+  // Gather statistics on where the time and memory goes while capturing: chunk counts and sizes per
+  // chunk type, initial contents sizes per resource type, and time spent in different phases of
+  // the capture. These are stored in the capture and reported through target control.
+  //
+  // Default - disabled
+  //
+  // 1 - Capture statistics are gathered
+  // 0 - No statistics are gathered
+  eRENDERDOC_Option_CaptureStatistics = 14,
+
+  // Write the data for resource creation out to a temporary file while not capturing, freeing its
+  // memory. When a capture is made it only needs to be copied from that file, rather than
+  // duplicated in memory, which reduces the capture hitch for applications with a large number of
+  // long-lived resources.
+  //
+  // The spilled data is read back while the capture is written, so this only takes effect along
+  // with eRENDERDOC_Option_AsyncCaptureWrite or eRENDERDOC_Option_RetroactiveFrames, where that
+  // happens on a background thread. It's supported on Vulkan and OpenGL.
+  //
+  // Default - disabled
+  //
+  // 1 - Resource creation data is spilled to disk
+  // 0 - Resource creation data is kept in memory
+  eRENDERDOC_Option_SpillResourceChunks = 15,
+
 } RENDERDOC_CaptureOption;
 
 // Sets an option that controls how RenderDoc behaves on capture.
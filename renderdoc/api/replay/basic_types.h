@@ -30,6 +30,7 @@
 #include <string.h>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 
 // we provide a basic templated type that is a fixed array that just contains a pointer to the
@@ -85,6 +86,22 @@ struct array
   static void deallocate(const void *p) { RENDERDOC_FreeArrayMem(p); }
 #endif
 
+  // copy-construct count elements from src into uninitialised memory at dst. Trivially copyable
+  // types like bytes are copied in one go rather than element by element
+  static void copyConstruct(T *dst, const T *src, int32_t num, std::true_type)
+  {
+    memcpy(dst, src, sizeof(T) * num);
+  }
+  static void copyConstruct(T *dst, const T *src, int32_t num, std::false_type)
+  {
+    for(int32_t i = 0; i < num; i++)
+      new(dst + i) T(src[i]);
+  }
+  static void copyConstruct(T *dst, const T *src, int32_t num)
+  {
+    copyConstruct(dst, src, num, typename std::is_trivially_copyable<T>::type());
+  }
+
   T &operator[](size_t i) { return elems[i]; }
   const T &operator[](size_t i) const { return elems[i]; }
   array(const std::vector<T> &in)
@@ -104,8 +121,7 @@ struct array
     else
     {
       elems = (T *)allocate(sizeof(T) * count);
-      for(int32_t i = 0; i < count; i++)
-        new(elems + i) T(in[i]);
+      copyConstruct(elems, in.data(), count);
     }
     return *this;
   }
@@ -127,12 +143,7 @@ struct array
     else
     {
       elems = (T *)allocate(sizeof(T) * count);
-      int i = 0;
-      for(const T &t : in)
-      {
-        new(elems + i) T(t);
-        i++;
-      }
+      copyConstruct(elems, in.begin(), count);
     }
     return *this;
   }
@@ -159,12 +170,45 @@ struct array
     else
     {
       elems = (T *)allocate(sizeof(T) * o.count);
-      for(int32_t i = 0; i < count; i++)
-        new(elems + i) T(o.elems[i]);
+      copyConstruct(elems, o.elems, count);
     }
     return *this;
   }
 
+  // moving an array takes ownership of its elements without copying them, and leaves the source
+  // empty
+  array(array &&o)
+  {
+    elems = o.elems;
+    count = o.count;
+    o.elems = 0;
+    o.count = 0;
+  }
+
+  array &operator=(array &&o)
+  {
+    // do nothing if we're self-assigning
+    if(this == &o)
+      return *this;
+
+    Delete();
+    elems = o.elems;
+    count = o.count;
+    o.elems = 0;
+    o.count = 0;
+    return *this;
+  }
+
+  void swap(array &o)
+  {
+    T *e = elems;
+    int32_t c = count;
+    elems = o.elems;
+    count = o.count;
+    o.elems = e;
+    o.count = c;
+  }
+
   void create(int sz)
   {
     Delete();
@@ -194,6 +238,81 @@ struct array
   const T &back() const { return *(elems + count - 1); }
 };
 
+// a buffer of bytes with a 64-bit length, for resource contents which can be larger than the 2GB
+// that array's 32-bit count allows.
+struct bytebuf
+{
+  uint8_t *elems;
+  uint64_t count;
+
+  bytebuf() : elems(0), count(0) {}
+  ~bytebuf() { Delete(); }
+  void Delete()
+  {
+    array<uint8_t>::deallocate(elems);
+    elems = 0;
+    count = 0;
+  }
+
+  bytebuf(const bytebuf &o) : elems(0), count(0) { *this = o; }
+  bytebuf &operator=(const bytebuf &o)
+  {
+    // do nothing if we're self-assigning
+    if(this == &o)
+      return *this;
+
+    assign(o.elems, o.count);
+    return *this;
+  }
+
+  bytebuf(bytebuf &&o) : elems(o.elems), count(o.count)
+  {
+    o.elems = 0;
+    o.count = 0;
+  }
+
+  bytebuf &operator=(bytebuf &&o)
+  {
+    // do nothing if we're self-assigning
+    if(this == &o)
+      return *this;
+
+    Delete();
+    elems = o.elems;
+    count = o.count;
+    o.elems = 0;
+    o.count = 0;
+    return *this;
+  }
+
+  // allocates sz bytes. Unlike array::create the contents are left uninitialised, since the
+  // buffer is always about to be filled and clearing gigabytes of memory first isn't free.
+  void create(uint64_t sz)
+  {
+    Delete();
+    count = sz;
+    if(sz > 0)
+      elems = (uint8_t *)array<uint8_t>::allocate((size_t)sz);
+  }
+
+  void assign(const uint8_t *src, uint64_t sz)
+  {
+    create(sz);
+    if(sz > 0)
+      memcpy(elems, src, (size_t)sz);
+  }
+
+  uint8_t &operator[](size_t i) { return elems[i]; }
+  const uint8_t &operator[](size_t i) const { return elems[i]; }
+  size_t size() const { return (size_t)count; }
+  void clear() { Delete(); }
+  bool empty() const { return count == 0; }
+  uint8_t *begin() { return elems ? elems : end(); }
+  uint8_t *end() { return elems ? elems + count : NULL; }
+  const uint8_t *begin() const { return elems ? elems : end(); }
+  const uint8_t *end() const { return elems ? elems + count : NULL; }
+};
+
 struct str : public rdctype::array<char>
 {
   str &operator=(const std::string &in);
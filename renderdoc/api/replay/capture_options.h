@@ -178,4 +178,62 @@ Default - enabled
 ``False`` - API debugging is displayed as normal.
 )");
   bool32 DebugOutputMute;
+
+  DOCUMENT(R"(Write captures to disk on a background thread, so that the application can
+continue as soon as the capture's data has been gathered rather than waiting for it
+to be compressed and written.
+
+A small number of captures can be pending at once, after which capturing waits for
+earlier writes to finish.
+
+Default - disabled
+
+``True`` - Captures are written to disk in the background.
+
+``False`` - Captures are written to disk before the captured frame's present returns.
+)");
+  bool32 AsyncCaptureWrite;
+
+  DOCUMENT(R"(Continuously capture every frame into memory, keeping the most recent frames so
+that triggering a capture writes out frames that have already happened, rather than
+the next frame.
+
+This has a large overhead. Memory use is also capped, so fewer frames may be kept
+when frames are heavy, and a frame too large to fit on its own isn't kept at all.
+
+``0`` indicates that captures are only made of the frames after a trigger.
+
+Default - 0 frames
+)");
+  uint32_t RetroactiveFrames;
+
+  DOCUMENT(R"(Gather statistics on where the time and memory goes while capturing, such as
+chunk counts and sizes per chunk type, initial contents sizes per resource type, and time
+spent in different phases of the capture. These are stored in the capture and reported
+through target control.
+
+Default - disabled
+
+``True`` - Capture statistics are gathered.
+
+``False`` - No statistics are gathered.
+)");
+  bool32 CaptureStatistics;
+
+  DOCUMENT(R"(Write the data for resource creation out to a temporary file while not capturing,
+freeing its memory. When a capture is made it only needs to be copied from that file, rather than
+duplicated in memory, which reduces the capture hitch for applications with a large number of
+long-lived resources.
+
+The spilled data is read back while the capture is written, so this only takes effect along with
+:data:`AsyncCaptureWrite` or :data:`RetroactiveFrames`, where that happens on a background thread.
+It's supported on Vulkan and OpenGL.
+
+Default - disabled
+
+``True`` - Resource creation data is spilled to disk.
+
+``False`` - Resource creation data is kept in memory.
+)");
+  bool32 SpillResourceChunks;
 };
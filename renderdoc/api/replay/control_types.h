@@ -436,6 +436,10 @@ struct NewCaptureData
   rdctype::str path;
   DOCUMENT("``True`` if the target is running on the local system.");
   bool32 local;
+  DOCUMENT(R"(A human readable report of capture overhead statistics, if the capture was made
+with the :data:`CaptureOptions.CaptureStatistics` option enabled. Otherwise this is empty.
+)");
+  rdctype::str statistics;
 };
 
 DECLARE_REFLECTION_STRUCT(NewCaptureData);
@@ -579,6 +579,46 @@ See :meth:`BuildTargetShader`.
 )");
   virtual rdctype::array<DrawcallDescription> GetDrawcalls() = 0;
 
+  DOCUMENT(R"(Retrieve a single drawcall by its :data:`EID <APIEvent.eventID>`, without children.
+
+Unlike :meth:`GetDrawcalls` this doesn't copy the tree of drawcalls below the one returned, so
+together with :meth:`GetDrawcallChildren` it can be used to walk a large frame lazily.
+
+:param int eventID: The :data:`EID <APIEvent.eventID>` of the drawcall to retrieve.
+:return: The drawcall, with an empty :data:`DrawcallDescription.children` list. If no drawcall
+  exists at this EID, a default-constructed drawcall with :data:`DrawcallDescription.eventID` 0.
+:rtype: DrawcallDescription
+)");
+  virtual DrawcallDescription GetDrawcall(uint32_t eventID) = 0;
+
+  DOCUMENT(R"(Retrieve the :data:`EIDs <APIEvent.eventID>` of the children of a drawcall.
+
+:param int eventID: The :data:`EID <APIEvent.eventID>` of the parent drawcall, or ``0`` to list the
+  root-level drawcalls.
+:return: The EIDs of the drawcall's children, in order. These can be passed to
+  :meth:`GetDrawcall`.
+:rtype: ``list`` of ``int``
+)");
+  virtual rdctype::array<uint32_t> GetDrawcallChildren(uint32_t eventID) = 0;
+
+  DOCUMENT(R"(Search the events in the frame for some text.
+
+Each event is matched against its serialised call parameters and the name of any drawcall or marker
+at that :data:`EID <APIEvent.eventID>`. Matching is case-insensitive. The search uses an index built
+when the capture is loaded, so it does not need to walk the drawcall tree.
+
+Results can be fetched incrementally by passing the last EID returned as ``afterEventID`` in the
+next call.
+
+:param str text: The text to search for.
+:param int afterEventID: Only events after this :data:`EID <APIEvent.eventID>` are returned.
+:param int maxResults: The maximum number of results to return, or ``0`` to return all matches.
+:return: The EIDs of the matching events, in ascending order.
+:rtype: ``list`` of ``int``
+)");
+  virtual rdctype::array<uint32_t> FindEvents(const char *text, uint32_t afterEventID,
+                                              uint32_t maxResults) = 0;
+
   DOCUMENT(R"(Retrieve the values of a specified set of counters.
 
 :param list counters: The list of :class:`GPUCounter` to fetch results for.
@@ -737,13 +777,16 @@ texture to something compatible with the target file format.
 
   DOCUMENT(R"(Retrieve the contents of a range of a buffer as a ``bytes``.
 
+This can be used to fetch a large buffer in windows of ``len`` bytes at a time. A window that
+extends past the end of the buffer is clamped, and one that starts past the end returns no data.
+
 :param ResourceId buff: The id of the buffer to retrieve data from.
 :param int offset: The byte offset to the start of the range.
 :param int len: The length of the range, or 0 to retrieve the rest of the bytes in the buffer.
 :return: The requested buffer contents.
 :rtype: ``bytes``
 )");
-  virtual rdctype::array<byte> GetBufferData(ResourceId buff, uint64_t offset, uint64_t len) = 0;
+  virtual rdctype::bytebuf GetBufferData(ResourceId buff, uint64_t offset, uint64_t len) = 0;
 
   DOCUMENT(R"(Retrieve the contents of one subresource of a texture as a ``bytes``.
 
@@ -757,7 +800,43 @@ sample 0, etc.
 :return: The requested texture contents.
 :rtype: ``bytes``
 )");
-  virtual rdctype::array<byte> GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip) = 0;
+  virtual rdctype::bytebuf GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip) = 0;
+
+  DOCUMENT(R"(Retrieve the contents of a range of a buffer into caller-provided memory.
+
+This is equivalent to :meth:`GetBufferData` but writes directly into ``dest`` instead of returning a
+new ``bytes``, so that large buffers can be fetched without an extra allocation and copy. From
+python ``dest`` can be any writable object supporting the buffer protocol such as a ``bytearray``,
+``memoryview`` or numpy array, and its length is the length of the range to retrieve.
+
+:param ResourceId buff: The id of the buffer to retrieve data from.
+:param int offset: The byte offset to the start of the range.
+:param bytearray dest: The memory to write the range into.
+:return: The number of bytes written, which is less than the length of ``dest`` if the range
+  extends past the end of the buffer.
+:rtype: ``int``
+)");
+  virtual uint64_t GetBufferDataInto(ResourceId buff, uint64_t offset, byte *dest,
+                                     uint64_t destSize) = 0;
+
+  DOCUMENT(R"(Retrieve the contents of one subresource of a texture into caller-provided memory.
+
+This is equivalent to :meth:`GetTextureData` but writes directly into ``dest`` instead of returning
+a new ``bytes``. From python ``dest`` can be any writable object supporting the buffer protocol
+such as a ``bytearray``, ``memoryview`` or numpy array.
+
+If ``dest`` is smaller than the subresource, only as many bytes as fit are written. The size of the
+subresource is returned either way, so it can be queried by passing an empty ``dest``.
+
+:param ResourceId tex: The id of the texture to retrieve data from.
+:param int arrayIdx: The slice of an array or 3D texture, or face of a cubemap texture.
+:param int mip: The mip level to pick from.
+:param bytearray dest: The memory to write the texture contents into.
+:return: The size in bytes of the texture contents.
+:rtype: ``int``
+)");
+  virtual uint64_t GetTextureDataInto(ResourceId tex, uint32_t arrayIdx, uint32_t mip, byte *dest,
+                                      uint64_t destSize) = 0;
 
   static const uint32_t NoPreference = ~0U;
 
@@ -28,6 +28,7 @@
 #include <string.h>
 #include <string>
 #include "common/threading.h"
+#include "core/capture_stats.h"
 #include "os/os_specific.h"
 #include "serialise/string_utils.h"
 
@@ -126,6 +127,8 @@ bool Vec16NotEqual(void *a, void *b)
 
 bool FindDiffRange(void *a, void *b, size_t bufSize, size_t &diffStart, size_t &diffEnd)
 {
+  SCOPED_CAPTURE_TIMER(FindDiffRange);
+
   RDCASSERT(uintptr_t(a) % 16 == 0);
   RDCASSERT(uintptr_t(b) % 16 == 0);
 
@@ -223,6 +226,114 @@ bool FindDiffRange(void *a, void *b, size_t bufSize, size_t &diffStart, size_t &
   return diffStart < bufSize;
 }
 
+// 64-bit hash of arbitrary data, following the xxHash64 algorithm. This is intended for quickly
+// comparing large blobs of data by content, it is not cryptographically secure.
+static const uint64_t HashPrime1 = 11400714785074694791ULL;
+static const uint64_t HashPrime2 = 14029467366897019727ULL;
+static const uint64_t HashPrime3 = 1609587929392839161ULL;
+static const uint64_t HashPrime4 = 9650029242287828579ULL;
+static const uint64_t HashPrime5 = 2870177450012600261ULL;
+
+static inline uint64_t HashRotl(uint64_t x, int r)
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t HashRead64(const byte *p)
+{
+  uint64_t ret;
+  memcpy(&ret, p, sizeof(ret));
+  return ret;
+}
+
+static inline uint32_t HashRead32(const byte *p)
+{
+  uint32_t ret;
+  memcpy(&ret, p, sizeof(ret));
+  return ret;
+}
+
+static inline uint64_t HashRound(uint64_t acc, uint64_t input)
+{
+  acc += input * HashPrime2;
+  acc = HashRotl(acc, 31);
+  return acc * HashPrime1;
+}
+
+static inline uint64_t HashMergeRound(uint64_t acc, uint64_t val)
+{
+  acc ^= HashRound(0, val);
+  return acc * HashPrime1 + HashPrime4;
+}
+
+uint64_t Hash64(const void *data, size_t len, uint64_t seed)
+{
+  const byte *p = (const byte *)data;
+  const byte *end = p + len;
+
+  uint64_t hash;
+
+  if(len >= 32)
+  {
+    const byte *limit = end - 32;
+
+    uint64_t v1 = seed + HashPrime1 + HashPrime2;
+    uint64_t v2 = seed + HashPrime2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - HashPrime1;
+
+    do
+    {
+      v1 = HashRound(v1, HashRead64(p));
+      v2 = HashRound(v2, HashRead64(p + 8));
+      v3 = HashRound(v3, HashRead64(p + 16));
+      v4 = HashRound(v4, HashRead64(p + 24));
+      p += 32;
+    } while(p <= limit);
+
+    hash = HashRotl(v1, 1) + HashRotl(v2, 7) + HashRotl(v3, 12) + HashRotl(v4, 18);
+    hash = HashMergeRound(hash, v1);
+    hash = HashMergeRound(hash, v2);
+    hash = HashMergeRound(hash, v3);
+    hash = HashMergeRound(hash, v4);
+  }
+  else
+  {
+    hash = seed + HashPrime5;
+  }
+
+  hash += (uint64_t)len;
+
+  while(p + 8 <= end)
+  {
+    hash ^= HashRound(0, HashRead64(p));
+    hash = HashRotl(hash, 27) * HashPrime1 + HashPrime4;
+    p += 8;
+  }
+
+  if(p + 4 <= end)
+  {
+    hash ^= (uint64_t)HashRead32(p) * HashPrime1;
+    hash = HashRotl(hash, 23) * HashPrime2 + HashPrime3;
+    p += 4;
+  }
+
+  while(p < end)
+  {
+    hash ^= (*p) * HashPrime5;
+    hash = HashRotl(hash, 11) * HashPrime1;
+    p++;
+  }
+
+  hash ^= hash >> 33;
+  hash *= HashPrime2;
+  hash ^= hash >> 29;
+  hash *= HashPrime3;
+  hash ^= hash >> 32;
+
+  return hash;
+}
+
 uint32_t CalcNumMips(int w, int h, int d)
 {
   int mipLevels = 1;
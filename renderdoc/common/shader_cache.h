@@ -26,9 +26,10 @@
 
 #include "os/os_specific.h"
 
-template <typename ResultType, typename ShaderCallbacks>
+// the cache key can be any plain integer type, it's stored as-is in the file
+template <typename KeyType, typename ResultType, typename ShaderCallbacks>
 bool LoadShaderCache(const char *filename, const uint32_t magicNumber, const uint32_t versionNumber,
-                     std::map<uint32_t, ResultType> &resultCache, const ShaderCallbacks &callbacks)
+                     std::map<KeyType, ResultType> &resultCache, const ShaderCallbacks &callbacks)
 {
   string shadercache = FileIO::GetAppFolderFilename(filename);
 
@@ -74,16 +75,17 @@ bool LoadShaderCache(const char *filename, const uint32_t magicNumber, const uin
 
       for(uint32_t i = 0; i < numentries; i++)
       {
-        if((size_t)bufsize < sizeof(uint32_t))
+        if((size_t)bufsize < sizeof(KeyType))
         {
           RDCERR("Invalid shader cache - truncated, not enough data for shader hash");
           ret = false;
           break;
         }
 
-        uint32_t hash = *(uint32_t *)ptr;
-        ptr += sizeof(uint32_t);
-        bufsize -= sizeof(uint32_t);
+        KeyType hash;
+        memcpy(&hash, ptr, sizeof(KeyType));
+        ptr += sizeof(KeyType);
+        bufsize -= sizeof(KeyType);
 
         if((size_t)bufsize < sizeof(uint32_t))
         {
@@ -137,9 +139,9 @@ bool LoadShaderCache(const char *filename, const uint32_t magicNumber, const uin
   return ret;
 }
 
-template <typename ResultType, typename ShaderCallbacks>
+template <typename KeyType, typename ResultType, typename ShaderCallbacks>
 void SaveShaderCache(const char *filename, uint32_t magicNumber, uint32_t versionNumber,
-                     const std::map<uint32_t, ResultType> &cache, const ShaderCallbacks &callbacks)
+                     const std::map<KeyType, ResultType> &cache, const ShaderCallbacks &callbacks)
 {
   string shadercache = FileIO::GetAppFolderFilename(filename);
 
@@ -158,7 +160,7 @@ void SaveShaderCache(const char *filename, uint32_t magicNumber, uint32_t versio
 
   for(auto it = cache.begin(); it != cache.end(); ++it)
   {
-    uint32_t hash = it->first;
+    KeyType hash = it->first;
     uint32_t len = callbacks.GetSize(it->second);
     byte *data = callbacks.GetData(it->second);
     FileIO::fwrite(&hash, 1, sizeof(hash), f);
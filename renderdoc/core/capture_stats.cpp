@@ -0,0 +1,359 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "capture_stats.h"
+#include <algorithm>
+#include "common/common.h"
+#include "os/os_specific.h"
+#include "serialise/serialiser.h"
+#include "serialise/string_utils.h"
+#include "core.h"
+
+static const char *TimerNames[] = {
+    "FindDiffRange",
+    "Prepare initial states",
+    "Serialise initial states",
+    "End capture: finish frame",
+    "End capture: thumbnail",
+    "End capture: resource chunks",
+    "End capture: frame chunks",
+};
+
+RDCCOMPILE_ASSERT(ARRAY_COUNT(TimerNames) == (uint32_t)CaptureTimer::Count,
+                  "Capture timer names are mismatched");
+
+namespace CaptureStats
+{
+volatile bool Enabled = false;
+
+// bumped on each Begin(), so threads lazily reset their stats the first time they record anything
+// in a new capture
+static uint32_t Generation = 0;
+
+struct ThreadStats
+{
+  Threading::CriticalSection lock;
+  uint32_t generation;
+  Totals totals;
+};
+
+// threads register their stats here the first time they record anything. The entries are never
+// freed, so that GetTotals doesn't race with thread exit - there's only one per thread that has
+// ever serialised during a capture.
+static Threading::CriticalSection ThreadListLock;
+static std::vector<ThreadStats *> ThreadList;
+
+static uint64_t ThreadStatsSlot = 0;
+
+Totals::Totals()
+{
+  for(uint32_t i = 0; i < (uint32_t)CaptureTimer::Count; i++)
+  {
+    timerMS[i] = 0.0;
+    timerCalls[i] = 0;
+  }
+}
+
+// returns this thread's stats locked, or NULL if we're not counting
+static ThreadStats *LockThreadStats()
+{
+  if(!Enabled)
+    return NULL;
+
+  ThreadStats *stats = (ThreadStats *)Threading::GetTLSValue(ThreadStatsSlot);
+
+  if(stats == NULL)
+  {
+    stats = new ThreadStats;
+    stats->generation = 0;
+
+    Threading::SetTLSValue(ThreadStatsSlot, stats);
+
+    SCOPED_LOCK(ThreadListLock);
+    ThreadList.push_back(stats);
+  }
+
+  stats->lock.Lock();
+
+  if(stats->generation != Generation)
+  {
+    stats->totals = Totals();
+    stats->generation = Generation;
+  }
+
+  return stats;
+}
+
+void Begin()
+{
+  SCOPED_LOCK(ThreadListLock);
+
+  if(ThreadStatsSlot == 0)
+    ThreadStatsSlot = Threading::AllocateTLSSlot();
+
+  Generation++;
+  Enabled = true;
+}
+
+void End()
+{
+  Enabled = false;
+}
+
+void GetTotals(Totals &totals)
+{
+  totals = Totals();
+
+  SCOPED_LOCK(ThreadListLock);
+
+  for(size_t t = 0; t < ThreadList.size(); t++)
+  {
+    ThreadStats *stats = ThreadList[t];
+
+    SCOPED_LOCK(stats->lock);
+
+    if(stats->generation != Generation)
+      continue;
+
+    for(uint32_t i = 0; i < (uint32_t)CaptureTimer::Count; i++)
+    {
+      totals.timerMS[i] += stats->totals.timerMS[i];
+      totals.timerCalls[i] += stats->totals.timerCalls[i];
+    }
+
+    const std::vector<Counter> &chunks = stats->totals.chunks;
+
+    if(totals.chunks.size() < chunks.size())
+      totals.chunks.resize(chunks.size());
+
+    for(size_t i = 0; i < chunks.size(); i++)
+    {
+      totals.chunks[i].count += chunks[i].count;
+      totals.chunks[i].bytes += chunks[i].bytes;
+    }
+
+    for(auto it = stats->totals.resources.begin(); it != stats->totals.resources.end(); ++it)
+    {
+      Counter &c = totals.resources[it->first];
+      c.count += it->second.count;
+      c.bytes += it->second.bytes;
+    }
+  }
+}
+
+void AddChunk(uint32_t type, uint64_t bytes)
+{
+  // don't count the placeholder for our own chunk
+  if(type == CAPTURE_STATISTICS)
+    return;
+
+  ThreadStats *stats = LockThreadStats();
+  if(stats == NULL)
+    return;
+
+  std::vector<Counter> &chunks = stats->totals.chunks;
+
+  if(type >= chunks.size())
+    chunks.resize(type + 1);
+
+  chunks[type].count++;
+  chunks[type].bytes += bytes;
+
+  stats->lock.Unlock();
+}
+
+void AddResourceBytes(const std::string &type, uint64_t bytes)
+{
+  ThreadStats *stats = LockThreadStats();
+  if(stats == NULL)
+    return;
+
+  Counter &c = stats->totals.resources[type];
+  c.count++;
+  c.bytes += bytes;
+
+  stats->lock.Unlock();
+}
+
+void AddTime(CaptureTimer timer, double ms)
+{
+  ThreadStats *stats = LockThreadStats();
+  if(stats == NULL)
+    return;
+
+  stats->totals.timerMS[(uint32_t)timer] += ms;
+  stats->totals.timerCalls[(uint32_t)timer]++;
+
+  stats->lock.Unlock();
+}
+
+Chunk *MakeChunk(Serialiser *chunkSerialiser, const Totals *totals)
+{
+  ScopedContext scope(chunkSerialiser, "Capture Statistics", CAPTURE_STATISTICS, false);
+
+  uint32_t numTimers = totals ? (uint32_t)CaptureTimer::Count : 0;
+  chunkSerialiser->Serialise("NumTimers", numTimers);
+
+  for(uint32_t i = 0; i < numTimers; i++)
+  {
+    std::string name = TimerNames[i];
+    double ms = totals->timerMS[i];
+    uint64_t calls = totals->timerCalls[i];
+
+    chunkSerialiser->Serialise("Name", name);
+    chunkSerialiser->Serialise("Milliseconds", ms);
+    chunkSerialiser->Serialise("Calls", calls);
+  }
+
+  uint32_t numChunkTypes = 0;
+  for(size_t i = 0; totals && i < totals->chunks.size(); i++)
+    if(totals->chunks[i].count > 0)
+      numChunkTypes++;
+
+  chunkSerialiser->Serialise("NumChunkTypes", numChunkTypes);
+
+  for(size_t i = 0; totals && i < totals->chunks.size(); i++)
+  {
+    if(totals->chunks[i].count == 0)
+      continue;
+
+    uint32_t type = (uint32_t)i;
+    uint64_t count = totals->chunks[i].count;
+    uint64_t bytes = totals->chunks[i].bytes;
+
+    chunkSerialiser->Serialise("ChunkType", type);
+    chunkSerialiser->Serialise("Count", count);
+    chunkSerialiser->Serialise("Bytes", bytes);
+  }
+
+  uint32_t numResourceTypes = totals ? (uint32_t)totals->resources.size() : 0;
+  chunkSerialiser->Serialise("NumResourceTypes", numResourceTypes);
+
+  if(totals)
+  {
+    for(auto it = totals->resources.begin(); it != totals->resources.end(); ++it)
+    {
+      std::string name = it->first;
+      uint64_t count = it->second.count;
+      uint64_t bytes = it->second.bytes;
+
+      chunkSerialiser->Serialise("ResourceType", name);
+      chunkSerialiser->Serialise("Count", count);
+      chunkSerialiser->Serialise("Bytes", bytes);
+    }
+  }
+
+  return scope.Get(true);
+}
+
+static bool SortByBytes(const std::pair<uint32_t, Counter> &a,
+                        const std::pair<uint32_t, Counter> &b)
+{
+  return a.second.bytes > b.second.bytes;
+}
+
+std::string GetReport(const Totals &totals, ChunkNameCallback chunkNames)
+{
+  std::string ret = "Capture statistics:\n";
+
+  for(uint32_t i = 0; i < (uint32_t)CaptureTimer::Count; i++)
+  {
+    if(totals.timerCalls[i] == 0)
+      continue;
+
+    ret += StringFormat::Fmt("  %s: %.3lf ms", TimerNames[i], totals.timerMS[i]);
+
+    if(totals.timerCalls[i] > 1)
+      ret += StringFormat::Fmt(" (%llu calls)", totals.timerCalls[i]);
+
+    ret += "\n";
+  }
+
+  std::vector<std::pair<uint32_t, Counter> > chunks;
+  uint64_t chunkBytes = 0;
+
+  for(size_t i = 0; i < totals.chunks.size(); i++)
+  {
+    if(totals.chunks[i].count == 0)
+      continue;
+
+    chunks.push_back(std::make_pair((uint32_t)i, totals.chunks[i]));
+    chunkBytes += totals.chunks[i].bytes;
+  }
+
+  std::sort(chunks.begin(), chunks.end(), SortByBytes);
+
+  ret += StringFormat::Fmt("Chunks serialised: %llu bytes\n", chunkBytes);
+
+  for(size_t i = 0; i < chunks.size(); i++)
+  {
+    std::string name =
+        chunkNames ? chunkNames(chunks[i].first) : StringFormat::Fmt("Chunk %u", chunks[i].first);
+
+    ret += StringFormat::Fmt("  %s: %llu chunks, %llu bytes\n", name.c_str(),
+                             chunks[i].second.count, chunks[i].second.bytes);
+  }
+
+  if(!totals.resources.empty())
+  {
+    ret += "Initial contents:\n";
+
+    for(auto it = totals.resources.begin(); it != totals.resources.end(); ++it)
+      ret += StringFormat::Fmt("  %s: %llu resources, %llu bytes\n", it->first.c_str(),
+                               it->second.count, it->second.bytes);
+  }
+
+  return ret;
+}
+
+std::string GetRecordMemoryReport(const std::map<std::string, Counter> &records)
+{
+  std::string ret;
+
+  uint64_t recordBytes = 0;
+  for(auto it = records.begin(); it != records.end(); ++it)
+    recordBytes += it->second.bytes;
+
+  ret += StringFormat::Fmt("Resource records: %llu bytes\n", recordBytes);
+
+  for(auto it = records.begin(); it != records.end(); ++it)
+    ret += StringFormat::Fmt("  %s: %llu records, %llu bytes\n", it->first.c_str(),
+                             it->second.count, it->second.bytes);
+
+  return ret;
+}
+};
+
+void ScopedCaptureTimer::Start()
+{
+  m_Active = true;
+  m_Start = Timing::GetTick();
+}
+
+void ScopedCaptureTimer::Stop()
+{
+  double ms = double(Timing::GetTick() - m_Start) / Timing::GetTickFrequency();
+
+  CaptureStats::AddTime(m_Timer, ms);
+}
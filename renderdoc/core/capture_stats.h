@@ -0,0 +1,132 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "common/common.h"
+
+class Chunk;
+class Serialiser;
+
+// phases of a capture that are timed when the CaptureStatistics option is enabled
+enum class CaptureTimer : uint32_t
+{
+  FindDiffRange,
+  PrepareInitialState,
+  SerialiseInitialState,
+  EndCaptureFinishFrame,
+  EndCaptureThumbnail,
+  EndCaptureResourceChunks,
+  EndCaptureFrameChunks,
+  Count,
+};
+
+typedef const char *(*ChunkNameCallback)(uint32_t idx);
+
+// Counters for where capture-time overhead goes. Counting only happens between Begin() and End(),
+// which RenderDoc calls around a capture when the CaptureStatistics option is set - otherwise
+// every hook is a single branch on Enabled.
+//
+// Each thread accumulates into its own stats, so serialising from several threads doesn't
+// contend. They're only merged when the totals are fetched at the end of the capture.
+namespace CaptureStats
+{
+struct Counter
+{
+  Counter() : count(0), bytes(0) {}
+  uint64_t count;
+  uint64_t bytes;
+};
+
+struct Totals
+{
+  Totals();
+
+  double timerMS[(uint32_t)CaptureTimer::Count];
+  uint64_t timerCalls[(uint32_t)CaptureTimer::Count];
+
+  // indexed by chunk type
+  std::vector<Counter> chunks;
+
+  // initial contents, by resource type name
+  std::map<std::string, Counter> resources;
+};
+
+extern volatile bool Enabled;
+
+inline bool IsEnabled()
+{
+  return Enabled;
+}
+
+void Begin();
+void End();
+
+// merges every thread's stats since the last Begin()
+void GetTotals(Totals &totals);
+
+void AddChunk(uint32_t type, uint64_t bytes);
+void AddResourceBytes(const std::string &type, uint64_t bytes);
+void AddTime(CaptureTimer timer, double ms);
+
+// creates the CAPTURE_STATISTICS chunk. With no totals an empty chunk is created, which is used
+// as a placeholder to fill in once the capture is complete.
+Chunk *MakeChunk(Serialiser *chunkSerialiser, const Totals *totals);
+
+// a human readable summary of the totals, for the log and UI
+std::string GetReport(const Totals &totals, ChunkNameCallback chunkNames);
+
+// a human readable summary of the memory used by resource records, by resource type name
+std::string GetRecordMemoryReport(const std::map<std::string, Counter> &records);
+};
+
+class ScopedCaptureTimer
+{
+public:
+  ScopedCaptureTimer(CaptureTimer timer) : m_Timer(timer), m_Active(false), m_Start(0)
+  {
+    if(CaptureStats::IsEnabled())
+      Start();
+  }
+  ~ScopedCaptureTimer()
+  {
+    if(m_Active)
+      Stop();
+  }
+
+private:
+  void Start();
+  void Stop();
+
+  CaptureTimer m_Timer;
+  bool m_Active;
+  uint64_t m_Start;
+};
+
+#define SCOPED_CAPTURE_TIMER(timer) \
+  ScopedCaptureTimer CONCAT(capturetimer, __LINE__)(CaptureTimer::timer);
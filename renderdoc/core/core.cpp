@@ -30,6 +30,7 @@
 #include "common/common.h"
 #include "common/dds_readwrite.h"
 #include "hooks/hooks.h"
+#include "jpeg-compressor/jpge.h"
 #include "replay/replay_driver.h"
 #include "serialise/serialiser.h"
 #include "serialise/string_utils.h"
@@ -209,7 +210,7 @@ void RenderDoc::UnloadCrashHandler()
   SAFE_DELETE(m_ExHandler);
 }
 
-RenderDoc::RenderDoc()
+RenderDoc::RenderDoc() : m_CaptureWriteSlots(MaxPendingCaptureWrites)
 {
   m_LogFile = "";
   m_MarkerIndentLevel = 0;
@@ -220,6 +221,12 @@ RenderDoc::RenderDoc()
   m_RemoteIdent = 0;
   m_RemoteThread = 0;
 
+  m_CaptureWriteThread = 0;
+  m_CaptureWriteThreadRunning = false;
+
+  m_RetroactiveOverBudget = false;
+
+
   m_Replay = false;
 
   m_Cap = 0;
@@ -305,6 +312,10 @@ void RenderDoc::Initialise()
       SetLogFile(capture_filename.c_str());
 
     RDCLOGFILE(m_LoggingFilename.c_str());
+
+    // only opened if resource chunks are actually spilled
+    if(!IsReplayApp())
+      ChunkSpill::SetFilename(m_LoggingFilename + ".chunks");
   }
 
   if(IsReplayApp())
@@ -349,6 +360,22 @@ RenderDoc::~RenderDoc()
   for(auto it = m_ShutdownFunctions.begin(); it != m_ShutdownFunctions.end(); ++it)
     (*it)();
 
+  {
+    SCOPED_LOCK(m_CaptureWriteLock);
+    // as with the remote thread below we can't safely join here, so any background writes that
+    // haven't completed by now are lost
+    if(!m_PendingCaptureWrites.empty())
+      RDCWARN("%u capture(s) still being written in the background at shutdown",
+              (uint32_t)m_PendingCaptureWrites.size());
+  }
+
+  for(size_t i = 0; i < m_RetroactiveFrames.size(); i++)
+  {
+    DiscardThumbnail(m_RetroactiveFrames[i].fileSerialiser);
+    SAFE_DELETE(m_RetroactiveFrames[i].fileSerialiser);
+  }
+  m_RetroactiveFrames.clear();
+
   for(size_t i = 0; i < m_Captures.size(); i++)
   {
     if(m_Captures[i].retrieved)
@@ -362,6 +389,8 @@ RenderDoc::~RenderDoc()
     }
   }
 
+  ChunkSpill::Shutdown();
+
   RDCSTOPLOGGING();
 
   FileIO::Delete(m_LoggingFilename.c_str());
@@ -392,6 +421,8 @@ void RenderDoc::Shutdown()
     UnloadCrashHandler();
   }
 
+  FlushCaptureWrites();
+
   if(m_RemoteThread)
   {
     // explicitly wait for thread to shutdown, this call is not from module unloading and
@@ -475,6 +506,22 @@ void RenderDoc::StartFrameCapture(void *dev, void *wnd)
   IFrameCapturer *frameCap = MatchFrameCapturer(dev, wnd);
   if(frameCap)
   {
+    if(m_Options.CaptureStatistics)
+    {
+      SCOPED_LOCK(m_StatsLock);
+
+      if(m_Stats.capturer == NULL)
+      {
+        m_Stats = CaptureStatistics();
+        m_Stats.capturer = frameCap;
+        CaptureStats::Begin();
+      }
+      else if(m_Stats.capturer != frameCap)
+      {
+        RDCWARN("Capture statistics are already being collected for another device's capture");
+      }
+    }
+
     frameCap->StartFrameCapture(dev, wnd);
     m_CapturesActive++;
   }
@@ -500,7 +547,25 @@ bool RenderDoc::EndFrameCapture(void *dev, void *wnd)
   if(frameCap)
   {
     m_CapturesActive--;
-    return frameCap->EndFrameCapture(dev, wnd);
+    bool ret = frameCap->EndFrameCapture(dev, wnd);
+
+    // the statistics have been written by now, unless the capture failed
+    {
+      SCOPED_LOCK(m_StatsLock);
+
+      if(m_Stats.capturer == frameCap)
+      {
+        CaptureStats::End();
+        m_Stats = CaptureStatistics();
+      }
+    }
+
+    // walking every resource record is too expensive to do as part of the capture, so the record
+    // memory is only reported once it's complete, and only when statistics were requested
+    if(m_Options.CaptureStatistics)
+      LogRecordMemoryUsage(frameCap);
+
+    return ret;
   }
   return false;
 }
@@ -668,6 +733,22 @@ bool RenderDoc::ShouldTriggerCapture(uint32_t frameNumber)
   if(m_Cap > 0)
     m_Cap--;
 
+  if(m_Options.RetroactiveFrames > 0)
+  {
+    // a trigger writes out the frames we already have, so multi-frame triggers and queued frame
+    // numbers all collapse to the same thing.
+    if(ret || !m_QueuedFrameCaptures.empty())
+    {
+      m_Cap = 0;
+      m_QueuedFrameCaptures.clear();
+
+      WriteRetroactiveFrames();
+    }
+
+    // capture every frame so there is always history to write out
+    return true;
+  }
+
   set<uint32_t> frames;
   frames.swap(m_QueuedFrameCaptures);
   for(auto it = frames.begin(); it != frames.end(); ++it)
@@ -691,8 +772,29 @@ bool RenderDoc::ShouldTriggerCapture(uint32_t frameNumber)
   return ret;
 }
 
-Serialiser *RenderDoc::OpenWriteSerialiser(uint32_t frameNum, RDCInitParams *params, void *thpixels,
-                                           size_t thlen, uint32_t thwidth, uint32_t thheight)
+static Chunk *MakeThumbnailChunk(Serialiser *chunkSerialiser, void *thpixels, size_t thlen,
+                                 uint32_t thwidth, uint32_t thheight)
+{
+  ScopedContext scope(chunkSerialiser, "Thumbnail", THUMBNAIL_DATA, false);
+
+  bool HasThumbnail = (thpixels != NULL && thwidth > 0 && thheight > 0);
+  chunkSerialiser->Serialise("HasThumbnail", HasThumbnail);
+
+  if(HasThumbnail)
+  {
+    byte *buf = (byte *)thpixels;
+    chunkSerialiser->Serialise("ThumbWidth", thwidth);
+    chunkSerialiser->Serialise("ThumbHeight", thheight);
+    chunkSerialiser->SerialiseBuffer("ThumbnailPixels", buf, thlen);
+  }
+
+  return scope.Get(true);
+}
+
+Serialiser *RenderDoc::OpenWriteSerialiser(IFrameCapturer *capturer, uint32_t frameNum,
+                                           RDCInitParams *params, void *thpixels, size_t thlen,
+                                           uint32_t thwidth, uint32_t thheight,
+                                           ChunkNameCallback chunkNames)
 {
   RDCASSERT(m_CurrentDriver != RDC_Unknown);
 
@@ -709,22 +811,8 @@ Serialiser *RenderDoc::OpenWriteSerialiser(uint32_t frameNum, RDCInitParams *par
 
   Serialiser *chunkSerialiser = new Serialiser(NULL, Serialiser::WRITING, debugSerialiser);
 
-  {
-    ScopedContext scope(chunkSerialiser, "Thumbnail", THUMBNAIL_DATA, false);
-
-    bool HasThumbnail = (thpixels != NULL && thwidth > 0 && thheight > 0);
-    chunkSerialiser->Serialise("HasThumbnail", HasThumbnail);
-
-    if(HasThumbnail)
-    {
-      byte *buf = (byte *)thpixels;
-      chunkSerialiser->Serialise("ThumbWidth", thwidth);
-      chunkSerialiser->Serialise("ThumbHeight", thheight);
-      chunkSerialiser->SerialiseBuffer("ThumbnailPixels", buf, thlen);
-    }
-
-    fileSerialiser->Insert(scope.Get(true));
-  }
+  // the thumbnail must be the first chunk, see FinishThumbnail
+  fileSerialiser->Insert(MakeThumbnailChunk(chunkSerialiser, thpixels, thlen, thwidth, thheight));
 
   {
     ScopedContext scope(chunkSerialiser, "Capture Create Parameters", CREATE_PARAMS, false);
@@ -743,6 +831,21 @@ Serialiser *RenderDoc::OpenWriteSerialiser(uint32_t frameNum, RDCInitParams *par
     fileSerialiser->Insert(scope.Get(true));
   }
 
+  // the statistics aren't complete until the driver has finished serialising the frame, so this
+  // is filled in by FinishStatistics
+  {
+    SCOPED_LOCK(m_StatsLock);
+
+    if(m_Stats.capturer == capturer && capturer != NULL)
+    {
+      m_Stats.fileSerialiser = fileSerialiser;
+      m_Stats.chunkIndex = fileSerialiser->GetNumInsertedChunks();
+      m_Stats.chunkNames = chunkNames;
+
+      fileSerialiser->Insert(CaptureStats::MakeChunk(chunkSerialiser, NULL));
+    }
+  }
+
   SAFE_DELETE(chunkSerialiser);
 
   return fileSerialiser;
@@ -1016,17 +1119,407 @@ void RenderDoc::SetProgress(LoadProgressSection section, float delta)
   *m_ProgressPtr = progress;
 }
 
-void RenderDoc::SuccessfullyWrittenLog(uint32_t frameNumber)
+void RenderDoc::RegisterCapture(const string &logfile, uint32_t frameNumber,
+                                const string &statistics)
 {
-  RDCLOG("Written to disk: %s", m_CurrentLogFile.c_str());
+  RDCLOG("Written to disk: %s", logfile.c_str());
 
-  CaptureData cap(m_CurrentLogFile, Timing::GetUnixTimestamp(), frameNumber);
+  CaptureData cap(logfile, Timing::GetUnixTimestamp(), frameNumber, statistics);
   {
     SCOPED_LOCK(m_CaptureLock);
     m_Captures.push_back(cap);
   }
 }
 
+// memory limit for frames held for retroactive capture, regardless of how many were requested
+static const uint64_t RetroactiveMemoryBudget = 1024ULL * 1024 * 1024;
+
+void RenderDoc::EncodeThumbnailAsync(Serialiser *fileSerialiser, byte *thpixels, uint32_t thwidth,
+                                     uint32_t thheight)
+{
+  PendingThumbnail *thumb = new PendingThumbnail;
+  thumb->fileSerialiser = fileSerialiser;
+  thumb->pixels = thpixels;
+  thumb->width = thwidth;
+  thumb->height = thheight;
+  thumb->jpgbuf = NULL;
+  thumb->jpglen = 0;
+
+  thumb->thread = 0;
+
+  // most retroactive frames are never written, so leave the encode until FinishThumbnail
+  if(m_Options.RetroactiveFrames == 0)
+    thumb->thread = Threading::CreateThread(ThumbnailEncodeThread, thumb);
+
+  SCOPED_LOCK(m_ThumbnailLock);
+  m_PendingThumbnails.push_back(thumb);
+}
+
+void RenderDoc::ThumbnailEncodeThread(void *data)
+{
+  PendingThumbnail *thumb = (PendingThumbnail *)data;
+
+  // RGB8 JPEG output is always well under 1 byte per pixel at this quality
+  thumb->jpglen = int(thumb->width * thumb->height);
+  thumb->jpgbuf = new byte[thumb->jpglen];
+
+  jpge::params p;
+  p.m_quality = 80;
+
+  bool success = jpge::compress_image_to_jpeg_file_in_memory(
+      thumb->jpgbuf, thumb->jpglen, thumb->width, thumb->height, 3, thumb->pixels, p);
+
+  if(!success)
+  {
+    RDCERR("Failed to compress to jpg");
+    SAFE_DELETE_ARRAY(thumb->jpgbuf);
+    thumb->jpglen = 0;
+  }
+}
+
+void RenderDoc::FinishThumbnail(Serialiser *fileSerialiser)
+{
+  PendingThumbnail *thumb = NULL;
+
+  {
+    SCOPED_LOCK(m_ThumbnailLock);
+    for(size_t i = 0; i < m_PendingThumbnails.size(); i++)
+    {
+      if(m_PendingThumbnails[i]->fileSerialiser == fileSerialiser)
+      {
+        thumb = m_PendingThumbnails[i];
+        m_PendingThumbnails.erase(m_PendingThumbnails.begin() + i);
+        break;
+      }
+    }
+  }
+
+  if(thumb == NULL)
+    return;
+
+  if(thumb->thread)
+  {
+    Threading::JoinThread(thumb->thread);
+    Threading::CloseThread(thumb->thread);
+  }
+  else
+  {
+    ThumbnailEncodeThread(thumb);
+  }
+
+  if(thumb->jpgbuf)
+  {
+#if ENABLED(RDOC_RELEASE)
+    const bool debugSerialiser = false;
+#else
+    const bool debugSerialiser = true;
+#endif
+
+    Serialiser *chunkSerialiser = new Serialiser(NULL, Serialiser::WRITING, debugSerialiser);
+
+    // OpenWriteSerialiser always inserts the thumbnail as the first chunk
+    fileSerialiser->ReplaceChunk(0, MakeThumbnailChunk(chunkSerialiser, thumb->jpgbuf,
+                                                       (size_t)thumb->jpglen, thumb->width,
+                                                       thumb->height));
+
+    SAFE_DELETE(chunkSerialiser);
+  }
+
+  SAFE_DELETE_ARRAY(thumb->jpgbuf);
+  SAFE_DELETE_ARRAY(thumb->pixels);
+  SAFE_DELETE(thumb);
+}
+
+void RenderDoc::DiscardThumbnail(Serialiser *fileSerialiser)
+{
+  PendingThumbnail *thumb = NULL;
+
+  {
+    SCOPED_LOCK(m_ThumbnailLock);
+    for(size_t i = 0; i < m_PendingThumbnails.size(); i++)
+    {
+      if(m_PendingThumbnails[i]->fileSerialiser == fileSerialiser)
+      {
+        thumb = m_PendingThumbnails[i];
+        m_PendingThumbnails.erase(m_PendingThumbnails.begin() + i);
+        break;
+      }
+    }
+  }
+
+  if(thumb == NULL)
+    return;
+
+  if(thumb->thread)
+  {
+    Threading::JoinThread(thumb->thread);
+    Threading::CloseThread(thumb->thread);
+  }
+
+  SAFE_DELETE_ARRAY(thumb->jpgbuf);
+  SAFE_DELETE_ARRAY(thumb->pixels);
+  SAFE_DELETE(thumb);
+}
+
+void RenderDoc::LogRecordMemoryUsage(IFrameCapturer *capturer)
+{
+  std::map<std::string, CaptureStats::Counter> usage;
+  capturer->GetRecordMemoryUsage(usage);
+
+  if(usage.empty())
+    return;
+
+  string report = CaptureStats::GetRecordMemoryReport(usage);
+
+  vector<string> lines;
+  split(report, lines, '\n');
+
+  for(size_t i = 0; i < lines.size(); i++)
+    if(!lines[i].empty())
+      RDCLOG("%s", lines[i].c_str());
+}
+
+string RenderDoc::FinishStatistics(Serialiser *fileSerialiser)
+{
+  CaptureStatistics stats;
+
+  {
+    SCOPED_LOCK(m_StatsLock);
+
+    if(fileSerialiser == NULL || fileSerialiser != m_Stats.fileSerialiser)
+      return "";
+
+    stats = m_Stats;
+    m_Stats = CaptureStatistics();
+  }
+
+  CaptureStats::End();
+
+  CaptureStats::Totals totals;
+  CaptureStats::GetTotals(totals);
+
+#if ENABLED(RDOC_RELEASE)
+  const bool debugSerialiser = false;
+#else
+  const bool debugSerialiser = true;
+#endif
+
+  Serialiser *chunkSerialiser = new Serialiser(NULL, Serialiser::WRITING, debugSerialiser);
+
+  fileSerialiser->ReplaceChunk(stats.chunkIndex, CaptureStats::MakeChunk(chunkSerialiser, &totals));
+
+  SAFE_DELETE(chunkSerialiser);
+
+  string report = CaptureStats::GetReport(totals, stats.chunkNames);
+
+  // log line by line, the report can be longer than a single log message allows
+  vector<string> lines;
+  split(report, lines, '\n');
+
+  for(size_t i = 0; i < lines.size(); i++)
+    if(!lines[i].empty())
+      RDCLOG("%s", lines[i].c_str());
+
+  return report;
+}
+
+void RenderDoc::WriteCapture(Serialiser *fileSerialiser, uint32_t frameNumber)
+{
+  string statistics = FinishStatistics(fileSerialiser);
+
+  if(m_Options.RetroactiveFrames == 0)
+  {
+    FinishThumbnail(fileSerialiser);
+
+    WriteCaptureFile(fileSerialiser, frameNumber, statistics);
+    return;
+  }
+
+  // the frame is held until a trigger, so it can't reference any chunks owned by records, only share
+  // their data. The thumbnail is left pending until then, see EncodeThumbnailAsync
+  fileSerialiser->TakeChunkOwnership();
+
+  PendingCaptureWrite frame = {fileSerialiser, frameNumber, statistics, false};
+
+  SCOPED_LOCK(m_RetroactiveLock);
+
+  // a frame that doesn't fit in the budget by itself is refused, rather than emptying the ring and
+  // then going over the budget anyway
+  uint64_t frameBytes = fileSerialiser->GetChunkMemorySize(true);
+
+  if(frameBytes > RetroactiveMemoryBudget)
+  {
+    if(!m_RetroactiveOverBudget)
+      RDCWARN("Frame %u needs %llu MB, over the %llu MB retroactive capture budget. Not keeping "
+              "frames until they fit again",
+              frameNumber, frameBytes / (1024 * 1024), RetroactiveMemoryBudget / (1024 * 1024));
+
+    m_RetroactiveOverBudget = true;
+
+    DiscardThumbnail(fileSerialiser);
+    SAFE_DELETE(fileSerialiser);
+    return;
+  }
+
+  m_RetroactiveOverBudget = false;
+
+  m_RetroactiveFrames.push_back(frame);
+
+  // drop the oldest frames once we're over either limit
+  while(m_RetroactiveFrames.size() > m_Options.RetroactiveFrames ||
+        GetRetroactiveMemory() > RetroactiveMemoryBudget)
+  {
+    Serialiser *oldest = m_RetroactiveFrames.front().fileSerialiser;
+
+    DiscardThumbnail(oldest);
+    SAFE_DELETE(oldest);
+
+    m_RetroactiveFrames.erase(m_RetroactiveFrames.begin());
+  }
+}
+
+uint64_t RenderDoc::GetRetroactiveMemory()
+{
+  if(m_RetroactiveFrames.empty())
+    return 0;
+
+  // frames share the data of resource creation chunks and of initial contents that didn't change
+  // between them, and nearly all of it is still referenced by the newest frame. So count that frame
+  // in full, and only what the older frames hold on their own.
+  uint64_t ret = m_RetroactiveFrames.back().fileSerialiser->GetChunkMemorySize(true);
+
+  for(size_t i = 0; i + 1 < m_RetroactiveFrames.size(); i++)
+    ret += m_RetroactiveFrames[i].fileSerialiser->GetChunkMemorySize(false);
+
+  return ret;
+}
+
+void RenderDoc::WriteRetroactiveFrames()
+{
+  vector<PendingCaptureWrite> frames;
+
+  {
+    SCOPED_LOCK(m_RetroactiveLock);
+    frames.swap(m_RetroactiveFrames);
+  }
+
+  RDCLOG("Writing %u retroactively captured frames", (uint32_t)frames.size());
+
+  // these are already in memory with their chunks owned, so rather than blocking on write slots
+  // hand them all to the background writer, which also encodes their thumbnails
+  for(size_t i = 0; i < frames.size(); i++)
+    QueueCaptureWrite(frames[i]);
+}
+
+void RenderDoc::WriteCaptureFile(Serialiser *fileSerialiser, uint32_t frameNumber,
+                                 const string &statistics)
+{
+  if(!m_Options.AsyncCaptureWrite)
+  {
+    fileSerialiser->FlushToDisk();
+
+    RegisterCapture(fileSerialiser->GetFilename(), frameNumber, statistics);
+
+    SAFE_DELETE(fileSerialiser);
+    return;
+  }
+
+  // chunks owned by resource records can be freed as soon as the application continues, so take
+  // references to their data. Only data that can still be written to is copied.
+  fileSerialiser->TakeChunkOwnership();
+
+  PendingCaptureWrite write = {fileSerialiser, frameNumber, statistics, true};
+
+  if(!m_CaptureWriteSlots.TryWait())
+  {
+    RDCLOG("Too many captures waiting to be written, blocking until one completes");
+    m_CaptureWriteSlots.Wait();
+  }
+
+  QueueCaptureWrite(write);
+}
+
+void RenderDoc::QueueCaptureWrite(const PendingCaptureWrite &write)
+{
+  SCOPED_LOCK(m_CaptureWriteLock);
+
+  m_PendingCaptureWrites.push_back(write);
+
+  if(!m_CaptureWriteThreadRunning)
+  {
+    // the previous thread has finished with the queue and is exiting, tidy it up
+    if(m_CaptureWriteThread)
+    {
+      Threading::JoinThread(m_CaptureWriteThread);
+      Threading::CloseThread(m_CaptureWriteThread);
+    }
+
+    m_CaptureWriteThreadRunning = true;
+    m_CaptureWriteThread = Threading::CreateThread(CaptureWriteThread, NULL);
+  }
+}
+
+void RenderDoc::CaptureWriteThread(void *unused)
+{
+  Threading::KeepModuleAlive();
+
+  RenderDoc &rd = RenderDoc::Inst();
+
+  for(;;)
+  {
+    PendingCaptureWrite write;
+
+    {
+      SCOPED_LOCK(rd.m_CaptureWriteLock);
+
+      if(rd.m_PendingCaptureWrites.empty())
+      {
+        rd.m_CaptureWriteThreadRunning = false;
+        break;
+      }
+
+      write = rd.m_PendingCaptureWrites.front();
+    }
+
+    // only retroactive frames still have a pending thumbnail by now
+    rd.FinishThumbnail(write.fileSerialiser);
+
+    write.fileSerialiser->FlushToDisk();
+
+    rd.RegisterCapture(write.fileSerialiser->GetFilename(), write.frameNumber, write.statistics);
+
+    SAFE_DELETE(write.fileSerialiser);
+
+    {
+      SCOPED_LOCK(rd.m_CaptureWriteLock);
+      rd.m_PendingCaptureWrites.erase(rd.m_PendingCaptureWrites.begin());
+    }
+
+    if(write.holdsWriteSlot)
+      rd.m_CaptureWriteSlots.Signal();
+  }
+
+  Threading::ReleaseModuleExitThread();
+}
+
+void RenderDoc::FlushCaptureWrites()
+{
+  Threading::ThreadHandle thread = 0;
+
+  {
+    SCOPED_LOCK(m_CaptureWriteLock);
+    thread = m_CaptureWriteThread;
+    m_CaptureWriteThread = 0;
+  }
+
+  // the thread only exits once the queue is empty
+  if(thread)
+  {
+    Threading::JoinThread(thread);
+    Threading::CloseThread(thread);
+  }
+}
+
 void RenderDoc::AddDeviceFrameCapturer(void *dev, IFrameCapturer *cap)
 {
   if(dev == NULL || cap == NULL)
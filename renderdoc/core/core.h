@@ -35,6 +35,7 @@
 #include "api/replay/renderdoc_replay.h"
 #include "common/threading.h"
 #include "common/timing.h"
+#include "core/capture_stats.h"
 #include "os/os_specific.h"
 
 using std::string;
@@ -63,6 +64,9 @@ struct IFrameCapturer
 {
   virtual void StartFrameCapture(void *dev, void *wnd) = 0;
   virtual bool EndFrameCapture(void *dev, void *wnd) = 0;
+
+  // memory used by resource records, by resource type name. Only called outside of a capture
+  virtual void GetRecordMemoryUsage(std::map<std::string, CaptureStats::Counter> &usage) {}
 };
 
 enum LogState
@@ -83,8 +87,17 @@ enum SystemChunks
   INITIAL_CONTENTS,
 
   FIRST_CHUNK_ID,
+
+  // driver chunk IDs follow on from FIRST_CHUNK_ID, so system chunks added later are allocated
+  // from the top of the 14-bit chunk ID range instead
+  CAPTURE_STATISTICS = 0x3fff,
 };
 
+inline bool IsSystemChunk(uint32_t idx)
+{
+  return idx < FIRST_CHUNK_ID || idx == CAPTURE_STATISTICS;
+}
+
 enum RDCDriver
 {
   RDC_Unknown = 0,
@@ -146,13 +159,14 @@ struct RDCInitParams
 
 struct CaptureData
 {
-  CaptureData(string p, uint64_t t, uint32_t f)
-      : path(p), timestamp(t), frameNumber(f), retrieved(false)
+  CaptureData(string p, uint64_t t, uint32_t f, string s)
+      : path(p), timestamp(t), frameNumber(f), statistics(s), retrieved(false)
   {
   }
   string path;
   uint64_t timestamp;
   uint32_t frameNumber;
+  string statistics;
   bool retrieved;
 };
 
@@ -202,14 +216,35 @@ public:
   void SetConfigSetting(string name, string value) { m_ConfigSettings[name] = value; }
   void BecomeRemoteServer(const char *listenhost, uint16_t port, volatile uint32_t &killReplay);
 
+  // how long the remote server and target control threads wait for socket activity before
+  // checking if they should exit
+  static const uint32_t ServerWakeupMS = 50;
+
   void SetCaptureOptions(const CaptureOptions &opts);
   const CaptureOptions &GetCaptureOptions() const { return m_Options; }
   void RecreateCrashHandler();
   void UnloadCrashHandler();
   ICrashHandler *GetCrashHandler() const { return m_ExHandler; }
-  Serialiser *OpenWriteSerialiser(uint32_t frameNum, RDCInitParams *params, void *thpixels,
-                                  size_t thlen, uint32_t thwidth, uint32_t thheight);
-  void SuccessfullyWrittenLog(uint32_t frameNumber);
+  // capturer is the one ending the capture, and chunkNames is used to name chunk types in the
+  // capture statistics report, if enabled
+  Serialiser *OpenWriteSerialiser(IFrameCapturer *capturer, uint32_t frameNum,
+                                  RDCInitParams *params, void *thpixels, size_t thlen,
+                                  uint32_t thwidth, uint32_t thheight,
+                                  ChunkNameCallback chunkNames = NULL);
+  // writes a finished capture to disk and registers it, taking ownership of the serialiser. With
+  // the AsyncCaptureWrite option enabled this returns once the write is queued, and the capture is
+  // registered when the background write completes.
+  void WriteCapture(Serialiser *fileSerialiser, uint32_t frameNumber);
+
+  // blocks until any captures queued for writing are on disk
+  void FlushCaptureWrites();
+
+  // JPEG-encodes a tightly packed RGB8 thumbnail on a worker thread, taking ownership of the
+  // pixels. The serialiser should have been opened without a thumbnail; the encoded one replaces
+  // it when the serialiser is passed to WriteCapture, so the encode overlaps with the driver
+  // filling in the rest of the capture. Retroactive frames defer the encode until they're written.
+  void EncodeThumbnailAsync(Serialiser *fileSerialiser, byte *thpixels, uint32_t thwidth,
+                            uint32_t thheight);
 
   void AddChildProcess(uint32_t pid, uint32_t ident)
   {
@@ -364,6 +399,82 @@ private:
   Threading::CriticalSection m_CaptureLock;
   vector<CaptureData> m_Captures;
 
+  void RegisterCapture(const string &logfile, uint32_t frameNumber, const string &statistics);
+
+  struct PendingCaptureWrite
+  {
+    Serialiser *fileSerialiser;
+    uint32_t frameNumber;
+    string statistics;
+    // false for retroactive frames, which are already in memory and so don't count against
+    // MaxPendingCaptureWrites
+    bool holdsWriteSlot;
+  };
+
+  // how many captures can be queued or in the middle of being written before WriteCapture blocks
+  static const uint32_t MaxPendingCaptureWrites = 2;
+
+  // pending writes stay in the list until they're complete, so its size bounds the memory held.
+  // The semaphore counts the free slots in the list.
+  Threading::CriticalSection m_CaptureWriteLock;
+  Threading::Semaphore m_CaptureWriteSlots;
+  vector<PendingCaptureWrite> m_PendingCaptureWrites;
+  Threading::ThreadHandle m_CaptureWriteThread;
+  bool m_CaptureWriteThreadRunning;
+
+  static void CaptureWriteThread(void *unused);
+
+  void WriteCaptureFile(Serialiser *fileSerialiser, uint32_t frameNumber, const string &statistics);
+  void QueueCaptureWrite(const PendingCaptureWrite &write);
+
+  // with RetroactiveFrames set, every frame is captured into this ring (oldest first) and only
+  // written out when a capture is triggered. Their thumbnails aren't encoded until then, so frames
+  // that fall out of the ring never pay for it.
+  Threading::CriticalSection m_RetroactiveLock;
+  vector<PendingCaptureWrite> m_RetroactiveFrames;
+  // set while frames are refused for being over the memory budget, so it's only reported once
+  bool m_RetroactiveOverBudget;
+
+  // approximate memory held by the ring, must be called with m_RetroactiveLock held
+  uint64_t GetRetroactiveMemory();
+  void WriteRetroactiveFrames();
+
+  struct PendingThumbnail
+  {
+    Serialiser *fileSerialiser;
+    byte *pixels;
+    uint32_t width, height;
+    byte *jpgbuf;
+    int jpglen;
+    Threading::ThreadHandle thread;
+  };
+
+  Threading::CriticalSection m_ThumbnailLock;
+  vector<PendingThumbnail *> m_PendingThumbnails;
+
+  static void ThumbnailEncodeThread(void *data);
+  void FinishThumbnail(Serialiser *fileSerialiser);
+  void DiscardThumbnail(Serialiser *fileSerialiser);
+
+  // statistics for the one capture that's collecting them. The counters are process-wide, so a
+  // capture that overlaps it on another capturer doesn't get any rather than mixing the two
+  struct CaptureStatistics
+  {
+    CaptureStatistics() : capturer(NULL), fileSerialiser(NULL), chunkIndex(0), chunkNames(NULL) {}
+    IFrameCapturer *capturer;
+
+    // the serialiser with a placeholder chunk to fill in, see OpenWriteSerialiser
+    Serialiser *fileSerialiser;
+    size_t chunkIndex;
+    ChunkNameCallback chunkNames;
+  };
+
+  Threading::CriticalSection m_StatsLock;
+  CaptureStatistics m_Stats;
+
+  string FinishStatistics(Serialiser *fileSerialiser);
+  void LogRecordMemoryUsage(IFrameCapturer *capturer);
+
   Threading::CriticalSection m_ChildLock;
   vector<pair<uint32_t, uint32_t> > m_Children;
 
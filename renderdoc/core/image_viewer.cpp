@@ -110,6 +110,7 @@ public:
     return m_Proxy->GetHistogram(m_TextureID, sliceFace, mip, sample, typeHint, minval, maxval,
                                  channels, histogram);
   }
+  ReplayCache *GetReplayCache() { return NULL; }
   bool RenderTexture(TextureDisplay cfg)
   {
     cfg.texid = m_TextureID;
@@ -184,6 +185,10 @@ public:
   {
   }
   void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, vector<byte> &retData) {}
+  uint64_t GetBufferDataInto(ResourceId buff, uint64_t offset, uint64_t len, byte *dest)
+  {
+    return 0;
+  }
   void InitPostVSBuffers(uint32_t eventID) {}
   void InitPostVSBuffers(const vector<uint32_t> &eventID) {}
   MeshFormat GetPostVSBuffers(uint32_t eventID, uint32_t instID, MeshDataStage stage)
@@ -82,7 +82,9 @@ void Serialiser::Serialise(const char *name, EnvironmentModification &el)
   Serialise("value", el.value);
 }
 
-static const uint32_t RemoteServerProtocolVersion = 1;
+// version 3 added LZ4 compression of large packet payloads
+// version 4 added bulk buffer/texture description queries to the replay proxy
+static const uint32_t RemoteServerProtocolVersion = 4;
 
 enum RemoteServerPacket
 {
@@ -228,6 +230,9 @@ static void ActiveRemoteClientThread(void *data)
   {
     // handshake and continue
     SendPacket(threadData->socket, eRemoteServer_Handshake);
+
+    // any client speaking our protocol version can accept compressed packets
+    client->SetPacketCompression(true);
   }
 
   vector<string> tempFiles;
@@ -247,9 +252,8 @@ static void ActiveRemoteClientThread(void *data)
     RemoteServerPacket sendType = eRemoteServer_Noop;
     sendSer.Rewind();
 
-    Threading::Sleep(4);
-
-    if(client->IsRecvDataWaiting())
+    // wake up as soon as a command arrives, but regularly enough to notice being killed
+    if(client->WaitForRecvData(RenderDoc::ServerWakeupMS) && client->IsRecvDataWaiting())
     {
       type = eRemoteServer_Noop;
       Serialiser *recvser = NULL;
@@ -627,7 +631,7 @@ void RenderDoc::BecomeRemoteServer(const char *listenhost, uint16_t port, volati
         return;
       }
 
-      Threading::Sleep(5);
+      sock->WaitForRecvData(ServerWakeupMS);
 
       continue;
     }
@@ -1266,6 +1270,8 @@ RENDERDOC_CreateRemoteServerConnection(const char *host, uint32_t port, IRemoteS
     return ReplayStatus::NetworkIOFailed;
   }
 
+  sock->SetPacketCompression(true);
+
   *rend = new RemoteServer(sock, host);
 
   return ReplayStatus::Succeeded;
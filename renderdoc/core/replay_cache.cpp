@@ -0,0 +1,320 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#include "replay_cache.h"
+#include <algorithm>
+#include "api/replay/version.h"
+#include "os/os_specific.h"
+#include "serialise/string_utils.h"
+
+static const uint32_t ReplayCacheMagic = MAKE_FOURCC('R', 'D', 'R', 'C');
+// bump this whenever the layout of the file or of any data stored in it changes
+static const uint32_t ReplayCacheVersion = 2;
+
+// cache files that haven't been written in this long are deleted, as are the least recently
+// written ones once the total across all captures is over the size limit
+static const uint64_t ReplayCacheMaxAge = 30 * 24 * 60 * 60;
+static const uint64_t ReplayCacheMaxTotalSize = 256 * 1024 * 1024;
+
+static const char ReplayCachePrefix[] = "replaycache_";
+
+// how much of the start and end of the capture to hash to identify it. Hashing the whole file
+// would cost as much as a second load, and captures differ in their headers and frame data.
+static const uint64_t CaptureKeySampleSize = 1024 * 1024;
+
+static uint64_t CalcCaptureKey(const char *logfile)
+{
+  FILE *f = FileIO::fopen(logfile, "rb");
+
+  if(!f)
+    return 0;
+
+  FileIO::fseek64(f, 0, SEEK_END);
+  uint64_t len = FileIO::ftell64(f);
+  FileIO::fseek64(f, 0, SEEK_SET);
+
+  uint64_t sampleSize = RDCMIN(len, CaptureKeySampleSize);
+
+  std::vector<byte> sample((size_t)sampleSize);
+
+  uint64_t key = Hash64(&len, sizeof(len));
+
+  if(sampleSize > 0)
+  {
+    FileIO::fread(&sample[0], 1, sample.size(), f);
+    key = Hash64(&sample[0], sample.size(), key);
+
+    FileIO::fseek64(f, len - sampleSize, SEEK_SET);
+    FileIO::fread(&sample[0], 1, sample.size(), f);
+    key = Hash64(&sample[0], sample.size(), key);
+  }
+
+  FileIO::fclose(f);
+
+  // 0 is reserved for 'no capture'
+  return key ? key : 1;
+}
+
+// builds without a commit hash all share the same placeholder, so the version and serialise
+// version are mixed in as well to at least separate releases and incompatible serialisation.
+static uint64_t BuildKey()
+{
+  const char *version = RENDERDOC_VERSION_STRING;
+  const char *hash = GIT_COMMIT_HASH;
+  uint64_t serialiseVersion = Serialiser::SERIALISE_VERSION;
+
+  uint64_t key = Hash64(&ReplayCacheVersion, sizeof(ReplayCacheVersion));
+  key = Hash64(&serialiseVersion, sizeof(serialiseVersion), key);
+  key = Hash64(version, strlen(version), key);
+  key = Hash64(hash, strlen(hash), key);
+  return key;
+}
+
+static void PruneCacheFiles(const std::string &keep)
+{
+  std::string folder = FileIO::GetAppFolderFilename("");
+
+  std::vector<PathEntry> files = FileIO::GetFilesInDirectory(folder.c_str());
+
+  uint64_t now = Timing::GetUnixTimestamp();
+  uint64_t totalSize = 0;
+
+  std::vector<std::pair<uint32_t, PathEntry> > caches;
+
+  for(const PathEntry &f : files)
+  {
+    std::string name = f.filename.c_str();
+
+    if(f.flags & (PathProperty::Directory | PathProperty::ErrorUnknown |
+                  PathProperty::ErrorAccessDenied | PathProperty::ErrorInvalidPath))
+      continue;
+
+    if(name.compare(0, sizeof(ReplayCachePrefix) - 1, ReplayCachePrefix) != 0)
+      continue;
+
+    std::string path = folder + name;
+
+    if(path == keep)
+      continue;
+
+    if(f.lastmod + ReplayCacheMaxAge < now)
+    {
+      RDCDEBUG("Deleting stale replay cache %s", path.c_str());
+      FileIO::Delete(path.c_str());
+      continue;
+    }
+
+    totalSize += f.size;
+    caches.push_back(std::make_pair(f.lastmod, f));
+  }
+
+  if(totalSize <= ReplayCacheMaxTotalSize)
+    return;
+
+  std::sort(caches.begin(), caches.end(),
+            [](const std::pair<uint32_t, PathEntry> &a, const std::pair<uint32_t, PathEntry> &b) {
+              return a.first < b.first;
+            });
+
+  for(size_t i = 0; i < caches.size() && totalSize > ReplayCacheMaxTotalSize; i++)
+  {
+    std::string path = folder + caches[i].second.filename.c_str();
+
+    RDCDEBUG("Deleting replay cache %s to stay under the size limit", path.c_str());
+    FileIO::Delete(path.c_str());
+
+    totalSize -= caches[i].second.size;
+  }
+}
+
+ReplayCache::~ReplayCache()
+{
+  Save();
+  Unmap();
+}
+
+void ReplayCache::Open(const char *logfile)
+{
+  Unmap();
+  m_Added.clear();
+
+  m_CaptureKey = logfile ? CalcCaptureKey(logfile) : 0;
+
+  if(m_CaptureKey == 0)
+    return;
+
+  m_Filename = FileIO::GetAppFolderFilename(
+      StringFormat::Fmt("%s%016llx.bin", ReplayCachePrefix, m_CaptureKey));
+
+  Map();
+
+  if(m_File)
+    RDCDEBUG("Loaded %llu entries from replay cache %s", NumEntries(), m_Filename.c_str());
+}
+
+void ReplayCache::Map()
+{
+  m_File = (const byte *)FileIO::MapFile(m_Filename.c_str(), m_FileSize);
+
+  if(m_File && !Validate())
+  {
+    RDCDEBUG("Ignoring out of date or invalid replay cache %s", m_Filename.c_str());
+    Unmap();
+  }
+}
+
+void ReplayCache::Unmap()
+{
+  FileIO::UnmapFile(m_File, m_FileSize);
+  m_File = NULL;
+  m_FileSize = 0;
+}
+
+bool ReplayCache::Validate() const
+{
+  if(m_FileSize < sizeof(Header))
+    return false;
+
+  const Header *header = (const Header *)m_File;
+
+  if(header->magic != ReplayCacheMagic || header->version != ReplayCacheVersion ||
+     header->captureKey != m_CaptureKey || header->buildKey != BuildKey())
+    return false;
+
+  if(header->numEntries > (m_FileSize - sizeof(Header)) / sizeof(IndexEntry))
+    return false;
+
+  const IndexEntry *index = Index();
+
+  for(uint64_t i = 0; i < header->numEntries; i++)
+  {
+    if(index[i].offset > m_FileSize || index[i].size > m_FileSize - index[i].offset)
+      return false;
+
+    if(i > 0 && index[i].key <= index[i - 1].key)
+      return false;
+  }
+
+  return true;
+}
+
+bool ReplayCache::Find(uint64_t key, const byte *&data, uint64_t &size) const
+{
+  auto it = m_Added.find(key);
+  if(it != m_Added.end())
+  {
+    data = it->second.data();
+    size = it->second.size();
+    return true;
+  }
+
+  const IndexEntry *begin = Index();
+  const IndexEntry *end = begin + NumEntries();
+
+  const IndexEntry *entry = std::lower_bound(
+      begin, end, key, [](const IndexEntry &e, uint64_t k) { return e.key < k; });
+
+  if(entry == end || entry->key != key)
+    return false;
+
+  data = m_File + entry->offset;
+  size = entry->size;
+  return true;
+}
+
+void ReplayCache::Add(uint64_t key, const byte *data, uint64_t size)
+{
+  if(!IsOpen())
+    return;
+
+  m_Added[key] = std::vector<byte>(data, data + size);
+}
+
+void ReplayCache::Save()
+{
+  if(!IsOpen() || m_Added.empty())
+    return;
+
+  // merge the loaded entries with the new ones, so the index stays sorted
+  std::map<uint64_t, std::pair<const byte *, uint64_t> > entries;
+
+  const IndexEntry *index = Index();
+  for(uint64_t i = 0; i < NumEntries(); i++)
+    entries[index[i].key] = std::make_pair(m_File + index[i].offset, index[i].size);
+
+  for(auto it = m_Added.begin(); it != m_Added.end(); ++it)
+    entries[it->first] = std::make_pair(it->second.data(), (uint64_t)it->second.size());
+
+  Header header;
+  header.magic = ReplayCacheMagic;
+  header.version = ReplayCacheVersion;
+  header.captureKey = m_CaptureKey;
+  header.buildKey = BuildKey();
+  header.numEntries = entries.size();
+
+  std::vector<IndexEntry> newIndex;
+  newIndex.reserve(entries.size());
+
+  uint64_t offset = sizeof(Header) + sizeof(IndexEntry) * entries.size();
+
+  for(auto it = entries.begin(); it != entries.end(); ++it)
+  {
+    IndexEntry e = {it->first, offset, it->second.second};
+    newIndex.push_back(e);
+
+    offset = AlignUp(offset + e.size, (uint64_t)8);
+  }
+
+  std::vector<byte> file((size_t)offset, 0);
+
+  memcpy(&file[0], &header, sizeof(header));
+  if(!newIndex.empty())
+    memcpy(&file[sizeof(Header)], &newIndex[0], sizeof(IndexEntry) * newIndex.size());
+
+  size_t i = 0;
+  for(auto it = entries.begin(); it != entries.end(); ++it, ++i)
+    if(it->second.second > 0)
+      memcpy(&file[(size_t)newIndex[i].offset], it->second.first, (size_t)it->second.second);
+
+  // the old file has to be unmapped before it can be overwritten, and is mapped again after -
+  // either the new file, or the old one still if writing failed
+  Unmap();
+
+  bool written = FileIO::dump(m_Filename.c_str(), file.data(), file.size());
+
+  Map();
+
+  if(!written)
+  {
+    RDCWARN("Couldn't write replay cache %s", m_Filename.c_str());
+    return;
+  }
+
+  RDCDEBUG("Wrote %llu entries to replay cache %s", header.numEntries, m_Filename.c_str());
+
+  m_Added.clear();
+
+  PruneCacheFiles(m_Filename);
+}
@@ -0,0 +1,109 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "common/common.h"
+#include "serialise/serialiser.h"
+
+// A per-capture cache of data that replay derives from a capture, such as shader reflection and
+// texture min/max values, so that opening the same capture again can reuse the results instead of
+// recomputing them.
+//
+// The cache is a file in the app folder named after a hash of the capture's size and contents,
+// and it's only used if its header matches that capture and this build. Entries are opaque blobs
+// keyed by a 64-bit hash of whatever inputs they were derived from. The file is a flat header,
+// a sorted index and then the blobs at 8-byte aligned offsets, so it's memory mapped and entries
+// are returned in place without any parsing or copying.
+//
+// The cache isn't thread-safe, it's only used from the replay thread.
+class ReplayCache
+{
+public:
+  ~ReplayCache();
+
+  // identifies the capture and maps its cache file, if a valid one exists
+  void Open(const char *logfile);
+
+  // writes the cache file back out if any entries have been added since it was opened. This is
+  // done once loading is finished, and again when the cache is destroyed for anything derived
+  // after that.
+  void Save();
+
+  bool IsOpen() const { return m_CaptureKey != 0; }
+  // returns a pointer to the cached blob, valid until the cache is closed or saved
+  bool Find(uint64_t key, const byte *&data, uint64_t &size) const;
+  void Add(uint64_t key, const byte *data, uint64_t size);
+
+private:
+  struct Header
+  {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t captureKey;
+    uint64_t buildKey;
+    uint64_t numEntries;
+  };
+
+  struct IndexEntry
+  {
+    uint64_t key;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  void Map();
+  void Unmap();
+  bool Validate() const;
+  const IndexEntry *Index() const
+  {
+    return m_File ? (const IndexEntry *)(m_File + sizeof(Header)) : NULL;
+  }
+  uint64_t NumEntries() const { return m_File ? ((const Header *)m_File)->numEntries : 0; }
+
+  std::string m_Filename;
+  uint64_t m_CaptureKey = 0;
+
+  // the cache file as mapped, if it's valid
+  const byte *m_File = NULL;
+  uint64_t m_FileSize = 0;
+
+  // entries added since loading, to be written on Save()
+  std::map<uint64_t, std::vector<byte> > m_Added;
+};
+
+struct ShaderReflection;
+struct ShaderBindpointMapping;
+
+// defined alongside the rest of the replay data serialisation in replay_proxy.cpp, so that derived
+// reflection data can be stored in the cache in the same form it's sent over the network.
+template <>
+void Serialiser::Serialise(const char *name, ShaderReflection &el);
+template <>
+void Serialiser::Serialise(const char *name, ShaderBindpointMapping &el);
@@ -2089,18 +2089,69 @@ void ReplayProxy::EnsureTexCached(ResourceId texid, uint32_t arrayIdx, uint32_t
 
     const ProxyTextureProperties &proxy = m_ProxyTextures[texid];
 
-    size_t size;
-    byte *data = GetTextureData(texid, arrayIdx, mip, proxy.params, size);
+    // only re-upload if the contents differ from what the proxy texture already holds
+    TextureProxyData &cached = m_TextureProxyData[entry];
+    vector<byte> &data = cached.data;
 
-    if(data)
-      m_Proxy->SetProxyTextureData(proxy.id, arrayIdx, mip, data, size);
+    m_TextureProxyDataBytes -= data.size();
 
-    delete[] data;
+    if(TransferTextureData(texid, arrayIdx, mip, proxy.params, data) && !data.empty())
+      m_Proxy->SetProxyTextureData(proxy.id, arrayIdx, mip, &data[0], data.size());
+
+    m_TextureProxyDataBytes += data.size();
+    cached.lastUse = ++m_TextureProxyUses;
 
     m_TextureProxyCache.insert(entry);
+
+    TrimTextureProxyData(entry);
   }
 }
 
+void ReplayProxy::TrimTextureProxyData(const TextureCacheEntry &keep)
+{
+  while(m_TextureProxyDataBytes > MaxTextureProxyDataBytes)
+  {
+    auto lru = m_TextureProxyData.end();
+
+    for(auto it = m_TextureProxyData.begin(); it != m_TextureProxyData.end(); ++it)
+    {
+      // never drop the subresource that was just transferred, even if it alone is over budget
+      if(!(it->first < keep) && !(keep < it->first))
+        continue;
+
+      if(lru == m_TextureProxyData.end() || it->second.lastUse < lru->second.lastUse)
+        lru = it;
+    }
+
+    if(lru == m_TextureProxyData.end())
+      break;
+
+    // the next transfer of this subresource will just send all of it
+    m_TextureProxyDataBytes -= lru->second.data.size();
+    m_TextureProxyData.erase(lru);
+  }
+}
+
+void ReplayProxy::ResetTextureProxyData()
+{
+  // anything not used since the previous reset is unlikely to be displayed again soon, so don't
+  // hold onto its contents any longer
+  for(auto it = m_TextureProxyData.begin(); it != m_TextureProxyData.end();)
+  {
+    if(it->second.lastUse <= m_TextureProxyLastReset)
+    {
+      m_TextureProxyDataBytes -= it->second.data.size();
+      it = m_TextureProxyData.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  m_TextureProxyLastReset = m_TextureProxyUses;
+}
+
 void ReplayProxy::EnsureBufCached(ResourceId bufid)
 {
   if(!m_Socket->Connected())
@@ -2147,6 +2198,8 @@ bool ReplayProxy::Tick(int type, Serialiser *incomingPacket)
     case eReplayProxy_GetTexture: GetTexture(ResourceId()); break;
     case eReplayProxy_GetBuffers: GetBuffers(); break;
     case eReplayProxy_GetBuffer: GetBuffer(ResourceId()); break;
+    case eReplayProxy_GetTextureDescriptions: GetTextureDescriptions(); break;
+    case eReplayProxy_GetBufferDescriptions: GetBufferDescriptions(); break;
     case eReplayProxy_GetShader: GetShader(ResourceId(), ""); break;
     case eReplayProxy_GetDebugMessages: GetDebugMessages(); break;
     case eReplayProxy_SavePipelineState: SavePipelineState(); break;
@@ -2187,8 +2240,8 @@ bool ReplayProxy::Tick(int type, Serialiser *incomingPacket)
     }
     case eReplayProxy_GetTextureData:
     {
-      size_t dummy;
-      GetTextureData(ResourceId(), 0, 0, GetTextureDataParams(), dummy);
+      vector<byte> dummy;
+      TransferTextureData(ResourceId(), 0, 0, GetTextureDataParams(), dummy);
       break;
     }
     case eReplayProxy_InitPostVS: InitPostVSBuffers(0); break;
@@ -2373,6 +2426,44 @@ BufferDescription ReplayProxy::GetBuffer(ResourceId id)
   return ret;
 }
 
+vector<TextureDescription> ReplayProxy::GetTextureDescriptions()
+{
+  vector<TextureDescription> ret;
+
+  if(m_RemoteServer)
+  {
+    ret = m_Remote->GetTextureDescriptions();
+  }
+  else
+  {
+    if(!SendReplayCommand(eReplayProxy_GetTextureDescriptions))
+      return ret;
+  }
+
+  m_FromReplaySerialiser->Serialise("", ret);
+
+  return ret;
+}
+
+vector<BufferDescription> ReplayProxy::GetBufferDescriptions()
+{
+  vector<BufferDescription> ret;
+
+  if(m_RemoteServer)
+  {
+    ret = m_Remote->GetBufferDescriptions();
+  }
+  else
+  {
+    if(!SendReplayCommand(eReplayProxy_GetBufferDescriptions))
+      return ret;
+  }
+
+  m_FromReplaySerialiser->Serialise("", ret);
+
+  return ret;
+}
+
 void ReplayProxy::SavePipelineState()
 {
   if(m_RemoteServer)
@@ -2415,6 +2506,7 @@ void ReplayProxy::ReplayLog(uint32_t endEventID, ReplayLogType replayType)
       return;
 
     m_TextureProxyCache.clear();
+    ResetTextureProxyData();
     m_BufferProxyCache.clear();
   }
 }
@@ -2649,11 +2741,75 @@ void ReplayProxy::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len,
   }
 }
 
+uint64_t ReplayProxy::GetBufferDataInto(ResourceId buff, uint64_t offset, uint64_t len, byte *dest)
+{
+  if(m_RemoteServer)
+  {
+    vector<byte> retData;
+    GetBufferData(buff, offset, len, retData);
+
+    uint64_t written = RDCMIN(len, (uint64_t)retData.size());
+    if(written > 0)
+      memcpy(dest, &retData[0], (size_t)written);
+    return written;
+  }
+
+  // same command as GetBufferData, but the data is copied straight out of the serialiser
+  m_ToReplaySerialiser->Serialise("", buff);
+  m_ToReplaySerialiser->Serialise("", offset);
+  m_ToReplaySerialiser->Serialise("", len);
+
+  if(!SendReplayCommand(eReplayProxy_GetBufferData))
+    return 0;
+
+  uint64_t sz = 0;
+  m_FromReplaySerialiser->Serialise("", sz);
+
+  byte *data = m_FromReplaySerialiser->RawReadBytes((size_t)sz);
+
+  uint64_t written = RDCMIN(len, sz);
+  if(written > 0)
+    memcpy(dest, data, (size_t)written);
+
+  return written;
+}
+
+// texture data is compared and transferred in blocks of this size, so that only the parts of a
+// subresource that have changed since the last transfer need to be sent again.
+static const size_t TextureDeltaBlockSize = 64 * 1024;
+
 byte *ReplayProxy::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
-                                  const GetTextureDataParams &_params, size_t &dataSize)
+                                  const GetTextureDataParams &params, size_t &dataSize)
+{
+  vector<byte> data;
+  TransferTextureData(tex, arrayIdx, mip, params, data);
+
+  dataSize = data.size();
+
+  if(data.empty())
+    return NULL;
+
+  byte *ret = new byte[dataSize];
+  memcpy(ret, &data[0], dataSize);
+  return ret;
+}
+
+// On the local side, data contains the contents from the last transfer of this subresource (or
+// is empty) and is updated in place. Returns true if the contents changed.
+bool ReplayProxy::TransferTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
+                                      const GetTextureDataParams &_params, vector<byte> &data)
 {
   GetTextureDataParams params = _params;    // Serialiser is non-const
 
+  // hash each block of the data we already have, so the remote side only sends what differs
+  vector<uint64_t> blockHashes;
+  if(!m_RemoteServer)
+  {
+    for(size_t offs = 0; offs < data.size(); offs += TextureDeltaBlockSize)
+      blockHashes.push_back(
+          Hash64(&data[offs], RDCMIN(TextureDeltaBlockSize, data.size() - offs)));
+  }
+
   m_ToReplaySerialiser->Serialise("", tex);
   m_ToReplaySerialiser->Serialise("", arrayIdx);
   m_ToReplaySerialiser->Serialise("", mip);
@@ -2663,56 +2819,134 @@ byte *ReplayProxy::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mi
   m_ToReplaySerialiser->Serialise("", params.remap);
   m_ToReplaySerialiser->Serialise("", params.blackPoint);
   m_ToReplaySerialiser->Serialise("", params.whitePoint);
+  m_ToReplaySerialiser->Serialise("", blockHashes);
 
   if(m_RemoteServer)
   {
-    byte *data = m_Remote->GetTextureData(tex, arrayIdx, mip, params, dataSize);
+    size_t dataSize = 0;
+    byte *remoteData = m_Remote->GetTextureData(tex, arrayIdx, mip, params, dataSize);
 
-    byte *compressed = new byte[LZ4_COMPRESSBOUND(dataSize)];
+    if(remoteData == NULL)
+      dataSize = 0;
 
     uint32_t uncompressedSize = (uint32_t)dataSize;
-    uint32_t compressedSize =
-        (uint32_t)LZ4_compress((const char *)data, (char *)compressed, (int)uncompressedSize);
+
+    size_t numBlocks = (dataSize + TextureDeltaBlockSize - 1) / TextureDeltaBlockSize;
+
+    // if the size changed, every block needs to be sent
+    bool allChanged = blockHashes.size() != numBlocks;
+
+    vector<uint32_t> changedBlocks;
+    size_t changedBytes = 0;
+
+    for(size_t b = 0; b < numBlocks; b++)
+    {
+      size_t offs = b * TextureDeltaBlockSize;
+      size_t len = RDCMIN(TextureDeltaBlockSize, dataSize - offs);
+
+      if(allChanged || Hash64(remoteData + offs, len) != blockHashes[b])
+      {
+        changedBlocks.push_back((uint32_t)b);
+        changedBytes += len;
+      }
+    }
+
+    // pack the changed blocks together, unless it's all of them
+    byte *packed = remoteData;
+    if(changedBytes > 0 && changedBytes < dataSize)
+    {
+      packed = new byte[changedBytes];
+
+      size_t dst = 0;
+      for(uint32_t b : changedBlocks)
+      {
+        size_t offs = b * TextureDeltaBlockSize;
+        size_t len = RDCMIN(TextureDeltaBlockSize, dataSize - offs);
+        memcpy(packed + dst, remoteData + offs, len);
+        dst += len;
+      }
+    }
+
+    uint32_t compressedSize = 0;
+    byte *compressed = NULL;
+
+    if(changedBytes > 0)
+    {
+      compressed = new byte[LZ4_COMPRESSBOUND(changedBytes)];
+      compressedSize =
+          (uint32_t)LZ4_compress((const char *)packed, (char *)compressed, (int)changedBytes);
+    }
 
     m_FromReplaySerialiser->Serialise("", uncompressedSize);
+    m_FromReplaySerialiser->Serialise("", changedBlocks);
     m_FromReplaySerialiser->Serialise("", compressedSize);
-    m_FromReplaySerialiser->RawWriteBytes(compressed, (size_t)compressedSize);
+    if(compressedSize > 0)
+      m_FromReplaySerialiser->RawWriteBytes(compressed, (size_t)compressedSize);
 
-    delete[] data;
+    if(packed != remoteData)
+      delete[] packed;
+    delete[] remoteData;
     delete[] compressed;
+
+    return !changedBlocks.empty();
   }
   else
   {
     if(!SendReplayCommand(eReplayProxy_GetTextureData))
     {
-      dataSize = 0;
-      return NULL;
+      data.clear();
+      return true;
     }
 
     uint32_t uncompressedSize = 0;
+    vector<uint32_t> changedBlocks;
     uint32_t compressedSize = 0;
 
     m_FromReplaySerialiser->Serialise("", uncompressedSize);
+    m_FromReplaySerialiser->Serialise("", changedBlocks);
     m_FromReplaySerialiser->Serialise("", compressedSize);
 
-    if(uncompressedSize == 0 || compressedSize == 0)
+    if(uncompressedSize == 0)
     {
-      dataSize = 0;
-      return NULL;
+      bool changed = !data.empty();
+      data.clear();
+      return changed;
     }
 
-    dataSize = (size_t)uncompressedSize;
-
-    byte *ret = new byte[dataSize + 512];
+    // nothing changed since the last transfer, our copy is current
+    if(changedBlocks.empty() || compressedSize == 0)
+      return false;
 
     byte *compressed = (byte *)m_FromReplaySerialiser->RawReadBytes((size_t)compressedSize);
 
-    LZ4_decompress_fast((const char *)compressed, (char *)ret, (int)dataSize);
+    data.resize((size_t)uncompressedSize);
 
-    return ret;
-  }
+    size_t changedBytes = 0;
+    for(uint32_t b : changedBlocks)
+      changedBytes += RDCMIN(TextureDeltaBlockSize, data.size() - b * TextureDeltaBlockSize);
 
-  return NULL;
+    if(changedBytes == data.size())
+    {
+      LZ4_decompress_fast((const char *)compressed, (char *)&data[0], (int)changedBytes);
+    }
+    else
+    {
+      // scatter the changed blocks back into place
+      vector<byte> packed(changedBytes);
+      LZ4_decompress_fast((const char *)compressed, (char *)&packed[0], (int)changedBytes);
+
+      size_t src = 0;
+      for(uint32_t b : changedBlocks)
+      {
+        size_t offs = b * TextureDeltaBlockSize;
+        size_t len = RDCMIN(TextureDeltaBlockSize, data.size() - offs);
+        memcpy(&data[offs], &packed[src], len);
+        src += len;
+      }
+    }
+
+    return true;
+  }
 }
 
 void ReplayProxy::InitPostVSBuffers(uint32_t eventID)
@@ -44,6 +44,8 @@ enum ReplayProxyPacket
   eReplayProxy_GetTexture,
   eReplayProxy_GetBuffers,
   eReplayProxy_GetBuffer,
+  eReplayProxy_GetTextureDescriptions,
+  eReplayProxy_GetBufferDescriptions,
   eReplayProxy_GetShader,
   eReplayProxy_GetDebugMessages,
 
@@ -103,6 +105,10 @@ public:
     m_ToReplaySerialiser = new Serialiser(NULL, Serialiser::WRITING, false);
     m_RemoteHasResolver = false;
 
+    m_TextureProxyDataBytes = 0;
+    m_TextureProxyUses = 0;
+    m_TextureProxyLastReset = 0;
+
     GetAPIProperties();
   }
 
@@ -113,6 +119,10 @@ public:
     m_FromReplaySerialiser = new Serialiser(NULL, Serialiser::WRITING, false);
     m_RemoteHasResolver = false;
 
+    m_TextureProxyDataBytes = 0;
+    m_TextureProxyUses = 0;
+    m_TextureProxyLastReset = 0;
+
     RDCEraseEl(m_APIProps);
   }
 
@@ -219,6 +229,9 @@ public:
     return false;
   }
 
+  // the capture is on the remote side, so there's no local cache of it
+  ReplayCache *GetReplayCache() { return NULL; }
+
   bool RenderTexture(TextureDisplay cfg)
   {
     if(m_Proxy)
@@ -392,6 +405,9 @@ public:
   vector<ResourceId> GetTextures();
   TextureDescription GetTexture(ResourceId id);
 
+  vector<BufferDescription> GetBufferDescriptions();
+  vector<TextureDescription> GetTextureDescriptions();
+
   APIProperties GetAPIProperties();
 
   vector<DebugMessage> GetDebugMessages();
@@ -420,6 +436,7 @@ public:
                             vector<ShaderVariable> &outvars, const vector<byte> &data);
 
   void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, vector<byte> &retData);
+  uint64_t GetBufferDataInto(ResourceId buff, uint64_t offset, uint64_t len, byte *dest);
   byte *GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
                        const GetTextureDataParams &params, size_t &dataSize);
 
@@ -483,6 +500,9 @@ public:
 private:
   bool SendReplayCommand(ReplayProxyPacket type);
 
+  bool TransferTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
+                           const GetTextureDataParams &params, vector<byte> &data);
+
   void EnsureTexCached(ResourceId texid, uint32_t arrayIdx, uint32_t mip);
   void RemapProxyTextureIfNeeded(ResourceFormat &format, GetTextureDataParams &params);
   void EnsureBufCached(ResourceId bufid);
@@ -503,6 +523,25 @@ private:
     }
   };
   set<TextureCacheEntry> m_TextureProxyCache;
+
+  // the last contents uploaded for each subresource. These persist when the cache above is
+  // invalidated so that only blocks which have changed need to be transferred again, but only
+  // for subresources that were used since the previous invalidation, and only up to a total of
+  // MaxTextureProxyDataBytes after which the least recently used are dropped.
+  struct TextureProxyData
+  {
+    vector<byte> data;
+    uint64_t lastUse;
+  };
+  map<TextureCacheEntry, TextureProxyData> m_TextureProxyData;
+  uint64_t m_TextureProxyDataBytes;
+  uint64_t m_TextureProxyUses;
+  uint64_t m_TextureProxyLastReset;
+
+  static const uint64_t MaxTextureProxyDataBytes = 256 * 1024 * 1024;
+
+  void TrimTextureProxyData(const TextureCacheEntry &keep);
+  void ResetTextureProxyData();
   set<ResourceId> m_LocalTextures;
 
   struct ProxyTextureProperties
@@ -25,6 +25,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <map>
 #include <set>
 #include "api/replay/renderdoc_replay.h"
@@ -83,6 +84,10 @@ public:
 // This is used to track the necessary resources for a frame, and include only those required
 // for the captured frame in its log. It also handles anything resource-specific such as
 // shadow CPU copies of data.
+//
+// There can be millions of records alive in a long-running application, so the per-record
+// storage is kept flat: parents and chunks are stored in vectors rather than node-based containers.
+// Most records never need a chunk lock, so it's only allocated for those that do.
 struct ResourceRecord
 {
   ResourceRecord(ResourceId id, bool lock)
@@ -103,12 +108,14 @@ struct ResourceRecord
   }
 
   ~ResourceRecord() { SAFE_DELETE(m_ChunkLock); }
+
   void AddParent(ResourceRecord *r)
   {
-    if(Parents.find(r) == Parents.end())
+    // records only have a handful of parents, so a linear search is cheapest
+    if(std::find(Parents.begin(), Parents.end(), r) == Parents.end())
     {
       r->AddRef();
-      Parents.insert(r);
+      Parents.push_back(r);
     }
   }
 
@@ -133,7 +140,7 @@ struct ResourceRecord
   }
 
   void MarkDataUnwritten() { DataWritten = false; }
-  void Insert(map<int32_t, Chunk *> &recordlist)
+  void Insert(ChunkList &recordlist)
   {
     bool dataWritten = DataWritten;
 
@@ -148,7 +155,7 @@ struct ResourceRecord
     }
 
     if(!dataWritten)
-      recordlist.insert(m_Chunks.begin(), m_Chunks.end());
+      recordlist.insert(recordlist.end(), m_Chunks.begin(), m_Chunks.end());
   }
 
   void AddRef() { Atomic::Inc32(&RefCount); }
@@ -175,7 +182,22 @@ struct ResourceRecord
     LockChunks();
     if(ID == 0)
       ID = GetID();
-    m_Chunks[ID] = chunk;
+
+    // IDs are nearly always increasing, so this is almost always an append
+    if(m_Chunks.empty() || m_Chunks.back().first < ID)
+    {
+      m_Chunks.push_back(std::make_pair(ID, chunk));
+    }
+    else
+    {
+      auto it =
+          std::lower_bound(m_Chunks.begin(), m_Chunks.end(), std::make_pair(ID, (Chunk *)NULL));
+
+      if(it != m_Chunks.end() && it->first == ID)
+        it->second = chunk;
+      else
+        m_Chunks.insert(it, std::make_pair(ID, chunk));
+    }
     UnlockChunks();
   }
 
@@ -217,6 +239,18 @@ struct ResourceRecord
     UnlockChunks();
   }
 
+  // spilling frees the chunks' memory, so it can't be done if we point into their data
+  void SpillChunks()
+  {
+    if(HasDataPtr())
+      return;
+
+    LockChunks();
+    for(auto it = m_Chunks.begin(); it != m_Chunks.end(); ++it)
+      it->second->Spill();
+    UnlockChunks();
+  }
+
   void DeleteChunks()
   {
     LockChunks();
@@ -238,13 +272,38 @@ struct ResourceRecord
     return m_Chunks.rbegin()->first;
   }
 
-  void PopChunk() { m_Chunks.erase(m_Chunks.rbegin()->first); }
+  void PopChunk() { m_Chunks.pop_back(); }
   byte *GetDataPtr() { return DataPtr + DataOffset; }
   bool HasDataPtr() { return DataPtr != NULL; }
   void SetDataOffset(uint64_t offs) { DataOffset = offs; }
   void SetDataPtr(byte *ptr) { DataPtr = ptr; }
   bool MarkResourceFrameReferenced(ResourceId id, FrameRefType refType);
   void AddResourceReferences(ResourceRecordHandler *mgr);
+  // approximate heap memory used by the generic record storage, not including the record itself.
+  // Chunk payloads are the captured data rather than overhead, so only their bookkeeping counts
+  uint64_t GetStorageSize()
+  {
+    uint64_t ret = 0;
+
+    // chunks can be added from other threads while we're walking them
+    LockChunks();
+
+    ret += Parents.capacity() * sizeof(ResourceRecord *);
+    ret += m_Chunks.capacity() * sizeof(std::pair<int32_t, Chunk *>);
+
+    ret += m_Chunks.size() * sizeof(Chunk);
+
+    if(m_ChunkLock)
+      ret += sizeof(Threading::CriticalSection);
+
+    // each map node has three pointers and a colour alongside the value
+    ret += m_FrameRefs.size() * (sizeof(std::pair<ResourceId, FrameRefType>) + 4 * sizeof(void *));
+
+    UnlockChunks();
+
+    return ret;
+  }
+
   void AddReferencedIDs(std::set<ResourceId> &ids)
   {
     for(auto it = m_FrameRefs.begin(); it != m_FrameRefs.end(); ++it)
@@ -258,6 +317,14 @@ struct ResourceRecord
   bool SpecialResource;    // like the swap chain back buffers
   bool DataWritten;
 
+  // chunks are ordered across all records by this ID
+  static int32_t GetID()
+  {
+    static volatile int32_t globalIDCounter = 10;
+
+    return Atomic::Inc32(&globalIDCounter);
+  }
+
 protected:
   volatile int32_t RefCount;
 
@@ -266,16 +333,11 @@ protected:
 
   ResourceId ResID;
 
-  std::set<ResourceRecord *> Parents;
+  std::vector<ResourceRecord *> Parents;
 
-  int32_t GetID()
-  {
-    static volatile int32_t globalIDCounter = 10;
-
-    return Atomic::Inc32(&globalIDCounter);
-  }
+  // sorted by chunk ID
+  std::vector<std::pair<int32_t, Chunk *> > m_Chunks;
 
-  std::map<int32_t, Chunk *> m_Chunks;
   Threading::CriticalSection *m_ChunkLock;
 
   map<ResourceId, FrameRefType> m_FrameRefs;
@@ -337,6 +399,10 @@ public:
   // insert the chunks for the resources referenced in the frame
   void InsertReferencedChunks(Serialiser *fileSer);
 
+  // get the memory used by all resource records, by type. This walks every record so it's only done
+  // on request, outside of a capture
+  void GetRecordMemoryUsage(std::map<std::string, CaptureStats::Counter> &usage);
+
   // mark resource records as unwritten, ready to be written to a new logfile.
   void MarkUnwrittenResources();
 
@@ -354,6 +420,19 @@ public:
   void MarkPendingDirty(ResourceId res);
   void FlushPendingDirty();
 
+  // with the SpillResourceChunks option, spill the chunks of records created before the previous
+  // call, so that any chunks added shortly after creation are spilled along with them. Must only
+  // be called while not capturing, e.g. at the end of a frame alongside FlushPendingDirty
+  void SpillResourceChunks();
+
+  // spilled chunks are read back from disk as the capture is written, so they're only spilled
+  // when that happens on the background writer thread rather than in the application's present
+  static bool SpillEnabled()
+  {
+    const CaptureOptions &opts = RenderDoc::Inst().GetCaptureOptions();
+    return opts.SpillResourceChunks && (opts.AsyncCaptureWrite || opts.RetroactiveFrames > 0);
+  }
+
   // this can be used when the resource is cleared or similar and it's in a known state
   void MarkCleanResource(ResourceId res);
 
@@ -435,6 +514,9 @@ protected:
   virtual void Create_InitialState(ResourceId id, WrappedResourceType live, bool hasData) = 0;
   virtual void Apply_InitialState(WrappedResourceType live, InitialContentData initial) = 0;
 
+  // used to break down initial contents by resource type in capture statistics
+  virtual std::string GetResourceTypeName(WrappedResourceType res) { return "Resource"; }
+
   LogState m_State;
   Serialiser *m_pSerialiser;
 
@@ -465,12 +547,30 @@ protected:
   set<ResourceId> m_DirtyResources;
   set<ResourceId> m_PendingDirtyResources;
 
+  // used during capture - records created since the last SpillResourceChunks, and the ones
+  // created before that which are spilled on the next call
+  vector<ResourceId> m_SpillPending, m_SpillReady;
+
   // used during capture or replay - holds initial contents
   map<ResourceId, InitialContentData> m_InitialContents;
   // on capture, if a chunk was prepared in Prepare_InitialContents and added, don't re-serialise.
   // Some initial contents may not need the delayed readback.
   map<ResourceId, Chunk *> m_InitialChunks;
 
+  // with retroactive captures, the initial contents chunks from the last frame. Resources that
+  // haven't been written or dirtied since are in the same state for the next frame, so their chunk
+  // is shared with it instead of being prepared and serialised again. m_RetroactiveWritten tracks
+  // writes since the last PrepareInitialContents, which picks the reusable chunks from it.
+  map<ResourceId, Chunk *> m_RetroactiveInitialChunks;
+  set<ResourceId> m_RetroactiveWritten, m_RetroactiveReusable;
+
+  static bool RetroactiveEnabled()
+  {
+    return RenderDoc::Inst().GetCaptureOptions().RetroactiveFrames > 0;
+  }
+  bool CanReuseInitialChunk(ResourceId id);
+  void FreeRetroactiveChunks();
+
   // used during capture or replay - map of resources currently alive with their real IDs, used in
   // capture and replay.
   map<ResourceId, WrappedResourceType> m_CurrentResourceMap;
@@ -529,6 +629,8 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::Shutdow
 
   FreeInitialContents();
 
+  FreeRetroactiveChunks();
+
   RDCASSERT(m_ResourceRecords.empty());
 }
 
@@ -626,6 +728,9 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::MarkDir
     return;
 
   m_DirtyResources.insert(res);
+
+  if(RetroactiveEnabled())
+    m_RetroactiveWritten.insert(res);
 }
 
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
@@ -637,6 +742,9 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::MarkPen
     return;
 
   m_PendingDirtyResources.insert(res);
+
+  if(RetroactiveEnabled())
+    m_RetroactiveWritten.insert(res);
 }
 
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
@@ -648,6 +756,33 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::FlushPe
   m_PendingDirtyResources.clear();
 }
 
+template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
+void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::SpillResourceChunks()
+{
+  SCOPED_LOCK(m_Lock);
+
+  if(!SpillEnabled())
+  {
+    m_SpillPending.clear();
+    m_SpillReady.clear();
+    return;
+  }
+
+  for(size_t i = 0; i < m_SpillReady.size(); i++)
+  {
+    auto it = m_ResourceRecords.find(m_SpillReady[i]);
+
+    // the resource may have been destroyed already
+    if(it == m_ResourceRecords.end() || !SerialisableResource(it->first, it->second))
+      continue;
+
+    it->second->SpillChunks();
+  }
+
+  m_SpillReady.swap(m_SpillPending);
+  m_SpillPending.clear();
+}
+
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
 bool ResourceManager<WrappedResourceType, RealResourceType, RecordType>::IsResourceDirty(ResourceId res)
 {
@@ -868,10 +1003,12 @@ template <typename WrappedResourceType, typename RealResourceType, typename Reco
 void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::InsertReferencedChunks(
     Serialiser *fileSer)
 {
-  map<int32_t, Chunk *> sortedChunks;
+  ChunkList chunks;
 
   SCOPED_LOCK(m_Lock);
 
+  SCOPED_CAPTURE_TIMER(EndCaptureResourceChunks);
+
   RDCDEBUG("%u frame resource records", (uint32_t)m_FrameReferencedResources.size());
 
   if(RenderDoc::Inst().GetCaptureOptions().RefAllResources)
@@ -881,7 +1018,7 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::InsertR
       if(!SerialisableResource(it->first, it->second))
         continue;
 
-      it->second->Insert(sortedChunks);
+      it->second->Insert(chunks);
     }
   }
   else
@@ -890,24 +1027,67 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::InsertR
     {
       RecordType *record = GetResourceRecord(it->first);
       if(record)
-        record->Insert(sortedChunks);
+        record->Insert(chunks);
     }
   }
 
-  RDCDEBUG("%u frame resource chunks", (uint32_t)sortedChunks.size());
+  RDCDEBUG("%u frame resource chunks", (uint32_t)chunks.size());
 
-  for(auto it = sortedChunks.begin(); it != sortedChunks.end(); it++)
-  {
-    fileSer->Insert(it->second);
-  }
+  fileSer->InsertSorted(chunks);
 
   RDCDEBUG("inserted to serialiser");
 }
 
+template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
+void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::GetRecordMemoryUsage(
+    std::map<std::string, CaptureStats::Counter> &usage)
+{
+  SCOPED_LOCK(m_Lock);
+
+  for(auto it = m_ResourceRecords.begin(); it != m_ResourceRecords.end(); ++it)
+  {
+    RecordType *record = it->second;
+
+    std::string type = "Untracked";
+
+    if(record->SpecialResource)
+    {
+      type = "Special";
+    }
+    else
+    {
+      auto res = m_CurrentResourceMap.find(it->first);
+      if(res != m_CurrentResourceMap.end())
+        type = GetResourceTypeName(res->second);
+    }
+
+    CaptureStats::Counter &c = usage[type];
+    c.count++;
+    c.bytes += sizeof(RecordType) + record->GetStorageSize();
+  }
+}
+
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
 void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::PrepareInitialContents()
 {
   SCOPED_LOCK(m_Lock);
+  SCOPED_CAPTURE_TIMER(PrepareInitialState);
+
+  // kept chunks for anything not written since the last frame's initial contents can be reused,
+  // then start tracking writes from this frame on. Writes aren't tracked without retroactive
+  // captures, so nothing kept from before they were disabled can be trusted.
+  m_RetroactiveReusable.clear();
+
+  if(!RetroactiveEnabled())
+    FreeRetroactiveChunks();
+
+  for(auto it = m_RetroactiveInitialChunks.begin(); it != m_RetroactiveInitialChunks.end(); ++it)
+  {
+    if(m_RetroactiveWritten.find(it->first) == m_RetroactiveWritten.end())
+      m_RetroactiveReusable.insert(it->first);
+  }
+
+  m_RetroactiveWritten.clear();
 
   RDCDEBUG("Preparing up to %u potentially dirty resources", (uint32_t)m_DirtyResources.size());
   uint32_t prepared = 0;
@@ -925,6 +1105,9 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::Prepare
     if(record == NULL || record->SpecialResource)
       continue;
 
+    if(CanReuseInitialChunk(id))
+      continue;
+
     prepared++;
 
 #if ENABLED(VERBOSE_DIRTY_RESOURCES)
@@ -953,14 +1136,38 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::Prepare
   RDCDEBUG("Force-prepared %u dirty resources", prepared);
 }
 
+template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
+bool ResourceManager<WrappedResourceType, RealResourceType, RecordType>::CanReuseInitialChunk(
+    ResourceId id)
+{
+  return m_RetroactiveReusable.find(id) != m_RetroactiveReusable.end() &&
+         m_RetroactiveInitialChunks.find(id) != m_RetroactiveInitialChunks.end();
+}
+
+template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
+void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::FreeRetroactiveChunks()
+{
+  for(auto it = m_RetroactiveInitialChunks.begin(); it != m_RetroactiveInitialChunks.end(); ++it)
+    delete it->second;
+
+  m_RetroactiveInitialChunks.clear();
+}
+
 template <typename WrappedResourceType, typename RealResourceType, typename RecordType>
 void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::InsertInitialContentsChunks(
     Serialiser *fileSerialiser)
 {
   SCOPED_LOCK(m_Lock);
+  SCOPED_CAPTURE_TIMER(SerialiseInitialState);
 
   uint32_t dirty = 0;
   uint32_t skipped = 0;
+  uint32_t reused = 0;
+
+  bool retroactive = RetroactiveEnabled();
+
+  // the initial contents chunks kept for the next retroactive frame
+  map<ResourceId, Chunk *> retroactiveChunks;
 
   RDCDEBUG("Checking %u possibly dirty resources", (uint32_t)m_DirtyResources.size());
 
@@ -1023,10 +1230,21 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::InsertI
       continue;
     }
 
+    Chunk *chunk = NULL;
+
     auto preparedChunk = m_InitialChunks.find(id);
-    if(preparedChunk != m_InitialChunks.end())
+    if(CanReuseInitialChunk(id))
+    {
+      // nothing was prepared for this resource, share the previous frame's contents
+      retroactiveChunks[id] = m_RetroactiveInitialChunks[id];
+      m_RetroactiveInitialChunks.erase(id);
+
+      chunk = retroactiveChunks[id]->Duplicate();
+      reused++;
+    }
+    else if(preparedChunk != m_InitialChunks.end())
     {
-      fileSerialiser->Insert(preparedChunk->second);
+      chunk = preparedChunk->second;
       m_InitialChunks.erase(preparedChunk);
     }
     else
@@ -1036,11 +1254,27 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::InsertI
 
       Serialise_InitialState(id, res);
 
-      fileSerialiser->Insert(scope.Get(true));
+      chunk = scope.Get(true);
     }
+
+    if(retroactive && retroactiveChunks.find(id) == retroactiveChunks.end())
+      retroactiveChunks[id] = chunk->Duplicate();
+
+    if(CaptureStats::IsEnabled())
+      CaptureStats::AddResourceBytes(GetResourceTypeName(res), chunk->GetLength());
+
+    fileSerialiser->Insert(chunk);
   }
 
-  RDCDEBUG("Serialised %u dirty resources, skipped %u unreferenced", dirty, skipped);
+  RDCDEBUG("Serialised %u dirty resources (%u unchanged since the last frame), skipped %u "
+           "unreferenced",
+           dirty, reused, skipped);
+
+  // only the chunks used in this frame are kept, anything else is freed or is held by the frames
+  // that used it
+  FreeRetroactiveChunks();
+  m_RetroactiveInitialChunks.swap(retroactiveChunks);
+  m_RetroactiveReusable.clear();
 
   dirty = 0;
 
@@ -1053,10 +1287,12 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::InsertI
     {
       dirty++;
 
+      Chunk *chunk = NULL;
+
       auto preparedChunk = m_InitialChunks.find(it->first);
       if(preparedChunk != m_InitialChunks.end())
       {
-        fileSerialiser->Insert(preparedChunk->second);
+        chunk = preparedChunk->second;
         m_InitialChunks.erase(preparedChunk);
       }
       else
@@ -1066,8 +1302,13 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::InsertI
 
         Serialise_InitialState(it->first, it->second);
 
-        fileSerialiser->Insert(scope.Get(true));
+        chunk = scope.Get(true);
       }
+
+      if(CaptureStats::IsEnabled())
+        CaptureStats::AddResourceBytes(GetResourceTypeName(it->second), chunk->GetLength());
+
+      fileSerialiser->Insert(chunk);
     }
   }
 
@@ -1101,12 +1342,17 @@ void ResourceManager<WrappedResourceType, RealResourceType, RecordType>::ClearRe
 {
   SCOPED_LOCK(m_Lock);
 
+  bool retroactive = RetroactiveEnabled();
+
   for(auto it = m_FrameReferencedResources.begin(); it != m_FrameReferencedResources.end(); ++it)
   {
     RecordType *record = GetResourceRecord(it->first);
 
     if(record)
       record->Delete(this);
+
+    if(retroactive && it->second != eFrameRef_ReadOnly)
+      m_RetroactiveWritten.insert(it->first);
   }
 
   m_FrameReferencedResources.clear();
@@ -1178,6 +1424,9 @@ RecordType *ResourceManager<WrappedResourceType, RealResourceType, RecordType>::
 
   RDCASSERT(m_ResourceRecords.find(id) == m_ResourceRecords.end(), id);
 
+  if(SpillEnabled())
+    m_SpillPending.push_back(id);
+
   return (m_ResourceRecords[id] = new RecordType(id));
 }
 
@@ -25,6 +25,52 @@
 
 #pragma once
 
+#include "lz4/lz4.h"
+
+// set in the packet type when the payload is LZ4 compressed. The payload is then prefixed with its
+// uncompressed length, and the length in the packet header covers the prefix and compressed data.
+static const uint32_t PacketCompressedFlag = 0x80000000U;
+
+// payloads smaller than this are always sent as-is, compressing them isn't worth the time
+static const uint32_t PacketCompressionThreshold = 4 * 1024;
+
+// sends a packet header and payload, compressing the payload if the socket has negotiated
+// compression and it's large enough. If compression doesn't save anything the payload is sent
+// uncompressed, so already-compressed data only costs the failed attempt.
+inline bool SendPacketPayload(Network::Socket *sock, uint32_t type, const void *payload,
+                              uint32_t payloadLength)
+{
+  if(sock->PacketCompression() && payloadLength >= PacketCompressionThreshold &&
+     payloadLength <= LZ4_MAX_INPUT_SIZE)
+  {
+    vector<byte> compressed(LZ4_COMPRESSBOUND(payloadLength));
+
+    int compSize = LZ4_compress_default((const char *)payload, (char *)&compressed[0],
+                                        (int)payloadLength, (int)compressed.size());
+
+    uint32_t packetLength = uint32_t(compSize) + (uint32_t)sizeof(uint32_t);
+
+    if(compSize > 0 && packetLength < payloadLength)
+    {
+      // the packet length covers the uncompressed length prefix as well as the compressed data
+      uint32_t header[3] = {type | PacketCompressedFlag, packetLength, payloadLength};
+
+      return sock->SendDataBlocking(header, sizeof(header)) &&
+             sock->SendDataBlocking(&compressed[0], (uint32_t)compSize);
+    }
+  }
+
+  uint32_t header[2] = {type, payloadLength};
+
+  if(!sock->SendDataBlocking(header, sizeof(header)))
+    return false;
+
+  if(payloadLength > 0 && !sock->SendDataBlocking(payload, payloadLength))
+    return false;
+
+  return true;
+}
+
 inline uint32_t RecvPacket(Network::Socket *sock)
 {
   if(sock == NULL)
@@ -51,13 +97,47 @@ bool RecvPacket(Network::Socket *sock, PacketTypeEnum &type, vector<byte> &paylo
   if(!sock->RecvDataBlocking(&payloadLength, sizeof(payloadLength)))
     return false;
 
-  if(payloadLength > 0)
+  if(t & PacketCompressedFlag)
+  {
+    t &= ~PacketCompressedFlag;
+
+    uint32_t uncompressedLength = 0;
+    if(payloadLength < sizeof(uncompressedLength) ||
+       !sock->RecvDataBlocking(&uncompressedLength, sizeof(uncompressedLength)))
+      return false;
+
+    payloadLength -= sizeof(uncompressedLength);
+
+    vector<byte> compressed(payloadLength);
+
+    if(payloadLength > 0 && !sock->RecvDataBlocking(&compressed[0], payloadLength))
+      return false;
+
+    payload.resize(uncompressedLength);
+
+    if(uncompressedLength > 0)
+    {
+      int decompSize = LZ4_decompress_safe((const char *)&compressed[0], (char *)&payload[0],
+                                           (int)payloadLength, (int)uncompressedLength);
+
+      if(decompSize < 0 || (uint32_t)decompSize != uncompressedLength)
+      {
+        RDCERR("Failed to decompress %u byte packet payload", uncompressedLength);
+        return false;
+      }
+    }
+  }
+  else if(payloadLength > 0)
   {
     payload.resize(payloadLength);
 
     if(!sock->RecvDataBlocking(&payload[0], payloadLength))
       return false;
   }
+  else
+  {
+    payload.clear();
+  }
 
   type = (PacketTypeEnum)t;
 
@@ -102,18 +182,7 @@ bool SendPacket(Network::Socket *sock, PacketTypeEnum type, const Serialiser &se
   if(sock == NULL)
     return false;
 
-  uint32_t t = (uint32_t)type;
-  if(!sock->SendDataBlocking(&t, sizeof(t)))
-    return false;
-
-  uint32_t payloadLength = ser.GetOffset() & 0xffffffff;
-  if(!sock->SendDataBlocking(&payloadLength, sizeof(payloadLength)))
-    return false;
-
-  if(!sock->SendDataBlocking(ser.GetRawPtr(0), payloadLength))
-    return false;
-
-  return true;
+  return SendPacketPayload(sock, (uint32_t)type, ser.GetRawPtr(0), ser.GetOffset() & 0xffffffff);
 }
 
 template <typename PacketTypeEnum>
@@ -229,12 +298,8 @@ bool SendChunkedFile(Network::Socket *sock, PacketTypeEnum type, const char *log
 
     FileIO::fread(buf, 1, payloadLength, f);
 
-    if(!sock->SendDataBlocking(&t, sizeof(t)) ||
-       !sock->SendDataBlocking(&payloadLength, sizeof(payloadLength)) ||
-       !sock->SendDataBlocking(buf, payloadLength))
-    {
+    if(!SendPacketPayload(sock, t, buf, payloadLength))
       break;
-    }
 
     fileLen -= payloadLength;
     if(progress)
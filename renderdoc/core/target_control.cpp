@@ -64,6 +64,11 @@ void RenderDoc::TargetControlClientThread(void *s)
   uint32_t mypid = Process::GetCurrentPID();
   ser.Serialise("", mypid);
 
+  // let the client know we can decompress packets. It only enables compression on its side if
+  // it asked for it in its own handshake
+  bool compress = true;
+  ser.Serialise("", compress);
+
   if(!SendPacket(client, ePacket_Handshake, ser))
   {
     SAFE_DELETE(client);
@@ -77,9 +82,9 @@ void RenderDoc::TargetControlClientThread(void *s)
     return;
   }
 
-  const int pingtime = 1000;    // ping every 1000ms
-  const int ticktime = 10;      // tick every 10ms
-  int curtime = 0;
+  const double pingtime = 1000.0;    // ping every 1000ms
+  const uint32_t ticktime = 10;      // tick every 10ms
+  PerformanceTimer pingTimer;
 
   vector<CaptureData> captures;
   vector<pair<uint32_t, uint32_t> > children;
@@ -94,8 +99,9 @@ void RenderDoc::TargetControlClientThread(void *s)
 
     ser.Rewind();
 
-    Threading::Sleep(ticktime);
-    curtime += ticktime;
+    // commands from the client wake us immediately, otherwise tick to check for new captures and
+    // children to send
+    client->WaitForRecvData(ticktime);
 
     PacketType packetType = ePacket_Noop;
 
@@ -139,6 +145,8 @@ void RenderDoc::TargetControlClientThread(void *s)
       size_t sz = buf.size();
       ser.Serialise("", buf.count);
       ser.SerialiseBuffer("", buf.elems, sz);
+
+      ser.Serialise("", captures.back().statistics);
     }
     else if(childprocs.size() != children.size())
     {
@@ -152,7 +160,7 @@ void RenderDoc::TargetControlClientThread(void *s)
       ser.Serialise("", children.back().second);
     }
 
-    if(curtime < pingtime && packetType == ePacket_Noop)
+    if(pingTimer.GetMilliseconds() < pingtime && packetType == ePacket_Noop)
     {
       if(client->IsRecvDataWaiting())
       {
@@ -224,7 +232,7 @@ void RenderDoc::TargetControlClientThread(void *s)
       continue;
     }
 
-    curtime = 0;
+    pingTimer.Restart();
 
     if(!SendPacket(client, packetType, ser))
     {
@@ -269,7 +277,8 @@ void RenderDoc::TargetControlServerThread(void *s)
         return;
       }
 
-      Threading::Sleep(5);
+      // wait for a client to connect, checking regularly if we should shut down
+      sock->WaitForRecvData(ServerWakeupMS);
 
       continue;
     }
@@ -299,6 +308,13 @@ void RenderDoc::TargetControlServerThread(void *s)
       ser->SerialiseString("", newClient);
       ser->Serialise("", kick);
 
+      // older clients don't send this, and can't receive compressed packets
+      bool compress = false;
+      if(ser->GetOffset() < ser->GetSize())
+        ser->Serialise("", compress);
+
+      client->SetPacketCompression(compress);
+
       SAFE_DELETE(ser);
 
       if(newClient.empty())
@@ -387,6 +403,9 @@ public:
       ser.SerialiseString("", clientName);
       ser.Serialise("", forceConnection);
 
+      bool compress = true;
+      ser.Serialise("", compress);
+
       if(!SendPacket(m_Socket, ePacket_Handshake, ser))
       {
         SAFE_DELETE(m_Socket);
@@ -409,6 +428,13 @@ public:
       ser->Serialise("", m_API);
       ser->Serialise("", m_PID);
 
+      // older targets don't send this, and can't receive compressed packets
+      bool compress = false;
+      if(ser->GetOffset() < ser->GetSize())
+        ser->Serialise("", compress);
+
+      m_Socket->SetPacketCompression(compress);
+
       RDCLOG("Got remote handshake: %s (%s) [%u]", m_Target.c_str(), m_API.c_str(), m_PID);
     }
     else if(type == ePacket_Busy)
@@ -499,6 +525,10 @@ public:
       return msg;
     }
 
+    // callers poll for messages in a loop, so wait briefly for one to arrive rather than returning
+    // immediately with nothing
+    m_Socket->WaitForRecvData(2);
+
     if(!m_Socket->IsRecvDataWaiting())
     {
       if(!m_Socket->Connected())
@@ -508,7 +538,6 @@ public:
       }
       else
       {
-        Threading::Sleep(2);
         msg.Type = TargetControlMessageType::Noop;
       }
 
@@ -609,6 +638,12 @@ public:
         byte *buf = &msg.NewCapture.thumbnail[0];
         ser->SerialiseBuffer("", buf, l);
 
+        // older targets don't send this
+        string statistics;
+        if(ser->GetOffset() < ser->GetSize())
+          ser->Serialise("", statistics);
+        msg.NewCapture.statistics = statistics;
+
         RDCLOG("Got a new capture: %d (time %llu) %d byte thumbnail", msg.NewCapture.ID,
                msg.NewCapture.timestamp, thumblen);
 
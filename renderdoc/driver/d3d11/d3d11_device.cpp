@@ -874,6 +874,8 @@ const char *WrappedID3D11Device::GetChunkName(uint32_t idx)
     return "Driver Init Params";
   if(idx == INITIAL_CONTENTS)
     return "Initial Contents";
+  if(idx == CAPTURE_STATISTICS)
+    return "Capture Statistics";
   if(idx < FIRST_CHUNK_ID || idx >= NUM_D3D11_CHUNKS)
     return "<unknown>";
   return D3D11ChunkNames[idx - FIRST_CHUNK_ID];
@@ -1081,7 +1083,7 @@ void WrappedID3D11Device::ProcessChunk(uint64_t offset, D3D11ChunkType context)
       // ignore system chunks
       if(context == INITIAL_CONTENTS)
         Serialise_InitialState(ResourceId(), NULL);
-      else if(context < FIRST_CHUNK_ID)
+      else if(IsSystemChunk(context))
         m_pSerialiser->SkipCurrentChunk();
       else
         m_pImmediateContext->ProcessChunk(offset, context, true);
@@ -3010,8 +3012,10 @@ bool WrappedID3D11Device::EndFrameCapture(void *dev, void *wnd)
       }
     }
 
-    Serialiser *m_pFileSerialiser = RenderDoc::Inst().OpenWriteSerialiser(
-        m_FrameCounter, &m_InitParams, jpgbuf, len, thwidth, thheight);
+    Serialiser *m_pFileSerialiser =
+        RenderDoc::Inst().OpenWriteSerialiser(this, m_FrameCounter, &m_InitParams, jpgbuf, len,
+                                              thwidth, thheight,
+                                              &WrappedID3D11Device::GetChunkName);
 
     SAFE_DELETE_ARRAY(jpgbuf);
     SAFE_DELETE(thpixels);
@@ -3050,25 +3054,21 @@ bool WrappedID3D11Device::EndFrameCapture(void *dev, void *wnd)
 
       RDCDEBUG("Accumulating context resource list");
 
-      map<int32_t, Chunk *> recordlist;
+      ChunkList recordlist;
       record->Insert(recordlist);
 
       RDCDEBUG("Flushing %u records to file serialiser", (uint32_t)recordlist.size());
 
-      for(auto it = recordlist.begin(); it != recordlist.end(); ++it)
-        m_pFileSerialiser->Insert(it->second);
+      m_pFileSerialiser->InsertSorted(recordlist);
 
       RDCDEBUG("Done");
     }
 
-    m_pFileSerialiser->FlushToDisk();
+    RenderDoc::Inst().WriteCapture(m_pFileSerialiser, m_FrameCounter);
+    m_pFileSerialiser = NULL;
 
     UnlockForChunkFlushing();
 
-    SAFE_DELETE(m_pFileSerialiser);
-
-    RenderDoc::Inst().SuccessfullyWrittenLog(m_FrameCounter);
-
     m_State = WRITING_IDLE;
 
     m_pImmediateContext->CleanupCapture();
@@ -454,6 +454,10 @@ public:
 
   void StartFrameCapture(void *dev, void *wnd);
   bool EndFrameCapture(void *dev, void *wnd);
+  void GetRecordMemoryUsage(std::map<std::string, CaptureStats::Counter> &usage)
+  {
+    GetResourceManager()->GetRecordMemoryUsage(usage);
+  }
 
   ID3DUserDefinedAnnotation *GetAnnotations() { return m_RealAnnotations; }
   // interface for DXGI
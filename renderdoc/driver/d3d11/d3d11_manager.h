@@ -131,7 +131,7 @@ struct D3D11ResourceRecord : public ResourceRecord
       SubResources[i]->SetDataPtr(ptr);
   }
 
-  void Insert(map<int32_t, Chunk *> &recordlist)
+  void Insert(ChunkList &recordlist)
   {
     bool dataWritten = DataWritten;
 
@@ -147,7 +147,7 @@ struct D3D11ResourceRecord : public ResourceRecord
 
     if(!dataWritten)
     {
-      recordlist.insert(m_Chunks.begin(), m_Chunks.end());
+      recordlist.insert(recordlist.end(), m_Chunks.begin(), m_Chunks.end());
 
       for(int i = 0; i < NumSubResources; i++)
         SubResources[i]->Insert(recordlist);
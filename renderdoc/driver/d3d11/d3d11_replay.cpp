@@ -340,6 +340,11 @@ FrameRecord D3D11Replay::GetFrameRecord()
   return m_pDevice->GetFrameRecord();
 }
 
+ReplayCache *D3D11Replay::GetReplayCache()
+{
+  return NULL;
+}
+
 vector<EventUsage> D3D11Replay::GetUsage(ResourceId id)
 {
   return m_pDevice->GetImmediateContext()->GetUsage(id);
@@ -1437,6 +1442,18 @@ void D3D11Replay::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len,
   m_pDevice->GetDebugManager()->GetBufferData(buff, offset, len, retData);
 }
 
+uint64_t D3D11Replay::GetBufferDataInto(ResourceId buff, uint64_t offset, uint64_t len, byte *dest)
+{
+  // the readback is still staged through a temporary array here
+  vector<byte> retData;
+  m_pDevice->GetDebugManager()->GetBufferData(buff, offset, len, retData);
+
+  uint64_t written = RDCMIN(len, (uint64_t)retData.size());
+  if(written > 0)
+    memcpy(dest, &retData[0], (size_t)written);
+  return written;
+}
+
 byte *D3D11Replay::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
                                   const GetTextureDataParams &params, size_t &dataSize)
 {
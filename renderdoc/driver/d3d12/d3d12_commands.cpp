@@ -428,7 +428,7 @@ void WrappedID3D12CommandQueue::ProcessChunk(uint64_t offset, D3D12ChunkType chu
       // ignore system chunks
       if(chunk == INITIAL_CONTENTS)
         GetResourceManager()->Serialise_InitialState(ResourceId(), NULL);
-      else if(chunk < FIRST_CHUNK_ID)
+      else if(IsSystemChunk(chunk))
         m_pSerialiser->SkipCurrentChunk();
       else
         RDCERR("Unexpected non-device chunk %d at offset %llu", chunk, offset);
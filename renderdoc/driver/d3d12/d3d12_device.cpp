@@ -82,6 +82,8 @@ const char *WrappedID3D12Device::GetChunkName(uint32_t idx)
     return "Driver Init Params";
   if(idx == INITIAL_CONTENTS)
     return "Initial Contents";
+  if(idx == CAPTURE_STATISTICS)
+    return "Capture Statistics";
   if(idx < FIRST_CHUNK_ID || idx >= NUM_D3D12_CHUNKS)
     return "<unknown>";
   return D3D12ChunkNames[idx - FIRST_CHUNK_ID];
@@ -1603,8 +1605,10 @@ bool WrappedID3D12Device::EndFrameCapture(void *dev, void *wnd)
       }
     }
 
-    m_pFileSerialiser = RenderDoc::Inst().OpenWriteSerialiser(m_FrameCounter, &m_InitParams, jpgbuf,
-                                                              len, thwidth, thheight);
+    m_pFileSerialiser =
+        RenderDoc::Inst().OpenWriteSerialiser(this, m_FrameCounter, &m_InitParams, jpgbuf, len,
+                                              thwidth, thheight,
+                                              &WrappedID3D12Device::GetChunkName);
 
     queues = m_Queues;
 
@@ -1645,7 +1649,7 @@ bool WrappedID3D12Device::EndFrameCapture(void *dev, void *wnd)
   // in capframe (the transition is thread-protected) so nothing will be
   // pushed to the vector
 
-  map<int32_t, Chunk *> recordlist;
+  ChunkList recordlist;
 
   for(auto it = queues.begin(); it != queues.end(); ++it)
   {
@@ -1677,17 +1681,14 @@ bool WrappedID3D12Device::EndFrameCapture(void *dev, void *wnd)
     RDCDEBUG("Flushing %u chunks to file serialiser from context record",
              (uint32_t)recordlist.size());
 
-    for(auto it = recordlist.begin(); it != recordlist.end(); ++it)
-      m_pFileSerialiser->Insert(it->second);
+    m_pFileSerialiser->InsertSorted(recordlist);
 
     RDCDEBUG("Done");
   }
 
-  m_pFileSerialiser->FlushToDisk();
+  RenderDoc::Inst().WriteCapture(m_pFileSerialiser, m_FrameCounter);
+  m_pFileSerialiser = NULL;
 
-  RenderDoc::Inst().SuccessfullyWrittenLog(m_FrameCounter);
-
-  SAFE_DELETE(m_pFileSerialiser);
   SAFE_DELETE(m_HeaderChunk);
 
   m_State = WRITING_IDLE;
@@ -2290,7 +2291,7 @@ void WrappedID3D12Device::ProcessChunk(uint64_t offset, D3D12ChunkType context)
       // ignore system chunks
       if(context == INITIAL_CONTENTS)
         GetResourceManager()->Serialise_InitialState(ResourceId(), NULL);
-      else if(context < FIRST_CHUNK_ID)
+      else if(IsSystemChunk(context))
         m_pSerialiser->SkipCurrentChunk();
       else
         RDCERR("Unexpected non-device chunk %d at offset %llu", context, offset);
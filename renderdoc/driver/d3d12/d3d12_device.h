@@ -441,6 +441,10 @@ public:
 
   void StartFrameCapture(void *dev, void *wnd);
   bool EndFrameCapture(void *dev, void *wnd);
+  void GetRecordMemoryUsage(std::map<std::string, CaptureStats::Counter> &usage)
+  {
+    GetResourceManager()->GetRecordMemoryUsage(usage);
+  }
 
   bool Serialise_BeginCaptureFrame(bool applyInitialState);
 
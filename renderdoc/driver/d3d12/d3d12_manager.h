@@ -393,7 +393,7 @@ struct D3D12ResourceRecord : public ResourceRecord
     cmdInfo->bundles.swap(bakedCommands->cmdInfo->bundles);
   }
 
-  void Insert(map<int32_t, Chunk *> &recordlist)
+  void Insert(ChunkList &recordlist)
   {
     bool dataWritten = DataWritten;
 
@@ -408,7 +408,7 @@ struct D3D12ResourceRecord : public ResourceRecord
     }
 
     if(!dataWritten)
-      recordlist.insert(m_Chunks.begin(), m_Chunks.end());
+      recordlist.insert(recordlist.end(), m_Chunks.begin(), m_Chunks.end());
   }
 
   D3D12ResourceType type;
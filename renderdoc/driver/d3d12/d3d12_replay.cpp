@@ -280,6 +280,11 @@ FrameRecord D3D12Replay::GetFrameRecord()
   return m_pDevice->GetFrameRecord();
 }
 
+ReplayCache *D3D12Replay::GetReplayCache()
+{
+  return NULL;
+}
+
 ResourceId D3D12Replay::GetLiveID(ResourceId id)
 {
   return m_pDevice->GetResourceManager()->GetLiveID(id);
@@ -1300,6 +1305,18 @@ void D3D12Replay::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len,
   m_pDevice->GetDebugManager()->GetBufferData(buff, offset, len, retData);
 }
 
+uint64_t D3D12Replay::GetBufferDataInto(ResourceId buff, uint64_t offset, uint64_t len, byte *dest)
+{
+  // the readback is still staged through a temporary array here
+  vector<byte> retData;
+  m_pDevice->GetDebugManager()->GetBufferData(buff, offset, len, retData);
+
+  uint64_t written = RDCMIN(len, (uint64_t)retData.size());
+  if(written > 0)
+    memcpy(dest, &retData[0], (size_t)written);
+  return written;
+}
+
 void D3D12Replay::PickPixel(ResourceId texture, uint32_t x, uint32_t y, uint32_t sliceFace,
                             uint32_t mip, uint32_t sample, CompType typeHint, float pixel[4])
 {
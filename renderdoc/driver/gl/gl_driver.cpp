@@ -28,7 +28,6 @@
 #include "common/common.h"
 #include "data/glsl_shaders.h"
 #include "driver/shaders/spirv/spirv_common.h"
-#include "jpeg-compressor/jpge.h"
 #include "maths/matrix.h"
 #include "maths/vec.h"
 #include "replay/type_helpers.h"
@@ -781,6 +780,7 @@ WrappedOpenGL::WrappedOpenGL(const char *logfile, const GLHookSet &funcs, GLPlat
     if(logfile)
     {
       m_pSerialiser = new Serialiser(logfile, Serialiser::READING, false);
+      m_ReplayCache.Open(logfile);
     }
     else
     {
@@ -1011,6 +1011,8 @@ const char *WrappedOpenGL::GetChunkName(uint32_t idx)
     return "Driver Init Params";
   if(idx == INITIAL_CONTENTS)
     return "Initial Contents";
+  if(idx == CAPTURE_STATISTICS)
+    return "Capture Statistics";
   if(idx < FIRST_CHUNK_ID || idx >= NUM_OPENGL_CHUNKS)
     return "<unknown>";
   return GLChunkNames[idx - FIRST_CHUNK_ID];
@@ -2277,8 +2279,12 @@ void WrappedOpenGL::FreeTargetResource(ResourceId id)
 void WrappedOpenGL::SwapBuffers(void *windowHandle)
 {
   if(m_State == WRITING_IDLE)
+  {
     RenderDoc::Inst().Tick();
 
+    GetResourceManager()->SpillResourceChunks();
+  }
+
   // don't do anything if no context is active.
   if(GetCtx() == NULL)
   {
@@ -2541,8 +2547,14 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
     m_FailedFrame = 0;
     m_FailedReason = CaptureSucceeded;
 
-    ContextEndFrame();
-    FinishCapture();
+    {
+      SCOPED_CAPTURE_TIMER(EndCaptureFinishFrame);
+
+      ContextEndFrame();
+      FinishCapture();
+    }
+
+    PerformanceTimer thumbnailTimer;
 
     BackbufferImage *bbim = NULL;
 
@@ -2564,8 +2576,18 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
     if(bbim == NULL)
       bbim = SaveBackbufferImage();
 
+    CaptureStats::AddTime(CaptureTimer::EndCaptureThumbnail, thumbnailTimer.GetMilliseconds());
+
+    // the thumbnail is JPEG-encoded on a worker thread while the rest of the capture is serialised
     Serialiser *m_pFileSerialiser = RenderDoc::Inst().OpenWriteSerialiser(
-        m_FrameCounter, &m_InitParams, bbim->jpgbuf, bbim->len, bbim->thwidth, bbim->thheight);
+        this, m_FrameCounter, &m_InitParams, NULL, 0, 0, 0, &WrappedOpenGL::GetChunkName);
+
+    if(bbim->pixels)
+    {
+      RenderDoc::Inst().EncodeThumbnailAsync(m_pFileSerialiser, bbim->pixels, bbim->thwidth,
+                                             bbim->thheight);
+      bbim->pixels = NULL;
+    }
 
     SAFE_DELETE(bbim);
 
@@ -2599,28 +2621,26 @@ bool WrappedOpenGL::EndFrameCapture(void *dev, void *wnd)
     }
 
     {
+      SCOPED_CAPTURE_TIMER(EndCaptureFrameChunks);
+
       RDCDEBUG("Getting Resource Record");
 
       GLResourceRecord *record = m_ResourceManager->GetResourceRecord(m_ContextResourceID);
 
       RDCDEBUG("Accumulating context resource list");
 
-      map<int32_t, Chunk *> recordlist;
+      ChunkList recordlist;
       record->Insert(recordlist);
 
       RDCDEBUG("Flushing %u records to file serialiser", (uint32_t)recordlist.size());
 
-      for(auto it = recordlist.begin(); it != recordlist.end(); ++it)
-        m_pFileSerialiser->Insert(it->second);
+      m_pFileSerialiser->InsertSorted(recordlist);
 
       RDCDEBUG("Done");
     }
 
-    m_pFileSerialiser->FlushToDisk();
-
-    RenderDoc::Inst().SuccessfullyWrittenLog(m_FrameCounter);
-
-    SAFE_DELETE(m_pFileSerialiser);
+    RenderDoc::Inst().WriteCapture(m_pFileSerialiser, m_FrameCounter);
+    m_pFileSerialiser = NULL;
 
     m_State = WRITING_IDLE;
 
@@ -2819,33 +2839,11 @@ WrappedOpenGL::BackbufferImage *WrappedOpenGL::SaveBackbufferImage()
     }
   }
 
-  byte *jpgbuf = NULL;
-  int len = thwidth * thheight;
-
-  if(len > 0)
-  {
-    jpgbuf = new byte[len];
-
-    jpge::params p;
-    p.m_quality = 80;
-
-    bool success =
-        jpge::compress_image_to_jpeg_file_in_memory(jpgbuf, len, thwidth, thheight, 3, thpixels, p);
-
-    if(!success)
-    {
-      RDCERR("Failed to compress to jpg");
-      SAFE_DELETE_ARRAY(jpgbuf);
-      thwidth = 0;
-      thheight = 0;
-    }
-  }
-
-  SAFE_DELETE_ARRAY(thpixels);
+  if(thwidth == 0 || thheight == 0)
+    SAFE_DELETE_ARRAY(thpixels);
 
   BackbufferImage *bbim = new BackbufferImage();
-  bbim->jpgbuf = jpgbuf;
-  bbim->len = len;
+  bbim->pixels = thpixels;
   bbim->thwidth = thwidth;
   bbim->thheight = thheight;
 
@@ -3267,6 +3265,9 @@ void WrappedOpenGL::ReadLogInitialisation()
            m_pSerialiser->GetSize() - frameOffset);
 
   m_pSerialiser->SetDebugText(false);
+
+  // everything derived while loading has been added to the cache by now
+  m_ReplayCache.Save();
 }
 
 void WrappedOpenGL::ProcessChunk(uint64_t offset, GLChunkType context)
@@ -3713,7 +3714,7 @@ void WrappedOpenGL::ProcessChunk(uint64_t offset, GLChunkType context)
       // ignore system chunks
       if((int)context == (int)INITIAL_CONTENTS)
         GetResourceManager()->Serialise_InitialState(ResourceId(), GLResource(MakeNullResource));
-      else if((int)context < (int)FIRST_CHUNK_ID)
+      else if(IsSystemChunk(context))
         m_pSerialiser->SkipCurrentChunk();
       else
         RDCERR("Unrecognised Chunk type %d", context);
@@ -29,6 +29,7 @@
 #include "common/common.h"
 #include "common/timing.h"
 #include "core/core.h"
+#include "core/replay_cache.h"
 #include "driver/shaders/spirv/spirv_common.h"
 #include "replay/replay_driver.h"
 #include "gl_common.h"
@@ -292,15 +293,19 @@ private:
 
   struct ShaderData
   {
-    ShaderData() : type(eGL_NONE), prog(0) {}
+    ShaderData() : type(eGL_NONE), prog(0), disassembled(false) {}
     GLenum type;
     vector<string> sources;
     vector<string> includepaths;
-    SPVModule spirv;
     ShaderReflection reflection;
     GLuint prog;
 
+    // the disassembly needs a full compile to SPIR-V, so it's only generated when it's first
+    // requested rather than for every shader at load time.
+    bool disassembled;
+
     void Compile(WrappedOpenGL &gl);
+    void Disassemble();
   };
 
   struct ProgramData
@@ -334,6 +339,9 @@ private:
   };
 
   map<ResourceId, ShaderData> m_Shaders;
+
+  // only opened when replaying a capture
+  ReplayCache m_ReplayCache;
   map<ResourceId, ProgramData> m_Programs;
   map<ResourceId, PipelineData> m_Pipelines;
   vector<pair<ResourceId, Replacement> > m_DependentReplacements;
@@ -499,10 +507,10 @@ private:
 
   struct BackbufferImage
   {
-    BackbufferImage() : jpgbuf(NULL), len(0), thwidth(0), thheight(0) {}
-    ~BackbufferImage() { SAFE_DELETE_ARRAY(jpgbuf); }
-    byte *jpgbuf;
-    size_t len;
+    BackbufferImage() : pixels(NULL), thwidth(0), thheight(0) {}
+    ~BackbufferImage() { SAFE_DELETE_ARRAY(pixels); }
+    // tightly packed RGB8, JPEG-encoded by RenderDoc::EncodeThumbnailAsync
+    byte *pixels;
     uint32_t thwidth;
     uint32_t thheight;
   };
@@ -570,6 +578,10 @@ public:
 
   void StartFrameCapture(void *dev, void *wnd);
   bool EndFrameCapture(void *dev, void *wnd);
+  void GetRecordMemoryUsage(std::map<std::string, CaptureStats::Counter> &usage)
+  {
+    GetResourceManager()->GetRecordMemoryUsage(usage);
+  }
 
   IMPLEMENT_FUNCTION_SERIALISED(void, glBindTexture(GLenum target, GLuint texture));
   IMPLEMENT_FUNCTION_SERIALISED(void,
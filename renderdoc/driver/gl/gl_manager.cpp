@@ -280,6 +280,28 @@ bool GLResourceManager::Need_InitialStateChunk(GLResource res)
   return true;
 }
 
+std::string GLResourceManager::GetResourceTypeName(GLResource res)
+{
+  switch(res.Namespace)
+  {
+    case eResTexture: return "Texture";
+    case eResSampler: return "Sampler";
+    case eResFramebuffer: return "Framebuffer";
+    case eResRenderbuffer: return "Renderbuffer";
+    case eResBuffer: return "Buffer";
+    case eResVertexArray: return "Vertex Array";
+    case eResShader: return "Shader";
+    case eResProgram: return "Program";
+    case eResProgramPipe: return "Program Pipeline";
+    case eResFeedback: return "Transform Feedback";
+    case eResQuery: return "Query";
+    case eResSync: return "Sync";
+    default: break;
+  }
+
+  return "Resource";
+}
+
 bool GLResourceManager::Prepare_InitialState(GLResource res, byte *blob)
 {
   const GLHookSet &gl = m_State < WRITING ? m_GL->GetHookset() : m_GL->GetInternalHookset();
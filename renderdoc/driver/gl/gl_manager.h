@@ -224,6 +224,7 @@ private:
 
   void Create_InitialState(ResourceId id, GLResource live, bool hasData);
   void Apply_InitialState(GLResource live, InitialContentData initial);
+  std::string GetResourceTypeName(GLResource res);
 
   map<GLResource, GLResourceRecord *> m_GLResourceRecords;
 
@@ -114,6 +114,11 @@ FrameRecord GLReplay::GetFrameRecord()
   return m_pDriver->GetFrameRecord();
 }
 
+ReplayCache *GLReplay::GetReplayCache()
+{
+  return &m_pDriver->m_ReplayCache;
+}
+
 ResourceId GLReplay::GetLiveID(ResourceId id)
 {
   return m_pDriver->GetResourceManager()->GetLiveID(id);
@@ -400,6 +405,28 @@ void GLReplay::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, vec
 
   ret.resize((size_t)len);
 
+  GetBufferDataInto(buff, offset, len, &ret[0]);
+}
+
+uint64_t GLReplay::GetBufferDataInto(ResourceId buff, uint64_t offset, uint64_t len, byte *dest)
+{
+  auto it = m_pDriver->m_Buffers.find(buff);
+  if(it == m_pDriver->m_Buffers.end())
+  {
+    RDCWARN("Requesting data for non-existant buffer %llu", buff);
+    return 0;
+  }
+
+  auto &buf = it->second;
+
+  if(offset >= buf.size)
+    return 0;
+
+  len = RDCMIN(len, buf.size - offset);
+
+  if(len == 0)
+    return 0;
+
   WrappedOpenGL &gl = *m_pDriver;
 
   GLuint oldbuf = 0;
@@ -407,9 +434,11 @@ void GLReplay::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, vec
 
   gl.glBindBuffer(eGL_COPY_READ_BUFFER, buf.resource.name);
 
-  gl.glGetBufferSubData(eGL_COPY_READ_BUFFER, (GLintptr)offset, (GLsizeiptr)len, &ret[0]);
+  gl.glGetBufferSubData(eGL_COPY_READ_BUFFER, (GLintptr)offset, (GLsizeiptr)len, dest);
 
   gl.glBindBuffer(eGL_COPY_READ_BUFFER, oldbuf);
+
+  return len;
 }
 
 bool GLReplay::IsRenderOutput(ResourceId id)
@@ -837,6 +866,9 @@ ShaderReflection *GLReplay::GetShader(ResourceId shader, string entryPoint)
     return NULL;
   }
 
+  if(!shaderDetails.disassembled)
+    shaderDetails.Disassemble();
+
   return &shaderDetails.reflection;
 }
 
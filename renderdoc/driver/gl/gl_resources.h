@@ -234,17 +234,15 @@ struct GLResourceRecord : public ResourceRecord
   void FilterChunks(const ChunkFilter &filter)
   {
     LockChunks();
-    std::vector<std::map<int32_t, Chunk *>::iterator> deletions;
-    for(auto it = m_Chunks.begin(); it != m_Chunks.end(); ++it)
+    size_t kept = 0;
+    for(size_t i = 0; i < m_Chunks.size(); i++)
     {
-      if(filter(it->second))
-        deletions.push_back(it);
-    }
-    for(size_t i = 0; i < deletions.size(); i++)
-    {
-      SAFE_DELETE(deletions[i]->second);
-      m_Chunks.erase(deletions[i]);
+      if(filter(m_Chunks[i].second))
+        SAFE_DELETE(m_Chunks[i].second);
+      else
+        m_Chunks[kept++] = m_Chunks[i];
     }
+    m_Chunks.resize(kept);
     UnlockChunks();
   }
 
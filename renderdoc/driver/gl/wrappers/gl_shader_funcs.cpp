@@ -69,16 +69,41 @@ void WrappedOpenGL::ShaderData::Compile(WrappedOpenGL &gl)
   else
   {
     prog = sepProg;
-    MakeShaderReflection(gl.GetHookset(), type, sepProg, reflection, pointSizeUsed, clipDistanceUsed);
 
-    vector<uint32_t> spirvwords;
+    // the separable program is always needed for replay, so a cache hit only saves the program
+    // introspection below. Disassembly is generated on demand and isn't part of this.
+    // The reflection depends on the shader's type and source, and on the driver that compiled it
+    uint64_t key = Hash64(&type, sizeof(type));
+    for(size_t i = 0; i < sources.size(); i++)
+      key = Hash64(sources[i].c_str(), sources[i].size(), key);
+
+    const char *driverStrings[] = {
+        (const char *)gl.GetHookset().glGetString(eGL_VENDOR),
+        (const char *)gl.GetHookset().glGetString(eGL_RENDERER),
+        (const char *)gl.GetHookset().glGetString(eGL_VERSION),
+    };
+    for(const char *str : driverStrings)
+      if(str)
+        key = Hash64(str, strlen(str), key);
+
+    const byte *data = NULL;
+    uint64_t size = 0;
+
+    if(gl.m_ReplayCache.Find(key, data, size))
+    {
+      Serialiser ser((size_t)size, data, false);
 
-    string s = CompileSPIRV(SPIRVShaderStage(ShaderIdx(type)), sources, spirvwords);
-    if(!spirvwords.empty())
-      ParseSPIRV(&spirvwords.front(), spirvwords.size(), spirv);
+      ShaderReflection cached;
+      ser.Serialise("", cached);
 
-    // for classic GL, entry point is always main
-    reflection.Disassembly = spirv.Disassemble("main");
+      if(!ser.HasError())
+      {
+        reflection = cached;
+        return;
+      }
+    }
+
+    MakeShaderReflection(gl.GetHookset(), type, sepProg, reflection, pointSizeUsed, clipDistanceUsed);
 
     create_array_uninit(reflection.DebugInfo.files, sources.size());
     for(size_t i = 0; i < sources.size(); i++)
@@ -86,9 +111,36 @@ void WrappedOpenGL::ShaderData::Compile(WrappedOpenGL &gl)
       reflection.DebugInfo.files[i].first = StringFormat::Fmt("source%u.glsl", (uint32_t)i);
       reflection.DebugInfo.files[i].second = sources[i];
     }
+
+    if(gl.m_ReplayCache.IsOpen())
+    {
+      Serialiser ser(NULL, Serialiser::WRITING, false);
+      ser.Serialise("", reflection);
+      gl.m_ReplayCache.Add(key, ser.GetRawPtr(0), ser.GetOffset());
+    }
   }
 }
 
+void WrappedOpenGL::ShaderData::Disassemble()
+{
+  disassembled = true;
+
+  // don't leave a previous source's disassembly behind if this compile fails
+  reflection.Disassembly = "";
+
+  vector<uint32_t> spirvwords;
+
+  string s = CompileSPIRV(SPIRVShaderStage(ShaderIdx(type)), sources, spirvwords);
+  if(spirvwords.empty())
+    return;
+
+  SPVModule spirv;
+  ParseSPIRV(&spirvwords.front(), spirvwords.size(), spirv);
+
+  // for classic GL, entry point is always main
+  reflection.Disassembly = spirv.Disassemble("main");
+}
+
 #pragma region Shaders
 
 bool WrappedOpenGL::Serialise_glCreateShader(GLuint shader, GLenum type)
@@ -194,7 +246,7 @@ bool WrappedOpenGL::Serialise_glShaderSource(GLuint shader, GLsizei count,
     {
       m_Real.glDeleteProgram(m_Shaders[liveId].prog);
       m_Shaders[liveId].prog = 0;
-      m_Shaders[liveId].spirv = SPVModule();
+      m_Shaders[liveId].disassembled = false;
       m_Shaders[liveId].reflection = ShaderReflection();
     }
 
@@ -87,10 +87,33 @@ struct SPVModule
   SPVInstruction *GetByID(uint32_t id);
   string Disassemble(const string &entryPoint);
 
+  // disassembly of each function, generated the first time it's needed. Disassembling annotates
+  // the instructions (inlining, line numbers) so must only happen once per function anyway.
+  vector<string> disassembledFuncs;
+
+  string DisassembleFunction(size_t f);
+  vector<bool> GetReachableFunctions(const string &entryPoint);
+
   void MakeReflection(ShaderStage stage, const string &entryPoint, ShaderReflection *reflection,
                       ShaderBindpointMapping *mapping);
 };
 
 string CompileSPIRV(SPIRVShaderStage shadType, const vector<string> &sources,
                     vector<uint32_t> &spirv);
+
+struct SPIRVCompilation
+{
+  SPIRVCompilation() : stage(eSPIRVInvalid) {}
+  SPIRVCompilation(SPIRVShaderStage s, const vector<string> &src) : stage(s), sources(src) {}
+  SPIRVShaderStage stage;
+  vector<string> sources;
+
+  // filled out as by CompileSPIRV
+  vector<uint32_t> spirv;
+  string errors;
+};
+
+// compiles each shader as with CompileSPIRV, spread across several threads. glslang keeps its
+// compilation state per-thread so independent shaders can be compiled concurrently.
+void CompileSPIRVParallel(vector<SPIRVCompilation *> &compiles);
 void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module);
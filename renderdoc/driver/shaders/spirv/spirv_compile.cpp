@@ -206,3 +206,62 @@ string CompileSPIRV(SPIRVShaderStage shadType, const std::vector<std::string> &s
 
   return errors;
 }
+
+struct SPIRVCompileWork
+{
+  vector<SPIRVCompilation *> *compiles;
+  volatile int32_t next;
+};
+
+// each thread that compiles keeps a small glslang pool allocator alive afterwards, as glslang's
+// DetachThread isn't safe to call here, so keep the number of threads bounded.
+static const size_t MaxSPIRVCompileThreads = 8;
+
+static void SPIRVCompileThread(void *data)
+{
+  SPIRVCompileWork *work = (SPIRVCompileWork *)data;
+
+  const int32_t numCompiles = (int32_t)work->compiles->size();
+
+  for(;;)
+  {
+    int32_t idx = Atomic::Inc32(&work->next) - 1;
+
+    if(idx >= numCompiles)
+      break;
+
+    SPIRVCompilation *c = work->compiles->at(idx);
+    c->errors = CompileSPIRV(c->stage, c->sources, c->spirv);
+  }
+}
+
+void CompileSPIRVParallel(vector<SPIRVCompilation *> &compiles)
+{
+  if(compiles.empty())
+    return;
+
+  // not worth spinning up threads for a single shader
+  if(compiles.size() == 1)
+  {
+    SPIRVCompilation *c = compiles[0];
+    c->errors = CompileSPIRV(c->stage, c->sources, c->spirv);
+    return;
+  }
+
+  SPIRVCompileWork work;
+  work.compiles = &compiles;
+  work.next = 0;
+
+  size_t numThreads = RDCMIN(compiles.size(), MaxSPIRVCompileThreads);
+
+  vector<Threading::ThreadHandle> threads;
+  for(size_t i = 0; i < numThreads; i++)
+    threads.push_back(Threading::CreateThread(&SPIRVCompileThread, &work));
+
+  for(size_t i = 0; i < threads.size(); i++)
+  {
+    Threading::JoinThread(threads[i]);
+    Threading::CloseThread(threads[i]);
+  }
+}
+
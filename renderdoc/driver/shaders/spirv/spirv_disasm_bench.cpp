@@ -0,0 +1,151 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+// standalone tool to time SPIR-V parsing and disassembly over a directory of .spv files. Built
+// with -DENABLE_SPIRV_DISASM_BENCH=ON, run as:
+//
+//   spirv-disasm-bench <directory> [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "common/common.h"
+#include "common/timing.h"
+#include "os/os_specific.h"
+#include "spirv_common.h"
+
+static bool ReadSPIRV(const string &path, vector<uint32_t> &spirv)
+{
+  FILE *f = FileIO::fopen(path.c_str(), "rb");
+
+  if(f == NULL)
+    return false;
+
+  FileIO::fseek64(f, 0, SEEK_END);
+  uint64_t size = FileIO::ftell64(f);
+  FileIO::fseek64(f, 0, SEEK_SET);
+
+  spirv.resize(size_t(size / sizeof(uint32_t)));
+
+  bool ret = FileIO::fread(&spirv[0], sizeof(uint32_t), spirv.size(), f) == spirv.size();
+
+  FileIO::fclose(f);
+
+  // must at least have a header, and start with the magic number
+  return ret && spirv.size() > 5 && spirv[0] == spv::MagicNumber;
+}
+
+// SPVInstruction is private to the disassembler, so find the first entry point name directly
+static string GetFirstEntryPoint(const vector<uint32_t> &spirv)
+{
+  size_t it = 5;
+  while(it < spirv.size())
+  {
+    uint32_t WordCount = spirv[it] >> spv::WordCountShift;
+
+    if(WordCount == 0 || it + WordCount > spirv.size())
+      break;
+
+    if(spv::Op(spirv[it] & spv::OpCodeMask) == spv::OpEntryPoint && WordCount > 3)
+      return string((const char *)&spirv[it + 3], (WordCount - 3) * sizeof(uint32_t)).c_str();
+
+    it += WordCount;
+  }
+
+  return "";
+}
+
+int main(int argc, char **argv)
+{
+  if(argc < 2)
+  {
+    fprintf(stderr, "Usage: %s <directory of .spv files> [iterations]\n", argv[0]);
+    return 1;
+  }
+
+  string dir = argv[1];
+  int iterations = argc > 2 ? RDCMAX(1, atoi(argv[2])) : 1;
+
+  std::vector<PathEntry> files = FileIO::GetFilesInDirectory(dir.c_str());
+
+  double totalParse = 0.0, totalFirst = 0.0, totalRepeat = 0.0;
+  uint32_t numModules = 0;
+
+  printf("%-40s %10s %12s %12s %12s\n", "file", "words", "parse (ms)", "first (ms)",
+         "repeat (ms)");
+
+  for(size_t i = 0; i < files.size(); i++)
+  {
+    string name = files[i].filename.elems;
+
+    if(name.size() < 4 || name.substr(name.size() - 4) != ".spv")
+      continue;
+
+    vector<uint32_t> spirv;
+    if(!ReadSPIRV(dir + "/" + name, spirv))
+    {
+      fprintf(stderr, "Skipping '%s', not a SPIR-V module\n", name.c_str());
+      continue;
+    }
+
+    double parse = 0.0, first = 0.0, repeat = 0.0;
+
+    for(int iter = 0; iter < iterations; iter++)
+    {
+      SPVModule module;
+
+      PerformanceTimer timer;
+      ParseSPIRV(&spirv[0], spirv.size(), module);
+      parse += timer.GetMilliseconds();
+
+      // the first disassembly of each entry point does the work, later ones should only rebuild
+      // the module header
+      string entry = GetFirstEntryPoint(spirv);
+
+      timer.Restart();
+      module.Disassemble(entry);
+      first += timer.GetMilliseconds();
+
+      timer.Restart();
+      module.Disassemble(entry);
+      repeat += timer.GetMilliseconds();
+    }
+
+    parse /= iterations;
+    first /= iterations;
+    repeat /= iterations;
+
+    printf("%-40s %10u %12.3f %12.3f %12.3f\n", name.c_str(), (uint32_t)spirv.size(), parse, first,
+           repeat);
+
+    totalParse += parse;
+    totalFirst += first;
+    totalRepeat += repeat;
+    numModules++;
+  }
+
+  printf("\n%u modules: parse %.3f ms, first disassembly %.3f ms, repeat disassembly %.3f ms\n",
+         numModules, totalParse, totalFirst, totalRepeat);
+
+  return 0;
+}
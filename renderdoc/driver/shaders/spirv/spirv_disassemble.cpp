@@ -2117,18 +2117,32 @@ SPVModule::~SPVModule()
 
 SPVInstruction *SPVModule::GetByID(uint32_t id)
 {
-  if(ids[id])
+  // IDs must be under the bound in the header. Don't grow the table for invalid IDs, just hand
+  // back a dummy instruction that isn't tracked by ID
+  bool valid = id < ids.size();
+
+  if(valid && ids[id])
     return ids[id];
 
-  // if there's an unrecognised instruction (e.g. from an extension) that generates
-  // an ID, it won't be in our list so we have to add a dummy instruction for it
-  RDCWARN("Expected to find ID %u but didn't - returning dummy instruction", id);
+  if(valid)
+  {
+    // if there's an unrecognised instruction (e.g. from an extension) that generates
+    // an ID, it won't be in our list so we have to add a dummy instruction for it
+    RDCWARN("Expected to find ID %u but didn't - returning dummy instruction", id);
+  }
+  else
+  {
+    RDCERR("ID %u is beyond the module's ID bound %u - returning dummy instruction", id,
+           (uint32_t)ids.size());
+  }
 
   operations.push_back(new SPVInstruction());
   SPVInstruction &op = *operations.back();
   op.opcode = spv::OpUnknown;
   op.id = id;
-  ids[id] = &op;
+
+  if(valid)
+    ids[id] = &op;
 
   return &op;
 }
@@ -2158,11 +2172,65 @@ void FindFirstInstructionUse(SPVInstruction *op, SPVInstruction *search, SPVInst
   }
 }
 
+vector<bool> SPVModule::GetReachableFunctions(const string &entryPoint)
+{
+  // if we can't find the entry point, fall back to everything
+  vector<bool> ret(funcs.size(), true);
+
+  uint32_t entryFunc = 0;
+  for(size_t i = 0; i < entries.size(); i++)
+    if(entries[i]->entry->name == entryPoint)
+      entryFunc = entries[i]->entry->func;
+
+  if(entryFunc == 0)
+    return ret;
+
+  map<uint32_t, size_t> funcIndex;
+  for(size_t f = 0; f < funcs.size(); f++)
+    funcIndex[funcs[f]->id] = f;
+
+  auto it = funcIndex.find(entryFunc);
+  if(it == funcIndex.end())
+    return ret;
+
+  ret.assign(funcs.size(), false);
+
+  vector<size_t> pending;
+  pending.push_back(it->second);
+  ret[it->second] = true;
+
+  while(!pending.empty())
+  {
+    SPVFunction *func = funcs[pending.back()]->func;
+    pending.pop_back();
+
+    for(size_t b = 0; b < func->blocks.size(); b++)
+    {
+      const vector<SPVInstruction *> &instrs = func->blocks[b]->block->instructions;
+
+      for(size_t i = 0; i < instrs.size(); i++)
+      {
+        if(instrs[i]->opcode != spv::OpFunctionCall)
+          continue;
+
+        it = funcIndex.find(instrs[i]->op->funcCall);
+        if(it != funcIndex.end() && !ret[it->second])
+        {
+          ret[it->second] = true;
+          pending.push_back(it->second);
+        }
+      }
+    }
+  }
+
+  return ret;
+}
+
 string SPVModule::Disassemble(const string &entryPoint)
 {
   string retDisasm = "";
 
-  // TODO filter to only functions/resources used by entryPoint
+  // TODO filter to only resources used by entryPoint
 
   retDisasm = StringFormat::Fmt("SPIR-V %u.%u:\n\n", moduleVersion.major, moduleVersion.minor);
 
@@ -2337,1022 +2405,995 @@ string SPVModule::Disassemble(const string &entryPoint)
 
   retDisasm += "\n";
 
+  // only disassemble the functions that the entry point can reach. Each function's disassembly
+  // is cached, so switching between entry points or re-opening a shader is free.
+  vector<bool> reachable = GetReachableFunctions(entryPoint);
+
+  if(disassembledFuncs.size() < funcs.size())
+    disassembledFuncs.resize(funcs.size());
+
   for(size_t f = 0; f < funcs.size(); f++)
   {
-    SPVFunction *func = funcs[f]->func;
-    RDCASSERT(func && func->retType && func->funcType);
+    if(!reachable[f])
+      continue;
 
-    string args = "";
+    if(disassembledFuncs[f].empty())
+      disassembledFuncs[f] = DisassembleFunction(f);
 
-    for(size_t a = 0; a < func->funcType->children.size(); a++)
-    {
-      const pair<SPVTypeData *, string> &arg = func->funcType->children[a];
-      RDCASSERT(a < func->arguments.size());
-      const SPVInstruction *argname = func->arguments[a];
+    retDisasm += disassembledFuncs[f];
+  }
 
-      if(argname->str.empty())
-        args += arg.first->GetName();
-      else
-        args += StringFormat::Fmt("%s %s", arg.first->GetName().c_str(), argname->str.c_str());
+  return retDisasm;
+}
 
-      if(a + 1 < func->funcType->children.size())
-        args += ", ";
-    }
+string SPVModule::DisassembleFunction(size_t f)
+{
+  string retDisasm;
 
-    retDisasm += StringFormat::Fmt("%s %s(%s)%s {\n", func->retType->GetName().c_str(),
-                                   funcs[f]->str.c_str(), args.c_str(),
-                                   OptionalFlagString(func->control).c_str());
+  SPVFunction *func = funcs[f]->func;
+  RDCASSERT(func && func->retType && func->funcType);
 
-    // local copy of variables vector
-    vector<SPVInstruction *> vars = func->variables;
-    vector<SPVInstruction *> funcops;
+  string args = "";
 
-    for(size_t b = 0; b < func->blocks.size(); b++)
-    {
-      SPVInstruction *block = func->blocks[b];
+  for(size_t a = 0; a < func->funcType->children.size(); a++)
+  {
+    const pair<SPVTypeData *, string> &arg = func->funcType->children[a];
+    RDCASSERT(a < func->arguments.size());
+    const SPVInstruction *argname = func->arguments[a];
 
-      // don't push first label in a function
-      if(b > 0)
-        funcops.push_back(block);    // OpLabel
+    if(argname->str.empty())
+      args += arg.first->GetName();
+    else
+      args += StringFormat::Fmt("%s %s", arg.first->GetName().c_str(), argname->str.c_str());
 
-      set<SPVInstruction *> ignore_items;
+    if(a + 1 < func->funcType->children.size())
+      args += ", ";
+  }
 
-      for(size_t i = 0; i < block->block->instructions.size(); i++)
-      {
-        SPVInstruction *instr = block->block->instructions[i];
+  retDisasm += StringFormat::Fmt("%s %s(%s)%s {\n", func->retType->GetName().c_str(),
+                                 funcs[f]->str.c_str(), args.c_str(),
+                                 OptionalFlagString(func->control).c_str());
 
-        if(ignore_items.find(instr) == ignore_items.end())
-          funcops.push_back(instr);
+  // local copy of variables vector
+  vector<SPVInstruction *> vars = func->variables;
+  vector<SPVInstruction *> funcops;
 
-        // we can't inline the arguments to an OpPhi
-        if(instr->op && instr->opcode != spv::OpPhi)
+  for(size_t b = 0; b < func->blocks.size(); b++)
+  {
+    SPVInstruction *block = func->blocks[b];
+
+    // don't push first label in a function
+    if(b > 0)
+      funcops.push_back(block);    // OpLabel
+
+    set<SPVInstruction *> ignore_items;
+
+    for(size_t i = 0; i < block->block->instructions.size(); i++)
+    {
+      SPVInstruction *instr = block->block->instructions[i];
+
+      if(ignore_items.find(instr) == ignore_items.end())
+        funcops.push_back(instr);
+
+      // we can't inline the arguments to an OpPhi
+      if(instr->op && instr->opcode != spv::OpPhi)
+      {
+        int maxcomplex = instr->op->complexity;
+
+        for(size_t a = 0; a < instr->op->arguments.size(); a++)
         {
-          int maxcomplex = instr->op->complexity;
+          SPVInstruction *arg = instr->op->arguments[a];
 
-          for(size_t a = 0; a < instr->op->arguments.size(); a++)
+          if(arg->op)
           {
-            SPVInstruction *arg = instr->op->arguments[a];
+            // allow less inlining in composite constructs
+            int maxAllowedComplexity = NO_INLINE_COMPLEXITY;
+            if(instr->opcode == spv::OpCompositeConstruct)
+              maxAllowedComplexity = RDCMIN(NO_INLINE_COMPLEXITY - 1, maxAllowedComplexity);
+
+            // don't fold up too complex an operation
+            // allow some ops to have multiple arguments, others with many
+            // arguments should not be inlined
+            if(arg->op->complexity >= maxAllowedComplexity ||
+               (arg->op->arguments.size() > 2 && arg->opcode != spv::OpAccessChain &&
+                arg->opcode != spv::OpArrayLength && arg->opcode != spv::OpInBoundsAccessChain &&
+                arg->opcode != spv::OpSelect && arg->opcode != spv::OpCompositeConstruct))
+              continue;
 
-            if(arg->op)
+            // for anything but store's dest argument
+            if(instr->opcode != spv::OpStore || a > 0)
             {
-              // allow less inlining in composite constructs
-              int maxAllowedComplexity = NO_INLINE_COMPLEXITY;
-              if(instr->opcode == spv::OpCompositeConstruct)
-                maxAllowedComplexity = RDCMIN(NO_INLINE_COMPLEXITY - 1, maxAllowedComplexity);
-
-              // don't fold up too complex an operation
-              // allow some ops to have multiple arguments, others with many
-              // arguments should not be inlined
-              if(arg->op->complexity >= maxAllowedComplexity ||
-                 (arg->op->arguments.size() > 2 && arg->opcode != spv::OpAccessChain &&
-                  arg->opcode != spv::OpArrayLength && arg->opcode != spv::OpInBoundsAccessChain &&
-                  arg->opcode != spv::OpSelect && arg->opcode != spv::OpCompositeConstruct))
+              // Do not inline this argument if it relies on a load from a
+              // variable that is written to between the argument and this
+              // op that we're inlining into, as that changes the meaning.
+              if(!IsUnmodified(func, arg, instr))
                 continue;
+            }
 
-              // for anything but store's dest argument
-              if(instr->opcode != spv::OpStore || a > 0)
-              {
-                // Do not inline this argument if it relies on a load from a
-                // variable that is written to between the argument and this
-                // op that we're inlining into, as that changes the meaning.
-                if(!IsUnmodified(func, arg, instr))
-                  continue;
-              }
+            maxcomplex = RDCMAX(arg->op->complexity, maxcomplex);
+          }
 
-              maxcomplex = RDCMAX(arg->op->complexity, maxcomplex);
-            }
+          erase_item(funcops, arg);
 
-            erase_item(funcops, arg);
+          instr->op->inlineArgs |= (1 << a);
+        }
 
-            instr->op->inlineArgs |= (1 << a);
-          }
+        instr->op->complexity = maxcomplex;
+
+        if(instr->opcode != spv::OpStore && instr->opcode != spv::OpLoad &&
+           instr->opcode != spv::OpCompositeExtract && instr->op->inlineArgs)
+          instr->op->complexity++;
+
+        // we try to merge away temp variables that are only used for a single store then a single
+        // load later. We can only do this if:
+        //  - The Load we're looking is the only load in this function of the variable
+        //  - The Load is preceeded by precisely one Store - not 0 or 2+
+        //  - The previous store is 'pure', ie. does not depend on any mutated variables
+        //    so it is safe to re-order to where the Load is.
+        //  - The variable in question is a function variable
+        //
+        // If those conditions are met then we can remove the previous store, inline it as the
+        // load
+        // function argument (instead of the variable), and remove the variable.
+
+        if(instr->opcode == spv::OpLoad && funcops.size() > 1 && instr->op->arguments[0]->var &&
+           instr->op->arguments[0]->var->storage == spv::StorageClassFunction)
+        {
+          SPVInstruction *prevstore = NULL;
+          int storecount = 0;
 
-          instr->op->complexity = maxcomplex;
-
-          if(instr->opcode != spv::OpStore && instr->opcode != spv::OpLoad &&
-             instr->opcode != spv::OpCompositeExtract && instr->op->inlineArgs)
-            instr->op->complexity++;
-
-          // we try to merge away temp variables that are only used for a single store then a single
-          // load later. We can only do this if:
-          //  - The Load we're looking is the only load in this function of the variable
-          //  - The Load is preceeded by precisely one Store - not 0 or 2+
-          //  - The previous store is 'pure', ie. does not depend on any mutated variables
-          //    so it is safe to re-order to where the Load is.
-          //  - The variable in question is a function variable
-          //
-          // If those conditions are met then we can remove the previous store, inline it as the
-          // load
-          // function argument (instead of the variable), and remove the variable.
-
-          if(instr->opcode == spv::OpLoad && funcops.size() > 1 && instr->op->arguments[0]->var &&
-             instr->op->arguments[0]->var->storage == spv::StorageClassFunction)
+          for(size_t o = 0; o < funcops.size(); o++)
           {
-            SPVInstruction *prevstore = NULL;
-            int storecount = 0;
-
-            for(size_t o = 0; o < funcops.size(); o++)
+            SPVInstruction *previnstr = funcops[o];
+            if(previnstr->opcode == spv::OpStore &&
+               previnstr->op->arguments[0] == instr->op->arguments[0])
             {
-              SPVInstruction *previnstr = funcops[o];
-              if(previnstr->opcode == spv::OpStore &&
-                 previnstr->op->arguments[0] == instr->op->arguments[0])
-              {
-                prevstore = previnstr;
-                storecount++;
-                if(storecount > 1)
-                  break;
-              }
+              prevstore = previnstr;
+              storecount++;
+              if(storecount > 1)
+                break;
             }
+          }
 
-            if(storecount == 1 && IsUnmodified(func, prevstore, instr))
+          if(storecount == 1 && IsUnmodified(func, prevstore, instr))
+          {
+            bool otherload = false;
+
+            // note variables have function scope, need to check all blocks in this function
+            for(size_t o = 0; o < func->blocks.size(); o++)
             {
-              bool otherload = false;
+              SPVInstruction *otherblock = func->blocks[o];
 
-              // note variables have function scope, need to check all blocks in this function
-              for(size_t o = 0; o < func->blocks.size(); o++)
+              for(size_t l = 0; l < otherblock->block->instructions.size(); l++)
               {
-                SPVInstruction *otherblock = func->blocks[o];
-
-                for(size_t l = 0; l < otherblock->block->instructions.size(); l++)
+                SPVInstruction *otherinstr = otherblock->block->instructions[l];
+                if(otherinstr != instr && otherinstr->opcode == spv::OpLoad &&
+                   otherinstr->op->arguments[0] == instr->op->arguments[0])
                 {
-                  SPVInstruction *otherinstr = otherblock->block->instructions[l];
-                  if(otherinstr != instr && otherinstr->opcode == spv::OpLoad &&
-                     otherinstr->op->arguments[0] == instr->op->arguments[0])
-                  {
-                    otherload = true;
-                    break;
-                  }
+                  otherload = true;
+                  break;
                 }
               }
+            }
 
-              if(!otherload)
-              {
-                instr->op->complexity = RDCMAX(instr->op->complexity, prevstore->op->complexity);
-                erase_item(vars, instr->op->arguments[0]);
-                erase_item(funcops, prevstore);
-                instr->op->arguments[0] = prevstore;
-              }
+            if(!otherload)
+            {
+              instr->op->complexity = RDCMAX(instr->op->complexity, prevstore->op->complexity);
+              erase_item(vars, instr->op->arguments[0]);
+              erase_item(funcops, prevstore);
+              instr->op->arguments[0] = prevstore;
             }
           }
+        }
 
-          // if we have a store from a temp ID, immediately following the op
-          // that produced that temp ID, we can combine these trivially
-          if((instr->opcode == spv::OpStore || instr->opcode == spv::OpCompositeInsert) &&
-             funcops.size() > 1)
+        // if we have a store from a temp ID, immediately following the op
+        // that produced that temp ID, we can combine these trivially
+        if((instr->opcode == spv::OpStore || instr->opcode == spv::OpCompositeInsert) &&
+           funcops.size() > 1)
+        {
+          if(instr->op->arguments[1] == funcops[funcops.size() - 2])
           {
-            if(instr->op->arguments[1] == funcops[funcops.size() - 2])
-            {
-              erase_item(funcops, instr->op->arguments[1]);
-              if(instr->op->arguments[1]->op)
-                instr->op->complexity =
-                    RDCMAX(instr->op->complexity, instr->op->arguments[1]->op->complexity);
-              instr->op->inlineArgs |= 2;
-            }
+            erase_item(funcops, instr->op->arguments[1]);
+            if(instr->op->arguments[1]->op)
+              instr->op->complexity =
+                  RDCMAX(instr->op->complexity, instr->op->arguments[1]->op->complexity);
+            instr->op->inlineArgs |= 2;
           }
+        }
 
-          // special handling for function call to inline temporary pointer variables
-          // created for passing parameters
-          if(instr->opcode == spv::OpFunctionCall)
+        // special handling for function call to inline temporary pointer variables
+        // created for passing parameters
+        if(instr->opcode == spv::OpFunctionCall)
+        {
+          for(size_t a = 0; a < instr->op->arguments.size(); a++)
           {
-            for(size_t a = 0; a < instr->op->arguments.size(); a++)
+            SPVInstruction *arg = instr->op->arguments[a];
+
+            // if this argument has
+            //  - only one usage as a store target before the function call
+            //  = then it's an in parameter, and we can fold it in.
+            //
+            //  - only one usage as a load target after the function call
+            //  = then it's an out parameter, we can fold it in as long as
+            //    the usage after is in a Store(a) = Load(param) case
+            //
+            //  - exactly one usage as store before, and load after, such that
+            //    it is Store(param) = Load(a) .... Store(a) = Load(param)
+            //  = then it's an inout parameter, and we can fold it in
+
+            bool canReplace = true;
+            SPVInstruction *storeBefore = NULL;
+            SPVInstruction *loadAfter = NULL;
+            size_t storeIdx = block->block->instructions.size();
+            size_t loadIdx = block->block->instructions.size();
+
+            for(size_t j = 0; j < i; j++)
             {
-              SPVInstruction *arg = instr->op->arguments[a];
-
-              // if this argument has
-              //  - only one usage as a store target before the function call
-              //  = then it's an in parameter, and we can fold it in.
-              //
-              //  - only one usage as a load target after the function call
-              //  = then it's an out parameter, we can fold it in as long as
-              //    the usage after is in a Store(a) = Load(param) case
-              //
-              //  - exactly one usage as store before, and load after, such that
-              //    it is Store(param) = Load(a) .... Store(a) = Load(param)
-              //  = then it's an inout parameter, and we can fold it in
-
-              bool canReplace = true;
-              SPVInstruction *storeBefore = NULL;
-              SPVInstruction *loadAfter = NULL;
-              size_t storeIdx = block->block->instructions.size();
-              size_t loadIdx = block->block->instructions.size();
-
-              for(size_t j = 0; j < i; j++)
+              SPVInstruction *searchInst = block->block->instructions[j];
+              for(size_t aa = 0; searchInst->op && aa < searchInst->op->arguments.size(); aa++)
               {
-                SPVInstruction *searchInst = block->block->instructions[j];
-                for(size_t aa = 0; searchInst->op && aa < searchInst->op->arguments.size(); aa++)
+                if(searchInst->op->arguments[aa]->id == arg->id)
                 {
-                  if(searchInst->op->arguments[aa]->id == arg->id)
+                  if(searchInst->opcode == spv::OpStore)
                   {
-                    if(searchInst->opcode == spv::OpStore)
+                    // if it's used in multiple stores, it can't be folded
+                    if(storeBefore)
                     {
-                      // if it's used in multiple stores, it can't be folded
-                      if(storeBefore)
-                      {
-                        canReplace = false;
-                        break;
-                      }
-                      storeBefore = searchInst;
-                      storeIdx = j;
-                    }
-                    else
-                    {
-                      // if it's used in anything but a store, it can't be folded
                       canReplace = false;
                       break;
                     }
+                    storeBefore = searchInst;
+                    storeIdx = j;
+                  }
+                  else
+                  {
+                    // if it's used in anything but a store, it can't be folded
+                    canReplace = false;
+                    break;
                   }
                 }
+              }
 
-                // if it's used in a condition, it can't be folded
-                if(searchInst->flow && searchInst->flow->condition &&
-                   searchInst->flow->condition->id == arg->id)
-                  canReplace = false;
+              // if it's used in a condition, it can't be folded
+              if(searchInst->flow && searchInst->flow->condition &&
+                 searchInst->flow->condition->id == arg->id)
+                canReplace = false;
 
-                if(!canReplace)
-                  break;
-              }
+              if(!canReplace)
+                break;
+            }
 
-              for(size_t j = i + 1; j < block->block->instructions.size(); j++)
+            for(size_t j = i + 1; j < block->block->instructions.size(); j++)
+            {
+              SPVInstruction *searchInst = block->block->instructions[j];
+              for(size_t aa = 0; searchInst->op && aa < searchInst->op->arguments.size(); aa++)
               {
-                SPVInstruction *searchInst = block->block->instructions[j];
-                for(size_t aa = 0; searchInst->op && aa < searchInst->op->arguments.size(); aa++)
+                if(searchInst->op->arguments[aa]->id == arg->id)
                 {
-                  if(searchInst->op->arguments[aa]->id == arg->id)
+                  if(searchInst->opcode == spv::OpLoad)
                   {
-                    if(searchInst->opcode == spv::OpLoad)
-                    {
-                      // if it's used in multiple load, it can't be folded
-                      if(loadAfter)
-                      {
-                        canReplace = false;
-                        break;
-                      }
-                      loadAfter = searchInst;
-                      loadIdx = j;
-                    }
-                    else
+                    // if it's used in multiple load, it can't be folded
+                    if(loadAfter)
                     {
-                      // if it's used in anything but a load, it can't be folded
                       canReplace = false;
                       break;
                     }
+                    loadAfter = searchInst;
+                    loadIdx = j;
+                  }
+                  else
+                  {
+                    // if it's used in anything but a load, it can't be folded
+                    canReplace = false;
+                    break;
                   }
                 }
+              }
 
-                // if it's used in a condition, it can't be folded
-                if(searchInst->flow && searchInst->flow->condition &&
-                   searchInst->flow->condition->id == arg->id)
-                  canReplace = false;
+              // if it's used in a condition, it can't be folded
+              if(searchInst->flow && searchInst->flow->condition &&
+                 searchInst->flow->condition->id == arg->id)
+                canReplace = false;
 
-                if(!canReplace)
-                  break;
-              }
+              if(!canReplace)
+                break;
+            }
 
-              if(canReplace)
+            if(canReplace)
+            {
+              // in parameter
+              if(storeBefore && !loadAfter)
               {
-                // in parameter
-                if(storeBefore && !loadAfter)
-                {
-                  erase_item(funcops, storeBefore);
+                erase_item(funcops, storeBefore);
 
-                  erase_item(vars, instr->op->arguments[a]);
+                erase_item(vars, instr->op->arguments[a]);
 
-                  // pass function parameter directly from where the store was coming from
-                  instr->op->arguments[a] = storeBefore->op->arguments[1];
-                }
+                // pass function parameter directly from where the store was coming from
+                instr->op->arguments[a] = storeBefore->op->arguments[1];
+              }
 
-                // out or inout parameter
-                if(loadAfter)
-                {
-                  // need to check the load afterwards is only ever used in a store operation
+              // out or inout parameter
+              if(loadAfter)
+              {
+                // need to check the load afterwards is only ever used in a store operation
 
-                  SPVInstruction *storeUse = NULL;
+                SPVInstruction *storeUse = NULL;
 
-                  for(size_t j = loadIdx + 1; j < block->block->instructions.size(); j++)
-                  {
-                    SPVInstruction *searchInst = block->block->instructions[j];
+                for(size_t j = loadIdx + 1; j < block->block->instructions.size(); j++)
+                {
+                  SPVInstruction *searchInst = block->block->instructions[j];
 
-                    for(size_t aa = 0; searchInst->op && aa < searchInst->op->arguments.size(); aa++)
+                  for(size_t aa = 0; searchInst->op && aa < searchInst->op->arguments.size(); aa++)
+                  {
+                    if(searchInst->op->arguments[aa] == loadAfter)
                     {
-                      if(searchInst->op->arguments[aa] == loadAfter)
+                      if(searchInst->opcode == spv::OpStore)
                       {
-                        if(searchInst->opcode == spv::OpStore)
-                        {
-                          // if it's used in multiple stores, it can't be folded
-                          if(storeUse)
-                          {
-                            canReplace = false;
-                            break;
-                          }
-                          storeUse = searchInst;
-                        }
-                        else
+                        // if it's used in multiple stores, it can't be folded
+                        if(storeUse)
                         {
-                          // if it's used in anything but a store, it can't be folded
                           canReplace = false;
                           break;
                         }
+                        storeUse = searchInst;
+                      }
+                      else
+                      {
+                        // if it's used in anything but a store, it can't be folded
+                        canReplace = false;
+                        break;
                       }
                     }
+                  }
 
-                    // if it's used in a condition, it can't be folded
-                    if(searchInst->flow && searchInst->flow->condition == loadAfter)
-                      canReplace = false;
+                  // if it's used in a condition, it can't be folded
+                  if(searchInst->flow && searchInst->flow->condition == loadAfter)
+                    canReplace = false;
 
-                    if(!canReplace)
-                      break;
-                  }
+                  if(!canReplace)
+                    break;
+                }
 
-                  if(canReplace && storeBefore != NULL)
+                if(canReplace && storeBefore != NULL)
+                {
+                  // for the inout parameter case, we also need to verify that
+                  // the Store() before the function call comes from a Load(),
+                  // and that the variable being Load()'d is identical to the
+                  // variable in the Store() in storeUse that we've found
+
+                  if(storeBefore->op->arguments[1]->opcode == spv::OpLoad &&
+                     storeBefore->op->arguments[1]->op->arguments[0]->id ==
+                         storeUse->op->arguments[0]->id)
                   {
-                    // for the inout parameter case, we also need to verify that
-                    // the Store() before the function call comes from a Load(),
-                    // and that the variable being Load()'d is identical to the
-                    // variable in the Store() in storeUse that we've found
-
-                    if(storeBefore->op->arguments[1]->opcode == spv::OpLoad &&
-                       storeBefore->op->arguments[1]->op->arguments[0]->id ==
-                           storeUse->op->arguments[0]->id)
-                    {
-                      erase_item(funcops, storeBefore);
-                    }
-                    else
-                    {
-                      canReplace = false;
-                    }
+                    erase_item(funcops, storeBefore);
                   }
-
-                  if(canReplace)
+                  else
                   {
-                    // we haven't reached this store instruction yet, so need to mark that
-                    // it has been folded and should be skipped
-                    ignore_items.insert(storeUse);
+                    canReplace = false;
+                  }
+                }
 
-                    erase_item(vars, instr->op->arguments[a]);
+                if(canReplace)
+                {
+                  // we haven't reached this store instruction yet, so need to mark that
+                  // it has been folded and should be skipped
+                  ignore_items.insert(storeUse);
 
-                    // pass argument directly
-                    instr->op->arguments[a] = storeUse->op->arguments[0];
-                  }
+                  erase_item(vars, instr->op->arguments[a]);
+
+                  // pass argument directly
+                  instr->op->arguments[a] = storeUse->op->arguments[0];
                 }
               }
             }
           }
         }
       }
+    }
 
-      if(block->block->mergeFlow)
-        funcops.push_back(block->block->mergeFlow);
-      if(block->block->exitFlow)
+    if(block->block->mergeFlow)
+      funcops.push_back(block->block->mergeFlow);
+    if(block->block->exitFlow)
+    {
+      // branch conditions are inlined unless otherwise required
+      SPVInstruction *cond = block->block->exitFlow->flow->condition;
+      if(cond && cond->op && cond->op->complexity < NEVER_INLINE_COMPLEXITY)
+        erase_item(funcops, cond);
+
+      // return values are inlined
+      if(block->block->exitFlow->opcode == spv::OpReturnValue)
       {
-        // branch conditions are inlined unless otherwise required
-        SPVInstruction *cond = block->block->exitFlow->flow->condition;
-        if(cond && cond->op && cond->op->complexity < NEVER_INLINE_COMPLEXITY)
-          erase_item(funcops, cond);
+        SPVInstruction *arg = ids[block->block->exitFlow->flow->targets[0]];
 
-        // return values are inlined
-        if(block->block->exitFlow->opcode == spv::OpReturnValue)
-        {
-          SPVInstruction *arg = ids[block->block->exitFlow->flow->targets[0]];
+        erase_item(funcops, arg);
+      }
 
-          erase_item(funcops, arg);
-        }
+      funcops.push_back(block->block->exitFlow);
+    }
+  }
 
-        funcops.push_back(block->block->exitFlow);
-      }
+  // keep track of switch statements, as they can contain
+  //     Branch 123
+  //     Label 123
+  // that we want to keep, to identify breaks and fallthroughs
+  vector<pair<uint32_t, SPVFlowControl *> > switchstack;
+
+  // find redundant branch/label pairs
+  for(size_t l = 0; l < funcops.size() - 1;)
+  {
+    if(funcops[l]->opcode == spv::OpSwitch)
+    {
+      RDCASSERT(l > 0 && funcops[l - 1]->opcode == spv::OpSelectionMerge);
+      switchstack.push_back(std::make_pair(funcops[l - 1]->flow->targets[0], funcops[l]->flow));
     }
 
-    // keep track of switch statements, as they can contain
-    //     Branch 123
-    //     Label 123
-    // that we want to keep, to identify breaks and fallthroughs
-    vector<pair<uint32_t, SPVFlowControl *> > switchstack;
+    if(funcops[l]->opcode == spv::OpLabel)
+    {
+      if(!switchstack.empty() && switchstack.back().first == funcops[l]->id)
+        switchstack.pop_back();
+    }
 
-    // find redundant branch/label pairs
-    for(size_t l = 0; l < funcops.size() - 1;)
+    if(funcops[l]->opcode == spv::OpBranch)
     {
-      if(funcops[l]->opcode == spv::OpSwitch)
-      {
-        RDCASSERT(l > 0 && funcops[l - 1]->opcode == spv::OpSelectionMerge);
-        switchstack.push_back(std::make_pair(funcops[l - 1]->flow->targets[0], funcops[l]->flow));
-      }
+      uint32_t branchTarget = funcops[l]->flow->targets[0];
 
-      if(funcops[l]->opcode == spv::OpLabel)
-      {
-        if(!switchstack.empty() && switchstack.back().first == funcops[l]->id)
-          switchstack.pop_back();
-      }
+      bool skip = false;
 
-      if(funcops[l]->opcode == spv::OpBranch)
+      for(size_t sw = 0; sw < switchstack.size(); sw++)
       {
-        uint32_t branchTarget = funcops[l]->flow->targets[0];
-
-        bool skip = false;
+        if(switchstack[sw].first == branchTarget)
+        {
+          l++;
+          skip = true;
+          break;
+        }
 
-        for(size_t sw = 0; sw < switchstack.size(); sw++)
+        for(size_t t = 0; t < switchstack[sw].second->targets.size(); t++)
         {
-          if(switchstack[sw].first == branchTarget)
+          if(switchstack[sw].second->targets[t] == branchTarget)
           {
             l++;
             skip = true;
             break;
           }
-
-          for(size_t t = 0; t < switchstack[sw].second->targets.size(); t++)
-          {
-            if(switchstack[sw].second->targets[t] == branchTarget)
-            {
-              l++;
-              skip = true;
-              break;
-            }
-          }
         }
+      }
 
-        if(skip)
-          continue;
+      if(skip)
+        continue;
 
-        if(funcops[l + 1]->opcode == spv::OpLabel && branchTarget == funcops[l + 1]->id)
-        {
-          uint32_t label = funcops[l + 1]->id;
+      if(funcops[l + 1]->opcode == spv::OpLabel && branchTarget == funcops[l + 1]->id)
+      {
+        uint32_t label = funcops[l + 1]->id;
 
-          bool refd = false;
+        bool refd = false;
 
-          // see if this label is a target anywhere else
-          for(size_t b = 0; b < funcops.size(); b++)
-          {
-            if(l == b)
-              continue;
+        // see if this label is a target anywhere else
+        for(size_t b = 0; b < funcops.size(); b++)
+        {
+          if(l == b)
+            continue;
 
-            if(funcops[b]->flow)
+          if(funcops[b]->flow)
+          {
+            for(size_t t = 0; t < funcops[b]->flow->targets.size(); t++)
             {
-              for(size_t t = 0; t < funcops[b]->flow->targets.size(); t++)
+              if(funcops[b]->flow->targets[t] == label)
               {
-                if(funcops[b]->flow->targets[t] == label)
-                {
-                  refd = true;
-                  break;
-                }
-              }
-
-              if(refd)
+                refd = true;
                 break;
+              }
             }
-          }
 
-          if(!refd)
-          {
-            funcops.erase(funcops.begin() + l);
-            funcops.erase(funcops.begin() + l);
-            continue;
-          }
-          else
-          {
-            // if it is refd, we can at least remove the goto
-            funcops.erase(funcops.begin() + l);
-            continue;
+            if(refd)
+              break;
           }
         }
-      }
 
-      l++;
+        if(!refd)
+        {
+          funcops.erase(funcops.begin() + l);
+          funcops.erase(funcops.begin() + l);
+          continue;
+        }
+        else
+        {
+          // if it is refd, we can at least remove the goto
+          funcops.erase(funcops.begin() + l);
+          continue;
+        }
+      }
     }
 
-    // if we have a vector compositeextract that is only ever used in a
-    // subsequent compositeconstruct which will just be inlined directly src-to-dest
-    // then remove the extract. This assumes though there will be no other uses of
-    // the extract elsewhere
-    for(size_t o = 0; o < funcops.size();)
+    l++;
+  }
+
+  // if we have a vector compositeextract that is only ever used in a
+  // subsequent compositeconstruct which will just be inlined directly src-to-dest
+  // then remove the extract. This assumes though there will be no other uses of
+  // the extract elsewhere
+  for(size_t o = 0; o < funcops.size();)
+  {
+    if(funcops[o]->opcode == spv::OpCompositeExtract &&
+       funcops[o]->op->arguments[0]->op->type->type == SPVTypeData::eVector)
     {
-      if(funcops[o]->opcode == spv::OpCompositeExtract &&
-         funcops[o]->op->arguments[0]->op->type->type == SPVTypeData::eVector)
+      // count how many times this extract is used in constructing a vector
+      uint32_t constructUses = 0;
+
+      for(size_t p = o + 1; p < funcops.size(); p++)
       {
-        // count how many times this extract is used in constructing a vector
-        uint32_t constructUses = 0;
+        SPVInstruction *useInstr = NULL;
 
-        for(size_t p = o + 1; p < funcops.size(); p++)
+        // return value is special because it doesn't hold a SPVInstruction* to its
+        // return value, so we check it manually
+        if(funcops[p]->opcode == spv::OpReturnValue)
         {
-          SPVInstruction *useInstr = NULL;
-
-          // return value is special because it doesn't hold a SPVInstruction* to its
-          // return value, so we check it manually
-          if(funcops[p]->opcode == spv::OpReturnValue)
-          {
-            if(funcops[o]->id == funcops[p]->flow->targets[0])
-              useInstr = funcops[p];
-            else
-            {
-              SPVInstruction *instr = ids[funcops[p]->flow->targets[0]];
-
-              if(instr && instr->op)
-                FindFirstInstructionUse(instr, funcops[o], &useInstr);
-            }
-          }
-
-          // find out if this instruction uses the extract somewhere
-          if(useInstr == NULL)
+          if(funcops[o]->id == funcops[p]->flow->targets[0])
+            useInstr = funcops[p];
+          else
           {
-            if(!funcops[p]->op)
-              continue;
+            SPVInstruction *instr = ids[funcops[p]->flow->targets[0]];
 
-            FindFirstInstructionUse(funcops[p], funcops[o], &useInstr);
+            if(instr && instr->op)
+              FindFirstInstructionUse(instr, funcops[o], &useInstr);
           }
+        }
 
-          if(useInstr == NULL)
+        // find out if this instruction uses the extract somewhere
+        if(useInstr == NULL)
+        {
+          if(!funcops[p]->op)
             continue;
 
-          if(useInstr->opcode != spv::OpCompositeConstruct ||
-             useInstr->op->type->type != SPVTypeData::eVector)
-          {
-            // extract is used in a non-construct, or not constructing a vector (e.g. a struct)
-            // so pretend the extract is used multiple times so that it can't be removed
-            constructUses = 10;
-            break;
-          }
-          else
-          {
-            // it was used in a construct of a vector, increment
-            constructUses++;
-
-            // if it's been used more than once, break
-            if(constructUses > 1)
-              break;
-          }
+          FindFirstInstructionUse(funcops[p], funcops[o], &useInstr);
         }
 
-        // if it's only been used once, then we can safely remove the extract
-        // as it will be in-lined at disassembly time. Otherwise just continue
-        if(constructUses == 1)
-          funcops.erase(funcops.begin() + o);
+        if(useInstr == NULL)
+          continue;
+
+        if(useInstr->opcode != spv::OpCompositeConstruct ||
+           useInstr->op->type->type != SPVTypeData::eVector)
+        {
+          // extract is used in a non-construct, or not constructing a vector (e.g. a struct)
+          // so pretend the extract is used multiple times so that it can't be removed
+          constructUses = 10;
+          break;
+        }
         else
-          o++;
+        {
+          // it was used in a construct of a vector, increment
+          constructUses++;
 
-        continue;
+          // if it's been used more than once, break
+          if(constructUses > 1)
+            break;
+        }
       }
 
-      o++;
+      // if it's only been used once, then we can safely remove the extract
+      // as it will be in-lined at disassembly time. Otherwise just continue
+      if(constructUses == 1)
+        funcops.erase(funcops.begin() + o);
+      else
+        o++;
+
+      continue;
     }
 
-    RDCASSERT(switchstack.empty());
+    o++;
+  }
+
+  RDCASSERT(switchstack.empty());
 
-    size_t tabSize = 2;
-    size_t indent = tabSize;
+  size_t tabSize = 2;
+  size_t indent = tabSize;
 
-    bool *varDeclared = new bool[vars.size()];
-    for(size_t v = 0; v < vars.size(); v++)
-      varDeclared[v] = false;
+  bool *varDeclared = new bool[vars.size()];
+  for(size_t v = 0; v < vars.size(); v++)
+    varDeclared[v] = false;
 
 // if we're declaring variables at the top of the function rather than at first use
 #if C_VARIABLE_DECLARATIONS
-    for(size_t v = 0; v < vars.size(); v++)
-    {
-      RDCASSERT(vars[v]->var && vars[v]->var->type);
-      retDisasm += string(indent, ' ') +
-                   vars[v]->var->type->DeclareVariable(vars[v]->decorations, vars[v]->GetIDName()) +
-                   ";\n";
+  for(size_t v = 0; v < vars.size(); v++)
+  {
+    RDCASSERT(vars[v]->var && vars[v]->var->type);
+    retDisasm += string(indent, ' ') +
+                 vars[v]->var->type->DeclareVariable(vars[v]->decorations, vars[v]->GetIDName()) +
+                 ";\n";
 
-      varDeclared[v] = true;
-    }
+    varDeclared[v] = true;
+  }
 
-    if(!vars.empty())
-      retDisasm += "\n";
+  if(!vars.empty())
+    retDisasm += "\n";
 #endif
 
-    struct sel
-    {
-      sel(uint32_t i) : id(i), elseif(false) {}
-      uint32_t id;
-      bool elseif;
-    };
+  struct sel
+  {
+    sel(uint32_t i) : id(i), elseif(false) {}
+    uint32_t id;
+    bool elseif;
+  };
 
-    vector<sel> selectionstack;
-    vector<uint32_t> elsestack;
+  vector<sel> selectionstack;
+  vector<uint32_t> elsestack;
 
-    vector<uint32_t> loopheadstack;
-    vector<uint32_t> loopstartstack;
-    vector<uint32_t> loopmergestack;
+  vector<uint32_t> loopheadstack;
+  vector<uint32_t> loopstartstack;
+  vector<uint32_t> loopmergestack;
 
-    string funcDisassembly = "";
+  string funcDisassembly = "";
 
-    for(size_t o = 0; o < funcops.size(); o++)
+  for(size_t o = 0; o < funcops.size(); o++)
+  {
+    if(funcops[o]->opcode == spv::OpLabel)
     {
-      if(funcops[o]->opcode == spv::OpLabel)
+      bool handled = false;
+
+      if(!switchstack.empty())
       {
-        bool handled = false;
+        if(switchstack.back().first == funcops[o]->id)
+        {
+          // handle the end of the switch block
+          indent -= tabSize;
 
-        if(!switchstack.empty())
+          handled = true;
+
+          funcDisassembly += string(indent, ' ');
+          funcDisassembly += "}\n";
+          selectionstack.pop_back();
+          switchstack.pop_back();
+        }
+        else
         {
-          if(switchstack.back().first == funcops[o]->id)
-          {
-            // handle the end of the switch block
-            indent -= tabSize;
-
-            handled = true;
-
-            funcDisassembly += string(indent, ' ');
-            funcDisassembly += "}\n";
-            selectionstack.pop_back();
-            switchstack.pop_back();
-          }
-          else
+          SPVInstruction *cond = switchstack.back().second->condition;
+          vector<uint32_t> &targets = switchstack.back().second->targets;
+          vector<uint32_t> &values = switchstack.back().second->literals;
+          for(size_t t = 0; t < targets.size(); t++)
           {
-            SPVInstruction *cond = switchstack.back().second->condition;
-            vector<uint32_t> &targets = switchstack.back().second->targets;
-            vector<uint32_t> &values = switchstack.back().second->literals;
-            for(size_t t = 0; t < targets.size(); t++)
+            if(targets[t] == funcops[o]->id)
             {
-              if(targets[t] == funcops[o]->id)
+              handled = true;
+
+              if(t == targets.size() - 1)
               {
-                handled = true;
+                funcDisassembly += string(indent - tabSize, ' ');
+                funcDisassembly += "default:\n";
+              }
+              else
+              {
+                RDCASSERT(t < values.size());
+                funcDisassembly += string(indent - tabSize, ' ');
 
-                if(t == targets.size() - 1)
+                if(cond->op && cond->op->type->type == SPVTypeData::eSInt)
                 {
-                  funcDisassembly += string(indent - tabSize, ' ');
-                  funcDisassembly += "default:\n";
+                  funcDisassembly += StringFormat::Fmt("case %d:\n", values[t]);
                 }
                 else
                 {
-                  RDCASSERT(t < values.size());
-                  funcDisassembly += string(indent - tabSize, ' ');
-
-                  if(cond->op && cond->op->type->type == SPVTypeData::eSInt)
-                  {
-                    funcDisassembly += StringFormat::Fmt("case %d:\n", values[t]);
-                  }
-                  else
-                  {
-                    funcDisassembly += StringFormat::Fmt("case %u:\n", values[t]);
-                  }
+                  funcDisassembly += StringFormat::Fmt("case %u:\n", values[t]);
                 }
               }
             }
           }
         }
+      }
+
+      if(handled)
+      {
+      }
+      else if(!elsestack.empty() && elsestack.back() == funcops[o]->id)
+      {
+        // handle meeting an else block
+        funcDisassembly += string(indent - tabSize, ' ');
+        funcDisassembly += "} else ";
 
-        if(handled)
+        if(o + 2 < funcops.size() && funcops[o + 1]->opcode == spv::OpSelectionMerge &&
+           funcops[o + 2]->opcode == spv::OpBranchConditional)
         {
+          // handle else if, remove the indent now as the else if will be on the same level
+          indent -= tabSize;
+          selectionstack.back().elseif = true;
         }
-        else if(!elsestack.empty() && elsestack.back() == funcops[o]->id)
+        else
         {
-          // handle meeting an else block
-          funcDisassembly += string(indent - tabSize, ' ');
-          funcDisassembly += "} else ";
-
-          if(o + 2 < funcops.size() && funcops[o + 1]->opcode == spv::OpSelectionMerge &&
-             funcops[o + 2]->opcode == spv::OpBranchConditional)
-          {
-            // handle else if, remove the indent now as the else if will be on the same level
-            indent -= tabSize;
-            selectionstack.back().elseif = true;
-          }
-          else
-          {
-            funcDisassembly += "{\n";
-          }
-          elsestack.pop_back();
+          funcDisassembly += "{\n";
         }
-        else if(!selectionstack.empty() && selectionstack.back().id == funcops[o]->id)
-        {
-          // handle meeting a selection merge block
+        elsestack.pop_back();
+      }
+      else if(!selectionstack.empty() && selectionstack.back().id == funcops[o]->id)
+      {
+        // handle meeting a selection merge block
 
-          // if we have hit an else if, the indent has already been
-          // removed
-          if(!selectionstack.back().elseif)
-          {
-            indent -= tabSize;
-            funcDisassembly += string(indent, ' ');
-            funcDisassembly += "}\n";
-          }
-          selectionstack.pop_back();
-        }
-        else if(!loopmergestack.empty() && loopmergestack.back() == funcops[o]->id)
+        // if we have hit an else if, the indent has already been
+        // removed
+        if(!selectionstack.back().elseif)
         {
-          // handle meeting a loop merge block
           indent -= tabSize;
-
           funcDisassembly += string(indent, ' ');
           funcDisassembly += "}\n";
-
-          loopheadstack.pop_back();
-          loopstartstack.pop_back();
-          loopmergestack.pop_back();
         }
-        else if(!loopstartstack.empty() && loopstartstack.back() == funcops[o]->id)
+        selectionstack.pop_back();
+      }
+      else if(!loopmergestack.empty() && loopmergestack.back() == funcops[o]->id)
+      {
+        // handle meeting a loop merge block
+        indent -= tabSize;
+
+        funcDisassembly += string(indent, ' ');
+        funcDisassembly += "}\n";
+
+        loopheadstack.pop_back();
+        loopstartstack.pop_back();
+        loopmergestack.pop_back();
+      }
+      else if(!loopstartstack.empty() && loopstartstack.back() == funcops[o]->id)
+      {
+        // completely skip a label at the start of the loop. It's implicit from braces
+      }
+      else if(funcops[o]->block->mergeFlow &&
+              funcops[o]->block->mergeFlow->opcode == spv::OpLoopMerge)
+      {
+        loopheadstack.push_back(funcops[o]->id);
+        loopstartstack.push_back(funcops[o]->block->exitFlow->flow->targets[0]);
+        loopmergestack.push_back(funcops[o]->block->mergeFlow->flow->targets[0]);
+
+        // should be either unconditional, or false from the condition should jump straight to
+        // merge block
+        RDCASSERT(funcops[o]->block->exitFlow->flow->targets.size() == 1 ||
+                  funcops[o]->block->exitFlow->flow->targets[1] ==
+                      funcops[o]->block->mergeFlow->flow->targets[0]);
+
+        // this block is a loop header
+        // TODO handle if the loop header condition expression isn't sufficiently in-lined.
+        // We need to force inline it.
+        funcDisassembly += string(indent, ' ');
+        if(funcops[o]->block->exitFlow->flow->condition)
         {
-          // completely skip a label at the start of the loop. It's implicit from braces
+          funcDisassembly +=
+              "while(" + funcops[o]->block->exitFlow->flow->condition->Disassemble(ids, true) +
+              ") {\n";
         }
-        else if(funcops[o]->block->mergeFlow &&
-                funcops[o]->block->mergeFlow->opcode == spv::OpLoopMerge)
+        else
         {
-          loopheadstack.push_back(funcops[o]->id);
-          loopstartstack.push_back(funcops[o]->block->exitFlow->flow->targets[0]);
-          loopmergestack.push_back(funcops[o]->block->mergeFlow->flow->targets[0]);
-
-          // should be either unconditional, or false from the condition should jump straight to
-          // merge block
-          RDCASSERT(funcops[o]->block->exitFlow->flow->targets.size() == 1 ||
-                    funcops[o]->block->exitFlow->flow->targets[1] ==
-                        funcops[o]->block->mergeFlow->flow->targets[0]);
-
-          // this block is a loop header
-          // TODO handle if the loop header condition expression isn't sufficiently in-lined.
-          // We need to force inline it.
-          funcDisassembly += string(indent, ' ');
-          if(funcops[o]->block->exitFlow->flow->condition)
-          {
-            funcDisassembly +=
-                "while(" + funcops[o]->block->exitFlow->flow->condition->Disassemble(ids, true) +
-                ") {\n";
-          }
-          else
+          bool foundCondition = false;
+
+          // check to see if we have a loopmerge and branchconditional right after this block
+          if(o + 3 < funcops.size() && funcops[o]->block->mergeFlow == funcops[o + 1] &&
+             funcops[o + 2]->opcode == spv::OpBranchConditional &&
+             funcops[o + 3]->opcode == spv::OpLabel)
           {
-            bool foundCondition = false;
+            uint32_t nextLabel = funcops[o + 3]->id;
 
-            // check to see if we have a loopmerge and branchconditional right after this block
-            if(o + 3 < funcops.size() && funcops[o]->block->mergeFlow == funcops[o + 1] &&
-               funcops[o + 2]->opcode == spv::OpBranchConditional &&
-               funcops[o + 3]->opcode == spv::OpLabel)
+            // check if this branch conditional is jumping to a label immediately after or
+            // the exit point. The condition could be reversed to check either direction
+            if(funcops[o + 2]->flow->targets[0] == nextLabel &&
+               funcops[o + 2]->flow->targets[1] == funcops[o]->block->mergeFlow->flow->targets[0])
             {
-              uint32_t nextLabel = funcops[o + 3]->id;
-
-              // check if this branch conditional is jumping to a label immediately after or
-              // the exit point. The condition could be reversed to check either direction
-              if(funcops[o + 2]->flow->targets[0] == nextLabel &&
-                 funcops[o + 2]->flow->targets[1] == funcops[o]->block->mergeFlow->flow->targets[0])
-              {
-                funcDisassembly += "while(" + funcops[o + 2]->Disassemble(ids, true) + ") {\n";
-
-                // skip all of the above that we just used up
-                o += 3;
-                foundCondition = true;
-              }
-              else if(funcops[o + 2]->flow->targets[1] == nextLabel &&
-                      funcops[o + 2]->flow->targets[0] ==
-                          funcops[o]->block->mergeFlow->flow->targets[0])
-              {
-                funcDisassembly += "while(!(" + funcops[o + 2]->Disassemble(ids, true) + ")) {\n";
+              funcDisassembly += "while(" + funcops[o + 2]->Disassemble(ids, true) + ") {\n";
 
-                // skip all of the above that we just used up
-                o += 3;
-                foundCondition = true;
-              }
+              // skip all of the above that we just used up
+              o += 3;
+              foundCondition = true;
             }
+            else if(funcops[o + 2]->flow->targets[1] == nextLabel &&
+                    funcops[o + 2]->flow->targets[0] ==
+                        funcops[o]->block->mergeFlow->flow->targets[0])
+            {
+              funcDisassembly += "while(!(" + funcops[o + 2]->Disassemble(ids, true) + ")) {\n";
 
-            if(!foundCondition)
-              funcDisassembly += "while(true) {\n";
+              // skip all of the above that we just used up
+              o += 3;
+              foundCondition = true;
+            }
           }
 
-          indent += tabSize;
-        }
-        else
-        {
-          funcDisassembly += funcops[o]->Disassemble(ids, false) + "\n";
+          if(!foundCondition)
+            funcDisassembly += "while(true) {\n";
         }
+
+        indent += tabSize;
       }
-      else if(funcops[o]->opcode == spv::OpBranch)
+      else
       {
-        bool handled = false;
+        funcDisassembly += funcops[o]->Disassemble(ids, false) + "\n";
+      }
+    }
+    else if(funcops[o]->opcode == spv::OpBranch)
+    {
+      bool handled = false;
 
-        if(!switchstack.empty())
+      if(!switchstack.empty())
+      {
+        if(switchstack.back().first == funcops[o]->flow->targets[0])
         {
-          if(switchstack.back().first == funcops[o]->flow->targets[0])
-          {
-            // this branch is to the selection merge label of the switch statement, it must
-            // be a break instruction
-            funcDisassembly += string(indent, ' ');
-            funcDisassembly += "break;\n";
+          // this branch is to the selection merge label of the switch statement, it must
+          // be a break instruction
+          funcDisassembly += string(indent, ' ');
+          funcDisassembly += "break;\n";
 
-            handled = true;
-          }
-          else
+          handled = true;
+        }
+        else
+        {
+          vector<uint32_t> &targets = switchstack.back().second->targets;
+          for(size_t t = 0; t < targets.size(); t++)
           {
-            vector<uint32_t> &targets = switchstack.back().second->targets;
-            for(size_t t = 0; t < targets.size(); t++)
+            if(targets[t] == funcops[o]->flow->targets[0])
             {
-              if(targets[t] == funcops[o]->flow->targets[0])
-              {
-                // if we're branching to one of the targets of the switch statement,
-                // assume this is fall-through. Normally only the switch itself would
-                // branch to one of these labels, but if a case branches to another
-                // that is a representation of fall-through.
-                // Note in this case the label will also be the next funcop, but this
-                // is required by the spec so we just assert
-                RDCASSERT(o + 1 < funcops.size() && funcops[o + 1]->id == targets[t]);
-                handled = true;
-              }
+              // if we're branching to one of the targets of the switch statement,
+              // assume this is fall-through. Normally only the switch itself would
+              // branch to one of these labels, but if a case branches to another
+              // that is a representation of fall-through.
+              // Note in this case the label will also be the next funcop, but this
+              // is required by the spec so we just assert
+              RDCASSERT(o + 1 < funcops.size() && funcops[o + 1]->id == targets[t]);
+              handled = true;
             }
           }
         }
+      }
 
-        if(handled)
-        {
-        }
-        else if(!selectionstack.empty() && funcops[o]->flow->targets[0] == selectionstack.back().id)
-        {
-          // if we're at the end of a true if path there will be a goto to
-          // the merge block before the false path label. Don't output it
-        }
-        else if(!loopheadstack.empty() && funcops[o]->flow->targets[0] == loopheadstack.back())
-        {
-          if(o + 1 < funcops.size() && funcops[o + 1]->opcode == spv::OpLabel &&
-             funcops[o + 1]->id == loopmergestack.back())
-          {
-            // skip any gotos at the end of a loop jumping back to the header
-            // block to do another loop
-          }
-          else
-          {
-            // if we're skipping to the header of the loop before the end, this is a continue
-            funcDisassembly += string(indent, ' ');
-            funcDisassembly += "continue;\n";
-          }
-        }
-        else if(!loopmergestack.empty() && funcops[o]->flow->targets[0] == loopmergestack.back())
+      if(handled)
+      {
+      }
+      else if(!selectionstack.empty() && funcops[o]->flow->targets[0] == selectionstack.back().id)
+      {
+        // if we're at the end of a true if path there will be a goto to
+        // the merge block before the false path label. Don't output it
+      }
+      else if(!loopheadstack.empty() && funcops[o]->flow->targets[0] == loopheadstack.back())
+      {
+        if(o + 1 < funcops.size() && funcops[o + 1]->opcode == spv::OpLabel &&
+           funcops[o + 1]->id == loopmergestack.back())
         {
-          // if we're skipping to the merge of the loop without going through the
-          // branch conditional, this is a break
-          funcDisassembly += string(indent, ' ');
-          funcDisassembly += "break;\n";
+          // skip any gotos at the end of a loop jumping back to the header
+          // block to do another loop
         }
         else
         {
+          // if we're skipping to the header of the loop before the end, this is a continue
           funcDisassembly += string(indent, ' ');
-          funcDisassembly += funcops[o]->Disassemble(ids, false) + ";\n";
+          funcDisassembly += "continue;\n";
         }
       }
-      else if(funcops[o]->opcode == spv::OpLoopMerge)
+      else if(!loopmergestack.empty() && funcops[o]->flow->targets[0] == loopmergestack.back())
       {
-        // handled above when this block started
-        o++;    // skip the branch conditional op
+        // if we're skipping to the merge of the loop without going through the
+        // branch conditional, this is a break
+        funcDisassembly += string(indent, ' ');
+        funcDisassembly += "break;\n";
       }
-      else if(funcops[o]->opcode == spv::OpSelectionMerge)
+      else
       {
-        RDCASSERT(o + 1 < funcops.size());
+        funcDisassembly += string(indent, ' ');
+        funcDisassembly += funcops[o]->Disassemble(ids, false) + ";\n";
+      }
+    }
+    else if(funcops[o]->opcode == spv::OpLoopMerge)
+    {
+      // handled above when this block started
+      o++;    // skip the branch conditional op
+    }
+    else if(funcops[o]->opcode == spv::OpSelectionMerge)
+    {
+      RDCASSERT(o + 1 < funcops.size());
 
-        bool elseif = false;
-        if(!selectionstack.empty())
-          elseif = selectionstack.back().elseif;
+      bool elseif = false;
+      if(!selectionstack.empty())
+        elseif = selectionstack.back().elseif;
 
-        selectionstack.push_back(sel(funcops[o]->flow->targets[0]));
+      selectionstack.push_back(sel(funcops[o]->flow->targets[0]));
 
-        o++;
+      o++;
 
-        if(funcops[o]->opcode == spv::OpBranchConditional)
-        {
-          if(!elseif)
-            funcDisassembly += string(indent, ' ');
-          funcDisassembly += "if(" + funcops[o]->Disassemble(ids, false) + ") {\n";
+      if(funcops[o]->opcode == spv::OpBranchConditional)
+      {
+        if(!elseif)
+          funcDisassembly += string(indent, ' ');
+        funcDisassembly += "if(" + funcops[o]->Disassemble(ids, false) + ") {\n";
 
-          indent += tabSize;
+        indent += tabSize;
 
-          // does the branch have an else case
-          if(funcops[o]->flow->targets[1] != selectionstack.back().id)
-            elsestack.push_back(funcops[o]->flow->targets[1]);
+        // does the branch have an else case
+        if(funcops[o]->flow->targets[1] != selectionstack.back().id)
+          elsestack.push_back(funcops[o]->flow->targets[1]);
 
-          RDCASSERT(o + 1 < funcops.size() && funcops[o + 1]->opcode == spv::OpLabel &&
-                    funcops[o + 1]->id == funcops[o]->flow->targets[0]);
-          o++;    // skip outputting this label, it becomes our { essentially
-        }
-        else if(funcops[o]->opcode == spv::OpSwitch)
-        {
-          funcDisassembly += string(indent, ' ');
-          funcDisassembly += funcops[o]->Disassemble(ids, false) + " {\n";
+        RDCASSERT(o + 1 < funcops.size() && funcops[o + 1]->opcode == spv::OpLabel &&
+                  funcops[o + 1]->id == funcops[o]->flow->targets[0]);
+        o++;    // skip outputting this label, it becomes our { essentially
+      }
+      else if(funcops[o]->opcode == spv::OpSwitch)
+      {
+        funcDisassembly += string(indent, ' ');
+        funcDisassembly += funcops[o]->Disassemble(ids, false) + " {\n";
 
-          indent += tabSize;
+        indent += tabSize;
 
-          switchstack.push_back(std::make_pair(selectionstack.back().id, funcops[o]->flow));
-        }
-        else
-        {
-          RDCERR("Unexpected opcode following selection merge");
-        }
+        switchstack.push_back(std::make_pair(selectionstack.back().id, funcops[o]->flow));
       }
-      else if(funcops[o]->opcode == spv::OpCompositeInsert && o + 1 < funcops.size() &&
-              funcops[o + 1]->opcode == spv::OpStore)
+      else
       {
-        // try to merge this load-hit-store construct:
-        // {id} = CompositeInsert <somevar> <foo> indices...
-        // Store <somevar> {id}
+        RDCERR("Unexpected opcode following selection merge");
+      }
+    }
+    else if(funcops[o]->opcode == spv::OpCompositeInsert && o + 1 < funcops.size() &&
+            funcops[o + 1]->opcode == spv::OpStore)
+    {
+      // try to merge this load-hit-store construct:
+      // {id} = CompositeInsert <somevar> <foo> indices...
+      // Store <somevar> {id}
 
-        uint32_t loadID = 0;
+      uint32_t loadID = 0;
 
-        if(funcops[o]->op->arguments[0]->opcode == spv::OpLoad)
-          loadID = funcops[o]->op->arguments[0]->op->arguments[0]->id;
+      if(funcops[o]->op->arguments[0]->opcode == spv::OpLoad)
+        loadID = funcops[o]->op->arguments[0]->op->arguments[0]->id;
 
-        if(loadID == funcops[o + 1]->op->arguments[0]->id)
-        {
-          // merge
-          SPVInstruction *loadhit = funcops[o];
-          SPVInstruction *store = funcops[o + 1];
+      if(loadID == funcops[o + 1]->op->arguments[0]->id)
+      {
+        // merge
+        SPVInstruction *loadhit = funcops[o];
+        SPVInstruction *store = funcops[o + 1];
 
-          o++;
+        o++;
 
-          bool printed = false;
+        bool printed = false;
 
-          SPVInstruction *storeVar = store->op->arguments[0];
+        SPVInstruction *storeVar = store->op->arguments[0];
 
 // declare variables at first use
 #if !C_VARIABLE_DECLARATIONS
-          for(size_t v = 0; v < vars.size(); v++)
+        for(size_t v = 0; v < vars.size(); v++)
+        {
+          if(!varDeclared[v] && vars[v] == storeVar)
           {
-            if(!varDeclared[v] && vars[v] == storeVar)
+            // if we're in a scope, be conservative as the variable might be
+            // used after the scope - print the declaration before the scope
+            // begins and continue as normal.
+            if(indent > tabSize)
             {
-              // if we're in a scope, be conservative as the variable might be
-              // used after the scope - print the declaration before the scope
-              // begins and continue as normal.
-              if(indent > tabSize)
-              {
-                retDisasm += string(tabSize, ' ');
-                retDisasm +=
-                    vars[v]->var->type->DeclareVariable(vars[v]->decorations, vars[v]->GetIDName()) +
-                    ";\n";
-              }
-              else
-              {
-                funcDisassembly += string(indent, ' ');
-                funcDisassembly +=
-                    vars[v]->var->type->DeclareVariable(vars[v]->decorations, vars[v]->GetIDName());
-
-                printed = true;
-              }
-
-              varDeclared[v] = true;
+              retDisasm += string(tabSize, ' ');
+              retDisasm +=
+                  vars[v]->var->type->DeclareVariable(vars[v]->decorations, vars[v]->GetIDName()) +
+                  ";\n";
             }
-          }
-#endif
-
-          if(!printed)
-          {
-            string storearg;
-            store->op->GetArg(ids, 0, storearg);
-
-            funcDisassembly += string(indent, ' ');
-            funcDisassembly += storearg;
-          }
-          funcDisassembly +=
-              loadhit->Disassemble(ids, true);    // inline compositeinsert includes ' = '
-          funcDisassembly += ";\n";
-
-          loadhit->line = (int)o;
-        }
-        else
-        {
-          // print separately
-          funcDisassembly += string(indent, ' ');
-          funcDisassembly += funcops[o]->Disassemble(ids, false) + ";\n";
-          funcops[o]->line = (int)o;
-
-          o++;
-
-          SPVInstruction *storeVar = funcops[o]->op->arguments[0];
-
-          bool printed = false;
-
-// declare variables at first use
-#if !C_VARIABLE_DECLARATIONS
-          for(size_t v = 0; v < vars.size(); v++)
-          {
-            if(!varDeclared[v] && vars[v] == storeVar)
+            else
             {
-              // if we're in a scope, be conservative as the variable might be
-              // used after the scope - print the declaration before the scope
-              // begins and continue as normal.
-              if(indent > tabSize)
-              {
-                retDisasm += string(tabSize, ' ');
-                retDisasm +=
-                    vars[v]->var->type->DeclareVariable(vars[v]->decorations, vars[v]->GetIDName()) +
-                    ";\n";
-              }
-              else
-              {
-                funcDisassembly += string(indent, ' ');
-                funcDisassembly +=
-                    vars[v]->var->type->DeclareVariable(vars[v]->decorations, vars[v]->GetIDName()) +
-                    " = ";
-                funcDisassembly += funcops[o]->Disassemble(ids, true) + ";\n";
-
-                printed = true;
-              }
+              funcDisassembly += string(indent, ' ');
+              funcDisassembly +=
+                  vars[v]->var->type->DeclareVariable(vars[v]->decorations, vars[v]->GetIDName());
 
-              varDeclared[v] = true;
+              printed = true;
             }
+
+            varDeclared[v] = true;
           }
+        }
 #endif
 
-          if(!printed)
-          {
-            funcDisassembly += string(indent, ' ');
-            funcDisassembly += funcops[o]->Disassemble(ids, false) + ";\n";
-          }
+        if(!printed)
+        {
+          string storearg;
+          store->op->GetArg(ids, 0, storearg);
+
+          funcDisassembly += string(indent, ' ');
+          funcDisassembly += storearg;
         }
+        funcDisassembly +=
+            loadhit->Disassemble(ids, true);    // inline compositeinsert includes ' = '
+        funcDisassembly += ";\n";
+
+        loadhit->line = (int)o;
       }
-      else if(funcops[o]->opcode == spv::OpReturn && o == funcops.size() - 1)
-      {
-        // don't print the return statement if it's the last statement in a function
-        break;
-      }
-      else if(funcops[o]->opcode == spv::OpStore)
+      else
       {
+        // print separately
+        funcDisassembly += string(indent, ' ');
+        funcDisassembly += funcops[o]->Disassemble(ids, false) + ";\n";
+        funcops[o]->line = (int)o;
+
+        o++;
+
         SPVInstruction *storeVar = funcops[o]->op->arguments[0];
 
         bool printed = false;
@@ -3395,45 +3436,94 @@ string SPVModule::Disassemble(const string &entryPoint)
           funcDisassembly += funcops[o]->Disassemble(ids, false) + ";\n";
         }
       }
-      else
+    }
+    else if(funcops[o]->opcode == spv::OpReturn && o == funcops.size() - 1)
+    {
+      // don't print the return statement if it's the last statement in a function
+      break;
+    }
+    else if(funcops[o]->opcode == spv::OpStore)
+    {
+      SPVInstruction *storeVar = funcops[o]->op->arguments[0];
+
+      bool printed = false;
+
+// declare variables at first use
+#if !C_VARIABLE_DECLARATIONS
+      for(size_t v = 0; v < vars.size(); v++)
+      {
+        if(!varDeclared[v] && vars[v] == storeVar)
+        {
+          // if we're in a scope, be conservative as the variable might be
+          // used after the scope - print the declaration before the scope
+          // begins and continue as normal.
+          if(indent > tabSize)
+          {
+            retDisasm += string(tabSize, ' ');
+            retDisasm +=
+                vars[v]->var->type->DeclareVariable(vars[v]->decorations, vars[v]->GetIDName()) +
+                ";\n";
+          }
+          else
+          {
+            funcDisassembly += string(indent, ' ');
+            funcDisassembly +=
+                vars[v]->var->type->DeclareVariable(vars[v]->decorations, vars[v]->GetIDName()) +
+                " = ";
+            funcDisassembly += funcops[o]->Disassemble(ids, true) + ";\n";
+
+            printed = true;
+          }
+
+          varDeclared[v] = true;
+        }
+      }
+#endif
+
+      if(!printed)
       {
         funcDisassembly += string(indent, ' ');
         funcDisassembly += funcops[o]->Disassemble(ids, false) + ";\n";
       }
-
-      funcops[o]->line = (int)o;
+    }
+    else
+    {
+      funcDisassembly += string(indent, ' ');
+      funcDisassembly += funcops[o]->Disassemble(ids, false) + ";\n";
     }
 
-    RDCASSERT(switchstack.empty());
-    RDCASSERT(selectionstack.empty());
-    RDCASSERT(elsestack.empty());
-    RDCASSERT(loopheadstack.empty());
-    RDCASSERT(loopstartstack.empty());
-    RDCASSERT(loopmergestack.empty());
+    funcops[o]->line = (int)o;
+  }
+
+  RDCASSERT(switchstack.empty());
+  RDCASSERT(selectionstack.empty());
+  RDCASSERT(elsestack.empty());
+  RDCASSERT(loopheadstack.empty());
+  RDCASSERT(loopstartstack.empty());
+  RDCASSERT(loopmergestack.empty());
 
 // declare any variables that didn't get declared inline somewhere above
 #if !C_VARIABLE_DECLARATIONS
-    for(size_t v = 0; v < vars.size(); v++)
-    {
-      if(varDeclared[v])
-        continue;
+  for(size_t v = 0; v < vars.size(); v++)
+  {
+    if(varDeclared[v])
+      continue;
 
-      RDCASSERT(vars[v]->var && vars[v]->var->type);
-      retDisasm += string(indent, ' ') +
-                   vars[v]->var->type->DeclareVariable(vars[v]->decorations, vars[v]->GetIDName()) +
-                   ";\n";
-    }
+    RDCASSERT(vars[v]->var && vars[v]->var->type);
+    retDisasm += string(indent, ' ') +
+                 vars[v]->var->type->DeclareVariable(vars[v]->decorations, vars[v]->GetIDName()) +
+                 ";\n";
+  }
 
-    if(!vars.empty())
-      retDisasm += "\n";
+  if(!vars.empty())
+    retDisasm += "\n";
 #endif
 
-    retDisasm += funcDisassembly;
+  retDisasm += funcDisassembly;
 
-    SAFE_DELETE_ARRAY(varDeclared);
+  SAFE_DELETE_ARRAY(varDeclared);
 
-    retDisasm += StringFormat::Fmt("} // %s\n\n", funcs[f]->str.c_str());
-  }
+  retDisasm += StringFormat::Fmt("} // %s\n\n", funcs[f]->str.c_str());
 
   return retDisasm;
 }
@@ -4430,6 +4520,15 @@ void ParseSPIRV(uint32_t *spirv, size_t spirvLength, SPVModule &module)
   module.generator = spirv[2];
 
   uint32_t idbound = spirv[3];
+
+  // the spec's universal limit on the ID bound. The ID table is sized from the header, so don't
+  // allocate whatever a corrupt module claims
+  if(idbound > 0x3fffff)
+  {
+    RDCERR("Invalid SPIR-V ID bound: %u", idbound);
+    return;
+  }
+
   module.ids.resize(idbound);
 
   RDCASSERT(spirv[4] == 0);
@@ -23,7 +23,6 @@
  ******************************************************************************/
 
 #include "vk_core.h"
-#include "jpeg-compressor/jpge.h"
 #include "maths/formatpacking.h"
 #include "serialise/string_utils.h"
 #include "vk_debug.h"
@@ -270,6 +269,7 @@ WrappedVulkan::WrappedVulkan(const char *logFilename) : m_RenderState(&m_Creatio
     if(logFilename)
     {
       m_pSerialiser = new Serialiser(logFilename, Serialiser::READING, debugSerialiser);
+      m_CreationInfo.m_ReplayCache.Open(logFilename);
     }
     else
     {
@@ -293,6 +293,7 @@ WrappedVulkan::WrappedVulkan(const char *logFilename) : m_RenderState(&m_Creatio
   m_AppControlledCapture = false;
 
   threadSerialiserTLSSlot = Threading::AllocateTLSSlot();
+  frameChunkLogTLSSlot = Threading::AllocateTLSSlot();
   tempMemoryTLSSlot = Threading::AllocateTLSSlot();
   debugMessageSinkTLSSlot = Threading::AllocateTLSSlot();
 
@@ -376,6 +377,11 @@ WrappedVulkan::~WrappedVulkan()
   for(size_t i = 0; i < m_ThreadSerialisers.size(); i++)
     delete m_ThreadSerialisers[i];
 
+  DeleteFrameChunks();
+
+  for(size_t i = 0; i < m_FrameChunkLogs.size(); i++)
+    delete m_FrameChunkLogs[i];
+
   for(size_t i = 0; i < m_ThreadTempMem.size(); i++)
   {
     delete[] m_ThreadTempMem[i]->memory;
@@ -577,6 +583,8 @@ const char *WrappedVulkan::GetChunkName(uint32_t idx)
     return "Driver Init Params";
   if(idx == INITIAL_CONTENTS)
     return "Initial Contents";
+  if(idx == CAPTURE_STATISTICS)
+    return "Capture Statistics";
   if(idx < FIRST_CHUNK_ID || idx >= NUM_VULKAN_CHUNKS)
     return "<unknown>";
   return VkChunkNames[idx - FIRST_CHUNK_ID];
@@ -670,6 +678,542 @@ Serialiser *WrappedVulkan::GetThreadSerialiser()
   return ser;
 }
 
+void WrappedVulkan::AddFrameChunk(Chunk *chunk)
+{
+  FrameChunkLog *log = (FrameChunkLog *)Threading::GetTLSValue(frameChunkLogTLSSlot);
+
+  if(log == NULL)
+  {
+    log = new FrameChunkLog;
+
+    Threading::SetTLSValue(frameChunkLogTLSSlot, (void *)log);
+
+    SCOPED_LOCK(m_ThreadSerialisersLock);
+    m_FrameChunkLogs.push_back(log);
+  }
+
+  uint32_t idx = uint32_t(log->count) % FrameChunkLog::BlockSize;
+
+  if(idx == 0 && log->count > 0)
+  {
+    log->tail->next = new FrameChunkLog::Block;
+    log->tail = log->tail->next;
+  }
+
+  log->tail->chunks[idx] = std::make_pair(ResourceRecord::GetID(), chunk);
+
+  // publish the chunk only once it's fully written
+  Atomic::Inc32(&log->count);
+}
+
+void WrappedVulkan::InsertFrameChunks(ChunkList &recordlist)
+{
+  SCOPED_LOCK(m_ThreadSerialisersLock);
+
+  for(size_t i = 0; i < m_FrameChunkLogs.size(); i++)
+  {
+    FrameChunkLog *log = m_FrameChunkLogs[i];
+
+    // atomic read of the published count, a thread could still be finishing a call that started
+    // before the capture ended
+    int32_t count = Atomic::CmpExch32(&log->count, 0, 0);
+
+    FrameChunkLog::Block *block = &log->head;
+
+    for(int32_t c = 0; c < count; c++)
+    {
+      if(c > 0 && (c % FrameChunkLog::BlockSize) == 0)
+        block = block->next;
+
+      recordlist.push_back(block->chunks[c % FrameChunkLog::BlockSize]);
+    }
+  }
+}
+
+void WrappedVulkan::DeleteFrameChunks()
+{
+  SCOPED_LOCK(m_ThreadSerialisersLock);
+
+  for(size_t i = 0; i < m_FrameChunkLogs.size(); i++)
+  {
+    FrameChunkLog *log = m_FrameChunkLogs[i];
+
+    FrameChunkLog::Block *block = &log->head;
+
+    for(int32_t c = 0; c < log->count; c++)
+    {
+      if(c > 0 && (c % FrameChunkLog::BlockSize) == 0)
+        block = block->next;
+
+      delete block->chunks[c % FrameChunkLog::BlockSize].second;
+    }
+
+    // keep the first block around for the next capture
+    block = log->head.next;
+    while(block)
+    {
+      FrameChunkLog::Block *next = block->next;
+      delete block;
+      block = next;
+    }
+
+    log->head.next = NULL;
+    log->tail = &log->head;
+    log->count = 0;
+  }
+}
+
+bool WrappedVulkan::CanDeferCmd()
+{
+  // callstacks have to be collected while the command is recorded
+  const CaptureOptions &opts = RenderDoc::Inst().GetCaptureOptions();
+  if(opts.CaptureCallstacks || opts.CaptureCallstacksOnlyDraws)
+    return false;
+
+  // likewise any debug messages raised by the command need to be serialised with it
+  ScopedDebugMessageSink *sink = GetDebugMessageSink();
+  if(sink && !sink->msgs.empty())
+    return false;
+
+  return true;
+}
+
+DeferredCmdWriter WrappedVulkan::DeferCmd(VkResourceRecord *record, VulkanChunkType type,
+                                          VkCommandBuffer commandBuffer)
+{
+  CmdBufferRecordingInfo *info = record->cmdInfo;
+
+  DeferredCmd cmd;
+  // reserve the chunk's place in the global order now, as it would have been if serialised
+  cmd.chunkID = ResourceRecord::GetID();
+  cmd.chunkType = (uint32_t)type;
+  cmd.cmdid = GetResID(commandBuffer);
+  cmd.dataOffset = info->deferredData.size();
+
+  info->deferred.push_back(cmd);
+
+  return DeferredCmdWriter(info->deferredData);
+}
+
+template <typename T>
+static T &SerialiseParam(Serialiser *ser, DeferredCmdReader &params, const char *name)
+{
+  T &el = params.Read<T>();
+  ser->Serialise(name, el);
+  return el;
+}
+
+// same as SERIALISE_ELEMENT_ARR
+template <typename T>
+static void SerialiseParamArray(Serialiser *ser, DeferredCmdReader &params, const char *name,
+                                uint32_t count)
+{
+  T *els = params.ReadArray<T>(count);
+  for(uint32_t i = 0; i < count; i++)
+    ser->Serialise(name, els[i]);
+}
+
+static void SerialiseParamBuffer(Serialiser *ser, DeferredCmdReader &params, const char *name,
+                                 size_t size)
+{
+  byte *buf = params.ReadArray<byte>((uint32_t)size);
+  ser->SerialiseBuffer(name, buf, size);
+}
+
+// these write the same as the Serialiser::Serialise overloads in vk_common.cpp for a struct with no
+// pNext, with the handle replaced by the ID recorded when the command was.
+static void SerialiseParam(Serialiser *ser, const char *name, VkBufferMemoryBarrier &el,
+                           ResourceId &buffer)
+{
+  ScopedContext scope(ser, name, "VkBufferMemoryBarrier", 0, true);
+
+  ser->Serialise("sType", el.sType);
+  ser->Serialise("srcAccessMask", (VkAccessFlagBits &)el.srcAccessMask);
+  ser->Serialise("dstAccessMask", (VkAccessFlagBits &)el.dstAccessMask);
+  ser->Serialise("srcQueueFamilyIndex", (int32_t &)el.srcQueueFamilyIndex);
+  ser->Serialise("dstQueueFamilyIndex", (int32_t &)el.dstQueueFamilyIndex);
+  ser->Serialise("buffer", buffer);
+  ser->Serialise("offset", el.offset);
+  ser->Serialise("size", el.size);
+}
+
+static void SerialiseParam(Serialiser *ser, const char *name, VkImageMemoryBarrier &el,
+                           ResourceId &image)
+{
+  ScopedContext scope(ser, name, "VkImageMemoryBarrier", 0, true);
+
+  ser->Serialise("sType", el.sType);
+  ser->Serialise("srcAccessMask", (VkAccessFlagBits &)el.srcAccessMask);
+  ser->Serialise("dstAccessMask", (VkAccessFlagBits &)el.dstAccessMask);
+  ser->Serialise("oldLayout", el.oldLayout);
+  ser->Serialise("newLayout", el.newLayout);
+  ser->Serialise("srcQueueFamilyIndex", (int32_t &)el.srcQueueFamilyIndex);
+  ser->Serialise("dstQueueFamilyIndex", (int32_t &)el.dstQueueFamilyIndex);
+  ser->Serialise("image", image);
+  ser->Serialise("subresourceRange", el.subresourceRange);
+}
+
+static void SerialiseParam(Serialiser *ser, const char *name, VkRenderPassBeginInfo &el,
+                           ResourceId &renderPass, ResourceId &framebuffer,
+                           VkClearValue *clearValues)
+{
+  ScopedContext scope(ser, name, "VkRenderPassBeginInfo", 0, true);
+
+  ser->Serialise("sType", el.sType);
+  ser->Serialise("renderPass", renderPass);
+  ser->Serialise("framebuffer", framebuffer);
+  ser->Serialise("renderArea", el.renderArea);
+  ser->SerialisePODArray("pClearValues", clearValues, el.clearValueCount);
+}
+
+void WrappedVulkan::SerialiseDeferredCmds(Serialiser *localSerialiser, VkResourceRecord *record)
+{
+  vector<DeferredCmd> &deferred = record->cmdInfo->deferred;
+  byte *data = record->cmdInfo->deferredData.data();
+
+  // this must produce exactly the same chunks as the Serialise_vkCmd* functions do when writing,
+  // so the parameters are read back in the order DeferCmd's callers wrote them, with the same names
+  for(size_t i = 0; i < deferred.size(); i++)
+  {
+    const DeferredCmd &cmd = deferred[i];
+    DeferredCmdReader params(data + cmd.dataOffset);
+    Serialiser *ser = localSerialiser;
+
+    // commands are only deferred with no debug messages or callstack to write, and worker
+    // threads have no debug message sink. Most commands serialise them last
+    bool serialisedMessages = false;
+
+    SCOPED_SERIALISE_CONTEXT(cmd.chunkType);
+
+    SERIALISE_ELEMENT(ResourceId, cmdid, cmd.cmdid);
+
+    switch(cmd.chunkType)
+    {
+      case SET_VP:
+      {
+        SerialiseParam<uint32_t>(ser, params, "first");
+        uint32_t count = SerialiseParam<uint32_t>(ser, params, "count");
+        SerialiseParamArray<VkViewport>(ser, params, "views", count);
+        break;
+      }
+      case SET_SCISSOR:
+      {
+        SerialiseParam<uint32_t>(ser, params, "first");
+        uint32_t count = SerialiseParam<uint32_t>(ser, params, "count");
+        SerialiseParamArray<VkRect2D>(ser, params, "scissors", count);
+        break;
+      }
+      case SET_LINE_WIDTH: SerialiseParam<float>(ser, params, "width"); break;
+      case SET_DEPTH_BIAS:
+      {
+        SerialiseParam<float>(ser, params, "bias");
+        SerialiseParam<float>(ser, params, "biasclamp");
+        SerialiseParam<float>(ser, params, "slope");
+        break;
+      }
+      case SET_BLEND_CONST:
+        ser->SerialisePODArray<4>("blendConst", params.ReadArray<float>(4));
+        break;
+      case SET_DEPTH_BOUNDS:
+      {
+        SerialiseParam<float>(ser, params, "mind");
+        SerialiseParam<float>(ser, params, "maxd");
+        break;
+      }
+      case SET_STENCIL_COMP_MASK:
+      case SET_STENCIL_WRITE_MASK:
+      case SET_STENCIL_REF:
+      {
+        SerialiseParam<VkStencilFaceFlagBits>(ser, params, "face");
+        SerialiseParam<uint32_t>(ser, params, "mask");
+        break;
+      }
+      case BIND_PIPELINE:
+      {
+        SerialiseParam<VkPipelineBindPoint>(ser, params, "bind");
+        SerialiseParam<ResourceId>(ser, params, "pipeid");
+        break;
+      }
+      case BIND_DESCRIPTOR_SET:
+      {
+        SerialiseParam<ResourceId>(ser, params, "layoutid");
+        SerialiseParam<VkPipelineBindPoint>(ser, params, "bind");
+        SerialiseParam<uint32_t>(ser, params, "first");
+        uint32_t numSets = SerialiseParam<uint32_t>(ser, params, "numSets");
+
+        Serialise_DebugMessages(localSerialiser, false);
+        serialisedMessages = true;
+
+        SerialiseParamArray<ResourceId>(ser, params, "DescriptorSet", numSets);
+        uint32_t offsCount = SerialiseParam<uint32_t>(ser, params, "offsCount");
+        SerialiseParamArray<uint32_t>(ser, params, "offs", offsCount);
+        break;
+      }
+      case BIND_VERTEX_BUFFERS:
+      {
+        SerialiseParam<uint32_t>(ser, params, "first");
+        uint32_t count = SerialiseParam<uint32_t>(ser, params, "count");
+
+        Serialise_DebugMessages(localSerialiser, false);
+        serialisedMessages = true;
+
+        ResourceId *bufids = params.ReadArray<ResourceId>(count);
+        VkDeviceSize *offs = params.ReadArray<VkDeviceSize>(count);
+        for(uint32_t b = 0; b < count; b++)
+        {
+          ser->Serialise("pBuffers[]", bufids[b]);
+          ser->Serialise("pOffsets[]", offs[b]);
+        }
+        break;
+      }
+      case BIND_INDEX_BUFFER:
+      {
+        SerialiseParam<ResourceId>(ser, params, "bufid");
+        SerialiseParam<uint64_t>(ser, params, "offs");
+        SerialiseParam<VkIndexType>(ser, params, "idxType");
+        break;
+      }
+      case PUSH_CONST:
+      {
+        SerialiseParam<ResourceId>(ser, params, "layid");
+        SerialiseParam<VkShaderStageFlagBits>(ser, params, "flags");
+        SerialiseParam<uint32_t>(ser, params, "s");
+        uint32_t len = SerialiseParam<uint32_t>(ser, params, "len");
+        SerialiseParamBuffer(ser, params, "vals", (size_t)len);
+        break;
+      }
+      case PIPELINE_BARRIER:
+      {
+        SerialiseParam<VkPipelineStageFlagBits>(ser, params, "srcStages");
+        SerialiseParam<VkPipelineStageFlagBits>(ser, params, "destStages");
+        SerialiseParam<VkDependencyFlags>(ser, params, "flags");
+        uint32_t memCount = SerialiseParam<uint32_t>(ser, params, "memCount");
+        uint32_t bufCount = SerialiseParam<uint32_t>(ser, params, "bufCount");
+        uint32_t imgCount = SerialiseParam<uint32_t>(ser, params, "imgCount");
+
+        SerialiseParamArray<VkMemoryBarrier>(ser, params, "memBarriers", memCount);
+
+        VkBufferMemoryBarrier *bufBarriers = params.ReadArray<VkBufferMemoryBarrier>(bufCount);
+        ResourceId *bufids = params.ReadArray<ResourceId>(bufCount);
+        for(uint32_t b = 0; b < bufCount; b++)
+          SerialiseParam(ser, "bufMemBarriers", bufBarriers[b], bufids[b]);
+
+        VkImageMemoryBarrier *imgBarriers = params.ReadArray<VkImageMemoryBarrier>(imgCount);
+        ResourceId *imgids = params.ReadArray<ResourceId>(imgCount);
+        for(uint32_t b = 0; b < imgCount; b++)
+          SerialiseParam(ser, "imgMemBarriers", imgBarriers[b], imgids[b]);
+        break;
+      }
+      case BEGIN_RENDERPASS:
+      {
+        VkRenderPassBeginInfo &beginInfo = params.Read<VkRenderPassBeginInfo>();
+        ResourceId &rpid = params.Read<ResourceId>();
+        ResourceId &fbid = params.Read<ResourceId>();
+        VkClearValue *clearValues = params.ReadArray<VkClearValue>(beginInfo.clearValueCount);
+        SerialiseParam(ser, "beginInfo", beginInfo, rpid, fbid, clearValues);
+        SerialiseParam<VkSubpassContents>(ser, params, "cont");
+        break;
+      }
+      case NEXT_SUBPASS: SerialiseParam<VkSubpassContents>(ser, params, "cont"); break;
+      case END_RENDERPASS: break;
+      case DRAW:
+      {
+        SerialiseParam<uint32_t>(ser, params, "vtxCount");
+        SerialiseParam<uint32_t>(ser, params, "instCount");
+        SerialiseParam<uint32_t>(ser, params, "firstVtx");
+        SerialiseParam<uint32_t>(ser, params, "firstInst");
+        break;
+      }
+      case DRAW_INDEXED:
+      {
+        SerialiseParam<uint32_t>(ser, params, "idxCount");
+        SerialiseParam<uint32_t>(ser, params, "instCount");
+        SerialiseParam<uint32_t>(ser, params, "firstIdx");
+        SerialiseParam<int32_t>(ser, params, "vtxOffs");
+        SerialiseParam<uint32_t>(ser, params, "firstInst");
+        break;
+      }
+      case DRAW_INDIRECT:
+      case DRAW_INDEXED_INDIRECT:
+      {
+        SerialiseParam<ResourceId>(ser, params, "bufid");
+        SerialiseParam<uint64_t>(ser, params, "offs");
+        SerialiseParam<uint32_t>(ser, params, "cnt");
+        SerialiseParam<uint32_t>(ser, params, "strd");
+        break;
+      }
+      case DISPATCH:
+      {
+        SerialiseParam<uint32_t>(ser, params, "X");
+        SerialiseParam<uint32_t>(ser, params, "Y");
+        SerialiseParam<uint32_t>(ser, params, "Z");
+        break;
+      }
+      case DISPATCH_INDIRECT:
+      {
+        SerialiseParam<ResourceId>(ser, params, "bufid");
+        SerialiseParam<uint64_t>(ser, params, "offs");
+        break;
+      }
+      case BLIT_IMG:
+      case RESOLVE_IMG:
+      case COPY_IMG:
+      {
+        SerialiseParam<ResourceId>(ser, params, "srcid");
+        SerialiseParam<VkImageLayout>(ser, params, "srclayout");
+        SerialiseParam<ResourceId>(ser, params, "dstid");
+        SerialiseParam<VkImageLayout>(ser, params, "dstlayout");
+        if(cmd.chunkType == BLIT_IMG)
+          SerialiseParam<VkFilter>(ser, params, "f");
+        uint32_t count = SerialiseParam<uint32_t>(ser, params, "count");
+        if(cmd.chunkType == BLIT_IMG)
+          SerialiseParamArray<VkImageBlit>(ser, params, "regions", count);
+        else if(cmd.chunkType == RESOLVE_IMG)
+          SerialiseParamArray<VkImageResolve>(ser, params, "regions", count);
+        else
+          SerialiseParamArray<VkImageCopy>(ser, params, "regions", count);
+        break;
+      }
+      case COPY_BUF2IMG:
+      case COPY_IMG2BUF:
+      {
+        SerialiseParam<ResourceId>(ser, params, "bufid");
+        SerialiseParam<ResourceId>(ser, params, "imgid");
+        SerialiseParam<VkImageLayout>(ser, params, "layout");
+        uint32_t count = SerialiseParam<uint32_t>(ser, params, "count");
+        SerialiseParamArray<VkBufferImageCopy>(ser, params, "regions", count);
+        break;
+      }
+      case COPY_BUF:
+      {
+        SerialiseParam<ResourceId>(ser, params, "srcid");
+        SerialiseParam<ResourceId>(ser, params, "dstid");
+        uint32_t count = SerialiseParam<uint32_t>(ser, params, "count");
+        SerialiseParamArray<VkBufferCopy>(ser, params, "regions", count);
+        break;
+      }
+      case UPDATE_BUF:
+      {
+        SerialiseParam<ResourceId>(ser, params, "bufid");
+        SerialiseParam<VkDeviceSize>(ser, params, "offs");
+        VkDeviceSize sz = SerialiseParam<VkDeviceSize>(ser, params, "sz");
+        SerialiseParamBuffer(ser, params, "bufdata", (size_t)sz);
+        break;
+      }
+      case FILL_BUF:
+      {
+        SerialiseParam<ResourceId>(ser, params, "bufid");
+        SerialiseParam<VkDeviceSize>(ser, params, "offs");
+        SerialiseParam<VkDeviceSize>(ser, params, "sz");
+        SerialiseParam<uint32_t>(ser, params, "d");
+        break;
+      }
+      case CLEAR_COLOR:
+      {
+        SerialiseParam<ResourceId>(ser, params, "imgid");
+        SerialiseParam<VkImageLayout>(ser, params, "layout");
+        SerialiseParam<VkClearColorValue>(ser, params, "col");
+        uint32_t count = SerialiseParam<uint32_t>(ser, params, "count");
+        SerialiseParamArray<VkImageSubresourceRange>(ser, params, "ranges", count);
+        break;
+      }
+      case CLEAR_DEPTHSTENCIL:
+      {
+        SerialiseParam<ResourceId>(ser, params, "imgid");
+        SerialiseParam<VkImageLayout>(ser, params, "l");
+        SerialiseParam<VkClearDepthStencilValue>(ser, params, "ds");
+        uint32_t count = SerialiseParam<uint32_t>(ser, params, "count");
+        SerialiseParamArray<VkImageSubresourceRange>(ser, params, "ranges", count);
+        break;
+      }
+      case CLEAR_ATTACH:
+      {
+        uint32_t acount = SerialiseParam<uint32_t>(ser, params, "acount");
+        SerialiseParamArray<VkClearAttachment>(ser, params, "atts", acount);
+        uint32_t rcount = SerialiseParam<uint32_t>(ser, params, "rcount");
+        SerialiseParamArray<VkClearRect>(ser, params, "rects", rcount);
+        break;
+      }
+      default: RDCERR("Unexpected deferred command %s", GetChunkName(cmd.chunkType)); break;
+    }
+
+    if(!serialisedMessages)
+      Serialise_DebugMessages(localSerialiser, false);
+
+    record->AddChunk(scope.Get(), cmd.chunkID);
+  }
+
+  // the baked command buffer can be submitted again in a later capture, and now has the chunks
+  deferred.clear();
+  record->cmdInfo->deferredData.clear();
+}
+
+void WrappedVulkan::DeferredCmdThread(void *data)
+{
+  DeferredCmdWork *work = (DeferredCmdWork *)data;
+
+#if ENABLED(RDOC_RELEASE)
+  const bool debugSerialiser = false;
+#else
+  const bool debugSerialiser = true;
+#endif
+
+  Serialiser ser(NULL, Serialiser::WRITING, debugSerialiser);
+  ser.SetUserData(work->driver->m_ResourceManager);
+
+  ser.SetChunkNameLookup(&GetChunkName);
+
+  const int32_t numRecords = (int32_t)work->records->size();
+
+  for(;;)
+  {
+    int32_t idx = Atomic::Inc32(&work->next) - 1;
+
+    if(idx >= numRecords)
+      break;
+
+    work->driver->SerialiseDeferredCmds(&ser, work->records->at(idx));
+  }
+}
+
+void WrappedVulkan::SerialiseDeferredCmds()
+{
+  vector<VkResourceRecord *> records;
+
+  for(size_t i = 0; i < m_CmdBufferRecords.size(); i++)
+  {
+    VkResourceRecord *record = m_CmdBufferRecords[i];
+    if(record->cmdInfo && !record->cmdInfo->deferred.empty())
+      records.push_back(record);
+  }
+
+  // the same baked command buffer may have been submitted several times
+  SortUnique(records);
+
+  if(records.empty())
+    return;
+
+  DeferredCmdWork work;
+  work.driver = this;
+  work.records = &records;
+  work.next = 0;
+
+  size_t numThreads = RDCMIN(records.size(), (size_t)MaxDeferredCmdThreads);
+
+  vector<Threading::ThreadHandle> threads;
+  for(size_t i = 0; i < numThreads; i++)
+    threads.push_back(Threading::CreateThread(&DeferredCmdThread, &work));
+
+  for(size_t i = 0; i < threads.size(); i++)
+  {
+    Threading::JoinThread(threads[i]);
+    Threading::CloseThread(threads[i]);
+  }
+
+  RDCDEBUG("Serialised deferred commands for %u command buffers on %u threads",
+           (uint32_t)records.size(), (uint32_t)numThreads);
+}
+
 static VkResult FillPropertyCountAndList(const VkExtensionProperties *src, uint32_t numExts,
                                          uint32_t *dstCount, VkExtensionProperties *dstProps)
 {
@@ -1026,7 +1570,7 @@ void WrappedVulkan::EndCaptureFrame(VkImage presentImage)
     delete call;
   }
 
-  m_FrameCaptureRecord->AddChunk(scope.Get());
+  AddFrameChunk(scope.Get());
 }
 
 void WrappedVulkan::FirstFrame(VkSwapchainKHR swap)
@@ -1140,6 +1684,7 @@ void WrappedVulkan::StartFrameCapture(void *dev, void *wnd)
 
     RDCDEBUG("Attempting capture");
     m_FrameCaptureRecord->DeleteChunks();
+    DeleteFrameChunks();
 
     {
       // must use main serialiser here to match resource manager
@@ -1160,6 +1705,223 @@ void WrappedVulkan::StartFrameCapture(void *dev, void *wnd)
   RDCLOG("Starting capture, frame %u", m_FrameCounter);
 }
 
+byte *WrappedVulkan::BlitThumbnail(VkImage backbuffer, VkFormat format, VkExtent2D extent,
+                                   uint32_t thwidth, uint32_t thheight)
+{
+  // very narrow or very wide backbuffers can round down to an empty thumbnail, which can't be
+  // used as a blit destination
+  if(thwidth == 0 || thheight == 0)
+    return NULL;
+
+  VkFormatProperties props = {};
+  ObjDisp(GetInstance())->GetPhysicalDeviceFormatProperties(Unwrap(GetPhysDev()), format, &props);
+
+  // if the backbuffer can't be blitted from, fall back to reading it back and sampling on the CPU
+  if((props.optimalTilingFeatures & VK_FORMAT_FEATURE_BLIT_SRC_BIT) == 0)
+    return NULL;
+
+  ResourceFormat fmt = MakeResourceFormat(format);
+
+  // integer formats can only be blitted to other integer formats, and never with linear filtering,
+  // so leave those to the CPU path too
+  if(fmt.compType == CompType::UInt || fmt.compType == CompType::SInt)
+    return NULL;
+
+  VkFilter filter = VK_FILTER_NEAREST;
+  if(props.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)
+    filter = VK_FILTER_LINEAR;
+
+  // the blit does all the format conversion. 8-bit and packed backbuffers are already in display
+  // space so the values are passed through, but floating point backbuffers are linear and need
+  // to be encoded to sRGB.
+  VkFormat thumbFormat = (fmt.srgbCorrected || fmt.compType == CompType::Float)
+                             ? VK_FORMAT_R8G8B8A8_SRGB
+                             : VK_FORMAT_R8G8B8A8_UNORM;
+
+  VkDevice device = GetDev();
+  VkCommandBuffer cmd = GetNextCmd();
+
+  const VkLayerDispatchTable *vt = ObjDisp(device);
+
+  VkResult vkr = VK_SUCCESS;
+
+  // since these objects are very short lived (only this scope), we
+  // don't wrap them.
+  VkImage thumbIm = VK_NULL_HANDLE;
+  VkDeviceMemory thumbMem = VK_NULL_HANDLE;
+  VkBuffer readbackBuf = VK_NULL_HANDLE;
+  VkDeviceMemory readbackMem = VK_NULL_HANDLE;
+
+  VkImageCreateInfo imInfo = {
+      VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+      NULL,
+      0,
+      VK_IMAGE_TYPE_2D,
+      thumbFormat,
+      {thwidth, thheight, 1},
+      1,
+      1,
+      VK_SAMPLE_COUNT_1_BIT,
+      VK_IMAGE_TILING_OPTIMAL,
+      VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
+      VK_SHARING_MODE_EXCLUSIVE,
+      0,
+      NULL,
+      VK_IMAGE_LAYOUT_UNDEFINED,
+  };
+  vkr = vt->CreateImage(Unwrap(device), &imInfo, NULL, &thumbIm);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkMemoryRequirements mrq = {0};
+  vt->GetImageMemoryRequirements(Unwrap(device), thumbIm, &mrq);
+
+  VkMemoryAllocateInfo allocInfo = {
+      VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, NULL, mrq.size,
+      GetGPULocalMemoryIndex(mrq.memoryTypeBits),
+  };
+
+  vkr = vt->AllocateMemory(Unwrap(device), &allocInfo, NULL, &thumbMem);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  vkr = vt->BindImageMemory(Unwrap(device), thumbIm, thumbMem, 0);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  const VkDeviceSize readbackSize = VkDeviceSize(thwidth) * thheight * 4;
+
+  VkBufferCreateInfo bufInfo = {
+      VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO, NULL, 0, readbackSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+  };
+  vkr = vt->CreateBuffer(Unwrap(device), &bufInfo, NULL, &readbackBuf);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  vt->GetBufferMemoryRequirements(Unwrap(device), readbackBuf, &mrq);
+
+  allocInfo.allocationSize = mrq.size;
+  allocInfo.memoryTypeIndex = GetReadbackMemoryIndex(mrq.memoryTypeBits);
+
+  vkr = vt->AllocateMemory(Unwrap(device), &allocInfo, NULL, &readbackMem);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  vkr = vt->BindBufferMemory(Unwrap(device), readbackBuf, readbackMem, 0);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
+                                        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
+
+  vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  VkImageMemoryBarrier bbBarrier = {
+      VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+      NULL,
+      0,
+      VK_ACCESS_TRANSFER_READ_BIT,
+      VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+      VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+      0,
+      0,    // MULTIDEVICE - need to actually pick the right queue family here maybe?
+      Unwrap(backbuffer),
+      {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}};
+
+  VkImageMemoryBarrier thumbBarrier = {VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                                       NULL,
+                                       0,
+                                       VK_ACCESS_TRANSFER_WRITE_BIT,
+                                       VK_IMAGE_LAYOUT_UNDEFINED,
+                                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                       VK_QUEUE_FAMILY_IGNORED,
+                                       VK_QUEUE_FAMILY_IGNORED,
+                                       thumbIm,    // was never wrapped
+                                       {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}};
+
+  DoPipelineBarrier(cmd, 1, &bbBarrier);
+  DoPipelineBarrier(cmd, 1, &thumbBarrier);
+
+  VkImageBlit blit = {
+      {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+      {
+          {0, 0, 0}, {(int32_t)extent.width, (int32_t)extent.height, 1},
+      },
+      {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1},
+      {
+          {0, 0, 0}, {(int32_t)thwidth, (int32_t)thheight, 1},
+      },
+  };
+
+  vt->CmdBlitImage(Unwrap(cmd), Unwrap(backbuffer), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, thumbIm,
+                   VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, filter);
+
+  // barrier to switch backbuffer back to present layout
+  std::swap(bbBarrier.oldLayout, bbBarrier.newLayout);
+  std::swap(bbBarrier.srcAccessMask, bbBarrier.dstAccessMask);
+
+  thumbBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  thumbBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+  thumbBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  thumbBarrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+  DoPipelineBarrier(cmd, 1, &bbBarrier);
+  DoPipelineBarrier(cmd, 1, &thumbBarrier);
+
+  VkBufferImageCopy cpy = {
+      0, 0, 0, {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1}, {0, 0, 0}, {thwidth, thheight, 1},
+  };
+
+  vt->CmdCopyImageToBuffer(Unwrap(cmd), thumbIm, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, readbackBuf,
+                           1, &cpy);
+
+  VkBufferMemoryBarrier bufBarrier = {
+      VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+      NULL,
+      VK_ACCESS_TRANSFER_WRITE_BIT,
+      VK_ACCESS_HOST_READ_BIT,
+      VK_QUEUE_FAMILY_IGNORED,
+      VK_QUEUE_FAMILY_IGNORED,
+      readbackBuf,    // was never wrapped
+      0,
+      readbackSize,
+  };
+
+  DoPipelineBarrier(cmd, 1, &bufBarrier);
+
+  vkr = vt->EndCommandBuffer(Unwrap(cmd));
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  SubmitCmds();
+  FlushQ();    // need to wait so we can readback
+
+  byte *pData = NULL;
+  vkr = vt->MapMemory(Unwrap(device), readbackMem, 0, VK_WHOLE_SIZE, 0, (void **)&pData);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  byte *thpixels = NULL;
+
+  if(pData)
+  {
+    thpixels = new byte[3 * thwidth * thheight];
+
+    // only need to drop the alpha channel
+    byte *src = pData;
+    byte *dst = thpixels;
+    for(uint32_t i = 0; i < thwidth * thheight; i++)
+    {
+      dst[0] = src[0];
+      dst[1] = src[1];
+      dst[2] = src[2];
+
+      src += 4;
+      dst += 3;
+    }
+
+    vt->UnmapMemory(Unwrap(device), readbackMem);
+  }
+
+  vt->DestroyBuffer(Unwrap(device), readbackBuf, NULL);
+  vt->FreeMemory(Unwrap(device), readbackMem, NULL);
+  vt->DestroyImage(Unwrap(device), thumbIm, NULL);
+  vt->FreeMemory(Unwrap(device), thumbMem, NULL);
+
+  return thpixels;
+}
+
 bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
 {
   if(m_State != WRITING_CAPFRAME)
@@ -1228,6 +1990,8 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
   // transition back to IDLE atomically
   {
     SCOPED_LOCK(m_CapTransitionLock);
+    SCOPED_CAPTURE_TIMER(EndCaptureFinishFrame);
+
     EndCaptureFrame(backbuffer);
 
     m_State = WRITING_IDLE;
@@ -1247,6 +2011,8 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
     }
   }
 
+  PerformanceTimer thumbnailTimer;
+
   byte *thpixels = NULL;
   uint32_t thwidth = 0;
   uint32_t thheight = 0;
@@ -1255,6 +2021,21 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
   const uint32_t maxSize = 2048;
 
   if(swap != VK_NULL_HANDLE)
+  {
+    const SwapchainInfo &swapInfo = *swaprecord->swapInfo;
+
+    float aspect = float(swapInfo.extent.width) / float(swapInfo.extent.height);
+
+    thwidth = RDCMIN(maxSize, swapInfo.extent.width);
+    thwidth &= ~0x7;    // align down to multiple of 8
+    thheight = uint32_t(float(thwidth) / aspect);
+
+    // downscale and convert on the GPU where possible, so only the thumbnail is read back
+    thpixels = BlitThumbnail(backbuffer, swapInfo.format, swapInfo.extent, thwidth, thheight);
+  }
+
+  // otherwise read back the whole backbuffer and point sample it on the CPU
+  if(swap != VK_NULL_HANDLE && thpixels == NULL)
   {
     VkDevice device = GetDev();
     VkCommandBuffer cmd = GetNextCmd();
@@ -1389,12 +2170,6 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
       float widthf = float(imInfo.extent.width);
       float heightf = float(imInfo.extent.height);
 
-      float aspect = widthf / heightf;
-
-      thwidth = RDCMIN(maxSize, imInfo.extent.width);
-      thwidth &= ~0x7;    // align down to multiple of 8
-      thheight = uint32_t(float(thwidth) / aspect);
-
       thpixels = new byte[3 * thwidth * thheight];
 
       uint32_t stride = fmt.compByteWidth * fmt.compCount;
@@ -1507,30 +2282,17 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
     vt->FreeMemory(Unwrap(device), readbackMem, NULL);
   }
 
-  byte *jpgbuf = NULL;
-  int len = thwidth * thheight;
-
-  if(wnd)
-  {
-    jpgbuf = new byte[len];
-
-    jpge::params p;
-    p.m_quality = 80;
+  CaptureStats::AddTime(CaptureTimer::EndCaptureThumbnail, thumbnailTimer.GetMilliseconds());
 
-    bool success =
-        jpge::compress_image_to_jpeg_file_in_memory(jpgbuf, len, thwidth, thheight, 3, thpixels, p);
+  // the thumbnail is JPEG-encoded on a worker thread while the rest of the capture is serialised
+  Serialiser *m_pFileSerialiser =
+      RenderDoc::Inst().OpenWriteSerialiser(this, m_FrameCounter, &m_InitParams, NULL, 0, 0, 0,
+                                            &WrappedVulkan::GetChunkName);
 
-    if(!success)
-    {
-      RDCERR("Failed to compress to jpg");
-      SAFE_DELETE_ARRAY(jpgbuf);
-      thwidth = 0;
-      thheight = 0;
-    }
-  }
-
-  Serialiser *m_pFileSerialiser = RenderDoc::Inst().OpenWriteSerialiser(
-      m_FrameCounter, &m_InitParams, jpgbuf, len, thwidth, thheight);
+  if(wnd && thpixels)
+    RenderDoc::Inst().EncodeThumbnailAsync(m_pFileSerialiser, thpixels, thwidth, thheight);
+  else
+    SAFE_DELETE_ARRAY(thpixels);
 
   {
     CACHE_THREAD_SERIALISER();
@@ -1565,10 +2327,14 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
   // pushed to the vector
 
   {
+    SCOPED_CAPTURE_TIMER(EndCaptureFrameChunks);
+
     RDCDEBUG("Flushing %u command buffer records to file serialiser",
              (uint32_t)m_CmdBufferRecords.size());
 
-    map<int32_t, Chunk *> recordlist;
+    SerialiseDeferredCmds();
+
+    ChunkList recordlist;
 
     // ensure all command buffer records within the frame evne if recorded before, but
     // otherwise order must be preserved (vs. queue submits and desc set updates)
@@ -1581,21 +2347,21 @@ bool WrappedVulkan::EndFrameCapture(void *dev, void *wnd)
     }
 
     m_FrameCaptureRecord->Insert(recordlist);
+    InsertFrameChunks(recordlist);
 
     RDCDEBUG("Flushing %u chunks to file serialiser from context record",
              (uint32_t)recordlist.size());
 
-    for(auto it = recordlist.begin(); it != recordlist.end(); ++it)
-      m_pFileSerialiser->Insert(it->second);
+    m_pFileSerialiser->InsertSorted(recordlist);
 
     RDCDEBUG("Done");
   }
 
-  m_pFileSerialiser->FlushToDisk();
+  // this may hand the write off to a background thread, so everything referenced by the serialiser
+  // must be owned by it or still alive until this returns
+  RenderDoc::Inst().WriteCapture(m_pFileSerialiser, m_FrameCounter);
+  m_pFileSerialiser = NULL;
 
-  RenderDoc::Inst().SuccessfullyWrittenLog(m_FrameCounter);
-
-  SAFE_DELETE(m_pFileSerialiser);
   SAFE_DELETE(m_HeaderChunk);
 
   m_State = WRITING_IDLE;
@@ -1730,6 +2496,9 @@ void WrappedVulkan::ReadLogInitialisation()
 
   m_pSerialiser->SetDebugText(false);
 
+  // everything derived while loading has been added to the cache by now
+  m_CreationInfo.m_ReplayCache.Save();
+
   // ensure the capture at least created a device and fetched a queue.
   RDCASSERT(m_Device != VK_NULL_HANDLE && m_Queue != VK_NULL_HANDLE &&
             m_InternalCmds.cmdpool != VK_NULL_HANDLE);
@@ -2313,7 +3082,7 @@ void WrappedVulkan::ProcessChunk(uint64_t offset, VulkanChunkType context)
       // ignore system chunks
       if((int)context == (int)INITIAL_CONTENTS)
         Serialise_InitialState(ResourceId(), NULL);
-      else if((int)context < (int)FIRST_CHUNK_ID)
+      else if(IsSystemChunk(context))
         m_pSerialiser->SkipCurrentChunk();
       else
         RDCERR("Unrecognised Chunk type %d", context);
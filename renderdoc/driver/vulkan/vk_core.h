@@ -228,6 +228,64 @@ private:
   Threading::CriticalSection m_ThreadSerialisersLock;
   vector<Serialiser *> m_ThreadSerialisers;
 
+  // chunks destined for m_FrameCaptureRecord are appended to a log owned by the calling thread,
+  // tagged with their global order ID, so that threads recording in parallel don't contend on the
+  // record's lock. The logs are merged in EndFrameCapture.
+  struct FrameChunkLog
+  {
+    enum
+    {
+      BlockSize = 1024
+    };
+
+    struct Block
+    {
+      Block() : next(NULL) {}
+      pair<int32_t, Chunk *> chunks[BlockSize];
+      Block *next;
+    };
+
+    FrameChunkLog() : tail(&head), count(0) {}
+    Block head;
+    Block *tail;
+
+    // number of chunks that are safe to read from other threads. Only the owning thread adds
+    // chunks, and the logs are only cleared while no thread can be capturing
+    volatile int32_t count;
+  };
+
+  uint64_t frameChunkLogTLSSlot;
+
+  // protected by m_ThreadSerialisersLock
+  vector<FrameChunkLog *> m_FrameChunkLogs;
+
+  void AddFrameChunk(Chunk *chunk);
+  void InsertFrameChunks(ChunkList &recordlist);
+  void DeleteFrameChunks();
+
+  // the common vkCmd* functions (state, binds, barriers, render passes, draws, dispatches, copies
+  // and clears) store their parameters compactly in the command buffer's recording info, and are
+  // only serialised into chunks when the command buffer is part of a captured frame. That's done
+  // in EndFrameCapture across a few worker threads.
+  enum
+  {
+    MaxDeferredCmdThreads = 4
+  };
+
+  struct DeferredCmdWork
+  {
+    WrappedVulkan *driver;
+    vector<VkResourceRecord *> *records;
+    volatile int32_t next;
+  };
+
+  bool CanDeferCmd();
+  DeferredCmdWriter DeferCmd(VkResourceRecord *record, VulkanChunkType type,
+                             VkCommandBuffer commandBuffer);
+  void SerialiseDeferredCmds();
+  void SerialiseDeferredCmds(Serialiser *localSerialiser, VkResourceRecord *record);
+  static void DeferredCmdThread(void *data);
+
   uint64_t tempMemoryTLSSlot;
   struct TempMem
   {
@@ -551,8 +609,9 @@ private:
   {
     ~DescriptorSetInfo()
     {
-      for(size_t i = 0; i < currentBindings.size(); i++)
-        delete[] currentBindings[i];
+      // all bindings are allocated in one block, see DescSetLayout::CreateBindingsArray
+      if(!currentBindings.empty())
+        delete[] currentBindings[0];
       currentBindings.clear();
     }
     ResourceId layout;
@@ -613,6 +672,10 @@ private:
 
   void StartFrameCapture(void *dev, void *wnd);
   bool EndFrameCapture(void *dev, void *wnd);
+  void GetRecordMemoryUsage(std::map<std::string, CaptureStats::Counter> &usage)
+  {
+    GetResourceManager()->GetRecordMemoryUsage(usage);
+  }
 
   bool Serialise_SetShaderDebugPath(Serialiser *localSerialiser, VkDevice device,
                                     VkDebugMarkerObjectTagInfoEXT *pTagInfo);
@@ -667,6 +730,19 @@ private:
 
   void AddUsage(VulkanDrawcallTreeNode &drawNode, vector<DebugMessage> &debugMessages);
 
+  byte *BlitThumbnail(VkImage backbuffer, VkFormat format, VkExtent2D extent, uint32_t thwidth,
+                      uint32_t thheight);
+
+  // in vk_cmd_funcs.cpp
+  CmdBufferRecordingInfo *AllocRecordingInfo(VkResourceRecord *cmdRecord);
+  void ReleaseBakedCommands(VkResourceRecord *cmdRecord);
+
+  // in vk_descriptor_funcs.cpp
+  void UpdateDescriptorSlotRefs(DescriptorSlotRefs &refs, const DescriptorSetSlot &bind,
+                                FrameRefType ref);
+  void MarkDescriptorSetReferenced(VkResourceRecord *setrecord, std::set<ResourceId> *refdIDs);
+  void MarkDescriptorSetDirtied(VkResourceRecord *setrecord, vector<ResourceId> &dirtied);
+
   // no copy semantics
   WrappedVulkan(const WrappedVulkan &);
   WrappedVulkan &operator=(const WrappedVulkan &);
@@ -170,51 +170,214 @@ struct VulkanBlobShaderCallbacks
   byte *GetData(vector<uint32_t> *blob) const { return (byte *)&(*blob)[0]; }
 } ShaderCacheCallbacks;
 
-string VulkanDebugManager::GetSPIRVBlob(SPIRVShaderStage shadType,
-                                        const std::vector<std::string> &sources,
-                                        vector<uint32_t> **outBlob)
+// the stage is included since the same source can be compiled for several, and each source's
+// length so that the same text split differently between sources doesn't collide.
+static uint64_t ShaderCacheKey(SPIRVShaderStage shadType, const std::vector<std::string> &sources,
+                               uint64_t seed = 0)
 {
-  RDCASSERT(sources.size() > 0);
+  uint64_t hash = Hash64(&shadType, sizeof(shadType), seed);
 
-  uint32_t hash = strhash(sources[0].c_str());
-  for(size_t i = 1; i < sources.size(); i++)
-    hash = strhash(sources[i].c_str(), hash);
+  for(size_t i = 0; i < sources.size(); i++)
+  {
+    uint64_t len = sources[i].size();
+    hash = Hash64(&len, sizeof(len), hash);
+    hash = Hash64(sources[i].c_str(), sources[i].size(), hash);
+  }
+
+  return hash;
+}
+
+void VulkanDebugManager::CompileInternalSPIRV(vector<SPIRVCompilation> &shaders,
+                                              vector<vector<uint32_t> *> &blobs)
+{
+  vector<uint64_t> keys(shaders.size());
+
+  vector<SPIRVCompilation *> compiles;
+  vector<uint64_t> compileKeys;
+
+  for(size_t i = 0; i < shaders.size(); i++)
+  {
+    RDCASSERT(shaders[i].sources.size() > 0);
+
+    keys[i] = ShaderCacheKey(shaders[i].stage, shaders[i].sources);
+
+    if(m_ShaderCache.find(keys[i]) != m_ShaderCache.end() ||
+       std::find(compileKeys.begin(), compileKeys.end(), keys[i]) != compileKeys.end())
+      continue;
+
+    compiles.push_back(&shaders[i]);
+    compileKeys.push_back(keys[i]);
+  }
+
+  if(compiles.empty())
+  {
+    RDCDEBUG("All %u internal shaders found in shader cache", (uint32_t)shaders.size());
+  }
+  else
+  {
+    PerformanceTimer timer;
+
+    CompileSPIRVParallel(compiles);
+
+    RDCLOG("Compiled %u of %u internal shaders in %.2lf ms", (uint32_t)compiles.size(),
+           (uint32_t)shaders.size(), timer.GetMilliseconds());
+
+    for(size_t i = 0; i < compiles.size(); i++)
+    {
+      if(!compiles[i]->errors.empty() || compiles[i]->spirv.empty())
+      {
+        string logerror = compiles[i]->errors;
+        if(logerror.length() > 1024)
+          logerror = logerror.substr(0, 1024) + "...";
+
+        RDCWARN("Shader compile error:\n%s", logerror.c_str());
+        continue;
+      }
 
-  char typestr[2] = {'a', 0};
-  typestr[0] += (char)shadType;
-  hash = strhash(typestr, hash);
+      // the cache owns every blob, so the pointers handed out below live as long as we do
+      vector<uint32_t> *spirv = new vector<uint32_t>();
+      spirv->swap(compiles[i]->spirv);
 
-  if(m_ShaderCache.find(hash) != m_ShaderCache.end())
+      m_ShaderCache[compileKeys[i]] = spirv;
+      m_ShaderCacheDirty = true;
+    }
+  }
+
+  blobs.resize(shaders.size());
+
+  for(size_t i = 0; i < shaders.size(); i++)
   {
-    *outBlob = m_ShaderCache[hash];
-    return "";
+    auto it = m_ShaderCache.find(keys[i]);
+    blobs[i] = it == m_ShaderCache.end() ? NULL : it->second;
   }
+}
+
+// user shader cache entries are stored as this header, then the compiler output padded to a whole
+// number of words, then the SPIR-V
+struct UserShaderCacheHeader
+{
+  uint64_t checkHash;
+  uint64_t lastUse;
+  uint32_t outputLength;
+  uint32_t padding;
+};
+
+static const size_t UserShaderHeaderWords = sizeof(UserShaderCacheHeader) / sizeof(uint32_t);
+
+// seeds the second, independent hash of a user shader that's checked on every hit
+static const uint64_t UserShaderCheckSeed = 0x9e3779b97f4a7c15ULL;
+
+static vector<uint32_t> *EncodeUserShader(const UserShaderCacheHeader &header, const string &output,
+                                          const vector<uint32_t> &spirv)
+{
+  size_t outputWords = (output.size() + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+  vector<uint32_t> *blob = new vector<uint32_t>(UserShaderHeaderWords + outputWords + spirv.size());
+
+  memcpy(&(*blob)[0], &header, sizeof(header));
+  if(!output.empty())
+    memcpy(&(*blob)[UserShaderHeaderWords], output.c_str(), output.size());
+  memcpy(&(*blob)[UserShaderHeaderWords + outputWords], &spirv[0], spirv.size() * sizeof(uint32_t));
+
+  return blob;
+}
+
+static bool DecodeUserShaderHeader(const vector<uint32_t> &blob, UserShaderCacheHeader &header)
+{
+  if(blob.size() < UserShaderHeaderWords)
+    return false;
+
+  memcpy(&header, &blob[0], sizeof(header));
+
+  size_t outputWords = (header.outputLength + sizeof(uint32_t) - 1) / sizeof(uint32_t);
 
-  vector<uint32_t> *spirv = new vector<uint32_t>();
-  string errors = CompileSPIRV(shadType, sources, *spirv);
+  // there must be some SPIR-V after the output
+  return UserShaderHeaderWords + outputWords < blob.size();
+}
+
+string VulkanDebugManager::CompileUserSPIRV(SPIRVShaderStage shadType,
+                                            const std::vector<std::string> &sources,
+                                            vector<uint32_t> &spirv)
+{
+  uint64_t hash = ShaderCacheKey(shadType, sources);
+  uint64_t checkHash = ShaderCacheKey(shadType, sources, UserShaderCheckSeed);
 
-  if(!errors.empty())
+  UserShaderCacheHeader header = {};
+
+  auto it = m_UserShaderCache.find(hash);
+  if(it != m_UserShaderCache.end())
   {
-    string logerror = errors;
-    if(logerror.length() > 1024)
-      logerror = logerror.substr(0, 1024) + "...";
+    vector<uint32_t> &blob = *it->second;
+
+    if(DecodeUserShaderHeader(blob, header) && header.checkHash == checkHash)
+    {
+      size_t outputWords = (header.outputLength + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+      string output((const char *)&blob[UserShaderHeaderWords], header.outputLength);
+      spirv.assign(blob.begin() + UserShaderHeaderWords + outputWords, blob.end());
+
+      header.lastUse = Timing::GetUnixTimestamp();
+      memcpy(&blob[0], &header, sizeof(header));
+      m_UserShaderCacheDirty = true;
 
-    RDCWARN("Shader compile error:\n%s", logerror.c_str());
+      return output;
+    }
 
-    delete spirv;
-    *outBlob = NULL;
-    return errors;
+    // a different shader with the same key, or a corrupt entry. Compile and replace it
+    delete it->second;
+    m_UserShaderCache.erase(it);
   }
 
-  *outBlob = spirv;
+  PerformanceTimer timer;
+
+  string output = CompileSPIRV(shadType, sources, spirv);
+
+  RDCLOG("Compiled shader in %.2lf ms", timer.GetMilliseconds());
 
-  if(m_CacheShaders)
+  if(spirv.empty())
+    return output;
+
+  if(m_UserShaderCache.size() >= m_MaxUserShaderCacheEntries)
   {
-    m_ShaderCache[hash] = spirv;
-    m_ShaderCacheDirty = true;
+    auto oldest = m_UserShaderCache.end();
+    uint64_t oldestUse = ~0ULL;
+
+    for(auto u = m_UserShaderCache.begin(); u != m_UserShaderCache.end(); ++u)
+    {
+      UserShaderCacheHeader h = {};
+      DecodeUserShaderHeader(*u->second, h);
+
+      if(h.lastUse < oldestUse)
+      {
+        oldest = u;
+        oldestUse = h.lastUse;
+      }
+    }
+
+    delete oldest->second;
+    m_UserShaderCache.erase(oldest);
   }
 
-  return errors;
+  header.checkHash = checkHash;
+  header.lastUse = Timing::GetUnixTimestamp();
+  header.outputLength = (uint32_t)output.size();
+  header.padding = 0;
+
+  m_UserShaderCache[hash] = EncodeUserShader(header, output, spirv);
+  m_UserShaderCacheDirty = true;
+
+  return output;
+}
+
+static string HistogramDefines(bool texelFetchBrokenDriver, size_t texType, size_t fmt)
+{
+  string defines = "";
+  if(texelFetchBrokenDriver)
+    defines += "#define NO_TEXEL_FETCH\n";
+  defines += string("#define SHADER_RESTYPE ") + ToStr::Get(texType) + "\n";
+  defines += string("#define UINT_TEX ") + (fmt == 1 ? "1" : "0") + "\n";
+  defines += string("#define SINT_TEX ") + (fmt == 2 ? "1" : "0") + "\n";
+  return defines;
 }
 
 VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
@@ -325,6 +488,9 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
   m_OutlineDescSet = VK_NULL_HANDLE;
   RDCEraseEl(m_OutlinePipeline);
 
+  m_ReadbackPtr = NULL;
+  RDCEraseEl(m_ReadbackFences);
+
   m_MeshFetchDescSetLayout = VK_NULL_HANDLE;
   m_MeshFetchDescSet = VK_NULL_HANDLE;
 
@@ -350,6 +516,10 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
   // if we failed to load from the cache
   m_ShaderCacheDirty = !success;
 
+  success = LoadShaderCache("vkusershaders.cache", m_ShaderCacheMagic, m_UserShaderCacheVersion,
+                            m_UserShaderCache, ShaderCacheCallbacks);
+  m_UserShaderCacheDirty = !success;
+
   VkResult vkr = VK_SUCCESS;
 
   // create linear sampler
@@ -731,6 +901,145 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
         "version");
   }
 
+  string shaderSources[] = {
+      GetEmbeddedResource(glsl_blit_vert),        GetEmbeddedResource(glsl_checkerboard_frag),
+      GetEmbeddedResource(glsl_texdisplay_frag),  GetEmbeddedResource(glsl_mesh_vert),
+      GetEmbeddedResource(glsl_mesh_geom),        GetEmbeddedResource(glsl_mesh_frag),
+      GetEmbeddedResource(glsl_minmaxtile_comp),  GetEmbeddedResource(glsl_minmaxresult_comp),
+      GetEmbeddedResource(glsl_histogram_comp),   GetEmbeddedResource(glsl_outline_frag),
+      GetEmbeddedResource(glsl_quadresolve_frag), GetEmbeddedResource(glsl_quadwrite_frag),
+      GetEmbeddedResource(glsl_mesh_comp),        GetEmbeddedResource(glsl_ms2array_comp),
+      GetEmbeddedResource(glsl_array2ms_comp),    GetEmbeddedResource(glsl_trisize_geom),
+      GetEmbeddedResource(glsl_trisize_frag),
+  };
+
+  SPIRVShaderStage shaderStages[] = {
+      eSPIRVVertex,  eSPIRVFragment, eSPIRVFragment, eSPIRVVertex,   eSPIRVGeometry, eSPIRVFragment,
+      eSPIRVCompute, eSPIRVCompute,  eSPIRVCompute,  eSPIRVFragment, eSPIRVFragment, eSPIRVFragment,
+      eSPIRVCompute, eSPIRVCompute,  eSPIRVCompute,  eSPIRVGeometry, eSPIRVFragment,
+  };
+
+  enum shaderIdx
+  {
+    BLITVS,
+    CHECKERBOARDFS,
+    TEXDISPLAYFS,
+    MESHVS,
+    MESHGS,
+    MESHFS,
+    MINMAXTILECS,
+    MINMAXRESULTCS,
+    HISTOGRAMCS,
+    OUTLINEFS,
+    QUADRESOLVEFS,
+    QUADWRITEFS,
+    MESHCS,
+    MS2ARRAYCS,
+    ARRAY2MSCS,
+    TRISIZEGS,
+    TRISIZEFS,
+    NUM_SHADERS,
+  };
+
+  RDCCOMPILE_ASSERT(ARRAY_COUNT(shaderSources) == ARRAY_COUNT(shaderStages), "Mismatched arrays!");
+  RDCCOMPILE_ASSERT(ARRAY_COUNT(shaderSources) == NUM_SHADERS, "Mismatched arrays!");
+
+  // generate the source of every internal shader up front, so that any which aren't in the shader
+  // cache can be compiled together across several threads. Pipeline creation below then picks
+  // each module's SPIR-V out of the results by its index in this list.
+  vector<SPIRVCompilation> compiles;
+
+  // depth MS<->array blit shaders, needed in both replay and capture
+  const size_t depthMSShaders = compiles.size();
+  {
+    std::string srcs[] = {
+        GetEmbeddedResource(glsl_blit_vert), GetEmbeddedResource(glsl_depthms2arr_frag),
+        GetEmbeddedResource(glsl_deptharr2ms_frag),
+    };
+
+    for(size_t i = 0; i < ARRAY_COUNT(srcs); i++)
+    {
+      GenerateGLSLShader(sources, eShaderVulkan, "", srcs[i], 430);
+      compiles.push_back(SPIRVCompilation(i == 0 ? eSPIRVVertex : eSPIRVFragment, sources));
+    }
+  }
+
+  size_t textShaders = 0, arrayMSShaders = 0;
+  size_t fixedColShader = 0;
+  size_t replayShaders[NUM_SHADERS] = {};
+  // the first of each histogram, min/max tile and (for 1D textures) min/max result set, in order
+  size_t histogramShaders[eTexType_Max][3] = {};
+
+  if(m_State >= WRITING)
+  {
+    textShaders = compiles.size();
+
+    GenerateGLSLShader(sources, eShaderVulkan, "", GetEmbeddedResource(glsl_text_vert), 430);
+    compiles.push_back(SPIRVCompilation(eSPIRVVertex, sources));
+
+    GenerateGLSLShader(sources, eShaderVulkan, "", GetEmbeddedResource(glsl_text_frag), 430);
+    compiles.push_back(SPIRVCompilation(eSPIRVFragment, sources));
+
+    arrayMSShaders = compiles.size();
+
+    GenerateGLSLShader(sources, eShaderVulkan, "", GetEmbeddedResource(glsl_array2ms_comp), 430,
+                       false);
+    compiles.push_back(SPIRVCompilation(eSPIRVCompute, sources));
+
+    GenerateGLSLShader(sources, eShaderVulkan, "", GetEmbeddedResource(glsl_ms2array_comp), 430,
+                       false);
+    compiles.push_back(SPIRVCompilation(eSPIRVCompute, sources));
+  }
+  else
+  {
+    fixedColShader = compiles.size();
+
+    GenerateGLSLShader(sources, eShaderVulkan, "", GetEmbeddedResource(glsl_fixedcol_frag), 430,
+                       false);
+    compiles.push_back(SPIRVCompilation(eSPIRVFragment, sources));
+
+    for(size_t i = 0; i < NUM_SHADERS; i++)
+    {
+      // these are compiled in several variants below
+      if(i == HISTOGRAMCS || i == MINMAXTILECS || i == MINMAXRESULTCS)
+        continue;
+
+      string defines = "";
+      if(texelFetchBrokenDriver)
+        defines += "#define NO_TEXEL_FETCH\n";
+
+      replayShaders[i] = compiles.size();
+
+      GenerateGLSLShader(sources, eShaderVulkan, defines, shaderSources[i], 430, i != QUADWRITEFS);
+      compiles.push_back(SPIRVCompilation(shaderStages[i], sources));
+    }
+
+    for(size_t t = eTexType_1D; t < eTexType_Max; t++)
+    {
+      for(size_t f = 0; f < 3; f++)
+      {
+        string defines = HistogramDefines(texelFetchBrokenDriver, t, f);
+
+        histogramShaders[t][f] = compiles.size();
+
+        GenerateGLSLShader(sources, eShaderVulkan, defines, shaderSources[HISTOGRAMCS], 430);
+        compiles.push_back(SPIRVCompilation(eSPIRVCompute, sources));
+
+        GenerateGLSLShader(sources, eShaderVulkan, defines, shaderSources[MINMAXTILECS], 430);
+        compiles.push_back(SPIRVCompilation(eSPIRVCompute, sources));
+
+        if(t == 1)
+        {
+          GenerateGLSLShader(sources, eShaderVulkan, defines, shaderSources[MINMAXRESULTCS], 430);
+          compiles.push_back(SPIRVCompilation(eSPIRVCompute, sources));
+        }
+      }
+    }
+  }
+
+  vector<vector<uint32_t> *> spirv;
+  CompileInternalSPIRV(compiles, spirv);
+
   // needed in both replay and capture, create depth MS->array pipelines
   {
     {
@@ -783,28 +1092,19 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
       ARR2MS
     };
 
-    std::string srcs[] = {
-        GetEmbeddedResource(glsl_blit_vert), GetEmbeddedResource(glsl_depthms2arr_frag),
-        GetEmbeddedResource(glsl_deptharr2ms_frag),
-    };
-
     VkShaderModule modules[3];
 
-    for(size_t i = 0; i < ARRAY_COUNT(srcs); i++)
+    for(size_t i = 0; i < ARRAY_COUNT(modules); i++)
     {
-      GenerateGLSLShader(sources, eShaderVulkan, "", srcs[i], 430);
-
-      vector<uint32_t> *spirv;
-
-      string err = GetSPIRVBlob(i == 0 ? eSPIRVVertex : eSPIRVFragment, sources, &spirv);
-      RDCASSERT(err.empty() && spirv);
+      vector<uint32_t> *blob = spirv[depthMSShaders + i];
+      RDCASSERT(blob);
 
       VkShaderModuleCreateInfo modinfo = {
           VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
           NULL,
           0,
-          spirv->size() * sizeof(uint32_t),
-          &(*spirv)[0],
+          blob->size() * sizeof(uint32_t),
+          &(*blob)[0],
       };
 
       vkr = m_pDriver->vkCreateShaderModule(dev, &modinfo, NULL, &modules[i]);
@@ -1009,21 +1309,15 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
 
     for(size_t i = 0; i < 2; i++)
     {
-      GenerateGLSLShader(
-          sources, eShaderVulkan, "",
-          i == 0 ? GetEmbeddedResource(glsl_text_vert) : GetEmbeddedResource(glsl_text_frag), 430);
-
-      vector<uint32_t> *spirv;
-
-      string err = GetSPIRVBlob(i == 0 ? eSPIRVVertex : eSPIRVFragment, sources, &spirv);
-      RDCASSERT(err.empty() && spirv);
+      vector<uint32_t> *blob = spirv[textShaders + i];
+      RDCASSERT(blob);
 
       VkShaderModuleCreateInfo modinfo = {
           VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
           NULL,
           0,
-          spirv->size() * sizeof(uint32_t),
-          &(*spirv)[0],
+          blob->size() * sizeof(uint32_t),
+          &(*blob)[0],
       };
 
       vkr = m_pDriver->vkCreateShaderModule(dev, &modinfo, NULL, &stages[i].module);
@@ -1032,21 +1326,15 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
 
     for(size_t i = 0; i < 2; i++)
     {
-      GenerateGLSLShader(sources, eShaderVulkan, "", i == 0 ? GetEmbeddedResource(glsl_array2ms_comp)
-                                                            : GetEmbeddedResource(glsl_ms2array_comp),
-                         430, false);
-
-      vector<uint32_t> *spirv;
-
-      string err = GetSPIRVBlob(eSPIRVCompute, sources, &spirv);
-      RDCASSERT(err.empty() && spirv);
+      vector<uint32_t> *blob = spirv[arrayMSShaders + i];
+      RDCASSERT(blob);
 
       VkShaderModuleCreateInfo modinfo = {
           VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
           NULL,
           0,
-          spirv->size() * sizeof(uint32_t),
-          &(*spirv)[0],
+          blob->size() * sizeof(uint32_t),
+          &(*blob)[0],
       };
 
       vkr = m_pDriver->vkCreateShaderModule(dev, &modinfo, NULL,
@@ -1695,7 +1983,21 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
                           GPUBuffer::eGPUBufferGPULocal | GPUBuffer::eGPUBufferSSBO);
   m_MeshPickResultReadback.Create(driver, dev, meshPickResultSize, 1, GPUBuffer::eGPUBufferReadback);
 
-  m_ReadbackWindow.Create(driver, dev, STAGE_BUFFER_BYTE_SIZE, 1, GPUBuffer::eGPUBufferReadback);
+  m_ReadbackWindow.Create(driver, dev, STAGE_BUFFER_BYTE_SIZE, 2, GPUBuffer::eGPUBufferReadback);
+
+  vkr = ObjDisp(dev)->MapMemory(Unwrap(dev), Unwrap(m_ReadbackWindow.mem), 0, VK_WHOLE_SIZE, 0,
+                                (void **)&m_ReadbackPtr);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  {
+    VkFenceCreateInfo fenceInfo = {VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+
+    for(size_t i = 0; i < ARRAY_COUNT(m_ReadbackFences); i++)
+    {
+      vkr = m_pDriver->vkCreateFence(dev, &fenceInfo, NULL, &m_ReadbackFences[i]);
+      RDCASSERTEQUAL(vkr, VK_SUCCESS);
+    }
+  }
 
   m_OutlineUBO.Create(driver, dev, 128, 10, 0);
   RDCCOMPILE_ASSERT(sizeof(OutlineUBOData) <= 128, "outline UBO size");
@@ -1705,88 +2007,34 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
 
   RDCCOMPILE_ASSERT(sizeof(TexDisplayUBOData) <= 128, "tex display size");
 
-  string shaderSources[] = {
-      GetEmbeddedResource(glsl_blit_vert),        GetEmbeddedResource(glsl_checkerboard_frag),
-      GetEmbeddedResource(glsl_texdisplay_frag),  GetEmbeddedResource(glsl_mesh_vert),
-      GetEmbeddedResource(glsl_mesh_geom),        GetEmbeddedResource(glsl_mesh_frag),
-      GetEmbeddedResource(glsl_minmaxtile_comp),  GetEmbeddedResource(glsl_minmaxresult_comp),
-      GetEmbeddedResource(glsl_histogram_comp),   GetEmbeddedResource(glsl_outline_frag),
-      GetEmbeddedResource(glsl_quadresolve_frag), GetEmbeddedResource(glsl_quadwrite_frag),
-      GetEmbeddedResource(glsl_mesh_comp),        GetEmbeddedResource(glsl_ms2array_comp),
-      GetEmbeddedResource(glsl_array2ms_comp),    GetEmbeddedResource(glsl_trisize_geom),
-      GetEmbeddedResource(glsl_trisize_frag),
-  };
-
-  SPIRVShaderStage shaderStages[] = {
-      eSPIRVVertex,  eSPIRVFragment, eSPIRVFragment, eSPIRVVertex,   eSPIRVGeometry, eSPIRVFragment,
-      eSPIRVCompute, eSPIRVCompute,  eSPIRVCompute,  eSPIRVFragment, eSPIRVFragment, eSPIRVFragment,
-      eSPIRVCompute, eSPIRVCompute,  eSPIRVCompute,  eSPIRVGeometry, eSPIRVFragment,
-  };
-
-  enum shaderIdx
-  {
-    BLITVS,
-    CHECKERBOARDFS,
-    TEXDISPLAYFS,
-    MESHVS,
-    MESHGS,
-    MESHFS,
-    MINMAXTILECS,
-    MINMAXRESULTCS,
-    HISTOGRAMCS,
-    OUTLINEFS,
-    QUADRESOLVEFS,
-    QUADWRITEFS,
-    MESHCS,
-    MS2ARRAYCS,
-    ARRAY2MSCS,
-    TRISIZEGS,
-    TRISIZEFS,
-    NUM_SHADERS,
-  };
+  m_FixedColSPIRV = spirv[fixedColShader];
+  RDCASSERT(m_FixedColSPIRV);
 
-  vector<uint32_t> *shaderSPIRV[NUM_SHADERS];
   VkShaderModule module[NUM_SHADERS];
 
-  RDCCOMPILE_ASSERT(ARRAY_COUNT(shaderSources) == ARRAY_COUNT(shaderStages), "Mismatched arrays!");
-  RDCCOMPILE_ASSERT(ARRAY_COUNT(shaderSources) == NUM_SHADERS, "Mismatched arrays!");
-
-  m_CacheShaders = true;
-
-  {
-    GenerateGLSLShader(sources, eShaderVulkan, "", GetEmbeddedResource(glsl_fixedcol_frag), 430,
-                       false);
-
-    string err = GetSPIRVBlob(eSPIRVFragment, sources, &m_FixedColSPIRV);
-    RDCASSERT(err.empty() && m_FixedColSPIRV);
-  }
-
   for(size_t i = 0; i < ARRAY_COUNT(module); i++)
   {
-    // these modules will be compiled later
+    // these modules are created per-variant below
     if(i == HISTOGRAMCS || i == MINMAXTILECS || i == MINMAXRESULTCS)
+    {
+      module[i] = VK_NULL_HANDLE;
       continue;
+    }
 
-    string defines = "";
-    if(texelFetchBrokenDriver)
-      defines += "#define NO_TEXEL_FETCH\n";
-
-    GenerateGLSLShader(sources, eShaderVulkan, defines, shaderSources[i], 430, i != QUADWRITEFS);
-
-    string err = GetSPIRVBlob(shaderStages[i], sources, &shaderSPIRV[i]);
-    RDCASSERT(err.empty() && shaderSPIRV[i]);
+    vector<uint32_t> *blob = spirv[replayShaders[i]];
+    RDCASSERT(blob);
 
     VkShaderModuleCreateInfo modinfo = {
         VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
         NULL,
         0,
-        shaderSPIRV[i]->size() * sizeof(uint32_t),
-        &(*shaderSPIRV[i])[0],
+        blob->size() * sizeof(uint32_t),
+        &(*blob)[0],
     };
 
     if(i == QUADWRITEFS)
     {
-      m_QuadSPIRV = shaderSPIRV[i];
+      m_QuadSPIRV = blob;
       module[i] = VK_NULL_HANDLE;
       continue;
     }
@@ -1897,23 +2145,12 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
       VkShaderModule minmaxtile = VK_NULL_HANDLE;
       VkShaderModule minmaxresult = VK_NULL_HANDLE;
       VkShaderModule histogram = VK_NULL_HANDLE;
-      string err;
-      vector<uint32_t> *blob = NULL;
       VkShaderModuleCreateInfo modinfo = {
           VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, NULL, 0, 0, NULL,
       };
 
-      string defines = "";
-      if(texelFetchBrokenDriver)
-        defines += "#define NO_TEXEL_FETCH\n";
-      defines += string("#define SHADER_RESTYPE ") + ToStr::Get(t) + "\n";
-      defines += string("#define UINT_TEX ") + (f == 1 ? "1" : "0") + "\n";
-      defines += string("#define SINT_TEX ") + (f == 2 ? "1" : "0") + "\n";
-
-      GenerateGLSLShader(sources, eShaderVulkan, defines, shaderSources[HISTOGRAMCS], 430);
-
-      err = GetSPIRVBlob(eSPIRVCompute, sources, &blob);
-      RDCASSERT(err.empty() && blob);
+      vector<uint32_t> *blob = spirv[histogramShaders[t][f]];
+      RDCASSERT(blob);
 
       modinfo.codeSize = blob->size() * sizeof(uint32_t);
       modinfo.pCode = &(*blob)[0];
@@ -1921,10 +2158,8 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
       vkr = m_pDriver->vkCreateShaderModule(dev, &modinfo, NULL, &histogram);
       RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-      GenerateGLSLShader(sources, eShaderVulkan, defines, shaderSources[MINMAXTILECS], 430);
-
-      err = GetSPIRVBlob(eSPIRVCompute, sources, &blob);
-      RDCASSERT(err.empty() && blob);
+      blob = spirv[histogramShaders[t][f] + 1];
+      RDCASSERT(blob);
 
       modinfo.codeSize = blob->size() * sizeof(uint32_t);
       modinfo.pCode = &(*blob)[0];
@@ -1934,10 +2169,8 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
 
       if(t == 1)
       {
-        GenerateGLSLShader(sources, eShaderVulkan, defines, shaderSources[MINMAXRESULTCS], 430);
-
-        err = GetSPIRVBlob(eSPIRVCompute, sources, &blob);
-        RDCASSERT(err.empty() && blob);
+        blob = spirv[histogramShaders[t][f] + 2];
+        RDCASSERT(blob);
 
         modinfo.codeSize = blob->size() * sizeof(uint32_t);
         modinfo.pCode = &(*blob)[0];
@@ -2001,8 +2234,6 @@ VulkanDebugManager::VulkanDebugManager(WrappedVulkan *driver, VkDevice dev)
     RDCASSERTEQUAL(vkr, VK_SUCCESS);
   }
 
-  m_CacheShaders = false;
-
   m_pDriver->vkDestroyRenderPass(dev, RGBA16RP, NULL);
   m_pDriver->vkDestroyRenderPass(dev, RGBA32RP, NULL);
   m_pDriver->vkDestroyRenderPass(dev, RGBA8sRGBRP, NULL);
@@ -2456,6 +2687,17 @@ VulkanDebugManager::~VulkanDebugManager()
       ShaderCacheCallbacks.Destroy(it->second);
   }
 
+  if(m_UserShaderCacheDirty)
+  {
+    SaveShaderCache("vkusershaders.cache", m_ShaderCacheMagic, m_UserShaderCacheVersion,
+                    m_UserShaderCache, ShaderCacheCallbacks);
+  }
+  else
+  {
+    for(auto it = m_UserShaderCache.begin(); it != m_UserShaderCache.end(); ++it)
+      ShaderCacheCallbacks.Destroy(it->second);
+  }
+
   for(auto it = m_PostVSData.begin(); it != m_PostVSData.end(); ++it)
   {
     m_pDriver->vkDestroyBuffer(dev, it->second.vsout.buf, NULL);
@@ -2577,6 +2819,13 @@ VulkanDebugManager::~VulkanDebugManager()
     }
   }
 
+  if(m_ReadbackPtr)
+    ObjDisp(dev)->UnmapMemory(Unwrap(dev), Unwrap(m_ReadbackWindow.mem));
+
+  for(size_t i = 0; i < ARRAY_COUNT(m_ReadbackFences); i++)
+    if(m_ReadbackFences[i] != VK_NULL_HANDLE)
+      m_pDriver->vkDestroyFence(dev, m_ReadbackFences[i], NULL);
+
   m_ReadbackWindow.Destroy();
 
   m_MinMaxTileResult.Destroy();
@@ -4382,9 +4631,6 @@ void VulkanDebugManager::EndText(const TextPrintState &textstate)
 void VulkanDebugManager::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len,
                                        vector<byte> &ret)
 {
-  VkDevice dev = m_pDriver->GetDev();
-  const VkLayerDispatchTable *vt = ObjDisp(dev);
-
   VkBuffer srcBuf = m_pDriver->GetResourceManager()->GetCurrentHandle<VkBuffer>(buff);
 
   if(srcBuf == VK_NULL_HANDLE)
@@ -4415,82 +4661,141 @@ void VulkanDebugManager::GetBufferData(ResourceId buff, uint64_t offset, uint64_
 
   ret.resize((size_t)len);
 
+  GetBufferDataInto(buff, offset, len, &ret[0]);
+}
+
+uint64_t VulkanDebugManager::GetBufferDataInto(ResourceId buff, uint64_t offset, uint64_t len,
+                                               byte *dest)
+{
+  VkDevice dev = m_pDriver->GetDev();
+  const VkLayerDispatchTable *vt = ObjDisp(dev);
+
+  VkBuffer srcBuf = m_pDriver->GetResourceManager()->GetCurrentHandle<VkBuffer>(buff);
+
+  if(srcBuf == VK_NULL_HANDLE)
+  {
+    RDCERR("Getting buffer data for unknown buffer %llu!", buff);
+    return 0;
+  }
+
+  uint64_t bufsize = m_pDriver->m_CreationInfo.m_Buffer[buff].size;
+
+  if(offset >= bufsize)
+    return 0;
+
+  len = RDCMIN(len, bufsize - offset);
+
+  if(len == 0)
+    return 0;
+
   VkDeviceSize srcoffset = (VkDeviceSize)offset;
   size_t dstoffset = 0;
   VkDeviceSize sizeRemaining = (VkDeviceSize)len;
 
-  VkCommandBuffer cmd = m_pDriver->GetNextCmd();
-
   VkCommandBufferBeginInfo beginInfo = {VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, NULL,
                                         VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT};
 
-  VkResult vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  VkResult vkr = VK_SUCCESS;
 
-  VkBufferMemoryBarrier bufBarrier = {
-      VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-      NULL,
-      0,
-      VK_ACCESS_TRANSFER_READ_BIT,
-      VK_QUEUE_FAMILY_IGNORED,
-      VK_QUEUE_FAMILY_IGNORED,
-      Unwrap(srcBuf),
-      srcoffset,
-      sizeRemaining,
-  };
+  VkQueue q = m_pDriver->GetQ();
 
-  bufBarrier.srcAccessMask = VK_ACCESS_ALL_WRITE_BITS;
+  // the data is copied through the readback window in chunks, alternating between the two halves.
+  // Each chunk's copy is fenced separately so that we can copy out one chunk on the CPU while the
+  // GPU is copying the next one.
+  const uint32_t numChunks = uint32_t((len + STAGE_BUFFER_BYTE_SIZE - 1) / STAGE_BUFFER_BYTE_SIZE);
 
-  // wait for previous writes to happen before we copy to our window buffer
-  DoPipelineBarrier(cmd, 1, &bufBarrier);
+  VkDeviceSize chunkSizes[2] = {0, 0};
 
-  vkr = vt->EndCommandBuffer(Unwrap(cmd));
-  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+  // one extra iteration, to read back the last chunk
+  for(uint32_t c = 0; c <= numChunks; c++)
+  {
+    if(c < numChunks)
+    {
+      const uint32_t slot = c % 2;
+      const VkDeviceSize slotOffset = slot * STAGE_BUFFER_BYTE_SIZE;
 
-#if ENABLED(SINGLE_FLUSH_VALIDATE)
-  m_pDriver->SubmitCmds();
-#endif
+      VkDeviceSize chunkSize = RDCMIN(sizeRemaining, STAGE_BUFFER_BYTE_SIZE);
 
-  while(sizeRemaining > 0)
-  {
-    VkDeviceSize chunkSize = RDCMIN(sizeRemaining, STAGE_BUFFER_BYTE_SIZE);
+      VkCommandBuffer cmd = m_pDriver->GetNextCmd();
 
-    vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+      vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+      RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-    VkBufferCopy region = {srcoffset, 0, chunkSize};
-    vt->CmdCopyBuffer(Unwrap(cmd), Unwrap(srcBuf), Unwrap(m_ReadbackWindow.buf), 1, &region);
+      VkBufferMemoryBarrier bufBarrier = {
+          VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+          NULL,
+          VK_ACCESS_ALL_WRITE_BITS,
+          VK_ACCESS_TRANSFER_READ_BIT,
+          VK_QUEUE_FAMILY_IGNORED,
+          VK_QUEUE_FAMILY_IGNORED,
+          Unwrap(srcBuf),
+          srcoffset,
+          sizeRemaining,
+      };
 
-    bufBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-    bufBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
-    bufBarrier.buffer = Unwrap(m_ReadbackWindow.buf);
-    bufBarrier.offset = 0;
-    bufBarrier.size = chunkSize;
+      // wait for previous writes to happen before we copy to our window buffer
+      if(c == 0)
+        DoPipelineBarrier(cmd, 1, &bufBarrier);
 
-    // wait for transfer to happen before we read
-    DoPipelineBarrier(cmd, 1, &bufBarrier);
+      VkBufferCopy region = {srcoffset, slotOffset, chunkSize};
+      vt->CmdCopyBuffer(Unwrap(cmd), Unwrap(srcBuf), Unwrap(m_ReadbackWindow.buf), 1, &region);
 
-    vkr = vt->EndCommandBuffer(Unwrap(cmd));
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+      bufBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+      bufBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+      bufBarrier.buffer = Unwrap(m_ReadbackWindow.buf);
+      bufBarrier.offset = slotOffset;
+      bufBarrier.size = chunkSize;
 
-    m_pDriver->SubmitCmds();
-    m_pDriver->FlushQ();
+      // wait for transfer to happen before we read
+      DoPipelineBarrier(cmd, 1, &bufBarrier);
 
-    byte *pData = NULL;
-    vkr = vt->MapMemory(Unwrap(dev), Unwrap(m_ReadbackWindow.mem), 0, VK_WHOLE_SIZE, 0,
-                        (void **)&pData);
-    RDCASSERTEQUAL(vkr, VK_SUCCESS);
+      vkr = vt->EndCommandBuffer(Unwrap(cmd));
+      RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-    RDCASSERT(pData != NULL);
-    memcpy(&ret[dstoffset], pData, (size_t)chunkSize);
+      m_pDriver->SubmitCmds();
 
-    dstoffset += (size_t)chunkSize;
-    sizeRemaining -= chunkSize;
+      vkr = ObjDisp(q)->QueueSubmit(Unwrap(q), 0, NULL, Unwrap(m_ReadbackFences[slot]));
+      RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-    vt->UnmapMemory(Unwrap(dev), Unwrap(m_ReadbackWindow.mem));
+      chunkSizes[slot] = chunkSize;
+
+      srcoffset += chunkSize;
+      sizeRemaining -= chunkSize;
+    }
+
+    // copy out the previous chunk while the GPU works on this one
+    if(c > 0)
+    {
+      const uint32_t slot = (c - 1) % 2;
+      const VkDeviceSize slotOffset = slot * STAGE_BUFFER_BYTE_SIZE;
+
+      VkFence fence = Unwrap(m_ReadbackFences[slot]);
+
+      vkr = vt->WaitForFences(Unwrap(dev), 1, &fence, VK_TRUE, UINT64_MAX);
+      RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+      vkr = vt->ResetFences(Unwrap(dev), 1, &fence);
+      RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+      VkMappedMemoryRange range = {
+          VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, NULL, Unwrap(m_ReadbackWindow.mem), slotOffset,
+          STAGE_BUFFER_BYTE_SIZE,
+      };
+
+      vkr = vt->InvalidateMappedMemoryRanges(Unwrap(dev), 1, &range);
+      RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+      RDCASSERT(m_ReadbackPtr != NULL);
+      memcpy(dest + dstoffset, m_ReadbackPtr + slotOffset, (size_t)chunkSizes[slot]);
+
+      dstoffset += (size_t)chunkSizes[slot];
+    }
   }
 
-  vt->DeviceWaitIdle(Unwrap(dev));
+  // all copies have been waited on already, this just recycles the command buffers
+  m_pDriver->FlushQ();
+
+  return len;
 }
 
 void VulkanDebugManager::MakeGraphicsPipelineInfo(VkGraphicsPipelineCreateInfo &pipeCreateInfo,
@@ -7929,8 +8234,12 @@ void VulkanDebugManager::InitPostVSBuffers(uint32_t eventID)
   if(pipeInfo.shaders[0].module == ResourceId())
     return;
 
-  const VulkanCreationInfo::ShaderModule &moduleInfo =
-      creationInfo.m_ShaderModule[pipeInfo.shaders[0].module];
+  auto moduleIt = creationInfo.m_ShaderModule.find(pipeInfo.shaders[0].module);
+
+  if(moduleIt == creationInfo.m_ShaderModule.end())
+    return;
+
+  const VulkanCreationInfo::ShaderModule &moduleInfo = moduleIt->second;
 
   ShaderReflection *refl = pipeInfo.shaders[0].refl;
 
@@ -8199,7 +8508,7 @@ void VulkanDebugManager::InitPostVSBuffers(uint32_t eventID)
   }
 
   uint32_t bufStride = 0;
-  vector<uint32_t> modSpirv = moduleInfo.spirv.spirv;
+  vector<uint32_t> modSpirv = moduleInfo.GetSPIRV().spirv;
 
   AddOutputDumping(*refl, pipeInfo.shaders[0].entryPoint.c_str(), descSet, vertexIndexOffset,
                    drawcall->instanceOffset, numVerts, modSpirv, bufStride);
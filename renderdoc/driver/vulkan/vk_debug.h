@@ -119,6 +119,7 @@ public:
   void AliasPostVSBuffers(uint32_t eventID, uint32_t alias) { m_PostVSAlias[alias] = eventID; }
   MeshFormat GetPostVSBuffers(uint32_t eventID, uint32_t instID, MeshDataStage stage);
   void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len, vector<byte> &ret);
+  uint64_t GetBufferDataInto(ResourceId buff, uint64_t offset, uint64_t len, byte *dest);
 
   FloatVector InterpretVertex(byte *data, uint32_t vert, const MeshDisplay &cfg, byte *end,
                               bool &valid);
@@ -134,6 +135,11 @@ public:
   void CreateCustomShaderTex(uint32_t width, uint32_t height, uint32_t mip);
   void CreateCustomShaderPipeline(ResourceId shader);
 
+  // compiles a user-provided shader (custom display or replacement) through the user shader
+  // cache. Returns the compiler output, which is cached along with the SPIR-V.
+  string CompileUserSPIRV(SPIRVShaderStage shadType, const std::vector<std::string> &sources,
+                          vector<uint32_t> &spirv);
+
   void ReplaceResource(ResourceId from, ResourceId to);
   void RemoveReplacement(ResourceId id);
 
@@ -326,7 +332,11 @@ public:
   VkPipeline m_OutlinePipeline[8];
   GPUBuffer m_OutlineUBO;
 
+  // readback window is split in two halves, so one can be copied out on the CPU while the GPU
+  // copies into the other. It stays persistently mapped.
   GPUBuffer m_ReadbackWindow;
+  byte *m_ReadbackPtr;
+  VkFence m_ReadbackFences[2];
 
   VkDescriptorSetLayout m_MeshFetchDescSetLayout;
   VkDescriptorSet m_MeshFetchDescSet;
@@ -342,13 +352,23 @@ private:
 
   VulkanResourceManager *GetResourceManager() { return m_ResourceManager; }
   static const uint32_t m_ShaderCacheMagic = 0xf00d00d5;
-  static const uint32_t m_ShaderCacheVersion = 1;
+  static const uint32_t m_ShaderCacheVersion = 3;
+
+  bool m_ShaderCacheDirty;
+  map<uint64_t, vector<uint32_t> *> m_ShaderCache;
+
+  // user shaders are cached in their own file, since they can be edited endlessly. Each entry
+  // holds a second hash to verify hits, the compiler output and when it was last used, and once
+  // there are this many the least recently used is evicted.
+  static const uint32_t m_UserShaderCacheVersion = 1;
+  static const size_t m_MaxUserShaderCacheEntries = 256;
 
-  bool m_ShaderCacheDirty, m_CacheShaders;
-  map<uint32_t, vector<uint32_t> *> m_ShaderCache;
+  bool m_UserShaderCacheDirty;
+  map<uint64_t, vector<uint32_t> *> m_UserShaderCache;
 
-  string GetSPIRVBlob(SPIRVShaderStage shadType, const std::vector<std::string> &sources,
-                      vector<uint32_t> **outBlob);
+  // compiles any shaders that aren't already in the cache concurrently and adds them to it, then
+  // returns the cached SPIR-V for each shader in order (NULL if it failed to compile)
+  void CompileInternalSPIRV(vector<SPIRVCompilation> &shaders, vector<vector<uint32_t> *> &blobs);
 
   void CopyDepthTex2DMSToArray(VkImage destArray, VkImage srcMS, VkExtent3D extent, uint32_t layers,
                                uint32_t samples, VkFormat fmt);
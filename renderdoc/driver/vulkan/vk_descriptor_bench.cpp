@@ -0,0 +1,162 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+// standalone tool to time the descriptor set reference tracking done on the capture side, without
+// needing a device. It builds DescriptorSetData directly and times the bookkeeping for each slot
+// written by vkUpdateDescriptorSets, and gathering the resources a set may have dirtied as done
+// for every bound set in vkEndCommandBuffer. Built with -DENABLE_VULKAN_DESCRIPTOR_BENCH=ON, run
+// as:
+//
+//   vk-descriptor-bench [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "common/common.h"
+#include "common/timing.h"
+#include "vk_resources.h"
+
+// one in this many slots is a storage descriptor, the rest are read-only
+static const uint32_t StorageSlotInterval = 256;
+
+static void CreateSet(DescriptorSetData &set, uint32_t numSlots)
+{
+  set.descBindings.push_back(new DescriptorSetSlot[numSlots]);
+  set.slotRefs.resize(numSlots);
+}
+
+static void WriteSlot(DescriptorSetData &set, uint32_t idx, ResourceId res, FrameRefType ref)
+{
+  DescriptorSlotRefs &refs = set.slotRefs[idx];
+
+  refs = DescriptorSlotRefs();
+  refs.ref = ref;
+  refs.view = res;
+  refs.resource = res;
+
+  set.UpdateWriteSlot(set.descBindings[0][idx]);
+}
+
+// what MarkDescriptorSetDirtied did before the write slots were tracked
+static void GatherDirtiedFullScan(const DescriptorSetData &set, vector<ResourceId> &dirtied)
+{
+  const vector<DescriptorSlotRefs> &slotRefs = set.slotRefs;
+
+  for(size_t i = 0; i < slotRefs.size(); i++)
+  {
+    if(slotRefs[i].ref == eFrameRef_Write && slotRefs[i].resource != ResourceId())
+      dirtied.push_back(slotRefs[i].resource);
+  }
+}
+
+static void GatherDirtiedWriteSlots(const DescriptorSetData &set, vector<ResourceId> &dirtied)
+{
+  const vector<DescriptorSlotRefs> &slotRefs = set.slotRefs;
+  const vector<uint32_t> &writeSlots = set.writeSlots;
+
+  for(size_t i = 0; i < writeSlots.size(); i++)
+    dirtied.push_back(slotRefs[writeSlots[i]].resource);
+}
+
+int main(int argc, char **argv)
+{
+  int iterations = argc > 1 ? RDCMAX(1, atoi(argv[1])) : 20000;
+
+  const uint32_t slotCounts[] = {64, 1024, 16384};
+
+  ResourceId res = ResourceIDGen::GetNewUniqueID();
+
+  // stops the gathered results being optimised out
+  size_t sink = 0;
+
+  printf("%8s %18s %18s %18s %18s\n", "slots", "read (ns/slot)", "storage (ns/slot)",
+         "full scan (ns)", "write list (ns)");
+
+  for(size_t s = 0; s < ARRAY_COUNT(slotCounts); s++)
+  {
+    uint32_t numSlots = slotCounts[s];
+
+    DescriptorSetData set;
+    CreateSet(set, numSlots);
+
+    // half of the slots are written with read-only descriptors, and every StorageSlotInterval'th
+    // slot with a storage descriptor
+    PerformanceTimer timer;
+    uint64_t readWrites = 0;
+
+    for(int iter = 0; iter < iterations; iter += numSlots / 2)
+    {
+      for(uint32_t i = 0; i < numSlots; i += 2)
+        WriteSlot(set, i, res, eFrameRef_Read);
+      readWrites += numSlots / 2;
+    }
+
+    double readNS = timer.GetMilliseconds() * 1000000.0 / double(readWrites);
+
+    // rewriting a storage slot with a read-only descriptor and back removes it from and re-adds it
+    // to the write list each time
+    timer.Restart();
+    uint64_t storageWrites = 0;
+
+    for(int iter = 0; iter < iterations; iter++)
+    {
+      uint32_t idx = (uint32_t(iter) * StorageSlotInterval) % numSlots + 1;
+      WriteSlot(set, idx, res, eFrameRef_Read);
+      WriteSlot(set, idx, res, eFrameRef_Write);
+      storageWrites += 2;
+    }
+
+    double storageNS = timer.GetMilliseconds() * 1000000.0 / double(storageWrites);
+
+    for(uint32_t i = 1; i < numSlots; i += StorageSlotInterval)
+      WriteSlot(set, i, res, eFrameRef_Write);
+
+    vector<ResourceId> dirtied;
+    dirtied.reserve(numSlots);
+
+    timer.Restart();
+    for(int iter = 0; iter < iterations; iter++)
+    {
+      dirtied.clear();
+      GatherDirtiedFullScan(set, dirtied);
+      sink += dirtied.size();
+    }
+    double scanNS = timer.GetMilliseconds() * 1000000.0 / double(iterations);
+
+    timer.Restart();
+    for(int iter = 0; iter < iterations; iter++)
+    {
+      dirtied.clear();
+      GatherDirtiedWriteSlots(set, dirtied);
+      sink += dirtied.size();
+    }
+    double listNS = timer.GetMilliseconds() * 1000000.0 / double(iterations);
+
+    printf("%8u %18.1f %18.1f %18.1f %18.1f\n", numSlots, readNS, storageNS, scanNS, listNS);
+  }
+
+  // print something dependent on the results so the loops aren't removed
+  printf("\n%llu resources gathered\n", (unsigned long long)sink);
+
+  return 0;
+}
@@ -71,14 +71,53 @@ void DescSetLayout::Init(VulkanResourceManager *resourceMan, VulkanCreationInfo
   }
 }
 
-void DescSetLayout::CreateBindingsArray(vector<DescriptorSetSlot *> &descBindings)
+uint32_t DescSetLayout::CreateBindingsArray(vector<DescriptorSetSlot *> &descBindings)
 {
+  uint32_t totalCount = 0;
+  for(size_t i = 0; i < bindings.size(); i++)
+    totalCount += bindings[i].descriptorCount;
+
   descBindings.resize(bindings.size());
+
+  if(bindings.empty())
+    return 0;
+
+  DescriptorSetSlot *slots = new DescriptorSetSlot[totalCount];
+  memset(slots, 0, sizeof(DescriptorSetSlot) * totalCount);
+
   for(size_t i = 0; i < bindings.size(); i++)
   {
-    descBindings[i] = new DescriptorSetSlot[bindings[i].descriptorCount];
-    memset(descBindings[i], 0, sizeof(DescriptorSetSlot) * bindings[i].descriptorCount);
+    descBindings[i] = slots;
+    slots += bindings[i].descriptorCount;
   }
+
+  return totalCount;
+}
+
+VulkanCreationInfo::~VulkanCreationInfo()
+{
+  for(auto it = m_ShaderModuleData.begin(); it != m_ShaderModuleData.end(); ++it)
+    delete it->second;
+
+  for(size_t i = 0; i < m_EmptyShaderModuleData.size(); i++)
+    delete m_EmptyShaderModuleData[i];
+}
+
+// pipelines write the reflection for their entry points into the module's data, so a module that
+// was never initialised gets an empty one of its own
+static VulkanCreationInfo::ShaderModule &GetModuleForPipeline(VulkanCreationInfo &info,
+                                                              ResourceId id)
+{
+  VulkanCreationInfo::ShaderModule &module = info.m_ShaderModule[id];
+
+  if(module.data == NULL)
+  {
+    RDCERR("Pipeline uses shader module %llu which has no data", id);
+    module.data = new VulkanCreationInfo::ShaderModuleData;
+    info.m_EmptyShaderModuleData.push_back(module.data);
+  }
+
+  return module;
 }
 
 void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan, VulkanCreationInfo &info,
@@ -105,14 +144,14 @@ void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan, Vulk
     shad.module = id;
     shad.entryPoint = pCreateInfo->pStages[i].pName;
 
-    ShaderModule::Reflection &reflData = info.m_ShaderModule[id].m_Reflections[shad.entryPoint];
+    ShaderModule &module = GetModuleForPipeline(info, id);
+    ShaderModule::Reflection &reflData = module.GetReflection(shad.entryPoint);
 
     if(reflData.entryPoint.empty())
     {
       reflData.entryPoint = shad.entryPoint;
       reflData.stage = stageIndex;
-      info.m_ShaderModule[id].spirv.MakeReflection(ShaderStage(reflData.stage), reflData.entryPoint,
-                                                   &reflData.refl, &reflData.mapping);
+      module.MakeReflection(info.m_ReplayCache, ShaderStage(reflData.stage), reflData);
     }
 
     if(pCreateInfo->pStages[i].pSpecializationInfo)
@@ -320,13 +359,13 @@ void VulkanCreationInfo::Pipeline::Init(VulkanResourceManager *resourceMan, Vulk
     shad.module = id;
     shad.entryPoint = pCreateInfo->stage.pName;
 
-    ShaderModule::Reflection &reflData = info.m_ShaderModule[id].m_Reflections[shad.entryPoint];
+    ShaderModule &module = GetModuleForPipeline(info, id);
+    ShaderModule::Reflection &reflData = module.GetReflection(shad.entryPoint);
 
     if(reflData.entryPoint.empty())
     {
       reflData.entryPoint = shad.entryPoint;
-      info.m_ShaderModule[id].spirv.MakeReflection(ShaderStage::Compute, reflData.entryPoint,
-                                                   &reflData.refl, &reflData.mapping);
+      module.MakeReflection(info.m_ReplayCache, ShaderStage::Compute, reflData);
     }
 
     if(pCreateInfo->stage.pSpecializationInfo)
@@ -564,14 +603,118 @@ void VulkanCreationInfo::ShaderModule::Init(VulkanResourceManager *resourceMan,
                                             VulkanCreationInfo &info,
                                             const VkShaderModuleCreateInfo *pCreateInfo)
 {
+  spirvHash = Hash64(pCreateInfo->pCode, pCreateInfo->codeSize);
+
   const uint32_t SPIRVMagic = 0x07230203;
-  if(pCreateInfo->codeSize < 4 || memcmp(pCreateInfo->pCode, &SPIRVMagic, sizeof(SPIRVMagic)))
+  bool isSPIRV = pCreateInfo->codeSize >= 4 &&
+                 memcmp(pCreateInfo->pCode, &SPIRVMagic, sizeof(SPIRVMagic)) == 0;
+
+  // look for a module created with identical code. In the vanishingly unlikely case of a hash
+  // collision with different code, probe onwards to the next key.
+  for(;;)
+  {
+    auto it = info.m_ShaderModuleData.find(spirvHash);
+
+    if(it == info.m_ShaderModuleData.end())
+      break;
+
+    const vector<uint32_t> &words = it->second->spirv.spirv;
+
+    if(isSPIRV && words.size() * sizeof(uint32_t) == pCreateInfo->codeSize &&
+       memcmp(&words[0], pCreateInfo->pCode, pCreateInfo->codeSize) == 0)
+    {
+      data = it->second;
+      return;
+    }
+
+    spirvHash++;
+  }
+
+  data = info.m_ShaderModuleData[spirvHash] = new ShaderModuleData;
+
+  if(!isSPIRV)
   {
     RDCWARN("Shader not provided with SPIR-V");
   }
   else
   {
     RDCASSERT(pCreateInfo->codeSize % sizeof(uint32_t) == 0);
-    ParseSPIRV((uint32_t *)pCreateInfo->pCode, pCreateInfo->codeSize / sizeof(uint32_t), spirv);
+    ParseSPIRV((uint32_t *)pCreateInfo->pCode, pCreateInfo->codeSize / sizeof(uint32_t),
+               data->spirv);
+  }
+}
+
+VulkanCreationInfo::ShaderModule::Reflection &VulkanCreationInfo::ShaderModule::GetReflection(
+    const string &entryPoint)
+{
+  RDCASSERT(data);
+  return data->reflections[entryPoint];
+}
+
+const VulkanCreationInfo::ShaderModule::Reflection &VulkanCreationInfo::ShaderModule::GetReflection(
+    const string &entryPoint) const
+{
+  static const Reflection empty = {};
+
+  if(data == NULL)
+    return empty;
+
+  auto it = data->reflections.find(entryPoint);
+  if(it == data->reflections.end())
+    return empty;
+
+  return it->second;
+}
+
+SPVModule &VulkanCreationInfo::ShaderModule::GetSPIRV()
+{
+  RDCASSERT(data);
+  return data->spirv;
+}
+
+const SPVModule &VulkanCreationInfo::ShaderModule::GetSPIRV() const
+{
+  static const SPVModule empty;
+
+  if(data == NULL)
+    return empty;
+
+  return data->spirv;
+}
+
+void VulkanCreationInfo::ShaderModule::MakeReflection(ReplayCache &cache, ShaderStage stage,
+                                                      Reflection &reflData)
+{
+  // reflection depends only on the SPIR-V, the stage and the entry point
+  uint64_t key = Hash64(&stage, sizeof(stage), spirvHash);
+  key = Hash64(reflData.entryPoint.c_str(), reflData.entryPoint.size(), key);
+
+  const byte *blob = NULL;
+  uint64_t size = 0;
+
+  if(cache.Find(key, blob, size))
+  {
+    Serialiser ser((size_t)size, blob, false);
+
+    ser.Serialise("", reflData.refl);
+    ser.Serialise("", reflData.mapping);
+
+    if(!ser.HasError())
+      return;
+
+    reflData.refl = ShaderReflection();
+    reflData.mapping = ShaderBindpointMapping();
+  }
+
+  data->spirv.MakeReflection(stage, reflData.entryPoint, &reflData.refl, &reflData.mapping);
+
+  if(cache.IsOpen())
+  {
+    Serialiser ser(NULL, Serialiser::WRITING, false);
+
+    ser.Serialise("", reflData.refl);
+    ser.Serialise("", reflData.mapping);
+
+    cache.Add(key, ser.GetRawPtr(0), ser.GetOffset());
   }
 }
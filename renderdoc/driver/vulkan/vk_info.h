@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include "core/replay_cache.h"
 #include "driver/shaders/spirv/spirv_common.h"
 #include "vk_common.h"
 #include "vk_manager.h"
@@ -35,7 +36,10 @@ struct DescSetLayout
   void Init(VulkanResourceManager *resourceMan, VulkanCreationInfo &info,
             const VkDescriptorSetLayoutCreateInfo *pCreateInfo);
 
-  void CreateBindingsArray(vector<DescriptorSetSlot *> &descBindings);
+  // allocates all slots for the layout in one block, with descBindings[i] pointing into it at
+  // the start of binding i. Only descBindings[0] must be delete[]'d. Returns the total number of
+  // slots allocated.
+  uint32_t CreateBindingsArray(vector<DescriptorSetSlot *> &descBindings);
 
   struct Binding
   {
@@ -62,6 +66,9 @@ struct DescSetLayout
 
 struct VulkanCreationInfo
 {
+  VulkanCreationInfo() {}
+  ~VulkanCreationInfo();
+
   struct Pipeline
   {
     void Init(VulkanResourceManager *resourceMan, VulkanCreationInfo &info,
@@ -318,12 +325,19 @@ struct VulkanCreationInfo
   };
   map<ResourceId, ImageView> m_ImageView;
 
+  struct ShaderModuleData;
+
   struct ShaderModule
   {
+    ShaderModule() : data(NULL), spirvHash(0) {}
     void Init(VulkanResourceManager *resourceMan, VulkanCreationInfo &info,
               const VkShaderModuleCreateInfo *pCreateInfo);
 
-    SPVModule spirv;
+    // the parsed SPIR-V and reflection, shared with every other module created with the same code
+    ShaderModuleData *data;
+
+    // hash of the SPIR-V words, identifying derived data in the replay cache
+    uint64_t spirvHash;
 
     string unstrippedPath;
 
@@ -334,11 +348,41 @@ struct VulkanCreationInfo
       ShaderReflection refl;
       ShaderBindpointMapping mapping;
     };
-    map<string, Reflection> m_Reflections;
+
+    // data is only NULL if the module was never initialised, in which case the const versions
+    // return empty results. Modules that can be modified always have data, see GetModuleForPipeline
+    Reflection &GetReflection(const string &entryPoint);
+    const Reflection &GetReflection(const string &entryPoint) const;
+    SPVModule &GetSPIRV();
+    const SPVModule &GetSPIRV() const;
+
+    // fills out reflData for its entry point, from the replay cache if it's been made before
+    void MakeReflection(ReplayCache &cache, ShaderStage stage, Reflection &reflData);
   };
   map<ResourceId, ShaderModule> m_ShaderModule;
 
+  // applications often create a module per pipeline from the same few blobs, so the SPIR-V is
+  // parsed and reflected once per unique blob. Keyed by the hash of the code, owned here.
+  struct ShaderModuleData
+  {
+    SPVModule spirv;
+    map<string, ShaderModule::Reflection> reflections;
+  };
+  map<uint64_t, ShaderModuleData *> m_ShaderModuleData;
+
+  // empty data for modules that pipelines reference without them ever being initialised, so that
+  // each has its own rather than sharing one
+  vector<ShaderModuleData *> m_EmptyShaderModuleData;
+
   map<ResourceId, string> m_Names;
   map<ResourceId, SwapchainInfo> m_SwapChain;
   map<ResourceId, DescSetLayout> m_DescSetLayout;
+
+  // only opened when replaying a capture
+  ReplayCache m_ReplayCache;
+
+private:
+  // owns the shader module data, no copying
+  VulkanCreationInfo &operator=(const VulkanCreationInfo &other);
+  VulkanCreationInfo(const VulkanCreationInfo &other);
 };
@@ -596,6 +596,15 @@ void VulkanResourceManager::Apply_InitialState(WrappedVkRes *live, InitialConten
   return m_Core->Apply_InitialState(live, initial);
 }
 
+std::string VulkanResourceManager::GetResourceTypeName(WrappedVkRes *res)
+{
+  // deleted resources can still have initial contents
+  if(res == NULL)
+    return "Deleted";
+
+  return ToStr::Get(IdentifyTypeByPtr(res));
+}
+
 bool VulkanResourceManager::ResourceTypeRelease(WrappedVkRes *res)
 {
   return m_Core->ReleaseResource(res);
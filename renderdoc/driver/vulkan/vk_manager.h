@@ -267,6 +267,7 @@ private:
   bool Serialise_InitialState(ResourceId resid, WrappedVkRes *res);
   void Create_InitialState(ResourceId id, WrappedVkRes *live, bool hasData);
   void Apply_InitialState(WrappedVkRes *live, InitialContentData initial);
+  std::string GetResourceTypeName(WrappedVkRes *res);
 
   WrappedVulkan *m_Core;
 };
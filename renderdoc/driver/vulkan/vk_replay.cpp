@@ -34,6 +34,9 @@
 #define VULKAN 1
 #include "data/glsl/debuguniforms.h"
 
+// texture readbacks larger than this are copied and read back in pipelined slabs
+static const VkDeviceSize READBACK_SLAB_SIZE = 8 * 1024 * 1024ULL;
+
 VulkanReplay::OutputWindow::OutputWindow()
     : m_WindowSystem(WindowingSystem::Unknown), width(0), height(0)
 {
@@ -750,6 +753,11 @@ FrameRecord VulkanReplay::GetFrameRecord()
   return m_pDriver->GetFrameRecord();
 }
 
+ReplayCache *VulkanReplay::GetReplayCache()
+{
+  return &m_pDriver->m_CreationInfo.m_ReplayCache;
+}
+
 vector<DebugMessage> VulkanReplay::GetDebugMessages()
 {
   return m_pDriver->GetDebugMessages();
@@ -912,20 +920,19 @@ ShaderReflection *VulkanReplay::GetShader(ResourceId shader, string entryPoint)
     return NULL;
   }
 
-  // disassemble lazily on demand
-  if(shad->second.m_Reflections[entryPoint].refl.Disassembly.count == 0)
-    shad->second.m_Reflections[entryPoint].refl.Disassembly =
-        shad->second.spirv.Disassemble(entryPoint);
+  ShaderReflection &refl = shad->second.GetReflection(entryPoint).refl;
+  SPVModule &spirv = shad->second.GetSPIRV();
 
-  if(shad->second.m_Reflections[entryPoint].refl.RawBytes.count == 0 &&
-     !shad->second.spirv.spirv.empty())
-  {
-    rdctype::array<byte> &bytes = shad->second.m_Reflections[entryPoint].refl.RawBytes;
-    const vector<uint32_t> &spirv = shad->second.spirv.spirv;
-    create_array_init(bytes, spirv.size() * sizeof(uint32_t), (byte *)&spirv[0]);
-  }
+  // disassemble lazily on demand. This is shared by all modules with the same code, so it's only
+  // done once for each.
+  if(refl.Disassembly.count == 0)
+    refl.Disassembly = spirv.Disassemble(entryPoint);
+
+  if(refl.RawBytes.count == 0 && !spirv.spirv.empty())
+    create_array_init(refl.RawBytes, spirv.spirv.size() * sizeof(uint32_t),
+                      (byte *)&spirv.spirv[0]);
 
-  return &shad->second.m_Reflections[entryPoint].refl;
+  return &refl;
 }
 
 void VulkanReplay::PickPixel(ResourceId texture, uint32_t x, uint32_t y, uint32_t sliceFace,
@@ -3143,6 +3150,11 @@ void VulkanReplay::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len,
   GetDebugManager()->GetBufferData(buff, offset, len, retData);
 }
 
+uint64_t VulkanReplay::GetBufferDataInto(ResourceId buff, uint64_t offset, uint64_t len, byte *dest)
+{
+  return GetDebugManager()->GetBufferDataInto(buff, offset, len, dest);
+}
+
 bool VulkanReplay::IsRenderOutput(ResourceId id)
 {
   for(int32_t i = 0; i < m_VulkanPipelineState.Pass.framebuffer.attachments.count; i++)
@@ -3949,8 +3961,8 @@ void VulkanReplay::FillCBufferVariables(ResourceId shader, string entryPoint, ui
     return;
   }
 
-  ShaderReflection &refl = it->second.m_Reflections[entryPoint].refl;
-  ShaderBindpointMapping &mapping = it->second.m_Reflections[entryPoint].mapping;
+  ShaderReflection &refl = it->second.GetReflection(entryPoint).refl;
+  ShaderBindpointMapping &mapping = it->second.GetReflection(entryPoint).mapping;
 
   if(cbufSlot >= (uint32_t)refl.ConstantBlocks.count)
   {
@@ -3992,7 +4004,7 @@ void VulkanReplay::FillCBufferVariables(ResourceId shader, string entryPoint, ui
         if(pipeIt != m_pDriver->m_CreationInfo.m_Pipeline.end())
         {
           auto specInfo =
-              pipeIt->second.shaders[it->second.m_Reflections[entryPoint].stage].specialization;
+              pipeIt->second.shaders[it->second.GetReflection(entryPoint).stage].specialization;
 
           // find any actual values specified
           for(size_t i = 0; i < specInfo.size(); i++)
@@ -5181,33 +5193,58 @@ byte *VulkanReplay::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t m
                     GetDepthOnlyFormat(imCreateInfo.format), mip);
 
     copyregion[1].bufferOffset = AlignUp(copyregion[1].bufferOffset, (VkDeviceSize)4);
-
-    vt->CmdCopyImageToBuffer(Unwrap(cmd), srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                             readbackBuf, 2, copyregion);
   }
-  else
+
+  // large colour readbacks are split into slabs of rows, or of slices for 3D images, and each slab
+  // is submitted with its own fence. That way the CPU copies out each slab while the GPU is copying
+  // the next one, instead of waiting for the whole copy to finish first.
+  const VkExtent3D &copyExtent = copyregion[0].imageExtent;
+  const bool slabSlices = copyExtent.depth > 1;
+  const uint32_t slabCount = slabSlices ? copyExtent.depth : copyExtent.height;
+
+  uint32_t numSlabs = 1;
+  uint32_t slabStep = slabCount;
+  VkDeviceSize slabStride = 0;
+
+  if(!isDepth && !isStencil && dataSize > READBACK_SLAB_SIZE)
   {
-    // copy from desired subresource in srcImage to buffer
-    vt->CmdCopyImageToBuffer(Unwrap(cmd), srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                             readbackBuf, 1, copyregion);
+    if(slabSlices)
+      slabStride = GetByteSize(copyExtent.width, copyExtent.height, 1, imCreateInfo.format, 0);
+    else if(!IsBlockFormat(imCreateInfo.format))
+      slabStride = GetByteSize(copyExtent.width, 1, 1, imCreateInfo.format, 0);
+
+    // buffer offsets for each slab must be 4-byte aligned
+    if(slabStride > 0 && (slabStride % 4) == 0)
+    {
+      slabStep = RDCMAX(1U, uint32_t(READBACK_SLAB_SIZE / slabStride));
+      numSlabs = (slabCount + slabStep - 1) / slabStep;
+    }
   }
 
-  // if we have no tmpImage, we're copying directly from the real image
-  if(tmpImage == VK_NULL_HANDLE)
+  VkFence slabFences[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+
+  if(numSlabs > 1)
   {
-    // ensure transfer has completed
-    srcimBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    VkFenceCreateInfo fenceInfo = {VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
 
-    // image layout back to normal
-    for(size_t si = 0; si < layouts.subresourceStates.size(); si++)
+    for(int i = 0; i < 2; i++)
     {
-      srcimBarrier.subresourceRange = layouts.subresourceStates[si].subresourceRange;
-      srcimBarrier.newLayout = layouts.subresourceStates[si].newLayout;
-      srcimBarrier.dstAccessMask = MakeAccessMask(srcimBarrier.newLayout);
-      DoPipelineBarrier(cmd, 1, &srcimBarrier);
+      vkr = vt->CreateFence(Unwrap(dev), &fenceInfo, NULL, &slabFences[i]);
+      RDCASSERTEQUAL(vkr, VK_SUCCESS);
     }
   }
 
+  // the buffer stays mapped while the slabs are copied into it
+  byte *pData = NULL;
+  vkr = vt->MapMemory(Unwrap(dev), readbackMem, 0, VK_WHOLE_SIZE, 0, (void **)&pData);
+  RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+  RDCASSERT(pData != NULL);
+
+  VkMappedMemoryRange readbackRange = {
+      VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE, NULL, readbackMem, 0, VK_WHOLE_SIZE,
+  };
+
   VkBufferMemoryBarrier bufBarrier = {
       VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
       NULL,
@@ -5220,22 +5257,123 @@ byte *VulkanReplay::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t m
       dataSize,
   };
 
-  // wait for copy to finish before reading back to host
-  DoPipelineBarrier(cmd, 1, &bufBarrier);
+  byte *ret = new byte[dataSize];
+
+  // one extra iteration, to read back the last slab
+  for(uint32_t slab = 0; slab <= numSlabs; slab++)
+  {
+    if(slab < numSlabs)
+    {
+      // the first slab's copy goes in the command buffer with the barriers above
+      if(slab > 0)
+      {
+        cmd = m_pDriver->GetNextCmd();
 
-  vt->EndCommandBuffer(Unwrap(cmd));
+        vkr = vt->BeginCommandBuffer(Unwrap(cmd), &beginInfo);
+        RDCASSERTEQUAL(vkr, VK_SUCCESS);
+      }
 
-  m_pDriver->SubmitCmds();
+      if(isDepth && isStencil)
+      {
+        vt->CmdCopyImageToBuffer(Unwrap(cmd), srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                 readbackBuf, 2, copyregion);
+      }
+      else
+      {
+        VkBufferImageCopy region = copyregion[0];
+
+        if(numSlabs > 1)
+        {
+          uint32_t first = slab * slabStep;
+          uint32_t num = RDCMIN(slabStep, slabCount - first);
+
+          if(slabSlices)
+          {
+            region.imageOffset.z = first;
+            region.imageExtent.depth = num;
+          }
+          else
+          {
+            region.imageOffset.y = first;
+            region.imageExtent.height = num;
+          }
+
+          region.bufferOffset = first * slabStride;
+
+          bufBarrier.offset = region.bufferOffset;
+          bufBarrier.size = num * slabStride;
+        }
+
+        // copy from desired subresource in srcImage to buffer
+        vt->CmdCopyImageToBuffer(Unwrap(cmd), srcImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                                 readbackBuf, 1, &region);
+      }
+
+      // if we have no tmpImage, we're copying directly from the real image
+      if(tmpImage == VK_NULL_HANDLE && slab + 1 == numSlabs)
+      {
+        // ensure transfer has completed
+        srcimBarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+        // image layout back to normal
+        for(size_t si = 0; si < layouts.subresourceStates.size(); si++)
+        {
+          srcimBarrier.subresourceRange = layouts.subresourceStates[si].subresourceRange;
+          srcimBarrier.newLayout = layouts.subresourceStates[si].newLayout;
+          srcimBarrier.dstAccessMask = MakeAccessMask(srcimBarrier.newLayout);
+          DoPipelineBarrier(cmd, 1, &srcimBarrier);
+        }
+      }
+
+      // wait for copy to finish before reading back to host
+      DoPipelineBarrier(cmd, 1, &bufBarrier);
+
+      vt->EndCommandBuffer(Unwrap(cmd));
+
+      m_pDriver->SubmitCmds();
+
+      if(numSlabs > 1)
+      {
+        VkQueue q = m_pDriver->GetQ();
+        vkr = ObjDisp(q)->QueueSubmit(Unwrap(q), 0, NULL, slabFences[slab % 2]);
+        RDCASSERTEQUAL(vkr, VK_SUCCESS);
+      }
+    }
+
+    // copy out the previous slab while the GPU works on this one
+    if(numSlabs > 1 && slab > 0)
+    {
+      VkFence fence = slabFences[(slab - 1) % 2];
+
+      vkr = vt->WaitForFences(Unwrap(dev), 1, &fence, VK_TRUE, UINT64_MAX);
+      RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+      vkr = vt->ResetFences(Unwrap(dev), 1, &fence);
+      RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+      vkr = vt->InvalidateMappedMemoryRanges(Unwrap(dev), 1, &readbackRange);
+      RDCASSERTEQUAL(vkr, VK_SUCCESS);
+
+      uint32_t first = (slab - 1) * slabStep;
+      uint32_t num = RDCMIN(slabStep, slabCount - first);
+
+      size_t offs = size_t(first * slabStride);
+      size_t len = RDCMIN(size_t(num * slabStride), dataSize - offs);
+
+      memcpy(ret + offs, pData + offs, len);
+    }
+  }
+
+  // everything has already been waited on if we read back in slabs, this just recycles the
+  // command buffers
   m_pDriver->FlushQ();
 
-  // map the buffer and copy to return buffer
-  byte *pData = NULL;
-  vkr = vt->MapMemory(Unwrap(dev), readbackMem, 0, VK_WHOLE_SIZE, 0, (void **)&pData);
+  vkr = vt->InvalidateMappedMemoryRanges(Unwrap(dev), 1, &readbackRange);
   RDCASSERTEQUAL(vkr, VK_SUCCESS);
 
-  RDCASSERT(pData != NULL);
-
-  byte *ret = new byte[dataSize];
+  for(int i = 0; i < 2; i++)
+    if(slabFences[i] != VK_NULL_HANDLE)
+      vt->DestroyFence(Unwrap(dev), slabFences[i], NULL);
 
   if(isDepth && isStencil)
   {
@@ -5307,7 +5445,7 @@ byte *VulkanReplay::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t m
     }
     // need to manually copy to interleave pixels
   }
-  else
+  else if(numSlabs == 1)
   {
     memcpy(ret, pData, dataSize);
   }
@@ -5362,7 +5500,7 @@ void VulkanReplay::BuildCustomShader(string source, string entry, const uint32_t
   sources.push_back(source);
   vector<uint32_t> spirv;
 
-  string output = CompileSPIRV(stage, sources, spirv);
+  string output = GetDebugManager()->CompileUserSPIRV(stage, sources, spirv);
 
   if(spirv.empty())
   {
@@ -5474,7 +5612,7 @@ void VulkanReplay::BuildTargetShader(string source, string entry, const uint32_t
   sources.push_back(source);
   vector<uint32_t> spirv;
 
-  string output = CompileSPIRV(stage, sources, spirv);
+  string output = GetDebugManager()->CompileUserSPIRV(stage, sources, spirv);
 
   if(spirv.empty())
   {
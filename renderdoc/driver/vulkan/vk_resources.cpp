@@ -755,6 +755,9 @@ VkResourceRecord::~VkResourceRecord()
   if(resType == eResCommandBuffer)
     SAFE_DELETE(cmdInfo);
 
+  if(resType == eResCommandPool)
+    SAFE_DELETE(cmdPoolInfo);
+
   if(resType == eResFramebuffer || resType == eResRenderPass)
     SAFE_DELETE_ARRAY(imageAttachments);
 
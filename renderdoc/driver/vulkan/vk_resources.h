@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include "common/wrapped_pool.h"
 #include "core/resource_manager.h"
 #include "vk_common.h"
@@ -880,6 +881,62 @@ struct SparseMapping
   void Update(uint32_t numBindings, const VkSparseImageMemoryBind *pBindings);
 };
 
+// a command recorded without serialising. It's turned into a chunk with the reserved ID only if
+// the command buffer is submitted in a captured frame. Any handles in its parameters are stored
+// as IDs, since the objects may be destroyed before the frame ends.
+struct DeferredCmd
+{
+  int32_t chunkID;
+  uint32_t chunkType;
+  ResourceId cmdid;
+  // where the command's parameters start in CmdBufferRecordingInfo::deferredData
+  size_t dataOffset;
+};
+
+// appends a deferred command's parameters. Each value is padded to 8 bytes so that the
+// parameters can be serialised in place when they're read back with DeferredCmdReader
+struct DeferredCmdWriter
+{
+  DeferredCmdWriter(vector<byte> &d) : data(d) {}
+  template <typename T>
+  void Write(const T &el)
+  {
+    WriteArray(&el, 1);
+  }
+
+  template <typename T>
+  void WriteArray(const T *els, uint32_t count)
+  {
+    size_t offs = data.size();
+    size_t size = sizeof(T) * count;
+    data.resize(offs + AlignUp(size, (size_t)8));
+    if(size > 0)
+      memcpy(&data[offs], els, size);
+  }
+
+  vector<byte> &data;
+};
+
+struct DeferredCmdReader
+{
+  DeferredCmdReader(byte *d) : data(d) {}
+  template <typename T>
+  T &Read()
+  {
+    return *ReadArray<T>(1);
+  }
+
+  template <typename T>
+  T *ReadArray(uint32_t count)
+  {
+    T *ret = (T *)data;
+    data += AlignUp(sizeof(T) * count, (size_t)8);
+    return ret;
+  }
+
+  byte *data;
+};
+
 struct CmdBufferRecordingInfo
 {
   VkDevice device;
@@ -889,30 +946,92 @@ struct CmdBufferRecordingInfo
 
   vector<pair<ResourceId, ImageRegionState> > imgbarriers;
 
+  // the lists below are appended to while recording, duplicates and all, and only sorted and
+  // deduplicated once in vkEndCommandBuffer. That's much cheaper than a set insert per command.
+
   // sparse resources referenced by this command buffer (at submit time
   // need to go through the sparse mapping and reference all memory)
-  set<SparseMapping *> sparse;
+  vector<SparseMapping *> sparse;
 
   // a list of all resources dirtied by this command buffer
-  set<ResourceId> dirtied;
+  vector<ResourceId> dirtied;
 
   // a list of descriptor sets that are bound at any point in this command buffer
   // used to look up all the frame refs per-desc set and apply them on queue
   // submit with latest binding refs.
-  set<VkDescriptorSet> boundDescSets;
+  vector<VkDescriptorSet> boundDescSets;
 
   vector<VkResourceRecord *> subcmds;
+
+  // commands that haven't been serialised yet, in recording order
+  vector<DeferredCmd> deferred;
+  vector<byte> deferredData;
+
+  // empties all the lists but keeps their storage, so the info can be recycled
+  void Reset()
+  {
+    framebuffer = NULL;
+    imgbarriers.clear();
+    sparse.clear();
+    dirtied.clear();
+    boundDescSets.clear();
+    subcmds.clear();
+    deferred.clear();
+    deferredData.clear();
+  }
+};
+
+// sorts and removes duplicates from a list that was appended to while recording
+template <typename T>
+void SortUnique(vector<T> &list)
+{
+  std::sort(list.begin(), list.end());
+  list.erase(std::unique(list.begin(), list.end()), list.end());
+}
+
+// command pools keep the recording info of baked command buffers that have been reset or
+// re-begun, so that frequently re-recorded command buffers reuse the same allocations instead of
+// building their lists from scratch every time. Protected by the pool record's chunk lock
+struct CmdPoolInfo
+{
+  ~CmdPoolInfo()
+  {
+    for(size_t i = 0; i < freeInfos.size(); i++)
+      delete freeInfos[i];
+  }
+
+  vector<CmdBufferRecordingInfo *> freeInfos;
 };
 
 struct DescSetLayout;
 
+// the resources referenced through one descriptor slot. These are resolved once when the slot
+// is written, so that binding and submitting only need to walk a flat array - and only while
+// capturing a frame - rather than maintaining a ref-counted map on every descriptor update.
+struct DescriptorSlotRefs
+{
+  DescriptorSlotRefs() : ref(eFrameRef_Read), sparse(false) {}
+  // the buffer, image view or texel buffer view in the slot. Always referenced as read
+  ResourceId view;
+  // the image behind an image view, or the memory behind a buffer or texel buffer view.
+  // Referenced according to the descriptor type
+  ResourceId resource;
+  // the memory bound to the image behind an image view. Always referenced as read
+  ResourceId mem;
+  ResourceId sampler;
+  FrameRefType ref;
+  // true if view has sparse mapping information that must be referenced as well
+  bool sparse;
+};
+
 struct DescriptorSetData
 {
   DescriptorSetData() : layout(NULL) {}
   ~DescriptorSetData()
   {
-    for(size_t i = 0; i < descBindings.size(); i++)
-      delete[] descBindings[i];
+    // all bindings are allocated in one block, see DescSetLayout::CreateBindingsArray
+    if(!descBindings.empty())
+      delete[] descBindings[0];
     descBindings.clear();
   }
 
@@ -922,13 +1041,36 @@ struct DescriptorSetData
   // create from the layout.
   vector<DescriptorSetSlot *> descBindings;
 
-  // contains the framerefs (ref counted) for the bound resources
-  // in the binding slots. Updated when updating descriptor sets
-  // and then applied in a block on descriptor set bind.
-  // the refcount has the high-bit set if this resource has sparse
-  // mapping information
-  static const uint32_t SPARSE_REF_BIT = 0x80000000;
-  map<ResourceId, pair<uint32_t, FrameRefType> > bindFrameRefs;
+  // the resolved references for each slot, flat in the same order as the slots pointed to by
+  // descBindings (ie. indexed by &descBindings[b][a] - descBindings[0]). Updated when updating
+  // descriptor sets and applied on demand when a set is used in a captured frame.
+  vector<DescriptorSlotRefs> slotRefs;
+
+  // sorted indices into slotRefs of the slots that reference a resource for writing, so the
+  // resources a set may have dirtied can be found without walking every slot.
+  vector<uint32_t> writeSlots;
+
+  DescriptorSlotRefs &GetSlotRefs(const DescriptorSetSlot &slot)
+  {
+    return slotRefs[&slot - descBindings[0]];
+  }
+
+  // must be called whenever a slot's references are updated, to keep writeSlots in sync
+  void UpdateWriteSlot(const DescriptorSetSlot &slot)
+  {
+    uint32_t idx = uint32_t(&slot - descBindings[0]);
+    const DescriptorSlotRefs &refs = slotRefs[idx];
+
+    bool write = (refs.ref == eFrameRef_Write && refs.resource != ResourceId());
+
+    auto it = std::lower_bound(writeSlots.begin(), writeSlots.end(), idx);
+    bool listed = (it != writeSlots.end() && *it == idx);
+
+    if(write && !listed)
+      writeSlots.insert(it, idx);
+    else if(!write && listed)
+      writeSlots.erase(it);
+  }
 };
 
 struct MemMapState
@@ -993,50 +1135,8 @@ public:
     cmdInfo->imgbarriers.swap(bakedCommands->cmdInfo->imgbarriers);
     cmdInfo->subcmds.swap(bakedCommands->cmdInfo->subcmds);
     cmdInfo->sparse.swap(bakedCommands->cmdInfo->sparse);
-  }
-
-  void AddBindFrameRef(ResourceId id, FrameRefType ref, bool hasSparse = false)
-  {
-    if(id == ResourceId())
-    {
-      RDCERR("Unexpected NULL resource ID being added as a bind frame ref");
-      return;
-    }
-
-    if((descInfo->bindFrameRefs[id].first & ~DescriptorSetData::SPARSE_REF_BIT) == 0)
-    {
-      descInfo->bindFrameRefs[id] =
-          std::make_pair(1 | (hasSparse ? DescriptorSetData::SPARSE_REF_BIT : 0), ref);
-    }
-    else
-    {
-      // be conservative - mark refs as read before write if we see a write and a read ref on it
-      if(ref == eFrameRef_Write && descInfo->bindFrameRefs[id].second == eFrameRef_Read)
-        descInfo->bindFrameRefs[id].second = eFrameRef_ReadBeforeWrite;
-      descInfo->bindFrameRefs[id].first++;
-    }
-  }
-
-  void RemoveBindFrameRef(ResourceId id)
-  {
-    // ignore any NULL IDs - probably an object that was
-    // deleted since it was bound.
-    if(id == ResourceId())
-      return;
-
-    auto it = descInfo->bindFrameRefs.find(id);
-
-    // in the case of re-used handles bound to descriptor sets,
-    // it's possible to try and remove a frameref on something we
-    // don't have (which means we'll have a corresponding stale ref)
-    // but this is harmless so we can ignore it.
-    if(it == descInfo->bindFrameRefs.end())
-      return;
-
-    it->second.first--;
-
-    if((it->second.first & ~DescriptorSetData::SPARSE_REF_BIT) == 0)
-      descInfo->bindFrameRefs.erase(it);
+    cmdInfo->deferred.swap(bakedCommands->cmdInfo->deferred);
+    cmdInfo->deferredData.swap(bakedCommands->cmdInfo->deferredData);
   }
 
   // we have a lot of 'cold' data in the resource record, as it can be accessed
@@ -1073,6 +1173,7 @@ public:
     SwapchainInfo *swapInfo;                       // only for swapchains
     MemMapState *memMapState;                      // only for device memory
     CmdBufferRecordingInfo *cmdInfo;               // only for command buffers
+    CmdPoolInfo *cmdPoolInfo;                      // only for command pools
     AttachmentInfo *imageAttachments;              // only for framebuffers and render passes
     DescriptorSetData *descInfo;    // only for descriptor sets and descriptor set layouts
   };
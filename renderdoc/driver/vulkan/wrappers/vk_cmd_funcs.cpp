@@ -361,6 +361,8 @@ VkResult WrappedVulkan::vkCreateCommandPool(VkDevice device,
 
       VkResourceRecord *record = GetResourceManager()->AddResourceRecord(*pCmdPool);
       record->AddChunk(chunk);
+
+      record->cmdPoolInfo = new CmdPoolInfo();
     }
     else
     {
@@ -385,6 +387,58 @@ void WrappedVulkan::vkTrimCommandPoolKHR(VkDevice device, VkCommandPool commandP
 
 // Command buffer functions
 
+CmdBufferRecordingInfo *WrappedVulkan::AllocRecordingInfo(VkResourceRecord *cmdRecord)
+{
+  CmdBufferRecordingInfo *ret = NULL;
+
+  VkResourceRecord *pool = cmdRecord->pool;
+
+  pool->LockChunks();
+  if(!pool->cmdPoolInfo->freeInfos.empty())
+  {
+    ret = pool->cmdPoolInfo->freeInfos.back();
+    pool->cmdPoolInfo->freeInfos.pop_back();
+  }
+  pool->UnlockChunks();
+
+  if(ret == NULL)
+    ret = new CmdBufferRecordingInfo();
+
+  ret->device = cmdRecord->cmdInfo->device;
+  ret->allocInfo = cmdRecord->cmdInfo->allocInfo;
+
+  return ret;
+}
+
+void WrappedVulkan::ReleaseBakedCommands(VkResourceRecord *cmdRecord)
+{
+  VkResourceRecord *baked = cmdRecord->bakedCommands;
+
+  if(baked == NULL)
+    return;
+
+  // a command buffer can't be reset while it's pending execution, so the only other references
+  // can come from an in-progress capture, and those can only be released concurrently - not
+  // added. If we hold the last reference, hand the recording info back to the pool.
+  if(baked->GetRefCount() == 1 && baked->cmdInfo)
+  {
+    CmdBufferRecordingInfo *info = baked->cmdInfo;
+    baked->cmdInfo = NULL;
+
+    info->Reset();
+
+    VkResourceRecord *pool = cmdRecord->pool;
+
+    pool->LockChunks();
+    pool->cmdPoolInfo->freeInfos.push_back(info);
+    pool->UnlockChunks();
+  }
+
+  baked->Delete(GetResourceManager());
+
+  cmdRecord->bakedCommands = NULL;
+}
+
 VkResult WrappedVulkan::vkAllocateCommandBuffers(VkDevice device,
                                                  const VkCommandBufferAllocateInfo *pAllocateInfo,
                                                  VkCommandBuffer *pCommandBuffers)
@@ -631,16 +685,15 @@ VkResult WrappedVulkan::vkBeginCommandBuffer(VkCommandBuffer commandBuffer,
     // If a command bfufer was already recorded (ie we have some baked commands),
     // then begin is spec'd to implicitly reset. That means we need to tidy up
     // any existing baked commands before creating a new set.
-    if(record->bakedCommands)
-      record->bakedCommands->Delete(GetResourceManager());
+    ReleaseBakedCommands(record);
 
     record->bakedCommands = GetResourceManager()->AddResourceRecord(ResourceIDGen::GetNewUniqueID());
     record->bakedCommands->SpecialResource = true;
     record->bakedCommands->Resource = (WrappedVkRes *)commandBuffer;
-    record->bakedCommands->cmdInfo = new CmdBufferRecordingInfo();
+    record->bakedCommands->cmdInfo = AllocRecordingInfo(record);
 
-    record->bakedCommands->cmdInfo->device = record->cmdInfo->device;
-    record->bakedCommands->cmdInfo->allocInfo = record->cmdInfo->allocInfo;
+    // discard anything left over from a recording that was reset before it was ended
+    record->cmdInfo->Reset();
 
     {
       CACHE_THREAD_SERIALISER();
@@ -794,6 +847,22 @@ VkResult WrappedVulkan::vkEndCommandBuffer(VkCommandBuffer commandBuffer)
       record->AddChunk(scope.Get());
     }
 
+    // conservatively mark all writeable objects in any descriptor set bound in this command
+    // buffer as dirty. Technically not all might be written although that required verifying
+    // what the shader does and is a large problem space. The binding could be overridden though
+    // but per Vulkan ethos we consider that the application's problem to solve. Sets can't be
+    // updated while bound in a recording command buffer, so doing this once per set at the end
+    // of recording is equivalent to doing it on every bind.
+    CmdBufferRecordingInfo *info = record->cmdInfo;
+
+    SortUnique(info->boundDescSets);
+
+    for(size_t i = 0; i < info->boundDescSets.size(); i++)
+      MarkDescriptorSetDirtied(GetRecord(info->boundDescSets[i]), info->dirtied);
+
+    SortUnique(info->dirtied);
+    SortUnique(info->sparse);
+
     record->Bake();
   }
 
@@ -819,10 +888,7 @@ VkResult WrappedVulkan::vkResetCommandBuffer(VkCommandBuffer commandBuffer,
     // each time they are begun, so on replay it looks like they were all unique
     // (albeit with the same properties for those that share a 'parent'). Hence,
     // we don't need to record or replay when a ResetCommandBuffer happens
-    if(record->bakedCommands)
-      record->bakedCommands->Delete(GetResourceManager());
-
-    record->bakedCommands = NULL;
+    ReleaseBakedCommands(record);
   }
 
   return ObjDisp(commandBuffer)->ResetCommandBuffer(Unwrap(commandBuffer), flags);
@@ -915,12 +981,25 @@ void WrappedVulkan::vkCmdBeginRenderPass(VkCommandBuffer commandBuffer,
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd() && pRenderPassBegin->pNext == NULL)
+    {
+      DeferredCmdWriter params = DeferCmd(record, BEGIN_RENDERPASS, commandBuffer);
+      params.Write(*pRenderPassBegin);
+      params.Write(GetResID(pRenderPassBegin->renderPass));
+      params.Write(GetResID(pRenderPassBegin->framebuffer));
+      params.WriteArray(pRenderPassBegin->pClearValues, pRenderPassBegin->clearValueCount);
+      params.Write(contents);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(BEGIN_RENDERPASS);
-    Serialise_vkCmdBeginRenderPass(localSerialiser, commandBuffer, pRenderPassBegin, contents);
+      SCOPED_SERIALISE_CONTEXT(BEGIN_RENDERPASS);
+      Serialise_vkCmdBeginRenderPass(localSerialiser, commandBuffer, pRenderPassBegin, contents);
+
+      record->AddChunk(scope.Get());
+    }
 
-    record->AddChunk(scope.Get());
     record->MarkResourceFrameReferenced(GetResID(pRenderPassBegin->renderPass), eFrameRef_Read);
 
     VkResourceRecord *fb = GetRecord(pRenderPassBegin->framebuffer);
@@ -936,8 +1015,8 @@ void WrappedVulkan::vkCmdBeginRenderPass(VkCommandBuffer commandBuffer,
       if(att->baseResourceMem != ResourceId())
         record->MarkResourceFrameReferenced(att->baseResourceMem, eFrameRef_Read);
       if(att->sparseInfo)
-        record->cmdInfo->sparse.insert(att->sparseInfo);
-      record->cmdInfo->dirtied.insert(att->baseResource);
+        record->cmdInfo->sparse.push_back(att->sparseInfo);
+      record->cmdInfo->dirtied.push_back(att->baseResource);
     }
 
     record->cmdInfo->framebuffer = fb;
@@ -1012,12 +1091,20 @@ void WrappedVulkan::vkCmdNextSubpass(VkCommandBuffer commandBuffer, VkSubpassCon
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, NEXT_SUBPASS, commandBuffer);
+      params.Write(contents);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(NEXT_SUBPASS);
-    Serialise_vkCmdNextSubpass(localSerialiser, commandBuffer, contents);
+      SCOPED_SERIALISE_CONTEXT(NEXT_SUBPASS);
+      Serialise_vkCmdNextSubpass(localSerialiser, commandBuffer, contents);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
   }
 }
 
@@ -1089,12 +1176,19 @@ void WrappedVulkan::vkCmdEndRenderPass(VkCommandBuffer commandBuffer)
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferCmd(record, END_RENDERPASS, commandBuffer);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(END_RENDERPASS);
-    Serialise_vkCmdEndRenderPass(localSerialiser, commandBuffer);
+      SCOPED_SERIALISE_CONTEXT(END_RENDERPASS);
+      Serialise_vkCmdEndRenderPass(localSerialiser, commandBuffer);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
 
     VkResourceRecord *fb = record->cmdInfo->framebuffer;
 
@@ -1217,12 +1311,22 @@ void WrappedVulkan::vkCmdBindPipeline(VkCommandBuffer commandBuffer,
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, BIND_PIPELINE, commandBuffer);
+      params.Write(pipelineBindPoint);
+      params.Write(GetResID(pipeline));
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(BIND_PIPELINE);
-    Serialise_vkCmdBindPipeline(localSerialiser, commandBuffer, pipelineBindPoint, pipeline);
+      SCOPED_SERIALISE_CONTEXT(BIND_PIPELINE);
+      Serialise_vkCmdBindPipeline(localSerialiser, commandBuffer, pipelineBindPoint, pipeline);
+
+      record->AddChunk(scope.Get());
+    }
 
-    record->AddChunk(scope.Get());
     record->MarkResourceFrameReferenced(GetResID(pipeline), eFrameRef_Read);
   }
 }
@@ -1402,35 +1506,36 @@ void WrappedVulkan::vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer,
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
-
-    SCOPED_SERIALISE_CONTEXT(BIND_DESCRIPTOR_SET);
-    Serialise_vkCmdBindDescriptorSets(localSerialiser, commandBuffer, pipelineBindPoint, layout,
-                                      firstSet, setCount, pDescriptorSets, dynamicOffsetCount,
-                                      pDynamicOffsets);
-
-    record->AddChunk(scope.Get());
-    record->MarkResourceFrameReferenced(GetResID(layout), eFrameRef_Read);
-    record->cmdInfo->boundDescSets.insert(pDescriptorSets, pDescriptorSets + setCount);
-
-    // conservatively mark all writeable objects in the descriptor set as dirty here.
-    // Technically not all might be written although that required verifying what the
-    // shader does and is a large problem space. The binding could be overridden though
-    // but per Vulkan ethos we consider that the application's problem to solve. Plus,
-    // it would mean we'd need to dirty every drawcall instead of just every bind at
-    // lower frequency.
-    for(uint32_t i = 0; i < setCount; i++)
+    if(CanDeferCmd())
     {
-      VkResourceRecord *descSet = GetRecord(pDescriptorSets[i]);
+      DeferredCmdWriter params = DeferCmd(record, BIND_DESCRIPTOR_SET, commandBuffer);
+      params.Write(GetResID(layout));
+      params.Write(pipelineBindPoint);
+      params.Write(firstSet);
+      params.Write(setCount);
+      for(uint32_t i = 0; i < setCount; i++)
+        params.Write(GetResID(pDescriptorSets[i]));
+      params.Write(dynamicOffsetCount);
+      params.WriteArray(pDynamicOffsets, dynamicOffsetCount);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-      map<ResourceId, pair<uint32_t, FrameRefType> > &frameRefs = descSet->descInfo->bindFrameRefs;
+      SCOPED_SERIALISE_CONTEXT(BIND_DESCRIPTOR_SET);
+      Serialise_vkCmdBindDescriptorSets(localSerialiser, commandBuffer, pipelineBindPoint, layout,
+                                        firstSet, setCount, pDescriptorSets, dynamicOffsetCount,
+                                        pDynamicOffsets);
 
-      for(auto it = frameRefs.begin(); it != frameRefs.end(); ++it)
-      {
-        if(it->second.second == eFrameRef_Write || it->second.second == eFrameRef_ReadBeforeWrite)
-          record->cmdInfo->dirtied.insert(it->first);
-      }
+      record->AddChunk(scope.Get());
     }
+
+    record->MarkResourceFrameReferenced(GetResID(layout), eFrameRef_Read);
+    record->cmdInfo->boundDescSets.insert(record->cmdInfo->boundDescSets.end(), pDescriptorSets,
+                                          pDescriptorSets + setCount);
+
+    // the writeable objects in bound descriptor sets are marked dirty once when the command
+    // buffer ends, rather than walking the set contents on every bind. See vkEndCommandBuffer
   }
 }
 
@@ -1528,19 +1633,32 @@ void WrappedVulkan::vkCmdBindVertexBuffers(VkCommandBuffer commandBuffer, uint32
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, BIND_VERTEX_BUFFERS, commandBuffer);
+      params.Write(firstBinding);
+      params.Write(bindingCount);
+      for(uint32_t i = 0; i < bindingCount; i++)
+        params.Write(GetResID(pBuffers[i]));
+      params.WriteArray(pOffsets, bindingCount);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(BIND_VERTEX_BUFFERS);
-    Serialise_vkCmdBindVertexBuffers(localSerialiser, commandBuffer, firstBinding, bindingCount,
-                                     pBuffers, pOffsets);
+      SCOPED_SERIALISE_CONTEXT(BIND_VERTEX_BUFFERS);
+      Serialise_vkCmdBindVertexBuffers(localSerialiser, commandBuffer, firstBinding, bindingCount,
+                                       pBuffers, pOffsets);
+
+      record->AddChunk(scope.Get());
+    }
 
-    record->AddChunk(scope.Get());
     for(uint32_t i = 0; i < bindingCount; i++)
     {
       record->MarkResourceFrameReferenced(GetResID(pBuffers[i]), eFrameRef_Read);
       record->MarkResourceFrameReferenced(GetRecord(pBuffers[i])->baseResource, eFrameRef_Read);
       if(GetRecord(pBuffers[i])->sparseInfo)
-        record->cmdInfo->sparse.insert(GetRecord(pBuffers[i])->sparseInfo);
+        record->cmdInfo->sparse.push_back(GetRecord(pBuffers[i])->sparseInfo);
     }
   }
 }
@@ -1602,16 +1720,27 @@ void WrappedVulkan::vkCmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, BIND_INDEX_BUFFER, commandBuffer);
+      params.Write(GetResID(buffer));
+      params.Write((uint64_t)offset);
+      params.Write(indexType);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(BIND_INDEX_BUFFER);
-    Serialise_vkCmdBindIndexBuffer(localSerialiser, commandBuffer, buffer, offset, indexType);
+      SCOPED_SERIALISE_CONTEXT(BIND_INDEX_BUFFER);
+      Serialise_vkCmdBindIndexBuffer(localSerialiser, commandBuffer, buffer, offset, indexType);
+
+      record->AddChunk(scope.Get());
+    }
 
-    record->AddChunk(scope.Get());
     record->MarkResourceFrameReferenced(GetResID(buffer), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(buffer)->baseResource, eFrameRef_Read);
     if(GetRecord(buffer)->sparseInfo)
-      record->cmdInfo->sparse.insert(GetRecord(buffer)->sparseInfo);
+      record->cmdInfo->sparse.push_back(GetRecord(buffer)->sparseInfo);
   }
 }
 
@@ -1670,13 +1799,24 @@ void WrappedVulkan::vkCmdUpdateBuffer(VkCommandBuffer commandBuffer, VkBuffer de
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, UPDATE_BUF, commandBuffer);
+      params.Write(GetResID(destBuffer));
+      params.Write(destOffset);
+      params.Write(dataSize);
+      params.WriteArray((const byte *)pData, (uint32_t)dataSize);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(UPDATE_BUF);
-    Serialise_vkCmdUpdateBuffer(localSerialiser, commandBuffer, destBuffer, destOffset, dataSize,
-                                pData);
+      SCOPED_SERIALISE_CONTEXT(UPDATE_BUF);
+      Serialise_vkCmdUpdateBuffer(localSerialiser, commandBuffer, destBuffer, destOffset, dataSize,
+                                  pData);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
 
     VkResourceRecord *buf = GetRecord(destBuffer);
 
@@ -1684,9 +1824,9 @@ void WrappedVulkan::vkCmdUpdateBuffer(VkCommandBuffer commandBuffer, VkBuffer de
     record->MarkResourceFrameReferenced(buf->GetResourceID(), eFrameRef_Read);
     record->MarkResourceFrameReferenced(buf->baseResource, eFrameRef_Write);
     if(buf->baseResource != ResourceId())
-      record->cmdInfo->dirtied.insert(buf->baseResource);
+      record->cmdInfo->dirtied.push_back(buf->baseResource);
     if(buf->sparseInfo)
-      record->cmdInfo->sparse.insert(buf->sparseInfo);
+      record->cmdInfo->sparse.push_back(buf->sparseInfo);
   }
 }
 
@@ -1739,12 +1879,24 @@ void WrappedVulkan::vkCmdFillBuffer(VkCommandBuffer commandBuffer, VkBuffer dest
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, FILL_BUF, commandBuffer);
+      params.Write(GetResID(destBuffer));
+      params.Write(destOffset);
+      params.Write(fillSize);
+      params.Write(data);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(FILL_BUF);
-    Serialise_vkCmdFillBuffer(localSerialiser, commandBuffer, destBuffer, destOffset, fillSize, data);
+      SCOPED_SERIALISE_CONTEXT(FILL_BUF);
+      Serialise_vkCmdFillBuffer(localSerialiser, commandBuffer, destBuffer, destOffset, fillSize,
+                                data);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
 
     VkResourceRecord *buf = GetRecord(destBuffer);
 
@@ -1752,9 +1904,9 @@ void WrappedVulkan::vkCmdFillBuffer(VkCommandBuffer commandBuffer, VkBuffer dest
     record->MarkResourceFrameReferenced(buf->GetResourceID(), eFrameRef_Read);
     record->MarkResourceFrameReferenced(buf->baseResource, eFrameRef_Write);
     if(buf->baseResource != ResourceId())
-      record->cmdInfo->dirtied.insert(buf->baseResource);
+      record->cmdInfo->dirtied.push_back(buf->baseResource);
     if(buf->sparseInfo)
-      record->cmdInfo->sparse.insert(buf->sparseInfo);
+      record->cmdInfo->sparse.push_back(buf->sparseInfo);
   }
 }
 
@@ -1816,13 +1968,26 @@ void WrappedVulkan::vkCmdPushConstants(VkCommandBuffer commandBuffer, VkPipeline
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, PUSH_CONST, commandBuffer);
+      params.Write(GetResID(layout));
+      params.Write((VkShaderStageFlagBits)stageFlags);
+      params.Write(start);
+      params.Write(length);
+      params.WriteArray((const byte *)values, length);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(PUSH_CONST);
-    Serialise_vkCmdPushConstants(localSerialiser, commandBuffer, layout, stageFlags, start, length,
-                                 values);
+      SCOPED_SERIALISE_CONTEXT(PUSH_CONST);
+      Serialise_vkCmdPushConstants(localSerialiser, commandBuffer, layout, stageFlags, start,
+                                   length, values);
+
+      record->AddChunk(scope.Get());
+    }
 
-    record->AddChunk(scope.Get());
     record->MarkResourceFrameReferenced(GetResID(layout), eFrameRef_Read);
   }
 }
@@ -1926,6 +2091,17 @@ bool WrappedVulkan::Serialise_vkCmdPipelineBarrier(
   return true;
 }
 
+// deferred barriers are stored flat, so any extension structs mean serialising immediately
+template <typename T>
+static bool NoNextChains(const T *structs, uint32_t count)
+{
+  for(uint32_t i = 0; i < count; i++)
+    if(structs[i].pNext != NULL)
+      return false;
+
+  return true;
+}
+
 void WrappedVulkan::vkCmdPipelineBarrier(
     VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStageMask,
     VkPipelineStageFlags destStageMask, VkDependencyFlags dependencyFlags,
@@ -1964,15 +2140,37 @@ void WrappedVulkan::vkCmdPipelineBarrier(
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd() && NoNextChains(pMemoryBarriers, memoryBarrierCount) &&
+       NoNextChains(pBufferMemoryBarriers, bufferMemoryBarrierCount) &&
+       NoNextChains(pImageMemoryBarriers, imageMemoryBarrierCount))
+    {
+      DeferredCmdWriter params = DeferCmd(record, PIPELINE_BARRIER, commandBuffer);
+      params.Write((VkPipelineStageFlagBits)srcStageMask);
+      params.Write((VkPipelineStageFlagBits)destStageMask);
+      params.Write(dependencyFlags);
+      params.Write(memoryBarrierCount);
+      params.Write(bufferMemoryBarrierCount);
+      params.Write(imageMemoryBarrierCount);
+      params.WriteArray(pMemoryBarriers, memoryBarrierCount);
+      params.WriteArray(pBufferMemoryBarriers, bufferMemoryBarrierCount);
+      for(uint32_t i = 0; i < bufferMemoryBarrierCount; i++)
+        params.Write(GetResID(pBufferMemoryBarriers[i].buffer));
+      params.WriteArray(pImageMemoryBarriers, imageMemoryBarrierCount);
+      for(uint32_t i = 0; i < imageMemoryBarrierCount; i++)
+        params.Write(GetResID(pImageMemoryBarriers[i].image));
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(PIPELINE_BARRIER);
-    Serialise_vkCmdPipelineBarrier(localSerialiser, commandBuffer, srcStageMask, destStageMask,
-                                   dependencyFlags, memoryBarrierCount, pMemoryBarriers,
-                                   bufferMemoryBarrierCount, pBufferMemoryBarriers,
-                                   imageMemoryBarrierCount, pImageMemoryBarriers);
+      SCOPED_SERIALISE_CONTEXT(PIPELINE_BARRIER);
+      Serialise_vkCmdPipelineBarrier(localSerialiser, commandBuffer, srcStageMask, destStageMask,
+                                     dependencyFlags, memoryBarrierCount, pMemoryBarriers,
+                                     bufferMemoryBarrierCount, pBufferMemoryBarriers,
+                                     imageMemoryBarrierCount, pImageMemoryBarriers);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
 
     if(imageMemoryBarrierCount > 0)
     {
@@ -2120,9 +2318,9 @@ void WrappedVulkan::vkCmdCopyQueryPoolResults(VkCommandBuffer commandBuffer, VkQ
     record->MarkResourceFrameReferenced(buf->GetResourceID(), eFrameRef_Read);
     record->MarkResourceFrameReferenced(buf->baseResource, eFrameRef_Write);
     if(buf->baseResource != ResourceId())
-      record->cmdInfo->dirtied.insert(buf->baseResource);
+      record->cmdInfo->dirtied.push_back(buf->baseResource);
     if(buf->sparseInfo)
-      record->cmdInfo->sparse.insert(buf->sparseInfo);
+      record->cmdInfo->sparse.push_back(buf->sparseInfo);
   }
 }
 
@@ -2604,11 +2802,13 @@ void WrappedVulkan::vkCmdExecuteCommands(VkCommandBuffer commandBuffer, uint32_t
       VkResourceRecord *execRecord = GetRecord(pCmdBuffers[i]);
       if(execRecord->bakedCommands)
       {
-        record->cmdInfo->dirtied.insert(execRecord->bakedCommands->cmdInfo->dirtied.begin(),
-                                        execRecord->bakedCommands->cmdInfo->dirtied.end());
-        record->cmdInfo->boundDescSets.insert(
-            execRecord->bakedCommands->cmdInfo->boundDescSets.begin(),
-            execRecord->bakedCommands->cmdInfo->boundDescSets.end());
+        CmdBufferRecordingInfo *execInfo = execRecord->bakedCommands->cmdInfo;
+
+        record->cmdInfo->dirtied.insert(record->cmdInfo->dirtied.end(), execInfo->dirtied.begin(),
+                                        execInfo->dirtied.end());
+        record->cmdInfo->boundDescSets.insert(record->cmdInfo->boundDescSets.end(),
+                                              execInfo->boundDescSets.begin(),
+                                              execInfo->boundDescSets.end());
         record->cmdInfo->subcmds.push_back(execRecord);
 
         GetResourceManager()->MergeBarriers(record->cmdInfo->imgbarriers,
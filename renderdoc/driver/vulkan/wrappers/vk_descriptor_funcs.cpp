@@ -334,7 +334,8 @@ VkResult WrappedVulkan::vkAllocateDescriptorSets(VkDevice device,
 
       record->descInfo = new DescriptorSetData();
       record->descInfo->layout = layoutRecord->descInfo->layout;
-      record->descInfo->layout->CreateBindingsArray(record->descInfo->descBindings);
+      record->descInfo->slotRefs.resize(
+          record->descInfo->layout->CreateBindingsArray(record->descInfo->descBindings));
     }
     else
     {
@@ -727,7 +728,7 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
         SCOPED_SERIALISE_CONTEXT(UPDATE_DESC_SET);
         Serialise_vkUpdateDescriptorSets(localSerialiser, device, 1, &pDescriptorWrites[i], 0, NULL);
 
-        m_FrameCaptureRecord->AddChunk(scope.Get());
+        AddFrameChunk(scope.Get());
       }
 
       // as long as descriptor sets are forced to have initial states, we don't have to mark them
@@ -749,7 +750,7 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
         SCOPED_SERIALISE_CONTEXT(UPDATE_DESC_SET);
         Serialise_vkUpdateDescriptorSets(localSerialiser, device, 0, NULL, 1, &pDescriptorCopies[i]);
 
-        m_FrameCaptureRecord->AddChunk(scope.Get());
+        AddFrameChunk(scope.Get());
       }
 
       // Like writes we don't have to mark the written descriptor set as used because unless it's
@@ -760,7 +761,7 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
       // - what refs
       // the source set?).
       // At the same time as ref'ing the source set, we must ref all of its resources (via the
-      // bindFrameRefs).
+      // slotRefs).
       // We just ref all rather than looking at only the copied sets to keep things simple.
       // This does mean a slightly conservative ref'ing if the dest set doesn't end up getting
       // bound, but we only
@@ -772,20 +773,7 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
         GetResourceManager()->MarkResourceFrameReferenced(GetResID(pDescriptorCopies[i].srcSet),
                                                           eFrameRef_Read);
 
-        VkResourceRecord *setrecord = GetRecord(pDescriptorCopies[i].srcSet);
-
-        for(auto refit = setrecord->descInfo->bindFrameRefs.begin();
-            refit != setrecord->descInfo->bindFrameRefs.end(); ++refit)
-        {
-          GetResourceManager()->MarkResourceFrameReferenced(refit->first, refit->second.second);
-
-          if(refit->second.first & DescriptorSetData::SPARSE_REF_BIT)
-          {
-            VkResourceRecord *record = GetResourceManager()->GetResourceRecord(refit->first);
-
-            GetResourceManager()->MarkSparseMapReferenced(record->sparseInfo);
-          }
-        }
+        MarkDescriptorSetReferenced(GetRecord(pDescriptorCopies[i].srcSet), NULL);
       }
     }
   }
@@ -836,7 +824,8 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
       // (would need to version handles somehow, but don't have enough bits
       // to do that reliably).
       //
-      // This is handled by RemoveBindFrameRef silently dropping id == ResourceId()
+      // This is handled by resolving the referenced IDs when the slot is written, so a stale
+      // handle only costs a conservative reference and never a lookup of a destroyed object.
 
       // start at the dstArrayElement
       uint32_t curIdx = pDescriptorWrites[i].dstArrayElement;
@@ -863,39 +852,6 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
 
         DescriptorSetSlot &bind = (*binding)[curIdx];
 
-        if(bind.texelBufferView != VK_NULL_HANDLE)
-        {
-          record->RemoveBindFrameRef(GetResID(bind.texelBufferView));
-
-          VkResourceRecord *viewRecord = GetRecord(bind.texelBufferView);
-          if(viewRecord && viewRecord->baseResource != ResourceId())
-            record->RemoveBindFrameRef(viewRecord->baseResource);
-        }
-        if(bind.imageInfo.imageView != VK_NULL_HANDLE)
-        {
-          record->RemoveBindFrameRef(GetResID(bind.imageInfo.imageView));
-
-          VkResourceRecord *viewRecord = GetRecord(bind.imageInfo.imageView);
-          if(viewRecord)
-          {
-            record->RemoveBindFrameRef(viewRecord->baseResource);
-            if(viewRecord->baseResourceMem != ResourceId())
-              record->RemoveBindFrameRef(viewRecord->baseResourceMem);
-          }
-        }
-        if(bind.imageInfo.sampler != VK_NULL_HANDLE)
-        {
-          record->RemoveBindFrameRef(GetResID(bind.imageInfo.sampler));
-        }
-        if(bind.bufferInfo.buffer != VK_NULL_HANDLE)
-        {
-          record->RemoveBindFrameRef(GetResID(bind.bufferInfo.buffer));
-
-          VkResourceRecord *bufRecord = GetRecord(bind.bufferInfo.buffer);
-          if(bufRecord && bufRecord->baseResource != ResourceId())
-            record->RemoveBindFrameRef(bufRecord->baseResource);
-        }
-
         // NULL everything out now so that we don't accidentally reference an object
         // that was removed already
         bind.texelBufferView = VK_NULL_HANDLE;
@@ -928,33 +884,8 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
           bind.bufferInfo = pDescriptorWrites[i].pBufferInfo[d];
         }
 
-        if(bind.texelBufferView != VK_NULL_HANDLE)
-        {
-          record->AddBindFrameRef(GetResID(bind.texelBufferView), eFrameRef_Read,
-                                  GetRecord(bind.texelBufferView)->sparseInfo != NULL);
-          if(GetRecord(bind.texelBufferView)->baseResource != ResourceId())
-            record->AddBindFrameRef(GetRecord(bind.texelBufferView)->baseResource, ref);
-        }
-        if(bind.imageInfo.imageView != VK_NULL_HANDLE)
-        {
-          record->AddBindFrameRef(GetResID(bind.imageInfo.imageView), eFrameRef_Read,
-                                  GetRecord(bind.imageInfo.imageView)->sparseInfo != NULL);
-          record->AddBindFrameRef(GetRecord(bind.imageInfo.imageView)->baseResource, ref);
-          if(GetRecord(bind.imageInfo.imageView)->baseResourceMem != ResourceId())
-            record->AddBindFrameRef(GetRecord(bind.imageInfo.imageView)->baseResourceMem,
-                                    eFrameRef_Read);
-        }
-        if(bind.imageInfo.sampler != VK_NULL_HANDLE)
-        {
-          record->AddBindFrameRef(GetResID(bind.imageInfo.sampler), eFrameRef_Read);
-        }
-        if(bind.bufferInfo.buffer != VK_NULL_HANDLE)
-        {
-          record->AddBindFrameRef(GetResID(bind.bufferInfo.buffer), eFrameRef_Read,
-                                  GetRecord(bind.bufferInfo.buffer)->sparseInfo != NULL);
-          if(GetRecord(bind.bufferInfo.buffer)->baseResource != ResourceId())
-            record->AddBindFrameRef(GetRecord(bind.bufferInfo.buffer)->baseResource, ref);
-        }
+        UpdateDescriptorSlotRefs(record->descInfo->GetSlotRefs(bind), bind, ref);
+        record->descInfo->UpdateWriteSlot(bind);
       }
     }
 
@@ -1027,60 +958,103 @@ void WrappedVulkan::vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount,
 
         DescriptorSetSlot &bind = (*dstbinding)[curDstIdx];
 
-        if(bind.texelBufferView != VK_NULL_HANDLE)
-        {
-          dstrecord->RemoveBindFrameRef(GetResID(bind.texelBufferView));
-          if(GetRecord(bind.texelBufferView)->baseResource != ResourceId())
-            dstrecord->RemoveBindFrameRef(GetRecord(bind.texelBufferView)->baseResource);
-        }
-        if(bind.imageInfo.imageView != VK_NULL_HANDLE)
-        {
-          dstrecord->RemoveBindFrameRef(GetResID(bind.imageInfo.imageView));
-          dstrecord->RemoveBindFrameRef(GetRecord(bind.imageInfo.imageView)->baseResource);
-          if(GetRecord(bind.imageInfo.imageView)->baseResourceMem != ResourceId())
-            dstrecord->RemoveBindFrameRef(GetRecord(bind.imageInfo.imageView)->baseResourceMem);
-        }
-        if(bind.imageInfo.sampler != VK_NULL_HANDLE)
-        {
-          dstrecord->RemoveBindFrameRef(GetResID(bind.imageInfo.sampler));
-        }
-        if(bind.bufferInfo.buffer != VK_NULL_HANDLE)
-        {
-          dstrecord->RemoveBindFrameRef(GetResID(bind.bufferInfo.buffer));
-          if(GetRecord(bind.bufferInfo.buffer)->baseResource != ResourceId())
-            dstrecord->RemoveBindFrameRef(GetRecord(bind.bufferInfo.buffer)->baseResource);
-        }
-
         bind = (*srcbinding)[curSrcIdx];
 
-        if(bind.texelBufferView != VK_NULL_HANDLE)
-        {
-          dstrecord->AddBindFrameRef(GetResID(bind.texelBufferView), eFrameRef_Read,
-                                     GetRecord(bind.texelBufferView)->sparseInfo != NULL);
-          if(GetRecord(bind.texelBufferView)->baseResource != ResourceId())
-            dstrecord->AddBindFrameRef(GetRecord(bind.texelBufferView)->baseResource, ref);
-        }
-        if(bind.imageInfo.imageView != VK_NULL_HANDLE)
-        {
-          dstrecord->AddBindFrameRef(GetResID(bind.imageInfo.imageView), eFrameRef_Read,
-                                     GetRecord(bind.imageInfo.imageView)->sparseInfo != NULL);
-          dstrecord->AddBindFrameRef(GetRecord(bind.imageInfo.imageView)->baseResource, ref);
-          if(GetRecord(bind.imageInfo.imageView)->baseResourceMem != ResourceId())
-            dstrecord->AddBindFrameRef(GetRecord(bind.imageInfo.imageView)->baseResourceMem,
-                                       eFrameRef_Read);
-        }
-        if(bind.imageInfo.sampler != VK_NULL_HANDLE)
-        {
-          dstrecord->AddBindFrameRef(GetResID(bind.imageInfo.sampler), ref);
-        }
-        if(bind.bufferInfo.buffer != VK_NULL_HANDLE)
-        {
-          dstrecord->AddBindFrameRef(GetResID(bind.bufferInfo.buffer), eFrameRef_Read,
-                                     GetRecord(bind.bufferInfo.buffer)->sparseInfo != NULL);
-          if(GetRecord(bind.bufferInfo.buffer)->baseResource != ResourceId())
-            dstrecord->AddBindFrameRef(GetRecord(bind.bufferInfo.buffer)->baseResource, ref);
-        }
+        // the source slot's references were resolved when it was written, so just copy them and
+        // apply the destination binding's reference type
+        DescriptorSlotRefs &dstRefs = dstrecord->descInfo->GetSlotRefs(bind);
+        dstRefs = srcrecord->descInfo->GetSlotRefs((*srcbinding)[curSrcIdx]);
+        dstRefs.ref = ref;
+        dstrecord->descInfo->UpdateWriteSlot(bind);
       }
     }
   }
 }
+
+void WrappedVulkan::UpdateDescriptorSlotRefs(DescriptorSlotRefs &refs, const DescriptorSetSlot &bind,
+                                             FrameRefType ref)
+{
+  refs = DescriptorSlotRefs();
+  refs.ref = ref;
+
+  if(bind.texelBufferView != VK_NULL_HANDLE)
+  {
+    VkResourceRecord *viewRecord = GetRecord(bind.texelBufferView);
+    refs.view = GetResID(bind.texelBufferView);
+    refs.resource = viewRecord->baseResource;
+    refs.sparse = viewRecord->sparseInfo != NULL;
+  }
+  if(bind.imageInfo.imageView != VK_NULL_HANDLE)
+  {
+    VkResourceRecord *viewRecord = GetRecord(bind.imageInfo.imageView);
+    refs.view = GetResID(bind.imageInfo.imageView);
+    refs.resource = viewRecord->baseResource;
+    refs.mem = viewRecord->baseResourceMem;
+    refs.sparse = viewRecord->sparseInfo != NULL;
+  }
+  if(bind.imageInfo.sampler != VK_NULL_HANDLE)
+  {
+    refs.sampler = GetResID(bind.imageInfo.sampler);
+  }
+  if(bind.bufferInfo.buffer != VK_NULL_HANDLE)
+  {
+    VkResourceRecord *bufRecord = GetRecord(bind.bufferInfo.buffer);
+    refs.view = GetResID(bind.bufferInfo.buffer);
+    refs.resource = bufRecord->baseResource;
+    refs.sparse = bufRecord->sparseInfo != NULL;
+  }
+}
+
+void WrappedVulkan::MarkDescriptorSetReferenced(VkResourceRecord *setrecord,
+                                                std::set<ResourceId> *refdIDs)
+{
+  const vector<DescriptorSlotRefs> &slotRefs = setrecord->descInfo->slotRefs;
+
+  for(size_t i = 0; i < slotRefs.size(); i++)
+  {
+    const DescriptorSlotRefs &refs = slotRefs[i];
+
+    // empty slots are the common case in large sets, skip them quickly
+    if(refs.view == ResourceId() && refs.sampler == ResourceId())
+      continue;
+
+    // the resource manager ignores NULL IDs, so we can pass these through unconditionally
+    GetResourceManager()->MarkResourceFrameReferenced(refs.view, eFrameRef_Read);
+    GetResourceManager()->MarkResourceFrameReferenced(refs.resource, refs.ref);
+    GetResourceManager()->MarkResourceFrameReferenced(refs.mem, eFrameRef_Read);
+    GetResourceManager()->MarkResourceFrameReferenced(refs.sampler, eFrameRef_Read);
+
+    if(refdIDs)
+    {
+      if(refs.view != ResourceId())
+        refdIDs->insert(refs.view);
+      if(refs.resource != ResourceId())
+        refdIDs->insert(refs.resource);
+      if(refs.mem != ResourceId())
+        refdIDs->insert(refs.mem);
+      if(refs.sampler != ResourceId())
+        refdIDs->insert(refs.sampler);
+    }
+
+    if(refs.sparse)
+    {
+      VkResourceRecord *sparserecord = GetResourceManager()->GetResourceRecord(refs.view);
+
+      // the view may have been destroyed since it was written into the set
+      if(sparserecord && sparserecord->sparseInfo)
+        GetResourceManager()->MarkSparseMapReferenced(sparserecord->sparseInfo);
+    }
+  }
+}
+
+void WrappedVulkan::MarkDescriptorSetDirtied(VkResourceRecord *setrecord,
+                                             vector<ResourceId> &dirtied)
+{
+  const vector<DescriptorSlotRefs> &slotRefs = setrecord->descInfo->slotRefs;
+  const vector<uint32_t> &writeSlots = setrecord->descInfo->writeSlots;
+
+  // conservatively consider everything written through a storage descriptor as dirtied. Only
+  // those slots are tracked, so large sets of read-only descriptors cost nothing here
+  for(size_t i = 0; i < writeSlots.size(); i++)
+    dirtied.push_back(slotRefs[writeSlots[i]].resource);
+}
@@ -1522,7 +1522,7 @@ VkResult WrappedVulkan::vkDeviceWaitIdle(VkDevice device)
     SCOPED_SERIALISE_CONTEXT(DEVICE_WAIT_IDLE);
     Serialise_vkDeviceWaitIdle(localSerialiser, device);
 
-    m_FrameCaptureRecord->AddChunk(scope.Get());
+    AddFrameChunk(scope.Get());
   }
 
   return ret;
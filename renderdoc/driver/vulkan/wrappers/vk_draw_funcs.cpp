@@ -146,13 +146,24 @@ void WrappedVulkan::vkCmdDraw(VkCommandBuffer commandBuffer, uint32_t vertexCoun
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, DRAW, commandBuffer);
+      params.Write(vertexCount);
+      params.Write(instanceCount);
+      params.Write(firstVertex);
+      params.Write(firstInstance);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(DRAW);
-    Serialise_vkCmdDraw(localSerialiser, commandBuffer, vertexCount, instanceCount, firstVertex,
-                        firstInstance);
+      SCOPED_SERIALISE_CONTEXT(DRAW);
+      Serialise_vkCmdDraw(localSerialiser, commandBuffer, vertexCount, instanceCount, firstVertex,
+                          firstInstance);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
   }
 }
 
@@ -245,13 +256,25 @@ void WrappedVulkan::vkCmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_t ind
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, DRAW_INDEXED, commandBuffer);
+      params.Write(indexCount);
+      params.Write(instanceCount);
+      params.Write(firstIndex);
+      params.Write(vertexOffset);
+      params.Write(firstInstance);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(DRAW_INDEXED);
-    Serialise_vkCmdDrawIndexed(localSerialiser, commandBuffer, indexCount, instanceCount,
-                               firstIndex, vertexOffset, firstInstance);
+      SCOPED_SERIALISE_CONTEXT(DRAW_INDEXED);
+      Serialise_vkCmdDrawIndexed(localSerialiser, commandBuffer, indexCount, instanceCount,
+                                 firstIndex, vertexOffset, firstInstance);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
   }
 }
 
@@ -516,17 +539,28 @@ void WrappedVulkan::vkCmdDrawIndirect(VkCommandBuffer commandBuffer, VkBuffer bu
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, DRAW_INDIRECT, commandBuffer);
+      params.Write(GetResID(buffer));
+      params.Write((uint64_t)offset);
+      params.Write(count);
+      params.Write(stride);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(DRAW_INDIRECT);
-    Serialise_vkCmdDrawIndirect(localSerialiser, commandBuffer, buffer, offset, count, stride);
+      SCOPED_SERIALISE_CONTEXT(DRAW_INDIRECT);
+      Serialise_vkCmdDrawIndirect(localSerialiser, commandBuffer, buffer, offset, count, stride);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
 
     record->MarkResourceFrameReferenced(GetResID(buffer), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(buffer)->baseResource, eFrameRef_Read);
     if(GetRecord(buffer)->sparseInfo)
-      record->cmdInfo->sparse.insert(GetRecord(buffer)->sparseInfo);
+      record->cmdInfo->sparse.push_back(GetRecord(buffer)->sparseInfo);
   }
 }
 
@@ -813,17 +847,29 @@ void WrappedVulkan::vkCmdDrawIndexedIndirect(VkCommandBuffer commandBuffer, VkBu
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, DRAW_INDEXED_INDIRECT, commandBuffer);
+      params.Write(GetResID(buffer));
+      params.Write((uint64_t)offset);
+      params.Write(count);
+      params.Write(stride);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(DRAW_INDEXED_INDIRECT);
-    Serialise_vkCmdDrawIndexedIndirect(localSerialiser, commandBuffer, buffer, offset, count, stride);
+      SCOPED_SERIALISE_CONTEXT(DRAW_INDEXED_INDIRECT);
+      Serialise_vkCmdDrawIndexedIndirect(localSerialiser, commandBuffer, buffer, offset, count,
+                                         stride);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
 
     record->MarkResourceFrameReferenced(GetResID(buffer), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(buffer)->baseResource, eFrameRef_Read);
     if(GetRecord(buffer)->sparseInfo)
-      record->cmdInfo->sparse.insert(GetRecord(buffer)->sparseInfo);
+      record->cmdInfo->sparse.push_back(GetRecord(buffer)->sparseInfo);
   }
 }
 
@@ -896,12 +942,22 @@ void WrappedVulkan::vkCmdDispatch(VkCommandBuffer commandBuffer, uint32_t x, uin
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, DISPATCH, commandBuffer);
+      params.Write(x);
+      params.Write(y);
+      params.Write(z);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(DISPATCH);
-    Serialise_vkCmdDispatch(localSerialiser, commandBuffer, x, y, z);
+      SCOPED_SERIALISE_CONTEXT(DISPATCH);
+      Serialise_vkCmdDispatch(localSerialiser, commandBuffer, x, y, z);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
   }
 }
 
@@ -994,17 +1050,26 @@ void WrappedVulkan::vkCmdDispatchIndirect(VkCommandBuffer commandBuffer, VkBuffe
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, DISPATCH_INDIRECT, commandBuffer);
+      params.Write(GetResID(buffer));
+      params.Write((uint64_t)offset);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(DISPATCH_INDIRECT);
-    Serialise_vkCmdDispatchIndirect(localSerialiser, commandBuffer, buffer, offset);
+      SCOPED_SERIALISE_CONTEXT(DISPATCH_INDIRECT);
+      Serialise_vkCmdDispatchIndirect(localSerialiser, commandBuffer, buffer, offset);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
 
     record->MarkResourceFrameReferenced(GetResID(buffer), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(buffer)->baseResource, eFrameRef_Read);
     if(GetRecord(buffer)->sparseInfo)
-      record->cmdInfo->sparse.insert(GetRecord(buffer)->sparseInfo);
+      record->cmdInfo->sparse.push_back(GetRecord(buffer)->sparseInfo);
   }
 }
 
@@ -1117,23 +1182,37 @@ void WrappedVulkan::vkCmdBlitImage(VkCommandBuffer commandBuffer, VkImage srcIma
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, BLIT_IMG, commandBuffer);
+      params.Write(GetResID(srcImage));
+      params.Write(srcImageLayout);
+      params.Write(GetResID(destImage));
+      params.Write(destImageLayout);
+      params.Write(filter);
+      params.Write(regionCount);
+      params.WriteArray(pRegions, regionCount);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(BLIT_IMG);
-    Serialise_vkCmdBlitImage(localSerialiser, commandBuffer, srcImage, srcImageLayout, destImage,
-                             destImageLayout, regionCount, pRegions, filter);
+      SCOPED_SERIALISE_CONTEXT(BLIT_IMG);
+      Serialise_vkCmdBlitImage(localSerialiser, commandBuffer, srcImage, srcImageLayout, destImage,
+                               destImageLayout, regionCount, pRegions, filter);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
 
     record->MarkResourceFrameReferenced(GetResID(srcImage), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(srcImage)->baseResource, eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetResID(destImage), eFrameRef_Write);
     record->MarkResourceFrameReferenced(GetRecord(destImage)->baseResource, eFrameRef_Read);
-    record->cmdInfo->dirtied.insert(GetResID(destImage));
+    record->cmdInfo->dirtied.push_back(GetResID(destImage));
     if(GetRecord(srcImage)->sparseInfo)
-      record->cmdInfo->sparse.insert(GetRecord(srcImage)->sparseInfo);
+      record->cmdInfo->sparse.push_back(GetRecord(srcImage)->sparseInfo);
     if(GetRecord(destImage)->sparseInfo)
-      record->cmdInfo->sparse.insert(GetRecord(destImage)->sparseInfo);
+      record->cmdInfo->sparse.push_back(GetRecord(destImage)->sparseInfo);
   }
 }
 
@@ -1244,23 +1323,36 @@ void WrappedVulkan::vkCmdResolveImage(VkCommandBuffer commandBuffer, VkImage src
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, RESOLVE_IMG, commandBuffer);
+      params.Write(GetResID(srcImage));
+      params.Write(srcImageLayout);
+      params.Write(GetResID(destImage));
+      params.Write(destImageLayout);
+      params.Write(regionCount);
+      params.WriteArray(pRegions, regionCount);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(RESOLVE_IMG);
-    Serialise_vkCmdResolveImage(localSerialiser, commandBuffer, srcImage, srcImageLayout, destImage,
-                                destImageLayout, regionCount, pRegions);
+      SCOPED_SERIALISE_CONTEXT(RESOLVE_IMG);
+      Serialise_vkCmdResolveImage(localSerialiser, commandBuffer, srcImage, srcImageLayout,
+                                  destImage, destImageLayout, regionCount, pRegions);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
 
     record->MarkResourceFrameReferenced(GetResID(srcImage), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(srcImage)->baseResource, eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetResID(destImage), eFrameRef_Write);
     record->MarkResourceFrameReferenced(GetRecord(destImage)->baseResource, eFrameRef_Read);
-    record->cmdInfo->dirtied.insert(GetResID(destImage));
+    record->cmdInfo->dirtied.push_back(GetResID(destImage));
     if(GetRecord(srcImage)->sparseInfo)
-      record->cmdInfo->sparse.insert(GetRecord(srcImage)->sparseInfo);
+      record->cmdInfo->sparse.push_back(GetRecord(srcImage)->sparseInfo);
     if(GetRecord(destImage)->sparseInfo)
-      record->cmdInfo->sparse.insert(GetRecord(destImage)->sparseInfo);
+      record->cmdInfo->sparse.push_back(GetRecord(destImage)->sparseInfo);
   }
 }
 
@@ -1371,22 +1463,36 @@ void WrappedVulkan::vkCmdCopyImage(VkCommandBuffer commandBuffer, VkImage srcIma
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, COPY_IMG, commandBuffer);
+      params.Write(GetResID(srcImage));
+      params.Write(srcImageLayout);
+      params.Write(GetResID(destImage));
+      params.Write(destImageLayout);
+      params.Write(regionCount);
+      params.WriteArray(pRegions, regionCount);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
+
+      SCOPED_SERIALISE_CONTEXT(COPY_IMG);
+      Serialise_vkCmdCopyImage(localSerialiser, commandBuffer, srcImage, srcImageLayout, destImage,
+                               destImageLayout, regionCount, pRegions);
 
-    SCOPED_SERIALISE_CONTEXT(COPY_IMG);
-    Serialise_vkCmdCopyImage(localSerialiser, commandBuffer, srcImage, srcImageLayout, destImage,
-                             destImageLayout, regionCount, pRegions);
+      record->AddChunk(scope.Get());
+    }
 
-    record->AddChunk(scope.Get());
     record->MarkResourceFrameReferenced(GetResID(srcImage), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(srcImage)->baseResource, eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetResID(destImage), eFrameRef_Write);
     record->MarkResourceFrameReferenced(GetRecord(destImage)->baseResource, eFrameRef_Read);
-    record->cmdInfo->dirtied.insert(GetResID(destImage));
+    record->cmdInfo->dirtied.push_back(GetResID(destImage));
     if(GetRecord(srcImage)->sparseInfo)
-      record->cmdInfo->sparse.insert(GetRecord(srcImage)->sparseInfo);
+      record->cmdInfo->sparse.push_back(GetRecord(srcImage)->sparseInfo);
     if(GetRecord(destImage)->sparseInfo)
-      record->cmdInfo->sparse.insert(GetRecord(destImage)->sparseInfo);
+      record->cmdInfo->sparse.push_back(GetRecord(destImage)->sparseInfo);
   }
 }
 
@@ -1489,23 +1595,35 @@ void WrappedVulkan::vkCmdCopyBufferToImage(VkCommandBuffer commandBuffer, VkBuff
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, COPY_BUF2IMG, commandBuffer);
+      params.Write(GetResID(srcBuffer));
+      params.Write(GetResID(destImage));
+      params.Write(destImageLayout);
+      params.Write(regionCount);
+      params.WriteArray(pRegions, regionCount);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(COPY_BUF2IMG);
-    Serialise_vkCmdCopyBufferToImage(localSerialiser, commandBuffer, srcBuffer, destImage,
-                                     destImageLayout, regionCount, pRegions);
+      SCOPED_SERIALISE_CONTEXT(COPY_BUF2IMG);
+      Serialise_vkCmdCopyBufferToImage(localSerialiser, commandBuffer, srcBuffer, destImage,
+                                       destImageLayout, regionCount, pRegions);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
 
     record->MarkResourceFrameReferenced(GetResID(srcBuffer), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(srcBuffer)->baseResource, eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetResID(destImage), eFrameRef_Write);
     record->MarkResourceFrameReferenced(GetRecord(destImage)->baseResource, eFrameRef_Read);
-    record->cmdInfo->dirtied.insert(GetResID(destImage));
+    record->cmdInfo->dirtied.push_back(GetResID(destImage));
     if(GetRecord(srcBuffer)->sparseInfo)
-      record->cmdInfo->sparse.insert(GetRecord(srcBuffer)->sparseInfo);
+      record->cmdInfo->sparse.push_back(GetRecord(srcBuffer)->sparseInfo);
     if(GetRecord(destImage)->sparseInfo)
-      record->cmdInfo->sparse.insert(GetRecord(destImage)->sparseInfo);
+      record->cmdInfo->sparse.push_back(GetRecord(destImage)->sparseInfo);
   }
 }
 
@@ -1607,13 +1725,26 @@ void WrappedVulkan::vkCmdCopyImageToBuffer(VkCommandBuffer commandBuffer, VkImag
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, COPY_IMG2BUF, commandBuffer);
+      params.Write(GetResID(destBuffer));
+      params.Write(GetResID(srcImage));
+      params.Write(srcImageLayout);
+      params.Write(regionCount);
+      params.WriteArray(pRegions, regionCount);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
+
+      SCOPED_SERIALISE_CONTEXT(COPY_IMG2BUF);
+      Serialise_vkCmdCopyImageToBuffer(localSerialiser, commandBuffer, srcImage, srcImageLayout,
+                                       destBuffer, regionCount, pRegions);
 
-    SCOPED_SERIALISE_CONTEXT(COPY_IMG2BUF);
-    Serialise_vkCmdCopyImageToBuffer(localSerialiser, commandBuffer, srcImage, srcImageLayout,
-                                     destBuffer, regionCount, pRegions);
+      record->AddChunk(scope.Get());
+    }
 
-    record->AddChunk(scope.Get());
     record->MarkResourceFrameReferenced(GetResID(srcImage), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(srcImage)->baseResource, eFrameRef_Read);
 
@@ -1623,11 +1754,11 @@ void WrappedVulkan::vkCmdCopyImageToBuffer(VkCommandBuffer commandBuffer, VkImag
     record->MarkResourceFrameReferenced(buf->GetResourceID(), eFrameRef_Read);
     record->MarkResourceFrameReferenced(buf->baseResource, eFrameRef_Write);
     if(buf->baseResource != ResourceId())
-      record->cmdInfo->dirtied.insert(buf->baseResource);
+      record->cmdInfo->dirtied.push_back(buf->baseResource);
     if(GetRecord(srcImage)->sparseInfo)
-      record->cmdInfo->sparse.insert(GetRecord(srcImage)->sparseInfo);
+      record->cmdInfo->sparse.push_back(GetRecord(srcImage)->sparseInfo);
     if(buf->sparseInfo)
-      record->cmdInfo->sparse.insert(buf->sparseInfo);
+      record->cmdInfo->sparse.push_back(buf->sparseInfo);
   }
 }
 
@@ -1733,13 +1864,25 @@ void WrappedVulkan::vkCmdCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer srcB
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, COPY_BUF, commandBuffer);
+      params.Write(GetResID(srcBuffer));
+      params.Write(GetResID(destBuffer));
+      params.Write(regionCount);
+      params.WriteArray(pRegions, regionCount);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(COPY_BUF);
-    Serialise_vkCmdCopyBuffer(localSerialiser, commandBuffer, srcBuffer, destBuffer, regionCount,
-                              pRegions);
+      SCOPED_SERIALISE_CONTEXT(COPY_BUF);
+      Serialise_vkCmdCopyBuffer(localSerialiser, commandBuffer, srcBuffer, destBuffer, regionCount,
+                                pRegions);
+
+      record->AddChunk(scope.Get());
+    }
 
-    record->AddChunk(scope.Get());
     record->MarkResourceFrameReferenced(GetResID(srcBuffer), eFrameRef_Read);
     record->MarkResourceFrameReferenced(GetRecord(srcBuffer)->baseResource, eFrameRef_Read);
 
@@ -1749,11 +1892,11 @@ void WrappedVulkan::vkCmdCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer srcB
     record->MarkResourceFrameReferenced(buf->GetResourceID(), eFrameRef_Read);
     record->MarkResourceFrameReferenced(buf->baseResource, eFrameRef_Write);
     if(buf->baseResource != ResourceId())
-      record->cmdInfo->dirtied.insert(buf->baseResource);
+      record->cmdInfo->dirtied.push_back(buf->baseResource);
     if(GetRecord(srcBuffer)->sparseInfo)
-      record->cmdInfo->sparse.insert(GetRecord(srcBuffer)->sparseInfo);
+      record->cmdInfo->sparse.push_back(GetRecord(srcBuffer)->sparseInfo);
     if(buf->sparseInfo)
-      record->cmdInfo->sparse.insert(buf->sparseInfo);
+      record->cmdInfo->sparse.push_back(buf->sparseInfo);
   }
 }
 
@@ -1849,17 +1992,30 @@ void WrappedVulkan::vkCmdClearColorImage(VkCommandBuffer commandBuffer, VkImage
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, CLEAR_COLOR, commandBuffer);
+      params.Write(GetResID(image));
+      params.Write(imageLayout);
+      params.Write(*pColor);
+      params.Write(rangeCount);
+      params.WriteArray(pRanges, rangeCount);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
+
+      SCOPED_SERIALISE_CONTEXT(CLEAR_COLOR);
+      Serialise_vkCmdClearColorImage(localSerialiser, commandBuffer, image, imageLayout, pColor,
+                                     rangeCount, pRanges);
 
-    SCOPED_SERIALISE_CONTEXT(CLEAR_COLOR);
-    Serialise_vkCmdClearColorImage(localSerialiser, commandBuffer, image, imageLayout, pColor,
-                                   rangeCount, pRanges);
+      record->AddChunk(scope.Get());
+    }
 
-    record->AddChunk(scope.Get());
     record->MarkResourceFrameReferenced(GetResID(image), eFrameRef_Write);
     record->MarkResourceFrameReferenced(GetRecord(image)->baseResource, eFrameRef_Read);
     if(GetRecord(image)->sparseInfo)
-      record->cmdInfo->sparse.insert(GetRecord(image)->sparseInfo);
+      record->cmdInfo->sparse.push_back(GetRecord(image)->sparseInfo);
   }
 }
 
@@ -1955,17 +2111,30 @@ void WrappedVulkan::vkCmdClearDepthStencilImage(VkCommandBuffer commandBuffer, V
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, CLEAR_DEPTHSTENCIL, commandBuffer);
+      params.Write(GetResID(image));
+      params.Write(imageLayout);
+      params.Write(*pDepthStencil);
+      params.Write(rangeCount);
+      params.WriteArray(pRanges, rangeCount);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
+
+      SCOPED_SERIALISE_CONTEXT(CLEAR_DEPTHSTENCIL);
+      Serialise_vkCmdClearDepthStencilImage(localSerialiser, commandBuffer, image, imageLayout,
+                                            pDepthStencil, rangeCount, pRanges);
 
-    SCOPED_SERIALISE_CONTEXT(CLEAR_DEPTHSTENCIL);
-    Serialise_vkCmdClearDepthStencilImage(localSerialiser, commandBuffer, image, imageLayout,
-                                          pDepthStencil, rangeCount, pRanges);
+      record->AddChunk(scope.Get());
+    }
 
-    record->AddChunk(scope.Get());
     record->MarkResourceFrameReferenced(GetResID(image), eFrameRef_Write);
     record->MarkResourceFrameReferenced(GetRecord(image)->baseResource, eFrameRef_Read);
     if(GetRecord(image)->sparseInfo)
-      record->cmdInfo->sparse.insert(GetRecord(image)->sparseInfo);
+      record->cmdInfo->sparse.push_back(GetRecord(image)->sparseInfo);
   }
 }
 
@@ -2083,13 +2252,24 @@ void WrappedVulkan::vkCmdClearAttachments(VkCommandBuffer commandBuffer, uint32_
   {
     VkResourceRecord *record = GetRecord(commandBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, CLEAR_ATTACH, commandBuffer);
+      params.Write(attachmentCount);
+      params.WriteArray(pAttachments, attachmentCount);
+      params.Write(rectCount);
+      params.WriteArray(pRects, rectCount);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(CLEAR_ATTACH);
-    Serialise_vkCmdClearAttachments(localSerialiser, commandBuffer, attachmentCount, pAttachments,
-                                    rectCount, pRects);
+      SCOPED_SERIALISE_CONTEXT(CLEAR_ATTACH);
+      Serialise_vkCmdClearAttachments(localSerialiser, commandBuffer, attachmentCount, pAttachments,
+                                      rectCount, pRects);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
 
     // image/attachments are referenced when the render pass is started and the framebuffer is
     // bound.
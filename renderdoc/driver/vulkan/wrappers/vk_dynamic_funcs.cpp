@@ -75,12 +75,23 @@ void WrappedVulkan::vkCmdSetViewport(VkCommandBuffer cmdBuffer, uint32_t firstVi
   {
     VkResourceRecord *record = GetRecord(cmdBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, SET_VP, cmdBuffer);
+      params.Write(firstViewport);
+      params.Write(viewportCount);
+      params.WriteArray(pViewports, viewportCount);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(SET_VP);
-    Serialise_vkCmdSetViewport(localSerialiser, cmdBuffer, firstViewport, viewportCount, pViewports);
+      SCOPED_SERIALISE_CONTEXT(SET_VP);
+      Serialise_vkCmdSetViewport(localSerialiser, cmdBuffer, firstViewport, viewportCount,
+                                 pViewports);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
   }
 }
 
@@ -135,12 +146,22 @@ void WrappedVulkan::vkCmdSetScissor(VkCommandBuffer cmdBuffer, uint32_t firstSci
   {
     VkResourceRecord *record = GetRecord(cmdBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, SET_SCISSOR, cmdBuffer);
+      params.Write(firstScissor);
+      params.Write(scissorCount);
+      params.WriteArray(pScissors, scissorCount);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(SET_SCISSOR);
-    Serialise_vkCmdSetScissor(localSerialiser, cmdBuffer, firstScissor, scissorCount, pScissors);
+      SCOPED_SERIALISE_CONTEXT(SET_SCISSOR);
+      Serialise_vkCmdSetScissor(localSerialiser, cmdBuffer, firstScissor, scissorCount, pScissors);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
   }
 }
 
@@ -184,12 +205,20 @@ void WrappedVulkan::vkCmdSetLineWidth(VkCommandBuffer cmdBuffer, float lineWidth
   {
     VkResourceRecord *record = GetRecord(cmdBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, SET_LINE_WIDTH, cmdBuffer);
+      params.Write(lineWidth);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(SET_LINE_WIDTH);
-    Serialise_vkCmdSetLineWidth(localSerialiser, cmdBuffer, lineWidth);
+      SCOPED_SERIALISE_CONTEXT(SET_LINE_WIDTH);
+      Serialise_vkCmdSetLineWidth(localSerialiser, cmdBuffer, lineWidth);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
   }
 }
 
@@ -240,13 +269,23 @@ void WrappedVulkan::vkCmdSetDepthBias(VkCommandBuffer cmdBuffer, float depthBias
   {
     VkResourceRecord *record = GetRecord(cmdBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, SET_DEPTH_BIAS, cmdBuffer);
+      params.Write(depthBias);
+      params.Write(depthBiasClamp);
+      params.Write(slopeScaledDepthBias);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(SET_DEPTH_BIAS);
-    Serialise_vkCmdSetDepthBias(localSerialiser, cmdBuffer, depthBias, depthBiasClamp,
-                                slopeScaledDepthBias);
+      SCOPED_SERIALISE_CONTEXT(SET_DEPTH_BIAS);
+      Serialise_vkCmdSetDepthBias(localSerialiser, cmdBuffer, depthBias, depthBiasClamp,
+                                  slopeScaledDepthBias);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
   }
 }
 
@@ -300,12 +339,20 @@ void WrappedVulkan::vkCmdSetBlendConstants(VkCommandBuffer cmdBuffer, const floa
   {
     VkResourceRecord *record = GetRecord(cmdBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, SET_BLEND_CONST, cmdBuffer);
+      params.WriteArray(blendConst, 4);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(SET_BLEND_CONST);
-    Serialise_vkCmdSetBlendConstants(localSerialiser, cmdBuffer, blendConst);
+      SCOPED_SERIALISE_CONTEXT(SET_BLEND_CONST);
+      Serialise_vkCmdSetBlendConstants(localSerialiser, cmdBuffer, blendConst);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
   }
 }
 
@@ -353,12 +400,21 @@ void WrappedVulkan::vkCmdSetDepthBounds(VkCommandBuffer cmdBuffer, float minDept
   {
     VkResourceRecord *record = GetRecord(cmdBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, SET_DEPTH_BOUNDS, cmdBuffer);
+      params.Write(minDepthBounds);
+      params.Write(maxDepthBounds);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(SET_DEPTH_BOUNDS);
-    Serialise_vkCmdSetDepthBounds(localSerialiser, cmdBuffer, minDepthBounds, maxDepthBounds);
+      SCOPED_SERIALISE_CONTEXT(SET_DEPTH_BOUNDS);
+      Serialise_vkCmdSetDepthBounds(localSerialiser, cmdBuffer, minDepthBounds, maxDepthBounds);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
   }
 }
 
@@ -410,12 +466,21 @@ void WrappedVulkan::vkCmdSetStencilCompareMask(VkCommandBuffer cmdBuffer,
   {
     VkResourceRecord *record = GetRecord(cmdBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, SET_STENCIL_COMP_MASK, cmdBuffer);
+      params.Write((VkStencilFaceFlagBits)faceMask);
+      params.Write(compareMask);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(SET_STENCIL_COMP_MASK);
-    Serialise_vkCmdSetStencilCompareMask(localSerialiser, cmdBuffer, faceMask, compareMask);
+      SCOPED_SERIALISE_CONTEXT(SET_STENCIL_COMP_MASK);
+      Serialise_vkCmdSetStencilCompareMask(localSerialiser, cmdBuffer, faceMask, compareMask);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
   }
 }
 
@@ -467,12 +532,21 @@ void WrappedVulkan::vkCmdSetStencilWriteMask(VkCommandBuffer cmdBuffer, VkStenci
   {
     VkResourceRecord *record = GetRecord(cmdBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, SET_STENCIL_WRITE_MASK, cmdBuffer);
+      params.Write((VkStencilFaceFlagBits)faceMask);
+      params.Write(writeMask);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(SET_STENCIL_WRITE_MASK);
-    Serialise_vkCmdSetStencilWriteMask(localSerialiser, cmdBuffer, faceMask, writeMask);
+      SCOPED_SERIALISE_CONTEXT(SET_STENCIL_WRITE_MASK);
+      Serialise_vkCmdSetStencilWriteMask(localSerialiser, cmdBuffer, faceMask, writeMask);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
   }
 }
 
@@ -524,11 +598,20 @@ void WrappedVulkan::vkCmdSetStencilReference(VkCommandBuffer cmdBuffer, VkStenci
   {
     VkResourceRecord *record = GetRecord(cmdBuffer);
 
-    CACHE_THREAD_SERIALISER();
+    if(CanDeferCmd())
+    {
+      DeferredCmdWriter params = DeferCmd(record, SET_STENCIL_REF, cmdBuffer);
+      params.Write((VkStencilFaceFlagBits)faceMask);
+      params.Write(reference);
+    }
+    else
+    {
+      CACHE_THREAD_SERIALISER();
 
-    SCOPED_SERIALISE_CONTEXT(SET_STENCIL_REF);
-    Serialise_vkCmdSetStencilReference(localSerialiser, cmdBuffer, faceMask, reference);
+      SCOPED_SERIALISE_CONTEXT(SET_STENCIL_REF);
+      Serialise_vkCmdSetStencilReference(localSerialiser, cmdBuffer, faceMask, reference);
 
-    record->AddChunk(scope.Get());
+      record->AddChunk(scope.Get());
+    }
   }
 }
@@ -1020,7 +1020,10 @@ bool WrappedVulkan::Serialise_SetShaderDebugPath(Serialiser *localSerialiser, Vk
 
   if(m_State == READING)
   {
-    m_CreationInfo.m_ShaderModule[GetResourceManager()->GetLiveID(id)].unstrippedPath = path;
+    auto it = m_CreationInfo.m_ShaderModule.find(GetResourceManager()->GetLiveID(id));
+
+    if(it != m_CreationInfo.m_ShaderModule.end())
+      it->second.unstrippedPath = path;
   }
 
   return true;
@@ -650,21 +650,7 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
         {
           GetResourceManager()->MarkResourceFrameReferenced(GetResID(*it), eFrameRef_Read);
 
-          VkResourceRecord *setrecord = GetRecord(*it);
-
-          for(auto refit = setrecord->descInfo->bindFrameRefs.begin();
-              refit != setrecord->descInfo->bindFrameRefs.end(); ++refit)
-          {
-            refdIDs.insert(refit->first);
-            GetResourceManager()->MarkResourceFrameReferenced(refit->first, refit->second.second);
-
-            if(refit->second.first & DescriptorSetData::SPARSE_REF_BIT)
-            {
-              VkResourceRecord *sparserecord = GetResourceManager()->GetResourceRecord(refit->first);
-
-              GetResourceManager()->MarkSparseMapReferenced(sparserecord->sparseInfo);
-            }
-          }
+          MarkDescriptorSetReferenced(GetRecord(*it), &refdIDs);
         }
 
         for(auto it = record->bakedCommands->cmdInfo->sparse.begin();
@@ -800,7 +786,7 @@ VkResult WrappedVulkan::vkQueueSubmit(VkQueue queue, uint32_t submitCount,
         SCOPED_SERIALISE_CONTEXT(QUEUE_SUBMIT);
         Serialise_vkQueueSubmit(localSerialiser, queue, 1, &pSubmits[s], fence);
 
-        m_FrameCaptureRecord->AddChunk(scope.Get());
+        AddFrameChunk(scope.Get());
 
         for(uint32_t sem = 0; sem < pSubmits[s].waitSemaphoreCount; sem++)
           GetResourceManager()->MarkResourceFrameReferenced(
@@ -897,7 +883,7 @@ VkResult WrappedVulkan::vkQueueBindSparse(VkQueue queue, uint32_t bindInfoCount,
       SCOPED_SERIALISE_CONTEXT(BIND_SPARSE);
       Serialise_vkQueueBindSparse(localSerialiser, queue, 1, pBindInfo + i, fence);
 
-      m_FrameCaptureRecord->AddChunk(scope.Get());
+      AddFrameChunk(scope.Get());
       GetResourceManager()->MarkResourceFrameReferenced(GetResID(queue), eFrameRef_Read);
       GetResourceManager()->MarkResourceFrameReferenced(GetResID(fence), eFrameRef_Read);
       // images/buffers aren't marked referenced. If the only ref is a memory bind, we just skip it
@@ -1069,7 +1055,7 @@ VkResult WrappedVulkan::vkQueueWaitIdle(VkQueue queue)
     SCOPED_SERIALISE_CONTEXT(QUEUE_WAIT_IDLE);
     Serialise_vkQueueWaitIdle(localSerialiser, queue);
 
-    m_FrameCaptureRecord->AddChunk(scope.Get());
+    AddFrameChunk(scope.Get());
     GetResourceManager()->MarkResourceFrameReferenced(GetResID(queue), eFrameRef_Read);
   }
 
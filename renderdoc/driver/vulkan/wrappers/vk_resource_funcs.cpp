@@ -642,7 +642,7 @@ void WrappedVulkan::vkUnmapMemory(VkDevice device, VkDeviceMemory mem)
           }
           else
           {
-            m_FrameCaptureRecord->AddChunk(scope.Get());
+            AddFrameChunk(scope.Get());
             GetResourceManager()->MarkResourceFrameReferenced(id, eFrameRef_Write);
           }
         }
@@ -775,7 +775,7 @@ VkResult WrappedVulkan::vkFlushMappedMemoryRanges(VkDevice device, uint32_t memR
         SCOPED_SERIALISE_CONTEXT(FLUSH_MEM);
         Serialise_vkFlushMappedMemoryRanges(localSerialiser, device, 1, pMemRanges + i);
 
-        m_FrameCaptureRecord->AddChunk(scope.Get());
+        AddFrameChunk(scope.Get());
         GetResourceManager()->MarkResourceFrameReferenced(GetResID(pMemRanges[i].memory),
                                                           eFrameRef_Write);
       }
@@ -165,7 +165,7 @@ VkResult WrappedVulkan::vkGetFenceStatus(VkDevice device, VkFence fence)
     SCOPED_SERIALISE_CONTEXT(GET_FENCE_STATUS);
     Serialise_vkGetFenceStatus(localSerialiser, device, fence);
 
-    m_FrameCaptureRecord->AddChunk(scope.Get());
+    AddFrameChunk(scope.Get());
   }
 
   return ret;
@@ -223,7 +223,7 @@ VkResult WrappedVulkan::vkResetFences(VkDevice device, uint32_t fenceCount, cons
     SCOPED_SERIALISE_CONTEXT(RESET_FENCE);
     Serialise_vkResetFences(localSerialiser, device, fenceCount, pFences);
 
-    m_FrameCaptureRecord->AddChunk(scope.Get());
+    AddFrameChunk(scope.Get());
   }
 
   return ret;
@@ -282,7 +282,7 @@ VkResult WrappedVulkan::vkWaitForFences(VkDevice device, uint32_t fenceCount,
     SCOPED_SERIALISE_CONTEXT(WAIT_FENCES);
     Serialise_vkWaitForFences(localSerialiser, device, fenceCount, pFences, waitAll, timeout);
 
-    m_FrameCaptureRecord->AddChunk(scope.Get());
+    AddFrameChunk(scope.Get());
   }
 
   return ret;
@@ -382,7 +382,7 @@ VkResult WrappedVulkan::vkSetEvent(VkDevice device, VkEvent event)
     SCOPED_SERIALISE_CONTEXT(SET_EVENT);
     Serialise_vkSetEvent(localSerialiser, device, event);
 
-    m_FrameCaptureRecord->AddChunk(scope.Get());
+    AddFrameChunk(scope.Get());
   }
 
   return ret;
@@ -416,7 +416,7 @@ VkResult WrappedVulkan::vkResetEvent(VkDevice device, VkEvent event)
     SCOPED_SERIALISE_CONTEXT(RESET_EVENT);
     Serialise_vkResetEvent(localSerialiser, device, event);
 
-    m_FrameCaptureRecord->AddChunk(scope.Get());
+    AddFrameChunk(scope.Get());
   }
 
   return ret;
@@ -453,7 +453,7 @@ VkResult WrappedVulkan::vkGetEventStatus(VkDevice device, VkEvent event)
     SCOPED_SERIALISE_CONTEXT(GET_EVENT_STATUS);
     Serialise_vkGetEventStatus(localSerialiser, device, event);
 
-    m_FrameCaptureRecord->AddChunk(scope.Get());
+    AddFrameChunk(scope.Get());
   }
 
   return ret;
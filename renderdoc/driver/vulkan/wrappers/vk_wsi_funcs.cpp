@@ -616,6 +616,7 @@ VkResult WrappedVulkan::vkQueuePresentKHR(VkQueue queue, const VkPresentInfoKHR
     RenderDoc::Inst().Tick();
 
     GetResourceManager()->FlushPendingDirty();
+    GetResourceManager()->SpillResourceChunks();
   }
 
   m_FrameCounter++;    // first present becomes frame #1, this function is at the end of the frame
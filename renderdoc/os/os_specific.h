@@ -115,6 +115,27 @@ void JoinThread(ThreadHandle handle);
 void CloseThread(ThreadHandle handle);
 void Sleep(uint32_t milliseconds);
 
+// counting semaphore, for blocking a producer or consumer until there's work or space
+class Semaphore
+{
+public:
+  Semaphore(uint32_t initialCount);
+  ~Semaphore();
+
+  // blocks until the count is non-zero, then decrements it
+  void Wait();
+  // decrements the count if it's non-zero, without blocking. Returns true if it did
+  bool TryWait();
+  void Signal();
+
+private:
+  // no copying
+  Semaphore &operator=(const Semaphore &other);
+  Semaphore(const Semaphore &other);
+
+  void *m_Handle;
+};
+
 // kind of windows specific, to handle this case:
 // http://blogs.msdn.com/b/oldnewthing/archive/2013/11/05/10463645.aspx
 void KeepModuleAlive();
@@ -126,7 +147,7 @@ namespace Network
 class Socket
 {
 public:
-  Socket(ptrdiff_t s) : socket(s) {}
+  Socket(ptrdiff_t s) : socket(s), eventHandle(-1), eventMask(0), compressPackets(false) {}
   ~Socket();
   void Shutdown();
 
@@ -138,11 +159,28 @@ public:
 
   bool IsRecvDataWaiting();
 
+  // blocks until data can be received on the socket (or for a server socket, a client is waiting
+  // to be accepted), the connection closes, or timeoutMS passes. Returns true if the socket is
+  // ready, so that a subsequent IsRecvDataWaiting or AcceptClient returns without blocking.
+  // This only waits on this one socket - there's no event loop multiplexing several connections,
+  // each server connection is still serviced by its own thread.
+  bool WaitForRecvData(uint32_t timeoutMS);
+
   bool SendDataBlocking(const void *buf, uint32_t length);
   bool RecvDataBlocking(void *data, uint32_t length);
 
+  // set once both ends have agreed that large packet payloads can be sent compressed
+  void SetPacketCompression(bool compress) { compressPackets = compress; }
+  bool PacketCompression() const { return compressPackets; }
+
 private:
+  bool WaitForEvent(bool send, int timeoutMS);
+
   ptrdiff_t socket;
+  // platform-specific handle used to wait for events on the socket, and the events it's set up for
+  ptrdiff_t eventHandle;
+  uint32_t eventMask;
+  bool compressPackets;
 };
 
 Socket *CreateServerSocket(const char *addr, uint16_t port, int queuesize);
@@ -261,6 +299,10 @@ bool feof(FILE *f);
 
 int fclose(FILE *f);
 
+// maps a whole file read-only into memory. Returns NULL if the file is empty or can't be mapped
+const void *MapFile(const char *filename, uint64_t &size);
+void UnmapFile(const void *data, uint64_t size);
+
 // functions for atomically appending to a log that may be in use in multiple
 // processes
 void *logfile_open(const char *filename);
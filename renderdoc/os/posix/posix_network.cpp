@@ -27,6 +27,7 @@
 #include <netdb.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
+#include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -37,6 +38,13 @@
 #include "os/os_specific.h"
 #include "serialise/string_utils.h"
 
+#if ENABLED(RDOC_LINUX) || ENABLED(RDOC_ANDROID)
+#include <sys/epoll.h>
+#define USE_EPOLL OPTION_ON
+#else
+#define USE_EPOLL OPTION_OFF
+#endif
+
 using std::string;
 
 namespace Network
@@ -62,6 +70,12 @@ void Socket::Shutdown()
     close((int)socket);
     socket = -1;
   }
+
+  if((int)eventHandle != -1)
+  {
+    close((int)eventHandle);
+    eventHandle = -1;
+  }
 }
 
 bool Socket::Connected() const
@@ -102,9 +116,11 @@ Socket *Socket::AcceptClient(bool wait)
     {
       RDCWARN("accept: %d", err);
       Shutdown();
+      return NULL;
     }
 
-    Threading::Sleep(4);
+    if(wait)
+      WaitForEvent(false, -1);
   } while(wait);
 
   return NULL;
@@ -119,9 +135,8 @@ bool Socket::SendDataBlocking(const void *buf, uint32_t length)
 
   char *src = (char *)buf;
 
-  int flags = fcntl(socket, F_GETFL, 0);
-  fcntl(socket, F_SETFL, flags & ~O_NONBLOCK);
-
+  // the socket stays non-blocking, we wait for it to become writable whenever the send buffer is
+  // full instead of toggling it into blocking mode around every call.
   while(sent < length)
   {
     int ret = send(socket, src, length - sent, 0);
@@ -130,8 +145,14 @@ bool Socket::SendDataBlocking(const void *buf, uint32_t length)
     {
       int err = errno;
 
-      if(err == EWOULDBLOCK || err == EAGAIN)
+      if(err == EWOULDBLOCK || err == EAGAIN || err == EINTR)
       {
+        if(!WaitForEvent(true, -1))
+        {
+          Shutdown();
+          return false;
+        }
+
         ret = 0;
       }
       else
@@ -146,9 +167,6 @@ bool Socket::SendDataBlocking(const void *buf, uint32_t length)
     src += ret;
   }
 
-  flags = fcntl(socket, F_GETFL, 0);
-  fcntl(socket, F_SETFL, flags | O_NONBLOCK);
-
   RDCASSERT(sent == length);
 
   return true;
@@ -183,6 +201,90 @@ bool Socket::IsRecvDataWaiting()
   return ret > 0;
 }
 
+bool Socket::WaitForRecvData(uint32_t timeoutMS)
+{
+  if(!Connected())
+    return false;
+
+  return WaitForEvent(false, (int)RDCMIN(timeoutMS, (uint32_t)INT32_MAX));
+}
+
+bool Socket::WaitForEvent(bool send, int timeoutMS)
+{
+#if ENABLED(USE_EPOLL)
+  uint32_t events = (send ? EPOLLOUT : EPOLLIN) | EPOLLRDHUP;
+
+  // the epoll instance is created on first use, and only modified when switching between waiting
+  // to send and waiting to receive.
+  if((int)eventHandle == -1)
+  {
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+
+    if(ep == -1)
+    {
+      RDCWARN("epoll_create1: %d", errno);
+      return false;
+    }
+
+    epoll_event ev = {};
+    ev.events = events;
+    ev.data.fd = (int)socket;
+
+    if(epoll_ctl(ep, EPOLL_CTL_ADD, (int)socket, &ev) == -1)
+    {
+      RDCWARN("epoll_ctl: %d", errno);
+      close(ep);
+      return false;
+    }
+
+    eventHandle = ep;
+    eventMask = events;
+  }
+  else if(eventMask != events)
+  {
+    epoll_event ev = {};
+    ev.events = events;
+    ev.data.fd = (int)socket;
+
+    if(epoll_ctl((int)eventHandle, EPOLL_CTL_MOD, (int)socket, &ev) == -1)
+    {
+      RDCWARN("epoll_ctl: %d", errno);
+      return false;
+    }
+
+    eventMask = events;
+  }
+
+  epoll_event ev = {};
+  int ret = 0;
+
+  do
+  {
+    ret = epoll_wait((int)eventHandle, &ev, 1, timeoutMS);
+  } while(ret == -1 && errno == EINTR);
+#else
+  pollfd fd = {};
+  fd.fd = (int)socket;
+  fd.events = send ? POLLOUT : POLLIN;
+
+  int ret = 0;
+
+  do
+  {
+    ret = poll(&fd, 1, timeoutMS);
+  } while(ret == -1 && errno == EINTR);
+#endif
+
+  if(ret == -1)
+  {
+    RDCWARN("Waiting on socket: %d", errno);
+    return false;
+  }
+
+  // errors and hangups count as ready, the following send/recv will see them
+  return ret > 0;
+}
+
 bool Socket::RecvDataBlocking(void *buf, uint32_t length)
 {
   if(length == 0)
@@ -192,9 +294,6 @@ bool Socket::RecvDataBlocking(void *buf, uint32_t length)
 
   char *dst = (char *)buf;
 
-  int flags = fcntl(socket, F_GETFL, 0);
-  fcntl(socket, F_SETFL, flags & ~O_NONBLOCK);
-
   while(received < length)
   {
     int ret = recv(socket, dst, length - received, 0);
@@ -208,8 +307,14 @@ bool Socket::RecvDataBlocking(void *buf, uint32_t length)
     {
       int err = errno;
 
-      if(err == EWOULDBLOCK || err == EAGAIN)
+      if(err == EWOULDBLOCK || err == EAGAIN || err == EINTR)
       {
+        if(!WaitForEvent(false, -1))
+        {
+          Shutdown();
+          return false;
+        }
+
         ret = 0;
       }
       else
@@ -224,9 +329,6 @@ bool Socket::RecvDataBlocking(void *buf, uint32_t length)
     dst += ret;
   }
 
-  flags = fcntl(socket, F_GETFL, 0);
-  fcntl(socket, F_SETFL, flags | O_NONBLOCK);
-
   RDCASSERT(received == length);
 
   return true;
@@ -31,6 +31,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <time.h>
@@ -373,6 +374,39 @@ int fclose(FILE *f)
   return ::fclose(f);
 }
 
+const void *MapFile(const char *filename, uint64_t &size)
+{
+  size = 0;
+
+  int fd = open(filename, O_RDONLY);
+  if(fd < 0)
+    return NULL;
+
+  struct stat st;
+  void *ret = NULL;
+
+  if(fstat(fd, &st) == 0 && st.st_size > 0)
+  {
+    ret = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if(ret == MAP_FAILED)
+      ret = NULL;
+    else
+      size = (uint64_t)st.st_size;
+  }
+
+  // the mapping keeps the file open
+  close(fd);
+
+  return ret;
+}
+
+void UnmapFile(const void *data, uint64_t size)
+{
+  if(data)
+    munmap((void *)data, (size_t)size);
+}
+
 void *logfile_open(const char *filename)
 {
   int fd = open(filename, O_APPEND | O_WRONLY | O_CREAT, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
@@ -245,4 +245,62 @@ void Sleep(uint32_t milliseconds)
 {
   usleep(milliseconds * 1000);
 }
+
+// unnamed POSIX semaphores aren't available everywhere, so build one from a condition variable
+struct SemaphoreData
+{
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  uint32_t count;
+};
+
+Semaphore::Semaphore(uint32_t initialCount)
+{
+  SemaphoreData *data = new SemaphoreData;
+  pthread_mutex_init(&data->lock, NULL);
+  pthread_cond_init(&data->cond, NULL);
+  data->count = initialCount;
+  m_Handle = data;
+}
+
+Semaphore::~Semaphore()
+{
+  SemaphoreData *data = (SemaphoreData *)m_Handle;
+  pthread_cond_destroy(&data->cond);
+  pthread_mutex_destroy(&data->lock);
+  delete data;
+}
+
+void Semaphore::Wait()
+{
+  SemaphoreData *data = (SemaphoreData *)m_Handle;
+  pthread_mutex_lock(&data->lock);
+  while(data->count == 0)
+    pthread_cond_wait(&data->cond, &data->lock);
+  data->count--;
+  pthread_mutex_unlock(&data->lock);
+}
+
+bool Semaphore::TryWait()
+{
+  SemaphoreData *data = (SemaphoreData *)m_Handle;
+  bool ret = false;
+  pthread_mutex_lock(&data->lock);
+  if(data->count > 0)
+  {
+    data->count--;
+    ret = true;
+  }
+  pthread_mutex_unlock(&data->lock);
+  return ret;
+}
+
+void Semaphore::Signal()
+{
+  SemaphoreData *data = (SemaphoreData *)m_Handle;
+  pthread_mutex_lock(&data->lock);
+  data->count++;
+  pthread_cond_signal(&data->cond);
+  pthread_mutex_unlock(&data->lock);
+}
 };
@@ -97,9 +97,11 @@ Socket *Socket::AcceptClient(bool wait)
     {
       RDCWARN("accept: %d", err);
       Shutdown();
+      return NULL;
     }
 
-    Threading::Sleep(4);
+    if(wait)
+      WaitForEvent(false, -1);
   } while(wait);
 
   return NULL;
@@ -184,6 +186,38 @@ bool Socket::IsRecvDataWaiting()
   return ret > 0;
 }
 
+bool Socket::WaitForRecvData(uint32_t timeoutMS)
+{
+  if(!Connected())
+    return false;
+
+  return WaitForEvent(false, (int)RDCMIN(timeoutMS, (uint32_t)INT32_MAX));
+}
+
+bool Socket::WaitForEvent(bool send, int timeoutMS)
+{
+  // there's only ever one socket to wait on, so select() is as good as anything else here and
+  // doesn't need an event object associated with the socket.
+  fd_set set;
+  FD_ZERO(&set);
+  FD_SET((SOCKET)socket, &set);
+
+  timeval timeout;
+  timeout.tv_sec = timeoutMS / 1000;
+  timeout.tv_usec = (timeoutMS % 1000) * 1000;
+
+  int ret =
+      select(0, send ? NULL : &set, send ? &set : NULL, NULL, timeoutMS < 0 ? NULL : &timeout);
+
+  if(ret == SOCKET_ERROR)
+  {
+    RDCWARN("select: %d", WSAGetLastError());
+    return false;
+  }
+
+  return ret > 0;
+}
+
 bool Socket::RecvDataBlocking(void *buf, uint32_t length)
 {
   if(length == 0)
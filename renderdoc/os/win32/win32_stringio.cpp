@@ -514,6 +514,47 @@ int fclose(FILE *f)
   return ::fclose(f);
 }
 
+const void *MapFile(const char *filename, uint64_t &size)
+{
+  size = 0;
+
+  wstring wfn = StringFormat::UTF82Wide(string(filename));
+
+  HANDLE file = CreateFileW(wfn.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, NULL);
+  if(file == INVALID_HANDLE_VALUE)
+    return NULL;
+
+  LARGE_INTEGER len;
+  const void *ret = NULL;
+
+  if(GetFileSizeEx(file, &len) && len.QuadPart > 0)
+  {
+    HANDLE mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    if(mapping)
+    {
+      ret = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+      if(ret)
+        size = (uint64_t)len.QuadPart;
+
+      // the view keeps the mapping and file open
+      CloseHandle(mapping);
+    }
+  }
+
+  CloseHandle(file);
+
+  return ret;
+}
+
+void UnmapFile(const void *data, uint64_t size)
+{
+  if(data)
+    UnmapViewOfFile(data);
+}
+
 void *logfile_open(const char *filename)
 {
   wstring wfn = StringFormat::UTF82Wide(string(filename));
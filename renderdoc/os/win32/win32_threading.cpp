@@ -253,4 +253,29 @@ void Sleep(uint32_t milliseconds)
 {
   ::Sleep((DWORD)milliseconds);
 }
+
+Semaphore::Semaphore(uint32_t initialCount)
+{
+  m_Handle = (void *)CreateSemaphore(NULL, (LONG)initialCount, LONG_MAX, NULL);
+}
+
+Semaphore::~Semaphore()
+{
+  CloseHandle((HANDLE)m_Handle);
+}
+
+void Semaphore::Wait()
+{
+  WaitForSingleObject((HANDLE)m_Handle, INFINITE);
+}
+
+bool Semaphore::TryWait()
+{
+  return WaitForSingleObject((HANDLE)m_Handle, 0) == WAIT_OBJECT_0;
+}
+
+void Semaphore::Signal()
+{
+  ReleaseSemaphore((HANDLE)m_Handle, 1, NULL);
+}
 };
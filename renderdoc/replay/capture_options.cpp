@@ -48,6 +48,10 @@ int RENDERDOC_CC SetCaptureOptionU32(RENDERDOC_CaptureOption opt, uint32_t val)
     case eRENDERDOC_Option_SaveAllInitials: opts.SaveAllInitials = (val != 0); break;
     case eRENDERDOC_Option_CaptureAllCmdLists: opts.CaptureAllCmdLists = (val != 0); break;
     case eRENDERDOC_Option_DebugOutputMute: opts.DebugOutputMute = (val != 0); break;
+    case eRENDERDOC_Option_AsyncCaptureWrite: opts.AsyncCaptureWrite = (val != 0); break;
+    case eRENDERDOC_Option_RetroactiveFrames: opts.RetroactiveFrames = val; break;
+    case eRENDERDOC_Option_CaptureStatistics: opts.CaptureStatistics = (val != 0); break;
+    case eRENDERDOC_Option_SpillResourceChunks: opts.SpillResourceChunks = (val != 0); break;
     default: RDCLOG("Unrecognised capture option '%d'", opt); return 0;
   }
 
@@ -75,6 +79,10 @@ int RENDERDOC_CC SetCaptureOptionF32(RENDERDOC_CaptureOption opt, float val)
     case eRENDERDOC_Option_SaveAllInitials: opts.SaveAllInitials = (val != 0.0f); break;
     case eRENDERDOC_Option_CaptureAllCmdLists: opts.CaptureAllCmdLists = (val != 0.0f); break;
     case eRENDERDOC_Option_DebugOutputMute: opts.DebugOutputMute = (val != 0.0f); break;
+    case eRENDERDOC_Option_AsyncCaptureWrite: opts.AsyncCaptureWrite = (val != 0.0f); break;
+    case eRENDERDOC_Option_RetroactiveFrames: opts.RetroactiveFrames = (uint32_t)val; break;
+    case eRENDERDOC_Option_CaptureStatistics: opts.CaptureStatistics = (val != 0.0f); break;
+    case eRENDERDOC_Option_SpillResourceChunks: opts.SpillResourceChunks = (val != 0.0f); break;
     default: RDCLOG("Unrecognised capture option '%d'", opt); return 0;
   }
 
@@ -110,6 +118,14 @@ uint32_t RENDERDOC_CC GetCaptureOptionU32(RENDERDOC_CaptureOption opt)
       return (RenderDoc::Inst().GetCaptureOptions().CaptureAllCmdLists ? 1 : 0);
     case eRENDERDOC_Option_DebugOutputMute:
       return (RenderDoc::Inst().GetCaptureOptions().DebugOutputMute ? 1 : 0);
+    case eRENDERDOC_Option_AsyncCaptureWrite:
+      return (RenderDoc::Inst().GetCaptureOptions().AsyncCaptureWrite ? 1 : 0);
+    case eRENDERDOC_Option_RetroactiveFrames:
+      return (RenderDoc::Inst().GetCaptureOptions().RetroactiveFrames);
+    case eRENDERDOC_Option_CaptureStatistics:
+      return (RenderDoc::Inst().GetCaptureOptions().CaptureStatistics ? 1 : 0);
+    case eRENDERDOC_Option_SpillResourceChunks:
+      return (RenderDoc::Inst().GetCaptureOptions().SpillResourceChunks ? 1 : 0);
     default: break;
   }
 
@@ -145,6 +161,14 @@ float RENDERDOC_CC GetCaptureOptionF32(RENDERDOC_CaptureOption opt)
       return (RenderDoc::Inst().GetCaptureOptions().CaptureAllCmdLists ? 1.0f : 0.0f);
     case eRENDERDOC_Option_DebugOutputMute:
       return (RenderDoc::Inst().GetCaptureOptions().DebugOutputMute ? 1.0f : 0.0f);
+    case eRENDERDOC_Option_AsyncCaptureWrite:
+      return (RenderDoc::Inst().GetCaptureOptions().AsyncCaptureWrite ? 1.0f : 0.0f);
+    case eRENDERDOC_Option_RetroactiveFrames:
+      return (RenderDoc::Inst().GetCaptureOptions().RetroactiveFrames * 1.0f);
+    case eRENDERDOC_Option_CaptureStatistics:
+      return (RenderDoc::Inst().GetCaptureOptions().CaptureStatistics ? 1.0f : 0.0f);
+    case eRENDERDOC_Option_SpillResourceChunks:
+      return (RenderDoc::Inst().GetCaptureOptions().SpillResourceChunks ? 1.0f : 0.0f);
     default: break;
   }
 
@@ -166,4 +190,8 @@ CaptureOptions::CaptureOptions()
   SaveAllInitials = false;
   CaptureAllCmdLists = false;
   DebugOutputMute = true;
+  AsyncCaptureWrite = false;
+  RetroactiveFrames = 0;
+  CaptureStatistics = false;
+  SpillResourceChunks = false;
 }
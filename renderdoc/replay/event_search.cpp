@@ -0,0 +1,192 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#include "event_search.h"
+#include <algorithm>
+#include <ctype.h>
+#include <string.h>
+
+static std::string LowerCase(const char *str, size_t len)
+{
+  std::string ret(str, len);
+  for(char &c : ret)
+    c = (char)tolower((unsigned char)c);
+  return ret;
+}
+
+static uint32_t Trigram(const char *str)
+{
+  return (uint32_t((uint8_t)str[0]) << 16) | (uint32_t((uint8_t)str[1]) << 8) |
+         uint32_t((uint8_t)str[2]);
+}
+
+void EventSearchIndex::AddDrawcalls(const rdctype::array<DrawcallDescription> &draws,
+                                    std::vector<std::pair<uint32_t, std::string> > &texts)
+{
+  for(const DrawcallDescription &d : draws)
+  {
+    texts.push_back(std::make_pair(d.eventID, std::string(d.name.c_str())));
+
+    for(const APIEvent &ev : d.events)
+      texts.push_back(std::make_pair(ev.eventID, std::string(ev.eventDesc.c_str())));
+
+    AddDrawcalls(d.children, texts);
+  }
+}
+
+void EventSearchIndex::Build(const rdctype::array<DrawcallDescription> &draws)
+{
+  Clear();
+
+  std::vector<std::pair<uint32_t, std::string> > texts;
+  AddDrawcalls(draws, texts);
+
+  // a drawcall and its own event share an EID, keep the name first
+  std::stable_sort(texts.begin(), texts.end(),
+                   [](const std::pair<uint32_t, std::string> &a,
+                      const std::pair<uint32_t, std::string> &b) { return a.first < b.first; });
+
+  size_t totalLength = 0;
+  for(const std::pair<uint32_t, std::string> &t : texts)
+    totalLength += t.second.size() + 1;
+
+  m_Text.reserve(totalLength);
+
+  for(size_t i = 0; i < texts.size(); i++)
+  {
+    if(m_Entries.empty() || m_Entries.back().eventID != texts[i].first)
+    {
+      Entry e = {texts[i].first, (uint32_t)m_Text.size(), 0};
+      m_Entries.push_back(e);
+    }
+    else
+    {
+      // separate text from different sources so that a match can't span them
+      m_Text += '\n';
+    }
+
+    m_Text += LowerCase(texts[i].second.c_str(), texts[i].second.size());
+    m_Entries.back().length = uint32_t(m_Text.size() - m_Entries.back().offset);
+  }
+
+  for(uint32_t i = 0; i < (uint32_t)m_Entries.size(); i++)
+  {
+    const Entry &e = m_Entries[i];
+    const char *str = m_Text.c_str() + e.offset;
+
+    for(uint32_t c = 0; c + 3 <= e.length; c++)
+    {
+      std::vector<uint32_t> &list = m_Trigrams[Trigram(str + c)];
+
+      // entries are processed in order so duplicates within one entry are always at the back
+      if(list.empty() || list.back() != i)
+        list.push_back(i);
+    }
+  }
+}
+
+void EventSearchIndex::Clear()
+{
+  m_Text.clear();
+  m_Entries.clear();
+  m_Trigrams.clear();
+}
+
+bool EventSearchIndex::Matches(const Entry &e, const std::string &needle) const
+{
+  const char *begin = m_Text.c_str() + e.offset;
+  const char *end = begin + e.length;
+
+  return std::search(begin, end, needle.begin(), needle.end()) != end;
+}
+
+void EventSearchIndex::Find(const char *text, uint32_t afterEventID, uint32_t maxResults,
+                            std::vector<uint32_t> &results) const
+{
+  if(text == NULL || text[0] == 0)
+    return;
+
+  std::string needle = LowerCase(text, strlen(text));
+
+  uint32_t first = uint32_t(
+      std::upper_bound(m_Entries.begin(), m_Entries.end(), afterEventID,
+                       [](uint32_t eid, const Entry &e) { return eid < e.eventID; }) -
+      m_Entries.begin());
+
+  uint32_t found = 0;
+
+  // too short to use the index, check every entry
+  if(needle.size() < 3)
+  {
+    for(uint32_t i = first; i < (uint32_t)m_Entries.size(); i++)
+    {
+      if(Matches(m_Entries[i], needle))
+      {
+        results.push_back(m_Entries[i].eventID);
+        if(++found == maxResults)
+          return;
+      }
+    }
+
+    return;
+  }
+
+  // gather the lists for each trigram in the needle. Any entry that contains the needle must be in
+  // all of them, so we walk the shortest list and check the others.
+  std::vector<const std::vector<uint32_t> *> lists;
+
+  for(size_t c = 0; c + 3 <= needle.size(); c++)
+  {
+    auto it = m_Trigrams.find(Trigram(needle.c_str() + c));
+
+    if(it == m_Trigrams.end())
+      return;
+
+    lists.push_back(&it->second);
+  }
+
+  std::sort(lists.begin(), lists.end(),
+            [](const std::vector<uint32_t> *a, const std::vector<uint32_t> *b) {
+              return a->size() < b->size();
+            });
+
+  const std::vector<uint32_t> &shortest = *lists[0];
+
+  for(auto it = std::lower_bound(shortest.begin(), shortest.end(), first); it != shortest.end();
+      ++it)
+  {
+    uint32_t idx = *it;
+
+    bool candidate = true;
+    for(size_t l = 1; candidate && l < lists.size(); l++)
+      candidate = std::binary_search(lists[l]->begin(), lists[l]->end(), idx);
+
+    if(candidate && Matches(m_Entries[idx], needle))
+    {
+      results.push_back(m_Entries[idx].eventID);
+      if(++found == maxResults)
+        return;
+    }
+  }
+}
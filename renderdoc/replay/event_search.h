@@ -0,0 +1,67 @@
+/******************************************************************************
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2017 Baldur Karlsson
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ******************************************************************************/
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "api/replay/renderdoc_replay.h"
+
+// A case-insensitive substring index over the events in a frame. Each event's text is its
+// serialised call parameters plus the name of the drawcall or marker at that EID, if any.
+// Candidates are narrowed with a trigram index then verified against the text itself.
+class EventSearchIndex
+{
+public:
+  void Build(const rdctype::array<DrawcallDescription> &draws);
+  void Clear();
+
+  // appends to results up to maxResults (or all, if maxResults is 0) EIDs after afterEventID whose
+  // text contains the search string, in ascending order.
+  void Find(const char *text, uint32_t afterEventID, uint32_t maxResults,
+            std::vector<uint32_t> &results) const;
+
+private:
+  struct Entry
+  {
+    uint32_t eventID;
+    uint32_t offset;
+    uint32_t length;
+  };
+
+  void AddDrawcalls(const rdctype::array<DrawcallDescription> &draws,
+                    std::vector<std::pair<uint32_t, std::string> > &texts);
+
+  bool Matches(const Entry &e, const std::string &needle) const;
+
+  // the lower-cased text of every entry, concatenated
+  std::string m_Text;
+
+  // sorted by EID
+  std::vector<Entry> m_Entries;
+
+  // trigram -> ascending list of indices into m_Entries that contain it
+  std::unordered_map<uint32_t, std::vector<uint32_t> > m_Trigrams;
+};
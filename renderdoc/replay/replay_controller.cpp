@@ -219,6 +219,62 @@ rdctype::array<DrawcallDescription> ReplayController::GetDrawcalls()
   return m_FrameRecord.drawcallList;
 }
 
+DrawcallDescription ReplayController::GetDrawcall(uint32_t eventID)
+{
+  DrawcallDescription ret;
+
+  DrawcallDescription *draw = GetDrawcallByEID(eventID);
+
+  if(draw == NULL)
+    return ret;
+
+  // move the children out of the way while copying, so that we don't copy the whole subtree
+  rdctype::array<DrawcallDescription> children;
+  children.swap(draw->children);
+  ret = *draw;
+  children.swap(draw->children);
+
+  return ret;
+}
+
+rdctype::array<uint32_t> ReplayController::GetDrawcallChildren(uint32_t eventID)
+{
+  rdctype::array<uint32_t> ret;
+
+  const rdctype::array<DrawcallDescription> *children = NULL;
+
+  if(eventID == 0)
+  {
+    children = &m_FrameRecord.drawcallList;
+  }
+  else
+  {
+    DrawcallDescription *draw = GetDrawcallByEID(eventID);
+
+    if(draw == NULL)
+      return ret;
+
+    children = &draw->children;
+  }
+
+  create_array_uninit(ret, children->size());
+
+  for(int32_t i = 0; i < children->count; i++)
+    ret[i] = (*children)[i].eventID;
+
+  return ret;
+}
+
+rdctype::array<uint32_t> ReplayController::FindEvents(const char *text, uint32_t afterEventID,
+                                                      uint32_t maxResults)
+{
+  std::vector<uint32_t> results;
+  m_SearchIndex.Find(text, afterEventID, maxResults, results);
+
+  rdctype::array<uint32_t> ret = results;
+  return ret;
+}
+
 rdctype::array<CounterResult> ReplayController::FetchCounters(const rdctype::array<GPUCounter> &counters)
 {
   vector<GPUCounter> counterArray;
@@ -246,14 +302,7 @@ CounterDescription ReplayController::DescribeCounter(GPUCounter counterID)
 rdctype::array<BufferDescription> ReplayController::GetBuffers()
 {
   if(m_Buffers.empty())
-  {
-    vector<ResourceId> ids = m_pDevice->GetBuffers();
-
-    m_Buffers.resize(ids.size());
-
-    for(size_t i = 0; i < ids.size(); i++)
-      m_Buffers[i] = m_pDevice->GetBuffer(ids[i]);
-  }
+    m_Buffers = m_pDevice->GetBufferDescriptions();
 
   return m_Buffers;
 }
@@ -261,14 +310,7 @@ rdctype::array<BufferDescription> ReplayController::GetBuffers()
 rdctype::array<TextureDescription> ReplayController::GetTextures()
 {
   if(m_Textures.empty())
-  {
-    vector<ResourceId> ids = m_pDevice->GetTextures();
-
-    m_Textures.resize(ids.size());
-
-    for(size_t i = 0; i < ids.size(); i++)
-      m_Textures[i] = m_pDevice->GetTexture(ids[i]);
-  }
+    m_Textures = m_pDevice->GetTextureDescriptions();
 
   return m_Textures;
 }
@@ -320,9 +362,9 @@ MeshFormat ReplayController::GetPostVSData(uint32_t instID, MeshDataStage stage)
   return m_pDevice->GetPostVSBuffers(draw->eventID, instID, stage);
 }
 
-rdctype::array<byte> ReplayController::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len)
+rdctype::bytebuf ReplayController::GetBufferData(ResourceId buff, uint64_t offset, uint64_t len)
 {
-  rdctype::array<byte> ret;
+  rdctype::bytebuf ret;
 
   if(buff == ResourceId())
     return ret;
@@ -338,14 +380,15 @@ rdctype::array<byte> ReplayController::GetBufferData(ResourceId buff, uint64_t o
   vector<byte> retData;
   m_pDevice->GetBufferData(liveId, offset, len, retData);
 
-  create_array_init(ret, retData.size(), !retData.empty() ? &retData[0] : NULL);
+  if(!retData.empty())
+    ret.assign(&retData[0], retData.size());
 
   return ret;
 }
 
-rdctype::array<byte> ReplayController::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip)
+rdctype::bytebuf ReplayController::GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip)
 {
-  rdctype::array<byte> ret;
+  rdctype::bytebuf ret;
 
   ResourceId liveId = m_pDevice->GetLiveID(tex);
 
@@ -358,16 +401,99 @@ rdctype::array<byte> ReplayController::GetTextureData(ResourceId tex, uint32_t a
   size_t sz = 0;
   byte *bytes = m_pDevice->GetTextureData(liveId, arrayIdx, mip, GetTextureDataParams(), sz);
 
-  if(sz == 0 || bytes == NULL)
-    create_array_uninit(ret, 0);
-  else
-    create_array_init(ret, sz, bytes);
+  if(sz > 0 && bytes != NULL)
+    ret.assign(bytes, sz);
 
   SAFE_DELETE_ARRAY(bytes);
 
   return ret;
 }
 
+uint64_t ReplayController::GetBufferDataInto(ResourceId buff, uint64_t offset, byte *dest,
+                                             uint64_t destSize)
+{
+  if(buff == ResourceId() || dest == NULL || destSize == 0)
+    return 0;
+
+  ResourceId liveId = m_pDevice->GetLiveID(buff);
+
+  if(liveId == ResourceId())
+  {
+    RDCERR("Couldn't get Live ID for %llu getting buffer data", buff);
+    return 0;
+  }
+
+  return m_pDevice->GetBufferDataInto(liveId, offset, destSize, dest);
+}
+
+// the size of the data GetTextureData returns for one subresource: a single slice of an array
+// texture (or sample, for unresolved MSAA textures), or every slice of a mip of a 3D texture.
+// Returns 0 for formats whose layout depends on the driver
+static uint64_t GetTextureDataSize(const TextureDescription &td, uint32_t mip)
+{
+  uint64_t w = RDCMAX(1U, td.width >> mip);
+  uint64_t h = RDCMAX(1U, td.height >> mip);
+  uint64_t d = td.dimension == 3 ? RDCMAX(1U, td.depth >> mip) : 1;
+
+  switch(td.format.specialFormat)
+  {
+    case SpecialFormat::BC1:
+    case SpecialFormat::BC4: return ((w + 3) / 4) * ((h + 3) / 4) * 8 * d;
+    case SpecialFormat::BC2:
+    case SpecialFormat::BC3:
+    case SpecialFormat::BC5:
+    case SpecialFormat::BC6:
+    case SpecialFormat::BC7: return ((w + 3) / 4) * ((h + 3) / 4) * 16 * d;
+    case SpecialFormat::S8: return w * h * d;
+    case SpecialFormat::R10G10B10A2:
+    case SpecialFormat::R9G9B9E5:
+    case SpecialFormat::R11G11B10:
+    case SpecialFormat::D24S8: return w * h * d * 4;
+    case SpecialFormat::R5G6B5:
+    case SpecialFormat::R5G5B5A1:
+    case SpecialFormat::R4G4B4A4: return w * h * d * 2;
+    case SpecialFormat::D32S8: return w * h * d * 8;
+    case SpecialFormat::Unknown:
+      if(!td.format.special)
+        return w * h * d * td.format.compCount * td.format.compByteWidth;
+      return 0;
+    default: return 0;
+  }
+}
+
+uint64_t ReplayController::GetTextureDataInto(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
+                                              byte *dest, uint64_t destSize)
+{
+  ResourceId liveId = m_pDevice->GetLiveID(tex);
+
+  if(liveId == ResourceId())
+  {
+    RDCERR("Couldn't get Live ID for %llu getting texture data", tex);
+    return 0;
+  }
+
+  // a size query can be answered from the description without reading anything back
+  if(dest == NULL || destSize == 0)
+  {
+    uint64_t querySize = GetTextureDataSize(m_pDevice->GetTexture(liveId), mip);
+    if(querySize > 0)
+      return querySize;
+  }
+
+  size_t sz = 0;
+  byte *bytes = m_pDevice->GetTextureData(liveId, arrayIdx, mip, GetTextureDataParams(), sz);
+
+  if(bytes == NULL)
+    return 0;
+
+  if(dest)
+    memcpy(dest, bytes, (size_t)RDCMIN((uint64_t)sz, destSize));
+
+  SAFE_DELETE_ARRAY(bytes);
+
+  return (uint64_t)sz;
+}
+
 bool ReplayController::SaveTexture(const TextureSave &saveData, const char *path)
 {
   TextureSave sd = saveData;    // mutable copy
@@ -1483,6 +1609,8 @@ ReplayStatus ReplayController::PostCreateInit(IReplayDriver *device)
 
   SetupDrawcallPointers(&m_Drawcalls, m_FrameRecord.drawcallList, NULL, NULL);
 
+  m_SearchIndex.Build(m_FrameRecord.drawcallList);
+
   return ReplayStatus::Succeeded;
 }
 
@@ -1690,6 +1818,23 @@ ReplayRenderer_GetDrawcalls(IReplayController *rend, rdctype::array<DrawcallDesc
 {
   *draws = rend->GetDrawcalls();
 }
+extern "C" RENDERDOC_API void RENDERDOC_CC ReplayRenderer_GetDrawcall(IReplayController *rend,
+                                                                      uint32_t eventID,
+                                                                      DrawcallDescription *draw)
+{
+  *draw = rend->GetDrawcall(eventID);
+}
+extern "C" RENDERDOC_API void RENDERDOC_CC ReplayRenderer_GetDrawcallChildren(
+    IReplayController *rend, uint32_t eventID, rdctype::array<uint32_t> *children)
+{
+  *children = rend->GetDrawcallChildren(eventID);
+}
+extern "C" RENDERDOC_API void RENDERDOC_CC
+ReplayRenderer_FindEvents(IReplayController *rend, const char *text, uint32_t afterEventID,
+                          uint32_t maxResults, rdctype::array<uint32_t> *eventIDs)
+{
+  *eventIDs = rend->FindEvents(text, afterEventID, maxResults);
+}
 extern "C" RENDERDOC_API void RENDERDOC_CC
 ReplayRenderer_FetchCounters(IReplayController *rend, GPUCounter *counters, uint32_t numCounters,
                              rdctype::array<CounterResult> *results)
@@ -1799,7 +1944,7 @@ extern "C" RENDERDOC_API void RENDERDOC_CC ReplayRenderer_GetPostVSData(IReplayC
 extern "C" RENDERDOC_API void RENDERDOC_CC ReplayRenderer_GetBufferData(IReplayController *rend,
                                                                         ResourceId buff,
                                                                         uint64_t offset, uint64_t len,
-                                                                        rdctype::array<byte> *data)
+                                                                        rdctype::bytebuf *data)
 {
   *data = rend->GetBufferData(buff, offset, len);
 }
@@ -1808,7 +1953,20 @@ extern "C" RENDERDOC_API void RENDERDOC_CC ReplayRenderer_GetTextureData(IReplay
                                                                          ResourceId tex,
                                                                          uint32_t arrayIdx,
                                                                          uint32_t mip,
-                                                                         rdctype::array<byte> *data)
+                                                                         rdctype::bytebuf *data)
 {
   *data = rend->GetTextureData(tex, arrayIdx, mip);
 }
+
+extern "C" RENDERDOC_API uint64_t RENDERDOC_CC ReplayRenderer_GetBufferDataInto(
+    IReplayController *rend, ResourceId buff, uint64_t offset, byte *dest, uint64_t destSize)
+{
+  return rend->GetBufferDataInto(buff, offset, dest, destSize);
+}
+
+extern "C" RENDERDOC_API uint64_t RENDERDOC_CC ReplayRenderer_GetTextureDataInto(
+    IReplayController *rend, ResourceId tex, uint32_t arrayIdx, uint32_t mip, byte *dest,
+    uint64_t destSize)
+{
+  return rend->GetTextureDataInto(tex, arrayIdx, mip, dest, destSize);
+}
@@ -30,6 +30,7 @@
 #include "api/replay/renderdoc_replay.h"
 #include "common/common.h"
 #include "core/core.h"
+#include "replay/event_search.h"
 #include "replay/replay_driver.h"
 #include "type_helpers.h"
 
@@ -155,6 +156,9 @@ public:
 
   FrameDescription GetFrameInfo();
   rdctype::array<DrawcallDescription> GetDrawcalls();
+  DrawcallDescription GetDrawcall(uint32_t eventID);
+  rdctype::array<uint32_t> GetDrawcallChildren(uint32_t eventID);
+  rdctype::array<uint32_t> FindEvents(const char *text, uint32_t afterEventID, uint32_t maxResults);
   rdctype::array<CounterResult> FetchCounters(const rdctype::array<GPUCounter> &counters);
   rdctype::array<GPUCounter> EnumerateCounters();
   CounterDescription DescribeCounter(GPUCounter counterID);
@@ -175,8 +179,12 @@ public:
 
   rdctype::array<EventUsage> GetUsage(ResourceId id);
 
-  rdctype::array<byte> GetBufferData(ResourceId buff, uint64_t offset, uint64_t len);
-  rdctype::array<byte> GetTextureData(ResourceId buff, uint32_t arrayIdx, uint32_t mip);
+  rdctype::bytebuf GetBufferData(ResourceId buff, uint64_t offset, uint64_t len);
+  rdctype::bytebuf GetTextureData(ResourceId buff, uint32_t arrayIdx, uint32_t mip);
+
+  uint64_t GetBufferDataInto(ResourceId buff, uint64_t offset, byte *dest, uint64_t destSize);
+  uint64_t GetTextureDataInto(ResourceId tex, uint32_t arrayIdx, uint32_t mip, byte *dest,
+                              uint64_t destSize);
 
   bool SaveTexture(const TextureSave &saveData, const char *path);
 
@@ -199,6 +207,7 @@ private:
   IReplayDriver *GetDevice() { return m_pDevice; }
   FrameRecord m_FrameRecord;
   vector<DrawcallDescription *> m_Drawcalls;
+  EventSearchIndex m_SearchIndex;
 
   uint32_t m_EventID;
 
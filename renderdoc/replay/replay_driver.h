@@ -29,6 +29,8 @@
 #include "core/core.h"
 #include "maths/vec.h"
 
+class ReplayCache;
+
 struct FrameRecord
 {
   FrameDescription frameInfo;
@@ -88,6 +90,31 @@ public:
   virtual vector<ResourceId> GetTextures() = 0;
   virtual TextureDescription GetTexture(ResourceId id) = 0;
 
+  // bulk versions of the above, returning every resource's description in one call. Drivers only
+  // need to override these if they can do better than one query per resource, such as the proxy
+  // which can fetch everything in one round-trip.
+  virtual vector<BufferDescription> GetBufferDescriptions()
+  {
+    vector<ResourceId> ids = GetBuffers();
+
+    vector<BufferDescription> ret(ids.size());
+    for(size_t i = 0; i < ids.size(); i++)
+      ret[i] = GetBuffer(ids[i]);
+
+    return ret;
+  }
+
+  virtual vector<TextureDescription> GetTextureDescriptions()
+  {
+    vector<ResourceId> ids = GetTextures();
+
+    vector<TextureDescription> ret(ids.size());
+    for(size_t i = 0; i < ids.size(); i++)
+      ret[i] = GetTexture(ids[i]);
+
+    return ret;
+  }
+
   virtual vector<DebugMessage> GetDebugMessages() = 0;
 
   virtual ShaderReflection *GetShader(ResourceId shader, string entryPoint) = 0;
@@ -116,6 +143,10 @@ public:
 
   virtual void GetBufferData(ResourceId buff, uint64_t offset, uint64_t len,
                              vector<byte> &retData) = 0;
+  // as GetBufferData, but reads straight into len bytes at dest. The range is clamped to the end of
+  // the buffer, and the number of bytes written is returned
+  virtual uint64_t GetBufferDataInto(ResourceId buff, uint64_t offset, uint64_t len,
+                                     byte *dest) = 0;
   virtual byte *GetTextureData(ResourceId tex, uint32_t arrayIdx, uint32_t mip,
                                const GetTextureDataParams &params, size_t &dataSize) = 0;
 
@@ -177,6 +208,10 @@ public:
                             CompType typeHint, float minval, float maxval, bool channels[4],
                             vector<uint32_t> &histogram) = 0;
 
+  // the cache of results derived from this capture that's kept between replays, or NULL if there
+  // isn't one
+  virtual ReplayCache *GetReplayCache() = 0;
+
   virtual ResourceId CreateProxyTexture(const TextureDescription &templateTex) = 0;
   virtual void SetProxyTextureData(ResourceId texid, uint32_t arrayIdx, uint32_t mip, byte *data,
                                    size_t dataSize) = 0;
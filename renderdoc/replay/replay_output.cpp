@@ -24,6 +24,7 @@
  ******************************************************************************/
 
 #include "common/common.h"
+#include "core/replay_cache.h"
 #include "maths/matrix.h"
 #include "serialise/string_utils.h"
 #include "replay_controller.h"
@@ -282,8 +283,7 @@ bool ReplayOutput::AddThumbnail(WindowingSystem system, void *data, ResourceId t
 
 rdctype::pair<PixelValue, PixelValue> ReplayOutput::GetMinMax()
 {
-  PixelValue minval;
-  PixelValue maxval;
+  PixelValue minmax[2];
 
   ResourceId tex = m_pDevice->GetLiveID(m_RenderData.texDisplay.texid);
 
@@ -292,17 +292,52 @@ rdctype::pair<PixelValue, PixelValue> ReplayOutput::GetMinMax()
   uint32_t mip = m_RenderData.texDisplay.mip;
   uint32_t sample = m_RenderData.texDisplay.sampleIdx;
 
+  bool custom = false;
+
   if(m_RenderData.texDisplay.CustomShader != ResourceId() && m_CustomShaderResourceId != ResourceId())
   {
     tex = m_CustomShaderResourceId;
     typeHint = CompType::Typeless;
     slice = 0;
     sample = 0;
+    custom = true;
+  }
+
+  // a texture's contents at an event are the same every time the capture is replayed, so the
+  // result is cached under the capture's own ID for the texture. The output of a custom shader
+  // also depends on the shader, so that isn't cached.
+  ReplayCache *cache = custom ? NULL : m_pDevice->GetReplayCache();
+  uint64_t key = 0;
+
+  if(cache && cache->IsOpen())
+  {
+    const char tag[] = "minmax";
+    ResourceId origTex = m_RenderData.texDisplay.texid;
+
+    key = Hash64(tag, sizeof(tag));
+    key = Hash64(&m_EventID, sizeof(m_EventID), key);
+    key = Hash64(&origTex, sizeof(origTex), key);
+    key = Hash64(&slice, sizeof(slice), key);
+    key = Hash64(&mip, sizeof(mip), key);
+    key = Hash64(&sample, sizeof(sample), key);
+    key = Hash64(&typeHint, sizeof(typeHint), key);
+
+    const byte *data = NULL;
+    uint64_t size = 0;
+    if(cache->Find(key, data, size) && size == sizeof(minmax))
+    {
+      memcpy(minmax, data, sizeof(minmax));
+      return rdctype::make_pair(minmax[0], minmax[1]);
+    }
   }
 
-  m_pDevice->GetMinMax(tex, slice, mip, sample, typeHint, &minval.value_f[0], &minval.value_f[0]);
+  bool success =
+      m_pDevice->GetMinMax(tex, slice, mip, sample, typeHint, minmax[0].value_f, minmax[1].value_f);
+
+  if(success && key != 0)
+    cache->Add(key, (const byte *)minmax, sizeof(minmax));
 
-  return rdctype::make_pair(minval, maxval);
+  return rdctype::make_pair(minmax[0], minmax[1]);
 }
 
 rdctype::array<uint32_t> ReplayOutput::GetHistogram(float minval, float maxval, bool channels[4])
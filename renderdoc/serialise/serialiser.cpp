@@ -25,6 +25,8 @@
 
 #include "serialiser.h"
 #include <errno.h>
+#include <algorithm>
+#include <map>
 #include "3rdparty/lz4/lz4.h"
 #include "common/timing.h"
 #include "core/core.h"
@@ -237,6 +239,215 @@ struct CompressedFileIO
   size_t m_CompressSize;
 };
 
+namespace ChunkSpill
+{
+static Threading::CriticalSection SpillLock;
+static string SpillFilename;
+static FILE *SpillFile = NULL;
+static uint64_t SpillSize = 0;
+static bool SpillFailed = false;
+
+struct SpillRange
+{
+  uint32_t length;
+  uint32_t refs;
+};
+
+// ranges currently referenced by one or more chunks, by offset
+static std::map<uint64_t, SpillRange> SpillRanges;
+
+// released ranges available for re-use. Adjacent ranges are merged, and FreeBySize indexes the
+// same ranges to find the smallest one that fits a new chunk.
+static std::map<uint64_t, uint64_t> FreeByOffset;
+static std::multimap<uint64_t, uint64_t> FreeBySize;
+
+static void RemoveFree(std::map<uint64_t, uint64_t>::iterator it)
+{
+  auto range = FreeBySize.equal_range(it->second);
+  for(auto s = range.first; s != range.second; ++s)
+  {
+    if(s->second == it->first)
+    {
+      FreeBySize.erase(s);
+      break;
+    }
+  }
+
+  FreeByOffset.erase(it);
+}
+
+static void AddFree(uint64_t offset, uint64_t length)
+{
+  // merge with the following free range
+  auto next = FreeByOffset.find(offset + length);
+  if(next != FreeByOffset.end())
+  {
+    length += next->second;
+    RemoveFree(next);
+  }
+
+  // merge with the preceding free range
+  auto prev = FreeByOffset.lower_bound(offset);
+  if(prev != FreeByOffset.begin())
+  {
+    --prev;
+    if(prev->first + prev->second == offset)
+    {
+      offset = prev->first;
+      length += prev->second;
+      RemoveFree(prev);
+    }
+  }
+
+  // space at the end of the file is simply handed back, the file is never truncated
+  if(offset + length == SpillSize)
+  {
+    SpillSize = offset;
+    return;
+  }
+
+  FreeByOffset[offset] = length;
+  FreeBySize.insert(std::make_pair(length, offset));
+}
+
+static uint64_t Allocate(uint32_t length)
+{
+  auto it = FreeBySize.lower_bound(length);
+
+  if(it == FreeBySize.end())
+  {
+    uint64_t offset = SpillSize;
+    SpillSize += length;
+    return offset;
+  }
+
+  uint64_t offset = it->second;
+  uint64_t freeLength = it->first;
+
+  FreeBySize.erase(it);
+  FreeByOffset.erase(offset);
+
+  if(freeLength > length)
+  {
+    FreeByOffset[offset + length] = freeLength - length;
+    FreeBySize.insert(std::make_pair(freeLength - length, offset + length));
+  }
+
+  return offset;
+}
+
+void SetFilename(const std::string &filename)
+{
+  SCOPED_LOCK(SpillLock);
+  SpillFilename = filename;
+}
+
+static bool Write(const byte *data, uint32_t length, uint64_t &offset)
+{
+  SCOPED_LOCK(SpillLock);
+
+  if(SpillFile == NULL)
+  {
+    if(SpillFailed || SpillFilename.empty())
+      return false;
+
+#if ENABLED(RDOC_WIN32)
+    // D - delete the file when it's closed, including when the process exits without shutdown
+    SpillFile = FileIO::fopen(SpillFilename.c_str(), "w+bD");
+#else
+    SpillFile = FileIO::fopen(SpillFilename.c_str(), "w+b");
+#endif
+
+    if(SpillFile == NULL)
+    {
+      RDCERR("Can't open chunk spill file '%s', errno %d. Chunks will be kept in memory",
+             SpillFilename.c_str(), errno);
+      SpillFailed = true;
+      return false;
+    }
+
+    RDCLOG("Spilling chunks to '%s'", SpillFilename.c_str());
+
+#if DISABLED(RDOC_WIN32)
+    // the open handle keeps the data alive, so unlinking it now means the file is removed even if
+    // the process exits without shutting down
+    FileIO::Delete(SpillFilename.c_str());
+#endif
+
+    SpillSize = 0;
+  }
+
+  uint64_t dst = Allocate(length);
+
+  FileIO::fseek64(SpillFile, dst, SEEK_SET);
+
+  if(FileIO::fwrite(data, 1, length, SpillFile) != length)
+  {
+    AddFree(dst, length);
+    return false;
+  }
+
+  SpillRange &range = SpillRanges[dst];
+  range.length = length;
+  range.refs = 1;
+
+  offset = dst;
+
+  return true;
+}
+
+static bool Read(uint64_t offset, byte *data, uint32_t length)
+{
+  SCOPED_LOCK(SpillLock);
+
+  if(SpillFile == NULL)
+    return false;
+
+  FileIO::fseek64(SpillFile, offset, SEEK_SET);
+
+  return FileIO::fread(data, 1, length, SpillFile) == length;
+}
+
+static void AddRef(uint64_t offset)
+{
+  SCOPED_LOCK(SpillLock);
+
+  auto it = SpillRanges.find(offset);
+  if(it != SpillRanges.end())
+    it->second.refs++;
+}
+
+static void Release(uint64_t offset)
+{
+  SCOPED_LOCK(SpillLock);
+
+  auto it = SpillRanges.find(offset);
+  if(it == SpillRanges.end())
+    return;
+
+  if(--it->second.refs > 0)
+    return;
+
+  AddFree(offset, it->second.length);
+  SpillRanges.erase(it);
+}
+
+void Shutdown()
+{
+  SCOPED_LOCK(SpillLock);
+
+  // the file was opened to be deleted on close, so closing it is all that's needed
+  if(SpillFile)
+    FileIO::fclose(SpillFile);
+
+  SpillFile = NULL;
+  SpillSize = 0;
+  SpillRanges.clear();
+  FreeByOffset.clear();
+  FreeBySize.clear();
+}
+};
+
 Chunk::Chunk(Serialiser *ser, uint32_t chunkType, bool temporary)
 {
   m_Length = (uint32_t)ser->GetOffset();
@@ -247,6 +458,13 @@ Chunk::Chunk(Serialiser *ser, uint32_t chunkType, bool temporary)
 
   m_Temporary = temporary;
 
+  m_Spilled = false;
+  m_DataExposed = false;
+  m_SpillOffset = 0;
+
+  m_DataRefs = new int32_t;
+  *m_DataRefs = 1;
+
   if(ser->HasAlignedData())
   {
     m_Data = Serialiser::AllocAlignedBuffer(m_Length);
@@ -287,13 +505,37 @@ Chunk *Chunk::Duplicate()
   ret->m_ChunkType = m_ChunkType;
   ret->m_Temporary = m_Temporary;
   ret->m_AlignedData = m_AlignedData;
-
-  if(m_AlignedData)
-    ret->m_Data = Serialiser::AllocAlignedBuffer(m_Length);
+  ret->m_Spilled = m_Spilled;
+  ret->m_DataExposed = false;
+  ret->m_SpillOffset = m_SpillOffset;
+
+  // both spilled ranges and in-memory data are reference counted, so a chunk can be duplicated
+  // just by referencing the same data. The exception is data that might be written to after this
+  // point, which has to be copied.
+  if(m_Spilled)
+  {
+    ChunkSpill::AddRef(m_SpillOffset);
+    ret->m_Data = NULL;
+    ret->m_DataRefs = NULL;
+  }
+  else if(!m_DataExposed)
+  {
+    Atomic::Inc32(m_DataRefs);
+    ret->m_Data = m_Data;
+    ret->m_DataRefs = m_DataRefs;
+  }
   else
-    ret->m_Data = new byte[m_Length];
+  {
+    if(m_AlignedData)
+      ret->m_Data = Serialiser::AllocAlignedBuffer(m_Length);
+    else
+      ret->m_Data = new byte[m_Length];
+
+    memcpy(ret->m_Data, m_Data, m_Length);
 
-  memcpy(ret->m_Data, m_Data, m_Length);
+    ret->m_DataRefs = new int32_t;
+    *ret->m_DataRefs = 1;
+  }
 
 #if ENABLED(RDOC_DEVEL)
   int64_t newval = Atomic::Inc64(&m_LiveChunks);
@@ -311,6 +553,47 @@ Chunk *Chunk::Duplicate()
   return ret;
 }
 
+void Chunk::Spill()
+{
+  if(m_Spilled || m_Length == 0)
+    return;
+
+  // if the write fails for any reason, the chunk just stays in memory
+  if(!ChunkSpill::Write(m_Data, m_Length, m_SpillOffset))
+    return;
+
+  ReleaseData();
+
+  m_Spilled = true;
+}
+
+void Chunk::ReleaseData()
+{
+  if(m_Data == NULL)
+    return;
+
+  // duplicates may still be referencing the data, e.g. in a capture being written
+  if(Atomic::Dec32(m_DataRefs) == 0)
+  {
+    if(m_AlignedData)
+      Serialiser::FreeAlignedBuffer(m_Data);
+    else
+      delete[] m_Data;
+
+    delete m_DataRefs;
+  }
+
+  m_Data = NULL;
+  m_DataRefs = NULL;
+}
+
+bool Chunk::ReadSpilledData(byte *dst)
+{
+  RDCASSERT(m_Spilled);
+
+  return ChunkSpill::Read(m_SpillOffset, dst, m_Length);
+}
+
 Chunk::~Chunk()
 {
 #if ENABLED(RDOC_DEVEL)
@@ -318,17 +601,10 @@ Chunk::~Chunk()
   Atomic::ExchAdd64(&m_TotalMem, -int64_t(m_Length));
 #endif
 
-  if(m_AlignedData)
-  {
-    if(m_Data)
-      Serialiser::FreeAlignedBuffer(m_Data);
+  if(m_Spilled)
+    ChunkSpill::Release(m_SpillOffset);
 
-    m_Data = NULL;
-  }
-  else
-  {
-    SAFE_DELETE_ARRAY(m_Data);
-  }
+  ReleaseData();
 }
 
 /*
@@ -1397,6 +1673,12 @@ void Serialiser::FlushToDisk()
     uint64_t offs = 0;
     uint64_t alignedoffs = 0;
 
+    // scratch memory to read spilled chunks back into. Chunks are only spilled when captures are
+    // written on the background writer thread, see ResourceManager::SpillEnabled
+    vector<byte> spillData;
+
+    SortChunks();
+
     // write frame capture contents
     for(size_t i = 0; i < m_Chunks.size(); i++)
     {
@@ -1434,7 +1716,24 @@ void Serialiser::FlushToDisk()
         }
       }
 
-      fwriter.Write(chunk->GetData(), chunk->GetLength());
+      if(chunk->IsSpilled())
+      {
+        if(spillData.size() < chunk->GetLength())
+          spillData.resize(chunk->GetLength());
+
+        if(!chunk->ReadSpilledData(&spillData[0]))
+        {
+          RDCERR("Failed to read spilled chunk data back for '%s'", m_Filename.c_str());
+          m_ErrorCode = eSerError_FileIO;
+          m_HasError = true;
+        }
+
+        fwriter.Write(&spillData[0], chunk->GetLength());
+      }
+      else
+      {
+        fwriter.Write(chunk->m_Data, chunk->GetLength());
+      }
 
       offs += chunk->GetLength();
 
@@ -1821,6 +2120,127 @@ void Serialiser::Insert(Chunk *chunk)
   m_DebugText += chunk->GetDebugString();
 }
 
+static bool ChunkIDLess(const ChunkList::value_type &a, const ChunkList::value_type &b)
+{
+  return a.first < b.first;
+}
+
+void Serialiser::InsertSorted(const ChunkList &chunks)
+{
+  if(chunks.empty())
+    return;
+
+  size_t offset = m_Chunks.size();
+
+  m_SortRanges.push_back(SortRange());
+  m_SortRanges.back().offset = offset;
+  m_SortRanges.back().ids.reserve(chunks.size());
+
+  for(size_t i = 0; i < chunks.size(); i++)
+  {
+    m_SortRanges.back().ids.push_back(chunks[i].first);
+    m_Chunks.push_back(chunks[i].second);
+  }
+
+  // the debug text is appended as chunks are inserted, so it needs them in order now
+  if(m_DebugTextWriting)
+  {
+    SortChunks();
+
+    for(size_t i = offset; i < m_Chunks.size(); i++)
+      m_DebugText += m_Chunks[i]->GetDebugString();
+  }
+}
+
+void Serialiser::SortChunks()
+{
+  // go from the last range back, so removing duplicates doesn't move the ranges still to sort
+  for(size_t r = m_SortRanges.size(); r > 0; r--)
+  {
+    SortRange &range = m_SortRanges[r - 1];
+
+    ChunkList sorted;
+    sorted.reserve(range.ids.size());
+
+    for(size_t i = 0; i < range.ids.size(); i++)
+      sorted.push_back(std::make_pair(range.ids[i], m_Chunks[range.offset + i]));
+
+    std::stable_sort(sorted.begin(), sorted.end(), ChunkIDLess);
+
+    size_t count = 0;
+
+    for(size_t i = 0; i < sorted.size(); i++)
+    {
+      if(count > 0 && sorted[i].first == sorted[count - 1].first)
+      {
+        if(sorted[i].second->IsTemporary() && sorted[i].second != sorted[count - 1].second)
+          SAFE_DELETE(sorted[i].second);
+
+        continue;
+      }
+
+      sorted[count++] = sorted[i];
+    }
+
+    for(size_t i = 0; i < count; i++)
+      m_Chunks[range.offset + i] = sorted[i].second;
+
+    m_Chunks.erase(m_Chunks.begin() + range.offset + count,
+                   m_Chunks.begin() + range.offset + sorted.size());
+  }
+
+  m_SortRanges.clear();
+}
+
+void Serialiser::TakeChunkOwnership()
+{
+  for(size_t i = 0; i < m_Chunks.size(); i++)
+  {
+    if(m_Chunks[i]->IsTemporary())
+      continue;
+
+    m_Chunks[i] = m_Chunks[i]->Duplicate();
+    m_Chunks[i]->m_Temporary = true;
+  }
+}
+
+void Serialiser::ReplaceChunk(size_t idx, Chunk *chunk)
+{
+  if(idx >= m_Chunks.size())
+  {
+    RDCERR("Replacing chunk %llu out of bounds", (uint64_t)idx);
+    return;
+  }
+
+  if(m_Chunks[idx]->IsTemporary())
+    SAFE_DELETE(m_Chunks[idx]);
+
+  m_Chunks[idx] = chunk;
+}
+
+uint64_t Serialiser::GetInsertedChunkSize() const
+{
+  uint64_t ret = 0;
+
+  for(size_t i = 0; i < m_Chunks.size(); i++)
+    ret += m_Chunks[i]->GetLength();
+
+  return ret;
+}
+
+uint64_t Serialiser::GetChunkMemorySize(bool includeShared) const
+{
+  uint64_t ret = 0;
+
+  for(size_t i = 0; i < m_Chunks.size(); i++)
+  {
+    if(!m_Chunks[i]->IsSpilled() && (includeShared || !m_Chunks[i]->IsShared()))
+      ret += m_Chunks[i]->GetLength();
+  }
+
+  return ret;
+}
+
 void Serialiser::AlignNextBuffer(const size_t alignment)
 {
   // on new logs, we don't have to align. This code will be deleted once backwards-compat is dropped
@@ -34,6 +34,7 @@
 #include <vector>
 #include "api/replay/basic_types.h"
 #include "common/common.h"
+#include "core/capture_stats.h"
 #include "os/os_specific.h"
 #include "replay/type_helpers.h"
 
@@ -89,6 +90,15 @@ class Serialiser;
 class ScopedContext;
 struct CompressedFileIO;
 
+// chunks can be spilled to a temporary file that lives as long as the process, freeing their
+// memory. Spilled chunks are duplicated by reference, and read back when they're written out. The
+// space is re-used once the last chunk referencing it is deleted.
+namespace ChunkSpill
+{
+void SetFilename(const std::string &filename);
+void Shutdown();
+};
+
 // holds the memory, length and type for a given chunk, so that it can be
 // passed around and moved between owners before being serialised out
 class Chunk
@@ -97,11 +107,24 @@ public:
   ~Chunk();
 
   const char *GetDebugString() { return m_DebugStr.c_str(); }
-  byte *GetData() { return m_Data; }
+  // the returned pointer may be written through after the chunk is created, so a chunk whose data
+  // has been fetched is copied rather than shared when it's duplicated
+  byte *GetData()
+  {
+    m_DataExposed = true;
+    return m_Data;
+  }
   uint32_t GetLength() { return m_Length; }
   uint32_t GetChunkType() { return m_ChunkType; }
   bool IsAligned() { return m_AlignedData; }
   bool IsTemporary() { return m_Temporary; }
+  // spilled chunks have no data in memory, see ReadSpilledData. Chunks must not be spilled while
+  // anything holds a pointer to their data
+  bool IsSpilled() { return m_Spilled; }
+  // whether the in-memory data is also referenced by a duplicate of this chunk
+  bool IsShared() { return m_DataRefs && *m_DataRefs > 1; }
+  void Spill();
+  bool ReadSpilledData(byte *dst);
 #if ENABLED(RDOC_DEVEL)
   static uint64_t NumLiveChunks() { return m_LiveChunks; }
   static uint64_t TotalMem() { return m_TotalMem; }
@@ -113,23 +136,34 @@ public:
   // grab current contents of the serialiser into this chunk
   Chunk(Serialiser *ser, uint32_t chunkType, bool temp);
 
+  // in-memory data is reference counted, so this only copies the data if it could be modified
+  // through GetData()
   Chunk *Duplicate();
 
 private:
   Chunk() {}
+  void ReleaseData();
+
   // no copy semantics
   Chunk(const Chunk &);
   Chunk &operator=(const Chunk &);
 
   friend class ScopedContext;
+  friend class Serialiser;
 
   bool m_AlignedData;
   bool m_Temporary;
+  bool m_Spilled;
+  bool m_DataExposed;
+
+  uint64_t m_SpillOffset;
 
   uint32_t m_ChunkType;
 
   uint32_t m_Length;
   byte *m_Data;
+  // shared by every duplicate referencing m_Data
+  int32_t *m_DataRefs;
   string m_DebugStr;
 
 #if ENABLED(RDOC_DEVEL)
@@ -137,6 +171,10 @@ private:
 #endif
 };
 
+// chunks gathered from resource records, paired with the ID they were recorded with so they can be
+// put back in recording order. See Serialiser::InsertSorted
+typedef vector<std::pair<int32_t, Chunk *> > ChunkList;
+
 // this class has a few functions. It can be used to serialise chunks - on writing it enforces
 // that we only ever write a single chunk, then pull out the data into a Chunk class and erase
 // the contents of the serialiser ready to serialise the next (see the RDCASSERT at the start
@@ -572,6 +610,29 @@ public:
 
   void FlushToDisk();
 
+  // inserts chunks in any order. They're sorted by ID when the serialiser is flushed instead of
+  // now, so that happens on whichever thread writes the capture. As with inserting into a map, only
+  // the first chunk with each ID is kept.
+  void InsertSorted(const ChunkList &chunks);
+
+  // replaces any inserted chunks that are owned elsewhere with temporary duplicates, so that the
+  // serialiser can be flushed after the originals have been freed. Duplicates share the original's
+  // data where possible, see Chunk::Duplicate.
+  void TakeChunkOwnership();
+
+  // the total size of all chunks inserted so far, before compression
+  uint64_t GetInsertedChunkSize() const;
+  // the memory held by inserted chunks that aren't spilled to disk. Without includeShared, only
+  // counts chunks whose data would be freed along with the serialiser.
+  uint64_t GetChunkMemorySize(bool includeShared) const;
+  size_t GetNumInsertedChunks() const { return m_Chunks.size(); }
+
+  // replaces a previously inserted chunk, freeing it if it was temporary. The debug text is not
+  // updated.
+  void ReplaceChunk(size_t idx, Chunk *chunk);
+
+  const string &GetFilename() const { return m_Filename; }
+
   // set a function used when serialising a text representation
   // of the chunks
   void SetChunkNameLookup(ChunkLookup lookup) { m_ChunkLookup = lookup; }
@@ -699,6 +760,16 @@ private:
   // writing to file
   vector<Chunk *> m_Chunks;
 
+  // ranges of m_Chunks added with InsertSorted that haven't been sorted yet, with the chunk IDs
+  struct SortRange
+  {
+    size_t offset;
+    vector<int32_t> ids;
+  };
+  vector<SortRange> m_SortRanges;
+
+  void SortChunks();
+
   // a database of strings read from the file, useful when serialised structures
   // expect a char* to return and point to static memory
   set<string> m_StringDB;
@@ -738,7 +809,12 @@ public:
   Chunk *Get(bool temporary = false)
   {
     End();
-    return new Chunk(m_Ser, m_Idx, temporary);
+    Chunk *ret = new Chunk(m_Ser, m_Idx, temporary);
+
+    if(CaptureStats::IsEnabled())
+      CaptureStats::AddChunk(m_Idx, ret->GetLength());
+
+    return ret;
   }
 
 private:
@@ -771,6 +771,16 @@ int renderdoccmd(std::vector<std::string> &argv)
               "Capturing Option: Save all initial resource contents at frame start.");
       cmd.add("opt-capture-all-cmd-lists", 0,
               "Capturing Option: In D3D11, record all command lists from application start.");
+      cmd.add("opt-async-capture-write", 0,
+              "Capturing Option: Write captures to disk on a background thread.");
+      cmd.add<int>("opt-retroactive-frames", 0,
+                   "Capturing Option: Keep this many recent frames in memory, and write them out "
+                   "when a capture is triggered.",
+                   false, 0);
+      cmd.add("opt-capture-statistics", 0,
+              "Capturing Option: Gather statistics on capture overhead, stored in the capture.");
+      cmd.add("opt-spill-resource-chunks", 0,
+              "Capturing Option: Spill resource creation data to disk while not capturing.");
     }
 
     cmd.parse_check(argv, true);
@@ -802,6 +812,15 @@ int renderdoccmd(std::vector<std::string> &argv)
         opts.SaveAllInitials = true;
       if(cmd.exist("opt-capture-all-cmd-lists"))
         opts.CaptureAllCmdLists = true;
+      if(cmd.exist("opt-async-capture-write"))
+        opts.AsyncCaptureWrite = true;
+
+      opts.RetroactiveFrames = (uint32_t)cmd.get<int>("opt-retroactive-frames");
+
+      if(cmd.exist("opt-capture-statistics"))
+        opts.CaptureStatistics = true;
+      if(cmd.exist("opt-spill-resource-chunks"))
+        opts.SpillResourceChunks = true;
 
       opts.DelayForDebugger = (uint32_t)cmd.get<int>("opt-delay-for-debugger");
     }
@@ -80,5 +80,9 @@ public class CaptureOptions
         public bool SaveAllInitials;
         public bool CaptureAllCmdLists;
         public bool DebugOutputMute;
+        public bool AsyncCaptureWrite;
+        public UInt32 RetroactiveFrames;
+        public bool CaptureStatistics;
+        public bool SpillResourceChunks;
     };
 };
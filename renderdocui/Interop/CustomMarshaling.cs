@@ -38,6 +38,14 @@ public struct templated_array
         public IntPtr elems;
         public Int32 count;
     };
+
+    // corresponds to rdctype::bytebuf on the C side
+    [StructLayout(LayoutKind.Sequential)]
+    public struct templated_bytebuf
+    {
+        public IntPtr elems;
+        public UInt64 count;
+    };
     
     public enum CustomUnmanagedType
     {
@@ -400,6 +408,22 @@ public static object GetTemplatedArray(IntPtr sourcePtr, Type structureType, boo
             }
         }
 
+        // this function takes a pointer to a byte buffer and returns its contents as a byte array,
+        // cleaning up the memory if specified.
+        public static byte[] GetByteBuf(IntPtr sourcePtr, bool freeMem)
+        {
+            templated_bytebuf buf = (templated_bytebuf)Marshal.PtrToStructure(sourcePtr, typeof(templated_bytebuf));
+
+            byte[] val = new byte[buf.count];
+            if (val.Length > 0)
+                Marshal.Copy(buf.elems, val, 0, val.Length);
+
+            if (freeMem)
+                RENDERDOC_FreeArrayMem(buf.elems);
+
+            return val;
+        }
+
         public static string PtrToStringUTF8(IntPtr elems, int count)
         {
             byte[] buffer = new byte[count];
@@ -83,6 +83,8 @@ public struct NewCaptureData
             [CustomMarshalAs(CustomUnmanagedType.UTF8TemplatedString)]
             public string path;
             public bool local;
+            [CustomMarshalAs(CustomUnmanagedType.UTF8TemplatedString)]
+            public string statistics;
         };
         [CustomMarshalAs(CustomUnmanagedType.CustomClass)]
         public NewCaptureData NewCapture;
@@ -789,11 +791,11 @@ public MeshFormat GetPostVSData(UInt32 instID, MeshDataStage stage)
 
         public byte[] GetBufferData(ResourceId buff, UInt64 offset, UInt64 len)
         {
-            IntPtr mem = CustomMarshal.Alloc(typeof(templated_array));
+            IntPtr mem = CustomMarshal.Alloc(typeof(templated_bytebuf));
 
             ReplayRenderer_GetBufferData(m_Real, buff, offset, len, mem);
 
-            byte[] ret = (byte[])CustomMarshal.GetTemplatedArray(mem, typeof(byte), true);
+            byte[] ret = CustomMarshal.GetByteBuf(mem, true);
 
             CustomMarshal.Free(mem);
 
@@ -802,11 +804,11 @@ public byte[] GetBufferData(ResourceId buff, UInt64 offset, UInt64 len)
 
         public byte[] GetTextureData(ResourceId tex, UInt32 arrayIdx, UInt32 mip)
         {
-            IntPtr mem = CustomMarshal.Alloc(typeof(templated_array));
+            IntPtr mem = CustomMarshal.Alloc(typeof(templated_bytebuf));
 
             ReplayRenderer_GetTextureData(m_Real, tex, arrayIdx, mip, mem);
 
-            byte[] ret = (byte[])CustomMarshal.GetTemplatedArray(mem, typeof(byte), true);
+            byte[] ret = CustomMarshal.GetByteBuf(mem, true);
 
             CustomMarshal.Free(mem);
 